@@ -0,0 +1,121 @@
+#!/usr/bin/env python2
+from PIL import Image
+import struct
+
+# Animation file format, see custom_fs.h
+ANIMATION_MAGIC = 0xA1F5
+ANIMATION_XOR_FLAG = 0x01
+ANIMATION_RLE_FLAG = 0x02
+ANIMATION_DEPTH = 4
+
+# Display and buses, see platform_defines.h
+DISPLAY_WIDTH = 256
+DISPLAY_HEIGHT = 64
+OLED_SPI_FREQUENCY = 4000000
+DATAFLASH_SPI_FREQUENCY = 12000000
+
+# Load a picture as display rows of 2 pixels columns, first pixel in the high nibble
+def loadFrame(filename):
+	image = Image.open(filename)
+	image = image.convert(mode="L")
+
+	# Check size
+	if image.size[0] > DISPLAY_WIDTH or image.size[1] > DISPLAY_HEIGHT:
+		print "Picture " + filename + " is larger than 256x64"
+		return None
+
+	# Pictures smaller than the display are drawn at 0,0
+	frame = [[0] * (DISPLAY_WIDTH/2) for y in range(DISPLAY_HEIGHT)]
+	for y in range(0, image.size[1]):
+		for x in range(0, image.size[0]):
+			frame[y][x/2] |= (image.getpixel((x, y)) >> 4) << (4 if x % 2 == 0 else 0)
+	return frame
+
+# RLE encode data as <count-1> <byte> pairs
+def rleEncode(data):
+	encoded = []
+	i = 0
+	while i < len(data):
+		count = 1
+		while i + count < len(data) and count < 256 and data[i + count] == data[i]:
+			count += 1
+		encoded += [count - 1, data[i]]
+		i += count
+	return encoded
+
+# Get the changed rectangles between two frames: one rectangle per block of consecutive changed rows
+def getChangedRectangles(previous_frame, frame):
+	rectangles = []
+	y = 0
+	while y < DISPLAY_HEIGHT:
+		if previous_frame[y] == frame[y]:
+			y += 1
+			continue
+
+		# Grow the block while rows are changed
+		start_y = y
+		first_column = DISPLAY_WIDTH/2
+		last_column = 0
+		while y < DISPLAY_HEIGHT and previous_frame[y] != frame[y]:
+			changed_columns = [x for x in range(DISPLAY_WIDTH/2) if previous_frame[y][x] != frame[y][x]]
+			first_column = min(first_column, changed_columns[0])
+			last_column = max(last_column, changed_columns[-1])
+			y += 1
+		rectangles.append((first_column, start_y, last_column - first_column + 1, y - start_y))
+	return rectangles
+
+# Encode a changed rectangle, picking the smallest of replaced or xored, raw or RLE data
+def encodeRectangle(previous_frame, frame, rectangle, xor_allowed):
+	column, y, nb_columns, height = rectangle
+	raw_data = []
+	xor_data = []
+	for row in range(y, y + height):
+		raw_data += frame[row][column:column + nb_columns]
+		xor_data += [frame[row][x] ^ previous_frame[row][x] for x in range(column, column + nb_columns)]
+
+	candidates = [(0, raw_data), (ANIMATION_RLE_FLAG, rleEncode(raw_data))]
+	if xor_allowed:
+		candidates.append((ANIMATION_XOR_FLAG | ANIMATION_RLE_FLAG, rleEncode(xor_data)))
+	flags, data = min(candidates, key=lambda candidate: len(candidate[1]))
+	return struct.pack('<BBBBHH', column, y, nb_columns, height, flags, len(data)) + ''.join(chr(byte) for byte in data)
+
+# Encode frame pictures into an animation binary file, to be added to the bundle binary files
+def encodeAnimation(output_filename, frame_filenames, frame_period_ms):
+	# Previous frame, only xored with from the second frame
+	previous_frame = [[0] * (DISPLAY_WIDTH/2) for y in range(DISPLAY_HEIGHT)]
+	encoded_frames = ''
+	total_oled_bytes = 0
+
+	for frame_index, filename in enumerate(frame_filenames):
+		frame = loadFrame(filename)
+		if frame is None:
+			return
+
+		# First frame redraws the complete screen and can't be xored with unknown contents
+		if frame_index == 0:
+			rectangles = [(0, 0, DISPLAY_WIDTH/2, DISPLAY_HEIGHT)]
+		else:
+			rectangles = getChangedRectangles(previous_frame, frame)
+
+		encoded_rectangles = ''
+		for rectangle in rectangles:
+			encoded_rectangles += encodeRectangle(previous_frame, frame, rectangle, frame_index != 0)
+			total_oled_bytes += rectangle[2] * rectangle[3]
+
+		encoded_frames += struct.pack('<HHI', len(rectangles), 0, 8 + len(encoded_rectangles)) + encoded_rectangles
+		previous_frame = frame
+
+	# Binary file: <size> <animation header> <frames>
+	encoded_file = struct.pack('<HHHBB', ANIMATION_MAGIC, len(frame_filenames), frame_period_ms, ANIMATION_DEPTH, 0) + encoded_frames
+	output_file = open(output_filename, 'wb')
+	output_file.write(struct.pack('<I', len(encoded_file)) + encoded_file)
+	output_file.close()
+
+	# Bus bound estimate, flash reads and display writes not overlapping
+	nb_frames = len(frame_filenames)
+	full_frame_bytes = DISPLAY_WIDTH * DISPLAY_HEIGHT / 2
+	flash_time = len(encoded_frames) * 8.0 / DATAFLASH_SPI_FREQUENCY
+	oled_time = total_oled_bytes * 8.0 / OLED_SPI_FREQUENCY
+	print "Animation written to " + output_filename + ": " + str(nb_frames) + " frames, " + str(len(encoded_file)) + " bytes"
+	print "Average frame: " + str(len(encoded_frames) / nb_frames) + " bytes in flash, " + str(total_oled_bytes / nb_frames) + " bytes sent to display (full frame: " + str(full_frame_bytes) + ")"
+	print "Estimated bus bound frame rate: " + str(int(nb_frames / (flash_time + oled_time))) + " fps (full frames: " + str(int(OLED_SPI_FREQUENCY / 8.0 / full_frame_bytes)) + " fps)"
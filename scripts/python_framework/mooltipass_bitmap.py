@@ -0,0 +1,119 @@
+#!/usr/bin/env python2
+from PIL import Image
+import struct
+
+# Bitmap file format, see custom_fs.h
+BITMAP_RLE_FLAG = 0x01
+BITMAP_DEPTH = 4
+
+# Display and buses, see platform_defines.h
+DISPLAY_WIDTH = 256
+DISPLAY_HEIGHT = 64
+DATAFLASH_SPI_FREQUENCY = 12000000
+
+# Estimated RLE decoding cost when drawing into the frame buffer, flash reads excluded
+RLE_DECODE_NS_PER_PIXEL = 150
+# Max raw to RLE size ratio we accept to trade flash space for speed
+RAW_MAX_SIZE_RATIO = 4
+
+# Load a picture as a list of 4 bits pixels, row after row
+def loadBitmap(filename):
+	image = Image.open(filename)
+	image = image.convert(mode="L")
+	width, height = image.size
+
+	# Check size
+	if width > DISPLAY_WIDTH or height > DISPLAY_HEIGHT:
+		print "Picture " + filename + " is larger than 256x64"
+		return None
+
+	pixels = []
+	for y in range(0, height):
+		for x in range(0, width):
+			pixels.append(image.getpixel((x, y)) >> 4)
+	return (width, height, pixels)
+
+# Raw encode pixels as 2 pixels bytes, first pixel in the high nibble, rows not padded
+def rawEncodePixels(pixels):
+	if len(pixels) % 2 != 0:
+		pixels = pixels + [0]
+	return [(pixels[i] << 4) | pixels[i + 1] for i in range(0, len(pixels), 2)]
+
+# RLE encode pixels as <count-1> <color> nibbles, runs crossing rows
+def rleEncodePixels(pixels):
+	encoded = []
+	i = 0
+	while i < len(pixels):
+		count = 1
+		while i + count < len(pixels) and count < 16 and pixels[i + count] == pixels[i]:
+			count += 1
+		encoded.append(((count - 1) << 4) | pixels[i])
+		i += count
+	return encoded
+
+# Check if the raw bitmap qualifies for the firmware DMA fast path: byte aligned in the frame buffer
+def isDmaEligible(width, xpos):
+	return width % 2 == 0 and xpos % 2 == 0
+
+# Estimated draw time in us of raw (DMA fast path) and RLE bitmaps
+def estimateDrawTimes(width, height, raw_size, rle_size):
+	raw_time = raw_size * 8.0 * 1000000 / DATAFLASH_SPI_FREQUENCY
+	rle_time = rle_size * 8.0 * 1000000 / DATAFLASH_SPI_FREQUENCY + width * height * RLE_DECODE_NS_PER_PIXEL / 1000.0
+	return (raw_time, rle_time)
+
+# Encode a picture into a bundle bitmap file, stored raw when it is faster to draw and not too large
+def encodeBitmap(output_filename, picture_filename, xpos, ypos, force_raw=False):
+	bitmap = loadBitmap(picture_filename)
+	if bitmap is None:
+		return
+	width, height, pixels = bitmap
+
+	raw_data = rawEncodePixels(pixels)
+	rle_data = rleEncodePixels(pixels)
+	raw_time, rle_time = estimateDrawTimes(width, height, len(raw_data), len(rle_data))
+
+	# Raw storage is only worth it when the DMA fast path can be taken
+	store_raw = force_raw or (isDmaEligible(width, xpos) and raw_time < rle_time and len(raw_data) <= RAW_MAX_SIZE_RATIO * len(rle_data))
+	if store_raw:
+		flags, data = 0, raw_data
+	else:
+		flags, data = BITMAP_RLE_FLAG, rle_data
+
+	# Bitmap file: <bitmap header> <data>
+	output_file = open(output_filename, 'wb')
+	output_file.write(struct.pack('<HBBBBHH', width, height, xpos, ypos, BITMAP_DEPTH, flags, len(data)) + ''.join(chr(byte) for byte in data))
+	output_file.close()
+
+	print "Bitmap written to " + output_filename + ": " + str(width) + "x" + str(height) + ", " + ("raw" if store_raw else "RLE") + ", " + str(len(data)) + " bytes"
+	print "Raw: " + str(len(raw_data)) + " bytes, estimated " + str(int(raw_time)) + "us (DMA fast path: " + ("yes" if isDmaEligible(width, xpos) else "no") + ")"
+	print "RLE: " + str(len(rle_data)) + " bytes, estimated " + str(int(rle_time)) + "us"
+
+# Blend a foreground pixel over a background pixel, the foreground value being the white coverage, see sh1122_alpha_blend()
+def alphaBlendPixel(background, coverage):
+	return background + ((15 - background) * coverage + 7) // 15
+
+# Compute the firmware composite of a foreground picture blended over a background picture, for comparison with frame buffer captures
+def compositeReference(output_filename, background_filename, foreground_filename, xpos, ypos):
+	background = loadBitmap(background_filename)
+	foreground = loadBitmap(foreground_filename)
+	if background is None or foreground is None:
+		return
+	bg_width, bg_height, bg_pixels = background
+	fg_width, fg_height, fg_pixels = foreground
+
+	# Background at the top left of a black screen, foreground clipped to the screen
+	screen = [0] * (DISPLAY_WIDTH * DISPLAY_HEIGHT)
+	for y in range(0, bg_height):
+		for x in range(0, bg_width):
+			screen[y * DISPLAY_WIDTH + x] = bg_pixels[y * bg_width + x]
+	for y in range(0, fg_height):
+		for x in range(0, fg_width):
+			if 0 <= xpos + x < DISPLAY_WIDTH and 0 <= ypos + y < DISPLAY_HEIGHT:
+				index = (ypos + y) * DISPLAY_WIDTH + xpos + x
+				screen[index] = alphaBlendPixel(screen[index], fg_pixels[y * fg_width + x])
+
+	# 4 bits pixels scaled back to 8 bits gray levels
+	image = Image.new("L", (DISPLAY_WIDTH, DISPLAY_HEIGHT))
+	image.putdata([pixel * 17 for pixel in screen])
+	image.save(output_filename)
+	print "Composite reference written to " + output_filename
@@ -0,0 +1,52 @@
+#!/usr/bin/env python2
+import struct
+import zlib
+
+# Bundle format, see custom_fs.h
+BUNDLE_MAGIC = 0x12345678
+BUNDLE_CRC_START = 12
+BUNDLE_HEADER_FORMAT = '<III64sIIIIIIIIIIIII'
+FILE_CRC_MAGIC = 0xC3C5F11E
+FILE_CRC_HEADER_FORMAT = '<IIIII'
+NO_FILE_COUNT = 0xFFFFFFFF
+
+# Same crc32 as the firmware
+def crc32(data):
+	return zlib.crc32(data) & 0xFFFFFFFF
+
+# Append the file CRC table to a bundle image, one entry per file table entry, tables in header order
+def addBundleFileCrcs(input_filename, output_filename):
+	bundle = open(input_filename, 'rb').read()
+	header = struct.unpack_from(BUNDLE_HEADER_FORMAT, bundle)
+	total_size = header[1]
+
+	# Check bundle
+	if header[0] != BUNDLE_MAGIC or total_size > len(bundle):
+		print "Not a bundle image: " + input_filename
+		return
+	if len(bundle) > total_size:
+		print "Removing " + str(len(bundle) - total_size) + " bytes after the bundle"
+		bundle = bundle[:total_size]
+
+	# Update, string, fonts, bitmap and binary file tables
+	file_addresses = []
+	for i in range(0, 5):
+		count = header[4 + 2*i]
+		offset = header[5 + 2*i]
+		if count != NO_FILE_COUNT:
+			file_addresses += list(struct.unpack_from('<' + 'I' * count, bundle, offset))
+
+	# Files are stored one after the other after the file tables and language map, the last one ends with the bundle
+	file_starts = sorted(set(file_addresses)) + [total_size]
+	metadata_size = file_starts[0] - BUNDLE_CRC_START
+	entries = ''
+	for address in file_addresses:
+		size = file_starts[file_starts.index(address) + 1] - address
+		entries += struct.pack('<II', size, crc32(bundle[address:address+size]))
+
+	# Write bundle and table
+	table_header = struct.pack(FILE_CRC_HEADER_FORMAT, FILE_CRC_MAGIC, metadata_size, crc32(bundle[BUNDLE_CRC_START:BUNDLE_CRC_START+metadata_size]), len(file_addresses), crc32(entries))
+	output_file = open(output_filename, 'wb')
+	output_file.write(bundle + table_header + entries)
+	output_file.close()
+	print "Added CRCs of " + str(len(file_addresses)) + " files to " + output_filename
@@ -45,6 +45,16 @@ CMD_DBG_IS_DATA_FLASH_READY		= 0x8005
 CMD_DBG_DATAFLASH_WRITE_256B	= 0x8006
 CMD_DBG_REBOOT_TO_BOOTLOADER	= 0x8007
 CMD_DBG_GET_ACC_32_SAMPLES		= 0x8008
+CMD_DBG_GET_FRAME_BUFFER		= 0x8009
+
+# Frame buffer capture, see comms_hid_msgs_debug.h
+FB_CAPTURE_FLAG_DIRTY_ROWS_ONLY	= 0x01
+FB_CAPTURE_ROWS_PER_MSG			= 4
+FB_CAPTURE_NO_ROW				= 0xFF
+FB_CAPTURE_REPLY_LENGTH			= 12
+FB_WIDTH						= 256
+FB_HEIGHT						= 64
+FB_ROW_SIZE						= FB_WIDTH / 2
 
 # OLD Command IDs
 CMD_EXPORT_FLASH_START  = 0x8A
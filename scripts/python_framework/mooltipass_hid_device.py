@@ -214,6 +214,56 @@ class mooltipass_hid_device:
 		print "Sending done!"
 		
 	
+	# Capture the device frame buffer as a list of rows of 2 pixels bytes
+	# When the previous capture rows are given, only rows written since then are sent by the device
+	def captureFrameBuffer(self, previous_rows=None):
+		if previous_rows is None:
+			rows = [None] * FB_HEIGHT
+			flags = 0
+		else:
+			rows = list(previous_rows)
+			flags = FB_CAPTURE_FLAG_DIRTY_ROWS_ONLY
+		
+		# Data messages: <row indexes> <rows>, until the reply: <number of sent rows> <black rows bitmask>
+		packet = self.device.sendHidMessageWaitForAck(self.getPacketForCommand(CMD_DBG_GET_FRAME_BUFFER, [flags]))
+		while packet["len"] != FB_CAPTURE_REPLY_LENGTH:
+			for i in range(0, FB_CAPTURE_ROWS_PER_MSG):
+				row_index = packet["data"][i]
+				if row_index != FB_CAPTURE_NO_ROW:
+					rows[row_index] = packet["data"][FB_CAPTURE_ROWS_PER_MSG + i*FB_ROW_SIZE:FB_CAPTURE_ROWS_PER_MSG + (i+1)*FB_ROW_SIZE]
+			packet = self.device.receiveHidMessage()
+		
+		# Black rows aren't sent
+		nb_sent_rows, black_rows_low, black_rows_high = struct.unpack('<III', packet["data"].tostring())
+		black_rows = black_rows_low | (black_rows_high << 32)
+		for y in range(0, FB_HEIGHT):
+			if (black_rows >> y) & 0x01:
+				rows[y] = array('B', [0] * FB_ROW_SIZE)
+		return rows
+		
+	# Write captured frame buffer rows to a PNG file, 4 bits pixels being scaled to 8 bits gray levels
+	def frameBufferToPng(self, rows, filename):
+		pixels = []
+		for row in rows:
+			for byte in row:
+				pixels.extend([(byte >> 4) * 17, (byte & 0x0F) * 17])
+		image = Image.new("L", (FB_WIDTH, FB_HEIGHT))
+		image.putdata(pixels)
+		image.save(filename)
+		
+	# Capture frame buffers to numbered PNG files, only fetching written rows after the first capture if asked
+	def captureFrameBuffers(self, filename_prefix, nb_captures, dirty_rows_only):
+		rows = None
+		start_time = time.time()
+		for i in range(0, nb_captures):
+			if dirty_rows_only:
+				rows = self.captureFrameBuffer(rows)
+			else:
+				rows = self.captureFrameBuffer()
+			self.frameBufferToPng(rows, filename_prefix + str(i).zfill(4) + ".png")
+		end_time = time.time()
+		print str(nb_captures) + " captures in " + str(int((end_time-start_time)*1000)) + "ms, " + str(round(nb_captures / (end_time-start_time), 1)) + " captures/s"
+		
 	# Reboot to bootloader, no answer from device.
 	def rebootToBootloader(self):
 		self.device.sendHidMessage(self.getPacketForCommand(CMD_DBG_REBOOT_TO_BOOTLOADER, None))	
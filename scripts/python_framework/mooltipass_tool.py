@@ -1,5 +1,8 @@
 #!/usr/bin/env python2
 from mooltipass_hid_device import *
+from mooltipass_animation import *
+from mooltipass_bitmap import *
+from mooltipass_bundle import *
 from datetime import datetime
 from array import array
 import platform
@@ -8,7 +11,7 @@ import usb.util
 import random
 import time
 import sys
-nonConnectionCommands = []
+nonConnectionCommands = ["encodeAnimation", "encodeBitmap", "compositeReference", "addBundleFileCrcs"]
 
 def main():
 	skipConnection = False
@@ -62,6 +65,42 @@ def main():
 			else:
 				print "Please specify bundle filename"
 		
+		elif sys.argv[1] == "encodeAnimation":
+			# mooltipass_tool.py encodeAnimation output_filename frame_period_ms frame0 frame1 ...
+			if len(sys.argv) > 4:
+				encodeAnimation(sys.argv[2], sys.argv[4:], int(sys.argv[3]))
+			else:
+				print "Please specify output filename, frame period and frames"
+			
+		elif sys.argv[1] == "encodeBitmap":
+			# mooltipass_tool.py encodeBitmap output_filename picture_filename xpos ypos [forceRaw]
+			if len(sys.argv) > 5:
+				encodeBitmap(sys.argv[2], sys.argv[3], int(sys.argv[4]), int(sys.argv[5]), len(sys.argv) > 6 and sys.argv[6] == "forceRaw")
+			else:
+				print "Please specify output filename, picture filename and position"
+			
+		elif sys.argv[1] == "compositeReference":
+			# mooltipass_tool.py compositeReference output_filename background_filename foreground_filename xpos ypos
+			if len(sys.argv) > 6:
+				compositeReference(sys.argv[2], sys.argv[3], sys.argv[4], int(sys.argv[5]), int(sys.argv[6]))
+			else:
+				print "Please specify output filename, background and foreground filenames and foreground position"
+			
+		elif sys.argv[1] == "addBundleFileCrcs":
+			# mooltipass_tool.py addBundleFileCrcs input_filename output_filename
+			if len(sys.argv) > 3:
+				addBundleFileCrcs(sys.argv[2], sys.argv[3])
+			else:
+				print "Please specify input and output bundle filenames"
+			
+		elif sys.argv[1] == "captureFrameBuffer":
+			# mooltipass_tool.py captureFrameBuffer filename_prefix [nb_captures] [dirtyRowsOnly]
+			if len(sys.argv) > 2:
+				nb_captures = int(sys.argv[3]) if len(sys.argv) > 3 else 1
+				mooltipass_device.captureFrameBuffers(sys.argv[2], nb_captures, len(sys.argv) > 4 and sys.argv[4] == "dirtyRowsOnly")
+			else:
+				print "Please specify output filename prefix"
+			
 		elif sys.argv[1] == "rebootToBootloader":
 			mooltipass_device.rebootToBootloader()
 			
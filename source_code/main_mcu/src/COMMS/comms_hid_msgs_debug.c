@@ -59,6 +59,22 @@ void comms_hid_msgs_debug_printf(const char *fmt, ...)
 #pragma GCC diagnostic pop
 #endif
 
+#if defined(OLED_INTERNAL_FRAME_BUFFER) && defined(DEBUG_USB_COMMANDS_ENABLED)
+/*! \fn     comms_hid_msgs_debug_send_frame_buffer_rows(aux_mcu_message_t* message, uint16_t nb_rows)
+*   \brief  Send a frame buffer capture data message to USB
+*   \param  message     Message filled with the row indexes and row pixels
+*   \param  nb_rows     Number of rows in the message
+*/
+static void comms_hid_msgs_debug_send_frame_buffer_rows(aux_mcu_message_t* message, uint16_t nb_rows)
+{
+    message->message_type = AUX_MCU_MSG_TYPE_USB;
+    message->hid_message.message_type = HID_CMD_ID_GET_FRAME_BUFFER;
+    message->hid_message.payload_length = HID_FB_CAPTURE_ROWS_PER_MSG + nb_rows * sizeof(plat_oled_descriptor.frame_buffer[0]);
+    message->payload_length1 = message->hid_message.payload_length + sizeof(message->hid_message.payload_length) + sizeof(message->hid_message.message_type);
+    comms_aux_mcu_send_message(TRUE);
+}
+#endif
+
 /*! \fn     comms_hid_msgs_parse_debug(hid_message_t* rcv_msg, uint16_t supposed_payload_length, hid_message_t* send_msg)
 *   \brief  Parse an incoming message from USB or BLE
 *   \param  rcv_msg         Received message
@@ -174,6 +190,75 @@ int16_t comms_hid_msgs_parse_debug(hid_message_t* rcv_msg, uint16_t supposed_pay
             send_msg->payload_length = sizeof(acc_descriptor.fifo_read.acc_data_array);
             return sizeof(acc_descriptor.fifo_read.acc_data_array);
         }
+        #if defined(OLED_INTERNAL_FRAME_BUFFER) && defined(DEBUG_USB_COMMANDS_ENABLED)
+        case HID_CMD_ID_GET_FRAME_BUFFER:
+        {
+            /* Rows are sent in data messages: <row indexes> <row pixels>, then the reply gives the number of sent rows and the bitmask of black rows, which aren't sent */
+            BOOL dirty_rows_only = ((supposed_payload_length >= 1) && ((rcv_msg->payload[0] & HID_FB_CAPTURE_FLAG_DIRTY_ROWS_ONLY) != 0)) ? TRUE : FALSE;
+            uint32_t black_rows[sizeof(plat_oled_descriptor.frame_buffer_uncaptured_rows)/sizeof(uint32_t)] = {0};
+            aux_mcu_message_t* temp_message = comms_aux_mcu_get_temp_tx_message_object_pt();
+            uint16_t nb_rows_in_message = 0;
+            uint16_t nb_sent_rows = 0;
+            
+            /* Frame buffer contents must be settled */
+            sh1122_check_for_fill_and_terminate(&plat_oled_descriptor);
+            
+            for (uint16_t y = 0; y < SH1122_OLED_HEIGHT; y++)
+            {
+                uint32_t* row_words_pt = (uint32_t*)plat_oled_descriptor.frame_buffer[y];
+                uint32_t row_bit = 1UL << (y & 0x1F);
+                BOOL row_is_black = TRUE;
+                
+                /* Skip rows the host already has, if asked */
+                if ((dirty_rows_only != FALSE) && ((plat_oled_descriptor.frame_buffer_uncaptured_rows[y/32] & row_bit) == 0))
+                {
+                    continue;
+                }
+                
+                /* Black rows are only flagged */
+                for (uint16_t i = 0; i < sizeof(plat_oled_descriptor.frame_buffer[0])/sizeof(uint32_t); i++)
+                {
+                    if (row_words_pt[i] != 0)
+                    {
+                        row_is_black = FALSE;
+                        break;
+                    }
+                }
+                if (row_is_black != FALSE)
+                {
+                    black_rows[y/32] |= row_bit;
+                    continue;
+                }
+                
+                /* Add the row to the data message, send it when full */
+                if (nb_rows_in_message == 0)
+                {
+                    comms_aux_mcu_wait_for_message_sent();
+                    memset((void*)temp_message->hid_message.payload, HID_FB_CAPTURE_NO_ROW, HID_FB_CAPTURE_ROWS_PER_MSG);
+                }
+                temp_message->hid_message.payload[nb_rows_in_message] = (uint8_t)y;
+                memcpy((void*)&temp_message->hid_message.payload[HID_FB_CAPTURE_ROWS_PER_MSG + nb_rows_in_message * sizeof(plat_oled_descriptor.frame_buffer[0])], (void*)row_words_pt, sizeof(plat_oled_descriptor.frame_buffer[0]));
+                nb_sent_rows++;
+                if (++nb_rows_in_message == HID_FB_CAPTURE_ROWS_PER_MSG)
+                {
+                    comms_hid_msgs_debug_send_frame_buffer_rows(temp_message, nb_rows_in_message);
+                    nb_rows_in_message = 0;
+                }
+            }
+            if (nb_rows_in_message != 0)
+            {
+                comms_hid_msgs_debug_send_frame_buffer_rows(temp_message, nb_rows_in_message);
+            }
+            memset((void*)plat_oled_descriptor.frame_buffer_uncaptured_rows, 0x00, sizeof(plat_oled_descriptor.frame_buffer_uncaptured_rows));
+            
+            /* Reply, in the message object the data messages were sent from */
+            send_msg->message_type = rcv_msg->message_type;
+            send_msg->payload_as_uint32[0] = nb_sent_rows;
+            memcpy((void*)&send_msg->payload_as_uint32[1], (void*)black_rows, sizeof(black_rows));
+            send_msg->payload_length = sizeof(uint32_t) + sizeof(black_rows);
+            return send_msg->payload_length;
+        }
+        #endif
         default: break;
     }
     
@@ -23,6 +23,11 @@
 #define HID_CMD_ID_DATAFLASH_WRITE_256B     0x8006
 #define HID_CMD_ID_START_BOOTLOADER         0x8007
 #define HID_CMD_ID_GET_ACC_32_SAMPLES       0x8008
+#define HID_CMD_ID_GET_FRAME_BUFFER         0x8009
+// Frame buffer capture
+#define HID_FB_CAPTURE_FLAG_DIRTY_ROWS_ONLY 0x01    // Request flag: only send rows written since the previous capture
+#define HID_FB_CAPTURE_ROWS_PER_MSG         4       // Max number of rows in a data message, after the row indexes
+#define HID_FB_CAPTURE_NO_ROW               0xFF    // Row index of unused data message slots
 
 /* Prototypes */
 int16_t comms_hid_msgs_parse_debug(hid_message_t* rcv_msg, uint16_t supposed_payload_length, hid_message_t* send_msg);
@@ -17,12 +17,15 @@
 // SPI RX routine for transfer from accelerometer: level 2
 // SPI TX routine for transfer to accelerometer: level 2
 // SPI TX routine for transfer to a display: level 1
-DmacDescriptor dma_writeback_descriptors[7] __attribute__ ((aligned (16)));
-DmacDescriptor dma_descriptors[7] __attribute__ ((aligned (16)));
+// RAM fill routine: level 0
+DmacDescriptor dma_writeback_descriptors[8] __attribute__ ((aligned (16)));
+DmacDescriptor dma_descriptors[8] __attribute__ ((aligned (16)));
 /* Boolean to specify if the last DMA transfer for the custom_fs is done */
 volatile BOOL dma_custom_fs_transfer_done = FALSE;
 /* Boolean to specify if the last DMA transfer for the oled display is done */
 volatile BOOL dma_oled_transfer_done = FALSE;
+/* Boolean to specify if the last DMA RAM fill is done */
+volatile BOOL dma_ram_fill_transfer_done = FALSE;
 /* Boolean to specify if the last DMA transfer for the accelerometer is done */
 volatile BOOL dma_acc_transfer_done = FALSE;
 /* Boolean to specify if we received a packet from aux MCU */
@@ -72,6 +75,15 @@ void DMAC_Handler(void)
         DMAC->CHINTFLAG.reg = DMAC_CHINTFLAG_TCMPL;
     }
     
+    /* RAM fill routine */
+    DMAC->CHID.reg = DMAC_CHID_ID(DMA_DESCID_FILL_RAM);
+    if ((DMAC->CHINTFLAG.reg & DMAC_CHINTFLAG_TCMPL) != 0)
+    {
+        /* Set transfer done boolean, clear interrupt */
+        dma_ram_fill_transfer_done = TRUE;
+        DMAC->CHINTFLAG.reg = DMAC_CHINTFLAG_TCMPL;
+    }
+    
     /* Accelerometer RX routine */
     DMAC->CHID.reg = DMAC_CHID_ID(DMA_DESCID_RX_ACC);
     if ((DMAC->CHINTFLAG.reg & DMAC_CHINTFLAG_TCMPL) != 0)
@@ -192,6 +204,25 @@ void dma_init(void)
     DMAC->CHCTRLB = dma_chctrlb_reg;                                                        // Write register
     DMAC->CHINTENSET.reg = DMAC_CHINTENSET_TCMPL;                                           // Enable channel transfer complete interrupt
 
+    /* Setup transfer descriptor for RAM fill */
+    dma_descriptors[DMA_DESCID_FILL_RAM].BTCTRL.reg = DMAC_BTCTRL_VALID;                    // Valid descriptor
+    dma_descriptors[DMA_DESCID_FILL_RAM].BTCTRL.bit.STEPSIZE = DMAC_BTCTRL_STEPSIZE_X1_Val; // 1 beat address increment
+    dma_descriptors[DMA_DESCID_FILL_RAM].BTCTRL.bit.STEPSEL = DMAC_BTCTRL_STEPSEL_DST_Val;  // Step selection for destination
+    dma_descriptors[DMA_DESCID_FILL_RAM].BTCTRL.bit.SRCINC = 0;                             // Source Address Increment is disabled: same word copied
+    dma_descriptors[DMA_DESCID_FILL_RAM].BTCTRL.bit.DSTINC = 1;                             // Destination Address Increment is enabled.
+    dma_descriptors[DMA_DESCID_FILL_RAM].BTCTRL.bit.BEATSIZE = DMAC_BTCTRL_BEATSIZE_WORD_Val;// Word data transfer
+    dma_descriptors[DMA_DESCID_FILL_RAM].BTCTRL.bit.BLOCKACT = DMAC_BTCTRL_BLOCKACT_INT_Val;// Once data block is transferred, generate interrupt
+    dma_descriptors[DMA_DESCID_FILL_RAM].DESCADDR.reg = 0;                                  // No next descriptor address
+    
+    /* Setup DMA channel */
+    DMAC->CHID.reg = DMAC_CHID_ID(DMA_DESCID_FILL_RAM);                                     // Select channel
+    dma_chctrlb_reg.reg = 0;                                                                // Clear it
+    dma_chctrlb_reg.bit.LVL = 0;                                                            // Priority level
+    dma_chctrlb_reg.bit.TRIGACT = DMAC_CHCTRLB_TRIGACT_BLOCK_Val;                           // One trigger required for the complete block
+    dma_chctrlb_reg.bit.TRIGSRC = 0;                                                        // Software trigger only
+    DMAC->CHCTRLB = dma_chctrlb_reg;                                                        // Write register
+    DMAC->CHINTENSET.reg = DMAC_CHINTENSET_TCMPL;                                           // Enable channel transfer complete interrupt
+
     /* Setup transfer descriptor for accelerometer TX */
     dma_descriptors[DMA_DESCID_TX_ACC].BTCTRL.reg = DMAC_BTCTRL_VALID;                      // Valid descriptor
     dma_descriptors[DMA_DESCID_TX_ACC].BTCTRL.bit.STEPSIZE = DMAC_BTCTRL_STEPSIZE_X1_Val;   // 1 byte address increment
@@ -293,6 +324,22 @@ BOOL dma_oled_check_and_clear_dma_transfer_flag(void)
     return FALSE;
 }
 
+/*! \fn     dma_ram_fill_check_and_clear_dma_transfer_flag(void)
+*   \brief  Check if a DMA RAM fill that we requested is done
+*   \note   If the flag is true, flag will be cleared to false
+*   \return TRUE or FALSE
+*/
+BOOL dma_ram_fill_check_and_clear_dma_transfer_flag(void)
+{
+    /* flag can't be set twice, code is safe */
+    if (dma_ram_fill_transfer_done != FALSE)
+    {
+        dma_ram_fill_transfer_done = FALSE;
+        return TRUE;
+    }
+    return FALSE;
+}
+
 /*! \fn     dma_acc_check_and_clear_dma_transfer_flag(void)
 *   \brief  Check if a DMA transfer that we requested for led transfer is done
 *   \note   If the flag is true, flag will be cleared to false
@@ -503,6 +550,77 @@ uint32_t dma_bootloader_compute_crc32_from_spi(void* spi_data_p, uint32_t size)
     return DMAC->CRCCHKSUM.reg;
 }
 
+/*! \fn     dma_custom_fs_compute_crc32_from_spi(void* spi_data_p, uint32_t size)
+*   \brief  Use the custom fs DMA channels and the DMA CRC engine to compute a CRC32 from a spi transfer
+*   \param  spi_data_p  Pointer to the SPI data register
+*   \param  size        Number of bytes to transfer
+*   \return the crc32
+*   \note   Unlike dma_bootloader_compute_crc32_from_spi(), the DMA controller setup is kept: can be called by the application when no custom fs transfer is ongoing
+*/
+uint32_t dma_custom_fs_compute_crc32_from_spi(void* spi_data_p, uint32_t size)
+{
+    /* The byte that will be used to read/write spi data */
+    volatile uint8_t temp_src_dst_reg = 0;
+    uint32_t crc32;
+    
+    /* Setup CRC32 on the custom fs RX channel, the CRC module being disabled while configured */
+    DMAC->CTRL.bit.CRCENABLE = 0;                                                           // Disable CRC generator
+    DMAC_CRCCTRL_Type crc_ctrl_reg;
+    crc_ctrl_reg.reg = 0;
+    crc_ctrl_reg.bit.CRCSRC = 0x20 + DMA_DESCID_RX_FS;                                      // Custom fs DMA channel (SPI RX)
+    crc_ctrl_reg.bit.CRCPOLY = DMAC_CRCCTRL_CRCPOLY_CRC32_Val;                              // CRC32
+    crc_ctrl_reg.bit.CRCBEATSIZE = DMAC_CRCCTRL_CRCBEATSIZE_BYTE_Val;                       // Beat size is one byte
+    DMAC->CRCCTRL = crc_ctrl_reg;                                                           // Store register
+    DMAC->CRCCHKSUM.reg = 0xFFFFFFFF;                                                       // CRC32 initial value
+    DMAC->CTRL.bit.CRCENABLE = 1;                                                           // Enable CRC generator
+    
+    /* Same byte read and sent for the whole transfer */
+    dma_descriptors[DMA_DESCID_RX_FS].BTCTRL.bit.DSTINC = 0;                                // Destination Address Increment is not enabled.
+    dma_descriptors[DMA_DESCID_TX_FS].BTCTRL.bit.SRCINC = 0;                                // Source Address Increment is not enabled.
+    
+    while (size > 0)
+    {
+        /* Compute nb bytes to transfer */
+        uint16_t nb_bytes_to_transfer = (size > UINT16_MAX) ? UINT16_MAX : (uint16_t)size;
+    
+        cpu_irq_enter_critical();
+    
+        /* SPI RX DMA TRANSFER */
+        dma_descriptors[DMA_DESCID_RX_FS].BTCNT.bit.BTCNT = nb_bytes_to_transfer;
+        dma_descriptors[DMA_DESCID_RX_FS].SRCADDR.reg = (uint32_t)spi_data_p;
+        dma_descriptors[DMA_DESCID_RX_FS].DSTADDR.reg = (uint32_t)&temp_src_dst_reg;
+        DMAC->CHID.reg= DMAC_CHID_ID(DMA_DESCID_RX_FS);
+        DMAC->CHCTRLA.reg = DMAC_CHCTRLA_ENABLE;
+    
+        /* SPI TX DMA TRANSFER */
+        dma_descriptors[DMA_DESCID_TX_FS].BTCNT.bit.BTCNT = nb_bytes_to_transfer;
+        dma_descriptors[DMA_DESCID_TX_FS].DSTADDR.reg = (uint32_t)spi_data_p;
+        dma_descriptors[DMA_DESCID_TX_FS].SRCADDR.reg = (uint32_t)&temp_src_dst_reg;
+        DMAC->CHID.reg= DMAC_CHID_ID(DMA_DESCID_TX_FS);
+        DMAC->CHCTRLA.reg = DMAC_CHCTRLA_ENABLE;
+    
+        cpu_irq_leave_critical();
+    
+        /* Wait for transfer to finish, flagged by the DMA interrupt */
+        while (dma_custom_fs_check_and_clear_dma_transfer_flag() == FALSE);
+    
+        /* Update size */
+        size -= nb_bytes_to_transfer;
+    }
+    
+    /* Get crc32 from dma */
+    while ((DMAC->CRCSTATUS.reg & DMAC_CRCSTATUS_CRCBUSY) == DMAC_CRCSTATUS_CRCBUSY);
+    crc32 = DMAC->CRCCHKSUM.reg;
+    
+    /* Restore the custom fs setup */
+    DMAC->CTRL.bit.CRCENABLE = 0;
+    DMAC->CRCCTRL.reg = 0;
+    dma_descriptors[DMA_DESCID_RX_FS].BTCTRL.bit.DSTINC = 1;
+    dma_descriptors[DMA_DESCID_TX_FS].BTCTRL.bit.SRCINC = 1;
+    
+    return crc32;
+}
+
 /*! \fn     dma_oled_init_transfer(void* spi_data_p, void* datap, uint16_t size, uint16_t dma_trigger)
 *   \brief  Initialize a DMA transfer from an array to the oled spi bus
 *   \param  spi_data_p  Pointer to the SPI data register
@@ -521,6 +639,8 @@ void dma_oled_init_transfer(void* spi_data_p, void* datap, uint16_t size, uint16
     dma_descriptors[DMA_DESCID_TX_OLED].DSTADDR.reg = (uint32_t)spi_data_p;
     /* Destination address: given value */
     dma_descriptors[DMA_DESCID_TX_OLED].SRCADDR.reg = (uint32_t)datap + size;
+    /* Source address incremented, as the descriptor is shared with fills */
+    dma_descriptors[DMA_DESCID_TX_OLED].BTCTRL.bit.SRCINC = 1;
     
     /* Resume DMA channel operation */
     DMAC->CHID.reg = DMAC_CHID_ID(DMA_DESCID_TX_OLED);
@@ -529,6 +649,58 @@ void dma_oled_init_transfer(void* spi_data_p, void* datap, uint16_t size, uint16
     cpu_irq_leave_critical();
 }
 
+/*! \fn     dma_oled_init_fill_transfer(void* spi_data_p, const uint8_t* fill_byte_p, uint16_t size, uint16_t dma_trigger)
+*   \brief  Initialize a DMA transfer sending the same byte over and over to the oled spi bus
+*   \param  spi_data_p  Pointer to the SPI data register
+*   \param  fill_byte_p Pointer to the byte to send, which should stay valid until the transfer ends
+*   \param  size        Number of bytes to transfer
+*   \param  dma_trigger DMA trigger ID
+*/
+void dma_oled_init_fill_transfer(void* spi_data_p, const uint8_t* fill_byte_p, uint16_t size, uint16_t dma_trigger)
+{
+    cpu_irq_enter_critical();
+    
+    /* SPI TX DMA TRANSFER */
+    /* Setup transfer size */
+    dma_descriptors[DMA_DESCID_TX_OLED].BTCNT.bit.BTCNT = (uint16_t)size;
+    /* Destination address: DATA register from SPI */
+    dma_descriptors[DMA_DESCID_TX_OLED].DSTADDR.reg = (uint32_t)spi_data_p;
+    /* Source address: fill byte, not incremented */
+    dma_descriptors[DMA_DESCID_TX_OLED].SRCADDR.reg = (uint32_t)fill_byte_p;
+    dma_descriptors[DMA_DESCID_TX_OLED].BTCTRL.bit.SRCINC = 0;
+    
+    /* Resume DMA channel operation */
+    DMAC->CHID.reg = DMAC_CHID_ID(DMA_DESCID_TX_OLED);
+    DMAC->CHCTRLA.reg = DMAC_CHCTRLA_ENABLE;
+    
+    cpu_irq_leave_critical();
+}
+
+/*! \fn     dma_ram_init_fill_transfer(void* datap, const uint32_t* fill_word_p, uint16_t nb_words)
+*   \brief  Initialize a DMA transfer filling a RAM area with a given word
+*   \param  datap       Pointer to the word aligned area to fill
+*   \param  fill_word_p Pointer to the fill word, which should stay valid until the transfer ends
+*   \param  nb_words    Number of words to fill
+*/
+void dma_ram_init_fill_transfer(void* datap, const uint32_t* fill_word_p, uint16_t nb_words)
+{
+    cpu_irq_enter_critical();
+    
+    /* Setup transfer size */
+    dma_descriptors[DMA_DESCID_FILL_RAM].BTCNT.bit.BTCNT = nb_words;
+    /* Destination address: end of the area, as address is incremented */
+    dma_descriptors[DMA_DESCID_FILL_RAM].DSTADDR.reg = (uint32_t)datap + (uint32_t)nb_words*4;
+    /* Source address: fill word */
+    dma_descriptors[DMA_DESCID_FILL_RAM].SRCADDR.reg = (uint32_t)fill_word_p;
+    
+    /* Enable DMA channel and trigger the transfer */
+    DMAC->CHID.reg = DMAC_CHID_ID(DMA_DESCID_FILL_RAM);
+    DMAC->CHCTRLA.reg = DMAC_CHCTRLA_ENABLE;
+    DMAC->SWTRIGCTRL.reg = (1 << DMA_DESCID_FILL_RAM);
+    
+    cpu_irq_leave_critical();
+}
+
 /*! \fn     dma_acc_disable_transfer(void)
 *   \brief  Disable the DMA transfer for the accelerometer
 */
@@ -13,16 +13,20 @@
 #include "defines.h"
 
 /* Prototypes */
+void dma_oled_init_fill_transfer(void* spi_data_p, const uint8_t* fill_byte_p, uint16_t size, uint16_t dma_trigger);
 void dma_oled_init_transfer(void* spi_data_p, void* datap, uint16_t size, uint16_t dma_trigger);
 void dma_acc_init_transfer(void* spi_data_p, void* datap, uint16_t size, uint8_t* read_cmd);
 uint32_t dma_bootloader_compute_crc32_from_spi(void* spi_data_p, uint32_t size);
+uint32_t dma_custom_fs_compute_crc32_from_spi(void* spi_data_p, uint32_t size);
 void dma_aux_mcu_init_tx_transfer(void* spi_data_p, void* datap, uint16_t size);
 void dma_aux_mcu_init_rx_transfer(void* spi_data_p, void* datap, uint16_t size);
 void dma_custom_fs_init_transfer(void* spi_data_p, void* datap, uint16_t size);
+void dma_ram_init_fill_transfer(void* datap, const uint32_t* fill_word_p, uint16_t nb_words);
 uint16_t dma_aux_mcu_get_remaining_bytes_for_rx_transfer(void);
 BOOL dma_custom_fs_check_and_clear_dma_transfer_flag(void);
 BOOL dma_aux_mcu_check_and_clear_dma_transfer_flag(void);
 BOOL dma_oled_check_and_clear_dma_transfer_flag(void);
+BOOL dma_ram_fill_check_and_clear_dma_transfer_flag(void);
 BOOL dma_acc_check_and_clear_dma_transfer_flag(void);
 void dma_wait_for_aux_mcu_packet_sent(void);
 void dma_aux_mcu_disable_transfer(void);
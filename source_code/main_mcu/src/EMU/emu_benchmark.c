@@ -0,0 +1,635 @@
+/*!  \file     emu_benchmark.c
+*    \brief    Host emulator: rendering benchmark of the debug menu screens
+*    Created:  17/10/2026
+*    Notes:    Not part of the firmware project. Linux build, from the main_mcu/src folder:
+*              gcc -std=gnu99 -O2 -DEMULATOR_BUILD -D__SAMD21G18A__ -DBOARD=USER_BOARD -DARM_MATH_CM0PLUS=true "-D__packed=__attribute__((packed))"
+*                  -I. -IEMU -Iconfig -IPLATFORM -IOLED -IFILESYSTEM -IFLASH -ISERCOM -IDMA -ITIMER -ICOMMS -ILOGIC -IINPUTS -IGUI
+*                  -IASF/common/boards -IASF/common/utils -IASF/common2/boards/user_board -IASF/sam0/utils -IASF/sam0/utils/header_files
+*                  -IASF/sam0/utils/preprocessor -IASF/sam0/utils/cmsis/samd21/include -IASF/sam0/utils/cmsis/samd21/source
+*                  -IASF/thirdparty/CMSIS/Include -IASF/sam0/drivers/system -IASF/sam0/drivers/system/clock
+*                  -IASF/sam0/drivers/system/clock/clock_samd21_r21_da_ha1 -IASF/sam0/drivers/system/interrupt
+*                  -IASF/sam0/drivers/system/interrupt/system_interrupt_samd21 -IASF/sam0/drivers/system/pinmux
+*                  -IASF/sam0/drivers/system/power -IASF/sam0/drivers/system/power/power_sam_d_r_h
+*                  -IASF/sam0/drivers/system/reset -IASF/sam0/drivers/system/reset/reset_sam_d_r_h
+*                  EMU/emu_benchmark.c EMU/emu_hw.c EMU/emu_sh1122.c OLED/sh1122.c OLED/mooltipass_graphics_bundle.c
+*                  FILESYSTEM/custom_fs.c FILESYSTEM/custom_bitstream.c FILESYSTEM/custom_fs_emergency_font.c GUI/gui_list.c -o emu_benchmark
+*              Usage: emu_benchmark <bundle image file, as scripts/python_framework/bundle.img> [PNG dumps folder]
+*              File checks need the file CRC table: mooltipass_tool.py addBundleFileCrcs bundle.img bundle_crc.img
+*              Host times only compare builds with each other, bus times are estimated from the device SPI clocks
+*/
+#include <string.h>
+#include <stdio.h>
+#include <asf.h>
+#include "platform_defines.h"
+#include "custom_fs.h"
+#include "dataflash.h"
+#include "emu_sh1122.h"
+#include "gui_list.h"
+#include "emu_hw.h"
+#include "sh1122.h"
+
+/* Defines */
+#define EMU_BENCHMARK_MAX_PRIMITIVES        16
+#define EMU_BENCHMARK_MAX_DUMPS_PER_SCREEN  16
+#define EMU_BENCHMARK_NB_GLYPH_SCREENS      64
+#define EMU_BENCHMARK_NB_BITMAP_FRAMES      120
+#define EMU_BENCHMARK_NB_MENU_STRINGS       4
+#define EMU_BENCHMARK_NB_PREFETCHES         16
+#define EMU_BENCHMARK_NB_LIST_ITEMS         500
+#define EMU_BENCHMARK_FLASH_READ_CMD_BYTES  4       // Read command and 24 bits address
+#define EMU_BENCHMARK_OLED_SPI_FREQ         (EMU_MAIN_CLOCK_FREQ / (2 * (OLED_BAUD_DIVIDER + 1)))
+#define EMU_BENCHMARK_FLASH_SPI_FREQ        (EMU_MAIN_CLOCK_FREQ / (2 * (DATAFLASH_BAUD_DIVIDER + 1)))
+
+/* Typedefs */
+typedef struct
+{
+    const char* name;                   // Primitive name
+    uint32_t nb_calls;                  // Number of measured calls
+    uint64_t host_ns;                   // Total host time
+    emu_hw_stats_t hw_stats;            // Total transfers
+} emu_benchmark_primitive_t;
+
+/* Same descriptors as the firmware */
+sh1122_descriptor_t plat_oled_descriptor = {.sercom_pt = OLED_SERCOM, .dma_trigger_id = OLED_DMA_SERCOM_TX_TRIG, .sh1122_cs_pin_group = OLED_nCS_GROUP, .sh1122_cs_pin_mask = OLED_nCS_MASK, .sh1122_cd_pin_group = OLED_CD_GROUP, .sh1122_cd_pin_mask = OLED_CD_MASK};
+spi_flash_descriptor_t dataflash_descriptor = {.sercom_pt = DATAFLASH_SERCOM, .cs_pin_group = DATAFLASH_nCS_GROUP, .cs_pin_mask = DATAFLASH_nCS_MASK};
+/* Measured primitives of the current screen */
+emu_benchmark_primitive_t emu_benchmark_primitives[EMU_BENCHMARK_MAX_PRIMITIVES];
+uint16_t emu_benchmark_nb_primitives = 0;
+/* Current measure start */
+emu_hw_stats_t emu_benchmark_start_stats;
+uint64_t emu_benchmark_start_ns;
+#ifdef CUSTOM_FS_FLASH_CACHE
+/* Flash cache counters at the current screen start */
+uint32_t emu_benchmark_screen_cache_bytes_saved;
+uint32_t emu_benchmark_screen_cache_misses;
+uint32_t emu_benchmark_screen_cache_hits;
+#endif
+/* PNG dumps folder, 0 for no dumps */
+const char* emu_benchmark_dump_folder = 0;
+uint16_t emu_benchmark_nb_dumps = 0;
+
+
+/*! \fn     emu_benchmark_start(void)
+*   \brief  Start measuring a primitive call
+*/
+static void emu_benchmark_start(void)
+{
+    emu_hw_get_stats(&emu_benchmark_start_stats);
+    emu_benchmark_start_ns = emu_hw_get_time_ns();
+}
+
+/*! \fn     emu_benchmark_stop(const char* name)
+*   \brief  Stop measuring a primitive call, adding the measure to the primitive totals
+*   \param  name    Primitive name
+*/
+static void emu_benchmark_stop(const char* name)
+{
+    uint64_t host_ns = emu_hw_get_time_ns() - emu_benchmark_start_ns;
+    emu_benchmark_primitive_t* primitive_pt = 0;
+    emu_hw_stats_t stats;
+    
+    emu_hw_get_stats(&stats);
+    
+    /* Find the primitive or add it */
+    for (uint16_t i = 0; i < emu_benchmark_nb_primitives; i++)
+    {
+        if (strcmp(emu_benchmark_primitives[i].name, name) == 0)
+        {
+            primitive_pt = &emu_benchmark_primitives[i];
+        }
+    }
+    if (primitive_pt == 0)
+    {
+        if (emu_benchmark_nb_primitives == EMU_BENCHMARK_MAX_PRIMITIVES)
+        {
+            return;
+        }
+        primitive_pt = &emu_benchmark_primitives[emu_benchmark_nb_primitives++];
+        memset((void*)primitive_pt, 0x00, sizeof(*primitive_pt));
+        primitive_pt->name = name;
+    }
+    
+    primitive_pt->nb_calls++;
+    primitive_pt->host_ns += host_ns;
+    primitive_pt->hw_stats.oled_command_bytes += stats.oled_command_bytes - emu_benchmark_start_stats.oled_command_bytes;
+    primitive_pt->hw_stats.oled_data_bytes += stats.oled_data_bytes - emu_benchmark_start_stats.oled_data_bytes;
+    primitive_pt->hw_stats.oled_dma_transfers += stats.oled_dma_transfers - emu_benchmark_start_stats.oled_dma_transfers;
+    primitive_pt->hw_stats.flash_reads += stats.flash_reads - emu_benchmark_start_stats.flash_reads;
+    primitive_pt->hw_stats.flash_read_bytes += stats.flash_read_bytes - emu_benchmark_start_stats.flash_read_bytes;
+}
+
+/*! \fn     emu_benchmark_start_screen(const char* name)
+*   \brief  Start benchmarking a screen
+*   \param  name    Screen name
+*/
+static void emu_benchmark_start_screen(const char* name)
+{
+    printf("\n%s\n", name);
+    emu_benchmark_nb_primitives = 0;
+    emu_benchmark_nb_dumps = 0;
+    #ifdef CUSTOM_FS_FLASH_CACHE
+    emu_benchmark_screen_cache_bytes_saved = custom_fs_flash_cache_bytes_saved;
+    emu_benchmark_screen_cache_misses = custom_fs_flash_cache_misses;
+    emu_benchmark_screen_cache_hits = custom_fs_flash_cache_hits;
+    #endif
+}
+
+/*! \fn     emu_benchmark_dump_screen(const char* screen_name, uint16_t step)
+*   \brief  Write the displayed pixels to <dump folder>/<screen name>_<step>.png, if a dump folder was given
+*   \param  screen_name Screen name
+*   \param  step        Screen step
+*/
+static void emu_benchmark_dump_screen(const char* screen_name, uint16_t step)
+{
+    char filename[256];
+    
+    if ((emu_benchmark_dump_folder == 0) || (emu_benchmark_nb_dumps == EMU_BENCHMARK_MAX_DUMPS_PER_SCREEN))
+    {
+        return;
+    }
+    
+    snprintf(filename, sizeof(filename), "%s/%s_%03u.png", emu_benchmark_dump_folder, screen_name, step);
+    if (emu_sh1122_dump_png(filename) != RETURN_OK)
+    {
+        printf("Couldn't write %s\n", filename);
+    }
+    emu_benchmark_nb_dumps++;
+}
+
+/*! \fn     emu_benchmark_print_screen_results(void)
+*   \brief  Print the per call averages of the measured primitives
+*/
+static void emu_benchmark_print_screen_results(void)
+{
+    printf("%-28s %7s %10s %10s %10s %8s %10s %10s\n", "primitive", "calls", "host us", "oled B", "oled us", "fl reads", "flash B", "flash us");
+    for (uint16_t i = 0; i < emu_benchmark_nb_primitives; i++)
+    {
+        emu_benchmark_primitive_t* primitive_pt = &emu_benchmark_primitives[i];
+        double nb_calls = (double)primitive_pt->nb_calls;
+        double oled_bytes = (double)(primitive_pt->hw_stats.oled_command_bytes + primitive_pt->hw_stats.oled_data_bytes) / nb_calls;
+        double flash_reads = (double)primitive_pt->hw_stats.flash_reads / nb_calls;
+        double flash_bytes = (double)primitive_pt->hw_stats.flash_read_bytes / nb_calls;
+    
+        printf("%-28s %7u %10.1f %10.1f %10.1f %8.1f %10.1f %10.1f\n", primitive_pt->name, primitive_pt->nb_calls, (double)primitive_pt->host_ns / nb_calls / 1000.0,
+               oled_bytes, oled_bytes * 8 * 1000000.0 / EMU_BENCHMARK_OLED_SPI_FREQ,
+               flash_reads, flash_bytes, (flash_bytes + flash_reads * EMU_BENCHMARK_FLASH_READ_CMD_BYTES) * 8 * 1000000.0 / EMU_BENCHMARK_FLASH_SPI_FREQ);
+    }
+    #ifdef CUSTOM_FS_FLASH_CACHE
+    printf("Flash cache: %u hits, %u misses, %u bytes saved\n", custom_fs_flash_cache_hits - emu_benchmark_screen_cache_hits, custom_fs_flash_cache_misses - emu_benchmark_screen_cache_misses, custom_fs_flash_cache_bytes_saved - emu_benchmark_screen_cache_bytes_saved);
+    #endif
+}
+
+/*! \fn     emu_benchmark_boot(void)
+*   \brief  Benchmark of the bundle checks: whole bundle crc32 against file checks on first access
+*/
+static void emu_benchmark_boot(void)
+{
+    custom_fs_address_t address;
+    RET_TYPE bundle_check;
+    
+    emu_benchmark_start_screen("Boot");
+    
+    /* Whole bundle check, only done by the bootloader before updates */
+    emu_benchmark_start();
+    bundle_check = custom_fs_compute_and_check_external_bundle_crc32();
+    emu_benchmark_stop("bundle crc32 check");
+    
+    /* Bundle metadata is checked at initialization */
+    emu_benchmark_start();
+    custom_fs_init();
+    emu_benchmark_stop("custom_fs_init");
+    emu_benchmark_start();
+    sh1122_refresh_used_font(&plat_oled_descriptor);
+    emu_benchmark_stop("refresh_used_font");
+    
+    /* Files are checked when first looked up */
+    for (uint32_t i = 0; i < custom_fs_flash_header.bitmap_file_count; i++)
+    {
+        emu_benchmark_start();
+        if (custom_fs_get_file_address(i, &address, CUSTOM_FS_BITMAP_TYPE) == RETURN_OK)
+        {
+            emu_benchmark_stop("1st get_file_address (bmp)");
+        }
+        emu_benchmark_start();
+        if (custom_fs_get_file_address(i, &address, CUSTOM_FS_BITMAP_TYPE) == RETURN_OK)
+        {
+            emu_benchmark_stop("2nd get_file_address (bmp)");
+        }
+    }
+    emu_benchmark_print_screen_results();
+    printf("Bundle crc32: %s over %u bytes\n", (bundle_check == RETURN_OK) ? "OK" : "NOK", custom_fs_flash_header.total_size);
+    #ifdef CUSTOM_FS_LAZY_FILE_CHECK
+    if (custom_fs_file_crc_table_found != FALSE)
+    {
+        printf("File checks: %u files checked, %u corrupted, %u bytes read\n", custom_fs_nb_checked_files, custom_fs_nb_corrupted_files, custom_fs_checked_bytes);
+    }
+    else
+    {
+        printf("File checks: no file CRC table after the bundle\n");
+    }
+    #else
+    printf("File checks: disabled\n");
+    #endif
+}
+
+/*! \fn     emu_benchmark_glyph_scroll(void)
+*   \brief  Benchmark of the "Scroll Through Glyphs" debug screen, scrolling down
+*/
+static void emu_benchmark_glyph_scroll(void)
+{
+    uint16_t cur_glyph = 0;
+    
+    emu_benchmark_start_screen("Scroll Through Glyphs");
+    for (uint16_t i = 0; i < EMU_BENCHMARK_NB_GLYPH_SCREENS; i++)
+    {
+        emu_benchmark_start();
+        sh1122_clear_current_screen(&plat_oled_descriptor);
+        emu_benchmark_stop("clear_current_screen");
+    
+        /* Find a glyph to print, stopping if the font doesn't have any */
+        emu_benchmark_start();
+        do
+        {
+            cur_glyph++;
+        }
+        while ((sh1122_get_glyph_width(&plat_oled_descriptor, (cust_char_t)cur_glyph) == 0) && (cur_glyph != 0));
+        emu_benchmark_stop("get_glyph_width (search)");
+        if (cur_glyph == 0)
+        {
+            break;
+        }
+    
+        emu_benchmark_start();
+        sh1122_printf_xy(&plat_oled_descriptor, 0, 0, OLED_ALIGN_LEFT, FALSE, "Glyph %d: ", cur_glyph);
+        emu_benchmark_stop("printf_xy");
+        emu_benchmark_start();
+        sh1122_put_char(&plat_oled_descriptor, cur_glyph, FALSE);
+        emu_benchmark_stop("put_char");
+        emu_benchmark_dump_screen("glyph_scroll", i);
+    }
+    emu_benchmark_print_screen_results();
+}
+
+/*! \fn     emu_benchmark_language_test(void)
+*   \brief  Benchmark of the "Language Switch Test" debug screen, going through all languages once
+*/
+static void emu_benchmark_language_test(void)
+{
+    emu_benchmark_start_screen("Language Switch Test");
+    for (uint16_t i = 0; i < custom_fs_get_number_of_languages(); i++)
+    {
+        cust_char_t* temp_string = u"";
+    
+        emu_benchmark_start();
+        custom_fs_set_current_language(i);
+        emu_benchmark_stop("set_current_language");
+        emu_benchmark_start();
+        sh1122_refresh_used_font(&plat_oled_descriptor);
+        emu_benchmark_stop("refresh_used_font");
+        emu_benchmark_start();
+        custom_fs_get_string_from_file(0, &temp_string);
+        emu_benchmark_stop("get_string_from_file");
+        emu_benchmark_start();
+        sh1122_clear_current_screen(&plat_oled_descriptor);
+        emu_benchmark_stop("clear_current_screen");
+    
+        emu_benchmark_start();
+        sh1122_printf_xy(&plat_oled_descriptor, 0, 0, OLED_ALIGN_LEFT, FALSE, "%d/%d : ", i+1, custom_fs_flash_header.language_map_item_count);
+        emu_benchmark_stop("printf_xy");
+        emu_benchmark_start();
+        sh1122_put_string_xy(&plat_oled_descriptor, 30, 0, OLED_ALIGN_LEFT, custom_fs_get_current_language_text_desc(), FALSE);
+        emu_benchmark_stop("put_string_xy");
+        emu_benchmark_start();
+        sh1122_printf_xy(&plat_oled_descriptor, 0, 10, OLED_ALIGN_LEFT, FALSE, "String file ID: %d", custom_fs_cur_language_entry.string_file_index);
+        emu_benchmark_stop("printf_xy");
+        emu_benchmark_start();
+        sh1122_printf_xy(&plat_oled_descriptor, 0, 20, OLED_ALIGN_LEFT, FALSE, "Start font file ID: %d", custom_fs_cur_language_entry.starting_font);
+        emu_benchmark_stop("printf_xy");
+        emu_benchmark_start();
+        sh1122_printf_xy(&plat_oled_descriptor, 0, 30, OLED_ALIGN_LEFT, FALSE, "Start bitmap file ID: %d", custom_fs_cur_language_entry.starting_bitmap);
+        emu_benchmark_stop("printf_xy");
+        emu_benchmark_start();
+        sh1122_printf_xy(&plat_oled_descriptor, 0, 40, OLED_ALIGN_LEFT, FALSE, "Recommended keyboard file ID: %d", custom_fs_cur_language_entry.keyboard_layout_id);
+        emu_benchmark_stop("printf_xy");
+        emu_benchmark_start();
+        sh1122_printf_xy(&plat_oled_descriptor, 0, 50, OLED_ALIGN_LEFT, FALSE, "Line #0:");
+        emu_benchmark_stop("printf_xy");
+        emu_benchmark_start();
+        sh1122_put_string_xy(&plat_oled_descriptor, 50, 50, OLED_ALIGN_LEFT, temp_string, FALSE);
+        emu_benchmark_stop("put_string_xy");
+        emu_benchmark_dump_screen("language_test", i);
+    }
+    emu_benchmark_print_screen_results();
+    
+    /* Back to the default language */
+    custom_fs_set_current_language(0);
+    sh1122_refresh_used_font(&plat_oled_descriptor);
+}
+
+/*! \fn     emu_benchmark_animation(void)
+*   \brief  Benchmark of the "Animation Test" debug screen: bitmap per frame animation, then one loop of the first delta frames animation
+*/
+static void emu_benchmark_animation(void)
+{
+    sh1122_animation_t animation;
+    
+    emu_benchmark_start_screen("Animation Test");
+    for (uint16_t i = 0; i < EMU_BENCHMARK_NB_BITMAP_FRAMES; i++)
+    {
+        emu_benchmark_start();
+        sh1122_display_bitmap_from_flash_at_recommended_position(&plat_oled_descriptor, i, FALSE);
+        emu_benchmark_stop("display_bitmap_from_flash");
+        if ((i % 8) == 0)
+        {
+            emu_benchmark_dump_screen("animation_bitmaps", i);
+        }
+    }
+    
+    /* Look for a delta frames animation */
+    for (uint32_t i = 0; i < custom_fs_flash_header.binary_img_file_count; i++)
+    {
+        if (sh1122_open_animation(i, &animation) == RETURN_OK)
+        {
+            #ifdef OLED_INTERNAL_FRAME_BUFFER
+            BOOL write_to_buffer = TRUE;
+            sh1122_check_for_flush_and_terminate(&plat_oled_descriptor);
+            sh1122_clear_frame_buffer(&plat_oled_descriptor);
+            sh1122_set_frame_buffer_page_flip(&plat_oled_descriptor, TRUE);
+            #else
+            BOOL write_to_buffer = FALSE;
+            #endif
+    
+            while (animation.next_frame != animation.nb_frames)
+            {
+                emu_benchmark_start();
+                sh1122_draw_animation_frame(&plat_oled_descriptor, &animation, write_to_buffer);
+                emu_benchmark_stop("draw_animation_frame");
+                #ifdef OLED_INTERNAL_FRAME_BUFFER
+                emu_benchmark_start();
+                sh1122_flush_frame_buffer(&plat_oled_descriptor);
+                sh1122_check_for_flush_and_terminate(&plat_oled_descriptor);
+                emu_benchmark_stop("flush_frame_buffer");
+                #endif
+                if ((animation.next_frame % 8) == 1)
+                {
+                    emu_benchmark_dump_screen("animation_delta", animation.next_frame - 1);
+                }
+            }
+    
+            #ifdef OLED_INTERNAL_FRAME_BUFFER
+            sh1122_set_frame_buffer_page_flip(&plat_oled_descriptor, FALSE);
+            #endif
+            break;
+        }
+    }
+    emu_benchmark_print_screen_results();
+}
+
+/*! \fn     emu_benchmark_strings(void)
+*   \brief  Benchmark of a menu like redraw of the first strings of each language, done twice
+*/
+static void emu_benchmark_strings(void)
+{
+    cust_char_t* string_pt;
+    
+    emu_benchmark_start_screen("Language Strings");
+    for (uint16_t i = 0; i < custom_fs_get_number_of_languages(); i++)
+    {
+        custom_fs_set_current_language(i);
+        for (uint16_t redraw = 0; redraw < 2; redraw++)
+        {
+            for (uint32_t j = 0; j < EMU_BENCHMARK_NB_MENU_STRINGS; j++)
+            {
+                emu_benchmark_start();
+                if (custom_fs_get_string_from_file(j, &string_pt) == RETURN_OK)
+                {
+                    emu_benchmark_stop((redraw == 0) ? "get_string_from_file (1st)" : "get_string_from_file (2nd)");
+                }
+            }
+        }
+    }
+    emu_benchmark_print_screen_results();
+    #ifdef CUSTOM_FS_STRING_CACHE
+    printf("String cache: %u hits, %u misses\n", custom_fs_string_cache_hits, custom_fs_string_cache_misses);
+    #else
+    printf("String cache: disabled\n");
+    #endif
+    
+    /* Back to the default language */
+    custom_fs_set_current_language(0);
+}
+
+/*! \fn     emu_benchmark_list_fetch_item(uint16_t item_index, cust_char_t* string, uint16_t max_length)
+*   \brief  Generate list widget benchmark item strings
+*   \param  item_index  Item index
+*   \param  string      Where to store the string
+*   \param  max_length  Max number of characters, without terminating 0
+*/
+static void emu_benchmark_list_fetch_item(uint16_t item_index, cust_char_t* string, uint16_t max_length)
+{
+    char item_string[64];
+    uint16_t i;
+    
+    snprintf(item_string, sizeof(item_string), "Credential %u - login%u@mooltipass.com", item_index, item_index);
+    for (i = 0; (i < max_length) && (item_string[i] != 0); i++)
+    {
+        string[i] = item_string[i];
+    }
+    string[i] = 0;
+}
+
+/*! \fn     emu_benchmark_list_widget(void)
+*   \brief  Benchmark of wheel actions on a long list, rows being retained or all fetched and redrawn at each action as our menus used to
+*   \note   Each wheel action is rendered and sent to the display before the next one
+*/
+static void emu_benchmark_list_widget(void)
+{
+    uint32_t retained_nb_fetches = 0;
+    gui_list_t list;
+    
+    emu_benchmark_start_screen("List Widget");
+    sh1122_clear_frame_buffer(&plat_oled_descriptor);
+    for (uint16_t full_redraw = 0; full_redraw < 2; full_redraw++)
+    {
+        gui_list_init(&list, 0, 10, 6, EMU_BENCHMARK_NB_LIST_ITEMS, emu_benchmark_list_fetch_item);
+        gui_list_render(&plat_oled_descriptor, &list);
+        for (uint16_t i = 0; i < EMU_BENCHMARK_NB_LIST_ITEMS; i++)
+        {
+            emu_benchmark_start();
+            gui_list_move_selection(&list, 1);
+            if (full_redraw != 0)
+            {
+                gui_list_invalidate(&list);
+            }
+            gui_list_render(&plat_oled_descriptor, &list);
+            sh1122_flush_frame_buffer(&plat_oled_descriptor);
+            sh1122_check_for_flush_and_terminate(&plat_oled_descriptor);
+            emu_benchmark_stop((full_redraw == 0) ? "wheel action (retained)" : "wheel action (full redraw)");
+            if (i < 8)
+            {
+                emu_benchmark_dump_screen((full_redraw == 0) ? "list_retained" : "list_full_redraw", i);
+            }
+        }
+        if (full_redraw == 0)
+        {
+            retained_nb_fetches = list.nb_fetches;
+        }
+    }
+    emu_benchmark_print_screen_results();
+    printf("List fetches: %u retained, %u full redraw\n", retained_nb_fetches, list.nb_fetches);
+}
+
+#ifdef CUSTOM_FS_PREFETCH
+/*! \fn     emu_benchmark_prefetch(void)
+*   \brief  Prefetch queue check: bitmap headers read through the queue, one cancelled request each time
+*/
+static void emu_benchmark_prefetch(void)
+{
+    uint16_t nb_errors = 0;
+    
+    emu_benchmark_start_screen("Prefetch");
+    for (uint16_t i = 0; i < EMU_BENCHMARK_NB_PREFETCHES; i++)
+    {
+        custom_fs_prefetch_ticket_t cancelled_ticket;
+        custom_fs_prefetch_ticket_t ticket;
+        bitmap_t prefetched_header;
+        bitmap_t cancelled_header;
+        custom_fs_address_t address;
+        bitmap_t header;
+    
+        if (custom_fs_get_file_address(i, &address, CUSTOM_FS_BITMAP_TYPE) != RETURN_OK)
+        {
+            break;
+        }
+        memset((void*)&cancelled_header, 0x55, sizeof(cancelled_header));
+    
+        emu_benchmark_start();
+        custom_fs_prefetch_enqueue((uint8_t*)&prefetched_header, address, sizeof(prefetched_header), &ticket);
+        emu_benchmark_stop("prefetch_enqueue");
+        custom_fs_prefetch_enqueue((uint8_t*)&cancelled_header, address, sizeof(cancelled_header), &cancelled_ticket);
+        emu_benchmark_start();
+        custom_fs_prefetch_cancel(cancelled_ticket);
+        emu_benchmark_stop("prefetch_cancel");
+        emu_benchmark_start();
+        custom_fs_prefetch_routine();
+        emu_benchmark_stop("prefetch_routine");
+        emu_benchmark_start();
+        custom_fs_prefetch_wait(ticket);
+        emu_benchmark_stop("prefetch_wait");
+        emu_benchmark_start();
+        custom_fs_read_from_flash((uint8_t*)&header, address, sizeof(header));
+        emu_benchmark_stop("read_from_flash");
+    
+        /* Prefetched data must match, cancelled request buffer must be untouched */
+        if ((memcmp((void*)&header, (void*)&prefetched_header, sizeof(header)) != 0) || (cancelled_header.width != 0x5555) || (custom_fs_prefetch_is_done(cancelled_ticket) == FALSE))
+        {
+            nb_errors++;
+        }
+    }
+    emu_benchmark_print_screen_results();
+    printf("Prefetch: %u completed, %u bus waits, %u errors\n", custom_fs_prefetch_completed, custom_fs_prefetch_bus_waits, nb_errors);
+}
+#endif
+
+/*! \fn     emu_benchmark_file_lookups(void)
+*   \brief  Benchmark of the file address lookups done before each file read, for all languages
+*/
+static void emu_benchmark_file_lookups(void)
+{
+    custom_fs_address_t file_table_entry;
+    custom_fs_address_t address;
+    
+    emu_benchmark_start_screen("File Lookups");
+    for (uint16_t i = 0; i < custom_fs_get_number_of_languages(); i++)
+    {
+        custom_fs_set_current_language(i);
+    
+        /* Only successful lookups are measured, file IDs past the language files are rejected without flash reads */
+        for (uint32_t j = 0; j < custom_fs_flash_header.string_file_count; j++)
+        {
+            emu_benchmark_start();
+            if (custom_fs_get_file_address(j, &address, CUSTOM_FS_STRING_TYPE) == RETURN_OK)
+            {
+                emu_benchmark_stop("get_file_address (string)");
+            }
+        }
+        for (uint32_t j = 0; j < custom_fs_flash_header.fonts_file_count; j++)
+        {
+            emu_benchmark_start();
+            if (custom_fs_get_file_address(j, &address, CUSTOM_FS_FONTS_TYPE) == RETURN_OK)
+            {
+                emu_benchmark_stop("get_file_address (font)");
+            }
+        }
+        for (uint32_t j = 0; j < custom_fs_flash_header.bitmap_file_count; j++)
+        {
+            emu_benchmark_start();
+            if (custom_fs_get_file_address(j, &address, CUSTOM_FS_BITMAP_TYPE) == RETURN_OK)
+            {
+                emu_benchmark_stop("get_file_address (bitmap)");
+            }
+    
+            /* Reference: the table entry read done by lookups without file table and flash caches */
+            emu_benchmark_start();
+            dataflash_read_data_array(&dataflash_descriptor, CUSTOM_FS_FILES_ADDR_OFFSET + custom_fs_flash_header.bitmap_file_offset + j * sizeof(file_table_entry), (uint8_t*)&file_table_entry, sizeof(file_table_entry));
+            emu_benchmark_stop("table entry flash read");
+        }
+    }
+    emu_benchmark_print_screen_results();
+    #ifdef CUSTOM_FS_FILE_TABLE_CACHE
+    printf("File table cache: %u/%u entries used\n", custom_fs_file_table_cache_fill, CUSTOM_FS_FILE_TABLE_CACHE_SIZE);
+    #else
+    printf("File table cache: disabled\n");
+    #endif
+    
+    /* Back to the default language */
+    custom_fs_set_current_language(0);
+}
+
+/*! \fn     main(int argc, char* argv[])
+*   \brief  Benchmark entry point
+*   \param  argc    Number of arguments
+*   \param  argv    Arguments: bundle image file and optional PNG dumps folder
+*   \return 0 if the bundle could be used
+*/
+int main(int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        printf("Usage: emu_benchmark <bundle image file> [PNG dumps folder]\n");
+        return 1;
+    }
+    if (emu_dataflash_load_bundle(argv[1]) != RETURN_OK)
+    {
+        printf("Couldn't load bundle image %s\n", argv[1]);
+        return 1;
+    }
+    if (argc > 2)
+    {
+        emu_benchmark_dump_folder = argv[2];
+    }
+    
+    /* Same initialization as the firmware */
+    emu_hw_attach_sh1122(plat_oled_descriptor.sercom_pt, plat_oled_descriptor.sh1122_cd_pin_group, plat_oled_descriptor.sh1122_cd_pin_mask);
+    custom_fs_set_dataflash_descriptor(&dataflash_descriptor);
+    sh1122_init_display(&plat_oled_descriptor);
+    if (custom_fs_init() != RETURN_OK)
+    {
+        printf("No bundle in the dataflash image\n");
+        return 1;
+    }
+    sh1122_refresh_used_font(&plat_oled_descriptor);
+    
+    printf("Bus time estimates: display SPI at %lu Hz, dataflash SPI at %lu Hz, %u bytes per flash read command\n", EMU_BENCHMARK_OLED_SPI_FREQ, EMU_BENCHMARK_FLASH_SPI_FREQ, EMU_BENCHMARK_FLASH_READ_CMD_BYTES);
+    emu_benchmark_boot();
+    emu_benchmark_glyph_scroll();
+    emu_benchmark_language_test();
+    emu_benchmark_animation();
+    emu_benchmark_strings();
+    emu_benchmark_list_widget();
+    #ifdef CUSTOM_FS_PREFETCH
+    emu_benchmark_prefetch();
+    #endif
+    emu_benchmark_file_lookups();
+    return 0;
+}
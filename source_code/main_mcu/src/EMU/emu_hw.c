@@ -0,0 +1,413 @@
+/*!  \file     emu_hw.c
+*    \brief    Host emulator: RAM backed peripherals replacing the SERCOM, DMA, timer and dataflash drivers
+*    Created:  17/10/2026
+*    Notes:    Only built for the host emulator, in place of driver_sercom.c, dma.c, driver_timer.c and dataflash.c
+*              DMA transfers are completed when armed, their done flags being set right away
+*/
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <time.h>
+#include <asf.h>
+#include "platform_defines.h"
+#include "driver_sercom.h"
+#include "driver_timer.h"
+#include "emu_sh1122.h"
+#include "custom_fs.h"
+#include "dataflash.h"
+#include "emu_hw.h"
+#include "dma.h"
+
+/* Emulated registers */
+Port emu_port;
+Sercom emu_sercoms[EMU_NB_SERCOMS];
+/* Port output levels, updated from the OUTSET / OUTCLR register writes */
+uint32_t emu_port_out[sizeof(emu_port.Group)/sizeof(emu_port.Group[0])];
+/* SERCOM connected to the display and its CD pin */
+Sercom* emu_sh1122_sercom_pt = 0;
+uint8_t emu_sh1122_cd_pin_group = 0;
+uint32_t emu_sh1122_cd_pin_mask = 0;
+/* DMA done flags */
+BOOL emu_dma_custom_fs_transfer_done = FALSE;
+BOOL emu_dma_ram_fill_transfer_done = FALSE;
+BOOL emu_dma_oled_transfer_done = FALSE;
+/* Dataflash contents, bytes past the image reading as erased flash */
+const uint8_t* emu_dataflash_image = 0;
+uint32_t emu_dataflash_image_size = 0;
+/* Dataflash address of the opened read transfer */
+uint32_t emu_dataflash_read_address = 0;
+/* Time base */
+uint64_t emu_hw_boot_time_ns = 0;
+/* Transfer statistics */
+emu_hw_stats_t emu_hw_stats;
+
+
+/*! \fn     emu_hw_get_time_ns(void)
+*   \brief  Get the host monotonic time
+*   \return Time in ns
+*/
+uint64_t emu_hw_get_time_ns(void)
+{
+    struct timespec time_spec;
+    
+    clock_gettime(CLOCK_MONOTONIC, &time_spec);
+    return (uint64_t)time_spec.tv_sec * 1000000000ULL + (uint64_t)time_spec.tv_nsec;
+}
+
+/*! \fn     emu_hw_get_stats(emu_hw_stats_t* stats_pt)
+*   \brief  Get the transfer statistics
+*   \param  stats_pt    Where to store the statistics
+*/
+void emu_hw_get_stats(emu_hw_stats_t* stats_pt)
+{
+    *stats_pt = emu_hw_stats;
+}
+
+/*! \fn     emu_hw_advance_systick(uint32_t ms)
+*   \brief  Move the emulated systick forward, on top of the host time
+*   \param  ms  Number of ms
+*/
+void emu_hw_advance_systick(uint32_t ms)
+{
+    emu_hw_boot_time_ns -= (uint64_t)ms * 1000000ULL;
+}
+
+/*! \fn     emu_hw_attach_sh1122(Sercom* sercom_pt, uint8_t cd_pin_group, uint32_t cd_pin_mask)
+*   \brief  Connect the display to a SERCOM
+*   \param  sercom_pt       SERCOM the display descriptor uses
+*   \param  cd_pin_group    CD pin group
+*   \param  cd_pin_mask     CD pin mask
+*/
+void emu_hw_attach_sh1122(Sercom* sercom_pt, uint8_t cd_pin_group, uint32_t cd_pin_mask)
+{
+    emu_sh1122_sercom_pt = sercom_pt;
+    emu_sh1122_cd_pin_group = cd_pin_group;
+    emu_sh1122_cd_pin_mask = cd_pin_mask;
+    emu_hw_boot_time_ns = emu_hw_get_time_ns();
+    emu_sh1122_reset();
+}
+
+/*! \fn     emu_hw_update_port_outputs(void)
+*   \brief  Apply the OUTSET / OUTCLR register writes done since the last call to the port output levels
+*   \note   A pin set then cleared between two calls (or the opposite) ends up cleared
+*/
+static void emu_hw_update_port_outputs(void)
+{
+    for (uint16_t i = 0; i < sizeof(emu_port_out)/sizeof(emu_port_out[0]); i++)
+    {
+        emu_port_out[i] |= emu_port.Group[i].OUTSET.reg;
+        emu_port_out[i] &= ~emu_port.Group[i].OUTCLR.reg;
+        emu_port.Group[i].OUTSET.reg = 0;
+        emu_port.Group[i].OUTCLR.reg = 0;
+    }
+}
+
+/*! \fn     emu_hw_send_to_sh1122(const uint8_t* data_pt, uint16_t size, BOOL increment)
+*   \brief  Send bytes to the display, the CD pin telling commands from data
+*   \param  data_pt     Bytes to send
+*   \param  size        Number of bytes
+*   \param  increment   FALSE to send the same byte size times
+*/
+static void emu_hw_send_to_sh1122(const uint8_t* data_pt, uint16_t size, BOOL increment)
+{
+    emu_hw_update_port_outputs();
+    BOOL is_data = ((emu_port_out[emu_sh1122_cd_pin_group] & emu_sh1122_cd_pin_mask) != 0) ? TRUE : FALSE;
+    
+    for (uint16_t i = 0; i < size; i++)
+    {
+        emu_sh1122_spi_byte(is_data, *data_pt);
+        if (increment != FALSE)
+        {
+            data_pt++;
+        }
+    }
+    
+    if (is_data != FALSE)
+    {
+        emu_hw_stats.oled_data_bytes += size;
+    }
+    else
+    {
+        emu_hw_stats.oled_command_bytes += size;
+    }
+}
+
+/*! \fn     sercom_spi_send_single_byte(Sercom* sercom_pt, uint8_t data)
+*   \brief  Send a single byte through a given sercom
+*   \param  sercom_pt       Pointer to a sercom module
+*   \param  data            Byte to send
+*   \return received data
+*/
+uint8_t sercom_spi_send_single_byte(Sercom* sercom_pt, uint8_t data)
+{
+    if (sercom_pt == emu_sh1122_sercom_pt)
+    {
+        emu_hw_send_to_sh1122(&data, 1, TRUE);
+    }
+    return 0xFF;
+}
+
+/*! \fn     sercom_spi_send_single_byte_without_receive_wait(Sercom* sercom_pt, uint8_t data)
+*   \brief  Send a single byte through a given sercom, but do not wait to receive a new byte
+*   \param  sercom_pt       Pointer to a sercom module
+*   \param  data            Byte to send
+*/
+void sercom_spi_send_single_byte_without_receive_wait(Sercom* sercom_pt, uint8_t data)
+{
+    sercom_spi_send_single_byte(sercom_pt, data);
+}
+
+/*! \fn     sercom_spi_wait_for_transmit_complete(Sercom* sercom_pt)
+*   \brief  Wait for all data to be flushed out
+*   \param  sercom_pt       Pointer to a sercom module
+*/
+void sercom_spi_wait_for_transmit_complete(Sercom* sercom_pt)
+{
+}
+
+/*! \fn     dma_oled_init_transfer(void* spi_data_p, void* datap, uint16_t size, uint16_t dma_trigger)
+*   \brief  Send bytes to the display
+*   \param  spi_data_p  Pointer to the SPI data register, unused
+*   \param  datap       Pointer to the data
+*   \param  size        Number of bytes to transfer
+*   \param  dma_trigger DMA trigger, unused
+*/
+void dma_oled_init_transfer(void* spi_data_p, void* datap, uint16_t size, uint16_t dma_trigger)
+{
+    emu_hw_send_to_sh1122((uint8_t*)datap, size, TRUE);
+    emu_hw_stats.oled_dma_transfers++;
+    emu_dma_oled_transfer_done = TRUE;
+}
+
+/*! \fn     dma_oled_init_fill_transfer(void* spi_data_p, const uint8_t* fill_byte_p, uint16_t size, uint16_t dma_trigger)
+*   \brief  Send the same byte several times to the display
+*   \param  spi_data_p  Pointer to the SPI data register, unused
+*   \param  fill_byte_p Pointer to the byte to send
+*   \param  size        Number of bytes to transfer
+*   \param  dma_trigger DMA trigger, unused
+*/
+void dma_oled_init_fill_transfer(void* spi_data_p, const uint8_t* fill_byte_p, uint16_t size, uint16_t dma_trigger)
+{
+    emu_hw_send_to_sh1122(fill_byte_p, size, FALSE);
+    emu_hw_stats.oled_dma_transfers++;
+    emu_dma_oled_transfer_done = TRUE;
+}
+
+/*! \fn     dma_ram_init_fill_transfer(void* datap, const uint32_t* fill_word_p, uint16_t nb_words)
+*   \brief  Fill a RAM area with a given word
+*   \param  datap       Pointer to the RAM area, word aligned
+*   \param  fill_word_p Pointer to the fill word
+*   \param  nb_words    Number of words to write
+*/
+void dma_ram_init_fill_transfer(void* datap, const uint32_t* fill_word_p, uint16_t nb_words)
+{
+    uint32_t* dst_pt = (uint32_t*)datap;
+    
+    while (nb_words--)
+    {
+        *dst_pt++ = *fill_word_p;
+    }
+    emu_dma_ram_fill_transfer_done = TRUE;
+}
+
+/*! \fn     dma_custom_fs_init_transfer(void* spi_data_p, void* datap, uint16_t size)
+*   \brief  Read bytes from the opened dataflash transfer
+*   \param  spi_data_p  Pointer to the SPI data register, unused
+*   \param  datap       Where to store the data
+*   \param  size        Number of bytes to read
+*/
+void dma_custom_fs_init_transfer(void* spi_data_p, void* datap, uint16_t size)
+{
+    dataflash_read_bytes_from_opened_transfer(0, (uint8_t*)datap, size);
+    emu_dma_custom_fs_transfer_done = TRUE;
+}
+
+/*! \fn     dma_set_custom_fs_flag_done(void)
+*   \brief  Set custom fs DMA transfer done flag
+*/
+void dma_set_custom_fs_flag_done(void)
+{
+    emu_dma_custom_fs_transfer_done = TRUE;
+}
+
+/*! \fn     dma_custom_fs_check_and_clear_dma_transfer_flag(void)
+*   \brief  Check if a DMA transfer for custom fs is done
+*   \note   If the flag is true, flag will be cleared to false
+*   \return TRUE or FALSE
+*/
+BOOL dma_custom_fs_check_and_clear_dma_transfer_flag(void)
+{
+    BOOL flag = emu_dma_custom_fs_transfer_done;
+    emu_dma_custom_fs_transfer_done = FALSE;
+    return flag;
+}
+
+/*! \fn     dma_oled_check_and_clear_dma_transfer_flag(void)
+*   \brief  Check if a DMA transfer to the display is done
+*   \note   If the flag is true, flag will be cleared to false
+*   \return TRUE or FALSE
+*/
+BOOL dma_oled_check_and_clear_dma_transfer_flag(void)
+{
+    BOOL flag = emu_dma_oled_transfer_done;
+    emu_dma_oled_transfer_done = FALSE;
+    return flag;
+}
+
+/*! \fn     dma_ram_fill_check_and_clear_dma_transfer_flag(void)
+*   \brief  Check if a DMA RAM fill is done
+*   \note   If the flag is true, flag will be cleared to false
+*   \return TRUE or FALSE
+*/
+BOOL dma_ram_fill_check_and_clear_dma_transfer_flag(void)
+{
+    BOOL flag = emu_dma_ram_fill_transfer_done;
+    emu_dma_ram_fill_transfer_done = FALSE;
+    return flag;
+}
+
+/*! \fn     dma_bootloader_compute_crc32_from_spi(void* spi_data_p, uint32_t size)
+*   \brief  Compute the standard CRC32 of bytes read from the opened dataflash transfer
+*   \param  spi_data_p  Pointer to the SPI data register, unused
+*   \param  size        Number of bytes
+*   \return The CRC32
+*/
+uint32_t dma_bootloader_compute_crc32_from_spi(void* spi_data_p, uint32_t size)
+{
+    uint32_t crc32 = 0xFFFFFFFF;
+    uint8_t data;
+    
+    while (size--)
+    {
+        dataflash_read_bytes_from_opened_transfer(0, &data, 1);
+        crc32 ^= data;
+        for (uint16_t i = 0; i < 8; i++)
+        {
+            crc32 = (crc32 >> 1) ^ (0xEDB88320 & (0 - (crc32 & 0x01)));
+        }
+    }
+    return ~crc32;
+}
+
+/*! \fn     dma_custom_fs_compute_crc32_from_spi(void* spi_data_p, uint32_t size)
+*   \brief  Compute the standard CRC32 of bytes read from the opened dataflash transfer, as the application does with the DMA CRC engine
+*   \param  spi_data_p  Pointer to the SPI data register, unused
+*   \param  size        Number of bytes
+*   \return The CRC32
+*/
+uint32_t dma_custom_fs_compute_crc32_from_spi(void* spi_data_p, uint32_t size)
+{
+    return dma_bootloader_compute_crc32_from_spi(spi_data_p, size);
+}
+
+/*! \fn     timer_get_systick(void)
+*   \brief  Get system timer
+*   \return The system time in ms since the display was attached
+*/
+uint32_t timer_get_systick(void)
+{
+    return (uint32_t)((emu_hw_get_time_ns() - emu_hw_boot_time_ns) / 1000000ULL);
+}
+
+/*! \fn     timer_delay_ms(uint32_t ms)
+*   \brief  Timer based ms delay
+*   \param  ms  Number of ms
+*/
+void timer_delay_ms(uint32_t ms)
+{
+    struct timespec delay = {.tv_sec = ms / 1000, .tv_nsec = (ms % 1000) * 1000000L};
+    nanosleep(&delay, 0);
+}
+
+/*! \fn     emu_dataflash_load_bundle(const char* filename)
+*   \brief  Load the dataflash contents from a bundle image file
+*   \param  filename    Bundle image file
+*   \return RETURN_(N)OK
+*/
+RET_TYPE emu_dataflash_load_bundle(const char* filename)
+{
+    FILE* bundle_file = fopen(filename, "rb");
+    if (bundle_file == 0)
+    {
+        return RETURN_NOK;
+    }
+    
+    /* Bundles are stored at the beginning of the dataflash */
+    fseek(bundle_file, 0, SEEK_END);
+    long bundle_size = ftell(bundle_file);
+    uint8_t* image_pt = (uint8_t*)malloc(CUSTOM_FS_FILES_ADDR_OFFSET + bundle_size);
+    fseek(bundle_file, 0, SEEK_SET);
+    if ((bundle_size <= 0) || (image_pt == 0))
+    {
+        fclose(bundle_file);
+        free(image_pt);
+        return RETURN_NOK;
+    }
+    memset((void*)image_pt, 0xFF, CUSTOM_FS_FILES_ADDR_OFFSET + bundle_size);
+    if (fread(&image_pt[CUSTOM_FS_FILES_ADDR_OFFSET], 1, bundle_size, bundle_file) != (size_t)bundle_size)
+    {
+        fclose(bundle_file);
+        free(image_pt);
+        return RETURN_NOK;
+    }
+    fclose(bundle_file);
+    
+    emu_dataflash_image = image_pt;
+    emu_dataflash_image_size = CUSTOM_FS_FILES_ADDR_OFFSET + bundle_size;
+    return RETURN_OK;
+}
+
+/*! \fn     dataflash_read_data_array_start(spi_flash_descriptor_t* descriptor_pt, uint32_t address)
+*   \brief  Start a read transfer
+*   \param  descriptor_pt   Pointer to dataflash descriptor, unused
+*   \param  address         Read address
+*/
+void dataflash_read_data_array_start(spi_flash_descriptor_t* descriptor_pt, uint32_t address)
+{
+    emu_dataflash_read_address = address;
+    emu_hw_stats.flash_reads++;
+}
+
+/*! \fn     dataflash_read_bytes_from_opened_transfer(spi_flash_descriptor_t* descriptor_pt, uint8_t* data, uint32_t length)
+*   \brief  Read bytes from the opened read transfer
+*   \param  descriptor_pt   Pointer to dataflash descriptor, unused
+*   \param  data            Where to store the data
+*   \param  length          Number of bytes
+*/
+void dataflash_read_bytes_from_opened_transfer(spi_flash_descriptor_t* descriptor_pt, uint8_t* data, uint32_t length)
+{
+    emu_hw_stats.flash_read_bytes += length;
+    while (length--)
+    {
+        if (emu_dataflash_read_address < emu_dataflash_image_size)
+        {
+            *data++ = emu_dataflash_image[emu_dataflash_read_address++];
+        }
+        else
+        {
+            *data++ = 0xFF;
+            emu_dataflash_read_address++;
+        }
+    }
+}
+
+/*! \fn     dataflash_read_data_array(spi_flash_descriptor_t* descriptor_pt, uint32_t address, uint8_t* data, uint32_t length)
+*   \brief  Read bytes from the dataflash
+*   \param  descriptor_pt   Pointer to dataflash descriptor, unused
+*   \param  address         Read address
+*   \param  data            Where to store the data
+*   \param  length          Number of bytes
+*/
+void dataflash_read_data_array(spi_flash_descriptor_t* descriptor_pt, uint32_t address, uint8_t* data, uint32_t length)
+{
+    dataflash_read_data_array_start(descriptor_pt, address);
+    dataflash_read_bytes_from_opened_transfer(descriptor_pt, data, length);
+}
+
+/*! \fn     dataflash_stop_ongoing_transfer(spi_flash_descriptor_t* descriptor_pt)
+*   \brief  Stop the ongoing transfer
+*   \param  descriptor_pt   Pointer to dataflash descriptor, unused
+*/
+void dataflash_stop_ongoing_transfer(spi_flash_descriptor_t* descriptor_pt)
+{
+}
@@ -0,0 +1,53 @@
+/*!  \file     emu_hw.h
+*    \brief    Host emulator: RAM backed peripherals replacing the SERCOM, DMA, timer and dataflash drivers
+*    Created:  17/10/2026
+*/
+
+
+#ifndef EMU_HW_H_
+#define EMU_HW_H_
+
+#include <stdint.h>
+
+/* Peripherals accessed through registers are redirected to RAM instances */
+#undef PORT
+#undef SERCOM0
+#undef SERCOM1
+#undef SERCOM2
+#undef SERCOM3
+#undef SERCOM4
+#undef SERCOM5
+#define PORT        (&emu_port)
+#define SERCOM0     (&emu_sercoms[0])
+#define SERCOM1     (&emu_sercoms[1])
+#define SERCOM2     (&emu_sercoms[2])
+#define SERCOM3     (&emu_sercoms[3])
+#define SERCOM4     (&emu_sercoms[4])
+#define SERCOM5     (&emu_sercoms[5])
+
+/* Defines */
+#define EMU_MAIN_CLOCK_FREQ         48000000UL  // SERCOM core clock
+#define EMU_NB_SERCOMS              6
+
+/* Typedefs */
+typedef struct
+{
+    uint32_t oled_command_bytes;        // Bytes sent to the display with CD low
+    uint32_t oled_data_bytes;           // Bytes sent to the display with CD high
+    uint32_t oled_dma_transfers;        // Number of DMA transfers to the display
+    uint32_t flash_reads;               // Number of read commands sent to the dataflash
+    uint32_t flash_read_bytes;          // Number of bytes read from the dataflash
+} emu_hw_stats_t;
+
+/* Emulated registers */
+extern Port emu_port;
+extern Sercom emu_sercoms[EMU_NB_SERCOMS];
+
+/* Prototypes */
+void emu_hw_attach_sh1122(Sercom* sercom_pt, uint8_t cd_pin_group, uint32_t cd_pin_mask);
+RET_TYPE emu_dataflash_load_bundle(const char* filename);
+void emu_hw_get_stats(emu_hw_stats_t* stats_pt);
+void emu_hw_advance_systick(uint32_t ms);
+uint64_t emu_hw_get_time_ns(void);
+
+#endif /* EMU_HW_H_ */
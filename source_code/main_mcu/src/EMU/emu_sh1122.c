@@ -0,0 +1,297 @@
+/*!  \file     emu_sh1122.c
+*    \brief    Host emulator: SH1122 command stream decoder and virtual GDDRAM
+*    Created:  17/10/2026
+*    Notes:    GDDRAM is modelled the way the driver uses it: 128 rows of 128 two pixel bytes, the display start line
+*              scrolling through both pages. Remap, scan direction and analog settings are assumed to be the init ones
+*/
+#include <string.h>
+#include <stdio.h>
+#include <asf.h>
+#include "platform_defines.h"
+#include "emu_sh1122.h"
+
+/* Virtual GDDRAM */
+uint8_t emu_sh1122_gddram[EMU_SH1122_GDDRAM_NB_ROWS][EMU_SH1122_GDDRAM_NB_COLS];
+/* Write address */
+uint8_t emu_sh1122_column = 0;
+uint8_t emu_sh1122_row = 0;
+/* Display state */
+uint8_t emu_sh1122_start_line = 0;
+BOOL emu_sh1122_display_on = FALSE;
+BOOL emu_sh1122_all_pixels_on = FALSE;
+BOOL emu_sh1122_reversed = FALSE;
+/* Command waiting for its parameter byte, 0 if none */
+uint8_t emu_sh1122_param_command = 0;
+
+
+/*! \fn     emu_sh1122_reset(void)
+*   \brief  Reset the display state, GDDRAM contents being random at power up
+*/
+void emu_sh1122_reset(void)
+{
+    for (uint16_t i = 0; i < sizeof(emu_sh1122_gddram); i++)
+    {
+        ((uint8_t*)emu_sh1122_gddram)[i] = (uint8_t)(i * 0x9D);
+    }
+    emu_sh1122_column = 0;
+    emu_sh1122_row = 0;
+    emu_sh1122_start_line = 0;
+    emu_sh1122_display_on = FALSE;
+    emu_sh1122_all_pixels_on = FALSE;
+    emu_sh1122_reversed = FALSE;
+    emu_sh1122_param_command = 0;
+}
+
+/*! \fn     emu_sh1122_command_has_param(uint8_t command)
+*   \brief  Know if a command is followed by a parameter byte
+*   \param  command     Command byte
+*   \return TRUE or FALSE
+*/
+static BOOL emu_sh1122_command_has_param(uint8_t command)
+{
+    switch (command)
+    {
+        /* The driver sends display start lines as a data byte after this command */
+        case SH1122_CMD_SET_DISPLAY_START_LINE:
+        case SH1122_CMD_SET_ROW_ADDR:
+        case SH1122_CMD_SET_CLOCK_DIVIDER:
+        case SS1122_CMD_SET_DISCHARGE_PRECHARGE_PERIOD:
+        case SH1122_CMD_SET_CONTRAST_CURRENT:
+        case SH1122_CMD_SET_MULTIPLEX_RATIO:
+        case SH1122_CMD_SET_DCDC_SETTING:
+        case SH1122_CMD_SET_DISPLAY_OFFSET:
+        case SH1122_CMD_SET_VCOM_DESELECT_LEVEL:
+        case SH1122_CMD_SET_VSEGM_LEVEL: return TRUE;
+        default: return FALSE;
+    }
+}
+
+/*! \fn     emu_sh1122_execute_command(uint8_t command)
+*   \brief  Execute a command without parameter
+*   \param  command     Command byte
+*/
+static void emu_sh1122_execute_command(uint8_t command)
+{
+    if ((command & 0xF0) == SH1122_CMD_SET_LOW_COLUMN_ADDR)
+    {
+        emu_sh1122_column = (emu_sh1122_column & 0xF0) | (command & 0x0F);
+    }
+    else if ((command & 0xF8) == SH1122_CMD_SET_HIGH_COLUMN_ADDR)
+    {
+        emu_sh1122_column = (emu_sh1122_column & 0x0F) | ((command & 0x07) << 4);
+    }
+    else if ((command & 0xC0) == SH1122_CMD_SET_DISPLAY_START_LINE)
+    {
+        emu_sh1122_start_line = command & 0x3F;
+    }
+    else if ((command & 0xFE) == SH1122_CMD_SET_DISPLAY_OFF_ON)
+    {
+        emu_sh1122_all_pixels_on = ((command & 0x01) != 0) ? TRUE : FALSE;
+    }
+    else if (command == SH1122_CMD_SET_NORMAL_DISPLAY)
+    {
+        emu_sh1122_reversed = FALSE;
+    }
+    else if (command == SH1122_CMD_SET_REVERSE_DISPLAY)
+    {
+        emu_sh1122_reversed = TRUE;
+    }
+    else if (command == SH1122_CMD_SET_DISPLAY_OFF)
+    {
+        emu_sh1122_display_on = FALSE;
+    }
+    else if (command == SH1122_CMD_SET_DISPLAY_ON)
+    {
+        emu_sh1122_display_on = TRUE;
+    }
+}
+
+/*! \fn     emu_sh1122_execute_param_command(uint8_t command, uint8_t param)
+*   \brief  Execute a command with its parameter
+*   \param  command     Command byte
+*   \param  param       Parameter byte
+*/
+static void emu_sh1122_execute_param_command(uint8_t command, uint8_t param)
+{
+    if (command == SH1122_CMD_SET_DISPLAY_START_LINE)
+    {
+        emu_sh1122_start_line = param & SH1122_OLED_START_LINE_MASK;
+    }
+    else if (command == SH1122_CMD_SET_ROW_ADDR)
+    {
+        emu_sh1122_row = param & (EMU_SH1122_GDDRAM_NB_ROWS-1);
+    }
+}
+
+/*! \fn     emu_sh1122_spi_byte(BOOL is_data, uint8_t data)
+*   \brief  Decode a byte received by the display
+*   \param  is_data     TRUE if the CD pin was high
+*   \param  data        Received byte
+*/
+void emu_sh1122_spi_byte(BOOL is_data, uint8_t data)
+{
+    /* Parameters may be sent with CD low (init sequence) or high (contrast, start line) */
+    if (emu_sh1122_param_command != 0)
+    {
+        uint8_t command = emu_sh1122_param_command;
+        emu_sh1122_param_command = 0;
+    
+        /* Start line command without data byte: start line 0, process the new command */
+        if ((command != SH1122_CMD_SET_DISPLAY_START_LINE) || (is_data != FALSE))
+        {
+            emu_sh1122_execute_param_command(command, data);
+            return;
+        }
+        emu_sh1122_start_line = 0;
+    }
+    
+    if (is_data == FALSE)
+    {
+        if (emu_sh1122_command_has_param(data) != FALSE)
+        {
+            emu_sh1122_param_command = data;
+        }
+        else
+        {
+            emu_sh1122_execute_command(data);
+        }
+        return;
+    }
+    
+    /* GDDRAM write, wrapping to the next row */
+    emu_sh1122_gddram[emu_sh1122_row][emu_sh1122_column++] = data;
+    if (emu_sh1122_column == EMU_SH1122_GDDRAM_NB_COLS)
+    {
+        emu_sh1122_column = 0;
+        emu_sh1122_row = (emu_sh1122_row + 1) & (EMU_SH1122_GDDRAM_NB_ROWS-1);
+    }
+}
+
+/*! \fn     emu_sh1122_get_displayed_pixels(uint8_t pixels[SH1122_OLED_HEIGHT][SH1122_OLED_WIDTH])
+*   \brief  Get the pixels currently shown by the display
+*   \param  pixels      Where to store the 4 bits pixels
+*/
+void emu_sh1122_get_displayed_pixels(uint8_t pixels[SH1122_OLED_HEIGHT][SH1122_OLED_WIDTH])
+{
+    for (uint16_t y = 0; y < SH1122_OLED_HEIGHT; y++)
+    {
+        /* The init start line displays the first GDDRAM row on top */
+        uint8_t* row_pt = emu_sh1122_gddram[(emu_sh1122_start_line - SH1122_OLED_INIT_START_LINE + y) & SH1122_OLED_START_LINE_MASK];
+    
+        for (uint16_t x = 0; x < SH1122_OLED_WIDTH; x++)
+        {
+            uint8_t pixel = ((x & 0x01) == 0) ? (row_pt[x/2] >> 4) : (row_pt[x/2] & 0x0F);
+    
+            if (emu_sh1122_display_on == FALSE)
+            {
+                pixel = 0x00;
+            }
+            else if (emu_sh1122_all_pixels_on != FALSE)
+            {
+                pixel = 0x0F;
+            }
+            else if (emu_sh1122_reversed != FALSE)
+            {
+                pixel = 0x0F - pixel;
+            }
+            pixels[y][x] = pixel;
+        }
+    }
+}
+
+/*! \fn     emu_sh1122_update_crc32(uint32_t crc32, const uint8_t* data_pt, uint32_t size)
+*   \brief  Update a PNG chunk CRC32
+*   \param  crc32       Current CRC32, complemented
+*   \param  data_pt     Data
+*   \param  size        Data size
+*   \return Updated CRC32, complemented
+*/
+static uint32_t emu_sh1122_update_crc32(uint32_t crc32, const uint8_t* data_pt, uint32_t size)
+{
+    while (size--)
+    {
+        crc32 ^= *data_pt++;
+        for (uint16_t i = 0; i < 8; i++)
+        {
+            crc32 = (crc32 >> 1) ^ (0xEDB88320 & (0 - (crc32 & 0x01)));
+        }
+    }
+    return crc32;
+}
+
+/*! \fn     emu_sh1122_write_png_chunk(FILE* file_pt, const char* type, const uint8_t* data_pt, uint32_t size)
+*   \brief  Write a PNG chunk: <length> <type> <data> <crc32>
+*   \param  file_pt     PNG file
+*   \param  type        4 characters chunk type
+*   \param  data_pt     Chunk data
+*   \param  size        Chunk data size
+*/
+static void emu_sh1122_write_png_chunk(FILE* file_pt, const char* type, const uint8_t* data_pt, uint32_t size)
+{
+    uint8_t length[4] = {(uint8_t)(size >> 24), (uint8_t)(size >> 16), (uint8_t)(size >> 8), (uint8_t)size};
+    uint32_t crc32 = emu_sh1122_update_crc32(0xFFFFFFFF, (const uint8_t*)type, 4);
+    crc32 = ~emu_sh1122_update_crc32(crc32, data_pt, size);
+    uint8_t crc[4] = {(uint8_t)(crc32 >> 24), (uint8_t)(crc32 >> 16), (uint8_t)(crc32 >> 8), (uint8_t)crc32};
+    
+    fwrite(length, 1, sizeof(length), file_pt);
+    fwrite(type, 1, 4, file_pt);
+    fwrite(data_pt, 1, size, file_pt);
+    fwrite(crc, 1, sizeof(crc), file_pt);
+}
+
+/*! \fn     emu_sh1122_dump_png(const char* filename)
+*   \brief  Write the displayed pixels to an 8 bits grayscale PNG file
+*   \param  filename    PNG file name
+*   \return RETURN_(N)OK
+*   \note   Image data is stored uncompressed, so no zlib is needed
+*/
+RET_TYPE emu_sh1122_dump_png(const char* filename)
+{
+    static const uint8_t png_signature[] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    static const uint8_t png_header[] = {0, 0, SH1122_OLED_WIDTH >> 8, SH1122_OLED_WIDTH & 0xFF, 0, 0, 0, SH1122_OLED_HEIGHT, 8, 0, 0, 0, 0};
+    uint8_t pixels[SH1122_OLED_HEIGHT][SH1122_OLED_WIDTH];
+    /* zlib header, one stored deflate block of filter byte prefixed rows, adler32 */
+    uint8_t image_data[2 + 5 + SH1122_OLED_HEIGHT*(1+SH1122_OLED_WIDTH) + 4];
+    uint16_t block_size = SH1122_OLED_HEIGHT*(1+SH1122_OLED_WIDTH);
+    uint32_t adler_a = 1, adler_b = 0;
+    uint16_t index = 0;
+    
+    FILE* file_pt = fopen(filename, "wb");
+    if (file_pt == 0)
+    {
+        return RETURN_NOK;
+    }
+    
+    emu_sh1122_get_displayed_pixels(pixels);
+    image_data[index++] = 0x78;
+    image_data[index++] = 0x01;
+    image_data[index++] = 0x01;
+    image_data[index++] = (uint8_t)block_size;
+    image_data[index++] = (uint8_t)(block_size >> 8);
+    image_data[index++] = (uint8_t)~block_size;
+    image_data[index++] = (uint8_t)(~block_size >> 8);
+    for (uint16_t y = 0; y < SH1122_OLED_HEIGHT; y++)
+    {
+        image_data[index++] = 0x00;
+        for (uint16_t x = 0; x < SH1122_OLED_WIDTH; x++)
+        {
+            image_data[index++] = pixels[y][x] * 17;
+        }
+    }
+    for (uint16_t i = 7; i < index; i++)
+    {
+        adler_a = (adler_a + image_data[i]) % 65521;
+        adler_b = (adler_b + adler_a) % 65521;
+    }
+    image_data[index++] = (uint8_t)(adler_b >> 8);
+    image_data[index++] = (uint8_t)adler_b;
+    image_data[index++] = (uint8_t)(adler_a >> 8);
+    image_data[index++] = (uint8_t)adler_a;
+    
+    fwrite(png_signature, 1, sizeof(png_signature), file_pt);
+    emu_sh1122_write_png_chunk(file_pt, "IHDR", png_header, sizeof(png_header));
+    emu_sh1122_write_png_chunk(file_pt, "IDAT", image_data, index);
+    emu_sh1122_write_png_chunk(file_pt, "IEND", 0, 0);
+    fclose(file_pt);
+    return RETURN_OK;
+}
@@ -0,0 +1,23 @@
+/*!  \file     emu_sh1122.h
+*    \brief    Host emulator: SH1122 command stream decoder and virtual GDDRAM
+*    Created:  17/10/2026
+*/
+
+
+#ifndef EMU_SH1122_H_
+#define EMU_SH1122_H_
+
+#include "platform_defines.h"
+#include "sh1122.h"
+
+/* Defines */
+#define EMU_SH1122_GDDRAM_NB_ROWS   (SH1122_OLED_START_LINE_MASK+1)     // Both GDDRAM pages, see sh1122_get_hidden_page_first_row()
+#define EMU_SH1122_GDDRAM_NB_COLS   (SH1122_OLED_WIDTH/2)               // Column address unit is 2 pixels
+
+/* Prototypes */
+void emu_sh1122_get_displayed_pixels(uint8_t pixels[SH1122_OLED_HEIGHT][SH1122_OLED_WIDTH]);
+RET_TYPE emu_sh1122_dump_png(const char* filename);
+void emu_sh1122_spi_byte(BOOL is_data, uint8_t data);
+void emu_sh1122_reset(void);
+
+#endif /* EMU_SH1122_H_ */
@@ -0,0 +1,1165 @@
+/*!  \file     emu_tests.c
+*    \brief    Host emulator: display and filesystem tests against reference implementations
+*    Created:  17/10/2026
+*    Notes:    Not part of the firmware project. Linux build, from the main_mcu/src folder, same flags as emu_benchmark.c
+*              with the features under test enabled:
+*              gcc -std=gnu99 -O2 -Wall -DEMULATOR_BUILD -D__SAMD21G18A__ -DBOARD=USER_BOARD -DARM_MATH_CM0PLUS=true "-D__packed=__attribute__((packed))"
+*                  -DOLED_GLYPH_BITMAP_ARENA -DOLED_BANDED_RENDERING -DOLED_STRING_SPRITE_CACHE -DCUSTOM_FS_STRING_CACHE -DCUSTOM_FS_FLASH_CACHE -DOLED_MARQUEE
+*                  (same -I folders as emu_benchmark.c)
+*                  EMU/emu_tests.c EMU/emu_hw.c EMU/emu_sh1122.c OLED/sh1122.c OLED/mooltipass_graphics_bundle.c
+*                  FILESYSTEM/custom_fs.c FILESYSTEM/custom_bitstream.c FILESYSTEM/custom_fs_emergency_font.c GUI/gui_list.c -o emu_tests
+*              Usage: emu_tests <bundle image file, as scripts/python_framework/bundle.img>
+*              Returns the number of failed tests
+*/
+#include <string.h>
+#include <stdio.h>
+#include <asf.h>
+#include "platform_defines.h"
+#include "custom_bitstream.h"
+#include "custom_fs.h"
+#include "dataflash.h"
+#include "emu_sh1122.h"
+#include "gui_list.h"
+#include "emu_hw.h"
+#include "sh1122.h"
+
+/* Defines */
+#define EMU_TESTS_MAX_STRING_ID     64
+#define EMU_TESTS_MAX_BLIT_WIDTH    304     // Wider than the display, multiple of 8
+#define EMU_TESTS_NB_LIST_ITEMS     23
+#define EMU_TESTS_BACKGROUND_Y      16
+#define EMU_TESTS_MAX_FLASH_READ    80      // Larger than a flash cache line
+#define EMU_TESTS_BACKGROUND_NB_ROWS    32
+#define EMU_TESTS_MARQUEE_Y         20
+#define EMU_TESTS_MARQUEE_STEP_MS   100
+
+/* Same descriptors as the firmware */
+sh1122_descriptor_t plat_oled_descriptor = {.sercom_pt = OLED_SERCOM, .dma_trigger_id = OLED_DMA_SERCOM_TX_TRIG, .sh1122_cs_pin_group = OLED_nCS_GROUP, .sh1122_cs_pin_mask = OLED_nCS_MASK, .sh1122_cd_pin_group = OLED_CD_GROUP, .sh1122_cd_pin_mask = OLED_CD_MASK};
+spi_flash_descriptor_t dataflash_descriptor = {.sercom_pt = DATAFLASH_SERCOM, .cs_pin_group = DATAFLASH_nCS_GROUP, .cs_pin_mask = DATAFLASH_nCS_MASK};
+/* Frame buffer drawn by the reference implementations */
+uint8_t emu_tests_reference_frame_buffer[SH1122_OLED_HEIGHT][SH1122_OLED_WIDTH/2];
+/* Test strings drawn before the bundle ones */
+const cust_char_t* emu_tests_strings[] = {u"???this is line 1", u"AVAV To Ty Wa yo \"fj\" ij", u"  leading and trailing spaces  ", u"!\"#$%&'()*+,-./0123456789:;<=>?@", u"ABCDEFGHIJKLMNOPQRSTUVWXYZ[\\]^_`", u"abcdefghijklmnopqrstuvwxyz{|}~"};
+/* Bitmap pixels decoded as spans and one at a time */
+uint8_t emu_tests_span_pixels[SH1122_OLED_WIDTH*SH1122_OLED_HEIGHT*2];
+uint8_t emu_tests_single_pixels[SH1122_OLED_WIDTH*SH1122_OLED_HEIGHT*2];
+/* Background layer strings are blended over */
+uint8_t emu_tests_background_layer[EMU_TESTS_BACKGROUND_NB_ROWS][SH1122_OLED_WIDTH/2] __attribute__((aligned(4)));
+#ifdef OLED_MARQUEE
+/* Marquee scrolled by the tests */
+sh1122_marquee_t emu_tests_scrolled_marquee;
+/* Wider than the display, narrower than the marquee strip */
+const cust_char_t emu_tests_marquee_string[] = u"Marquee: ABCDEFGHIJKLMNOPQRSTUVWXYZ abcdefghijklmnopqrstuvwxyz";
+#endif
+/* Changed to modify the list test items */
+uint16_t emu_tests_list_item_revision = 0;
+/* Pseudo random numbers state */
+uint32_t emu_tests_random_state = 1;
+/* Number of failed tests */
+uint16_t emu_tests_nb_failures = 0;
+
+
+/*! \fn     emu_tests_report(const char* name, uint32_t nb_cases, uint32_t nb_failed_cases)
+*   \brief  Print a test result
+*   \param  name                Test name
+*   \param  nb_cases            Number of tested cases
+*   \param  nb_failed_cases     Number of failed cases
+*/
+static void emu_tests_report(const char* name, uint32_t nb_cases, uint32_t nb_failed_cases)
+{
+    if ((nb_failed_cases != 0) || (nb_cases == 0))
+    {
+        printf("FAIL %s: %u/%u cases failed\n", name, nb_failed_cases, nb_cases);
+        emu_tests_nb_failures++;
+    }
+    else
+    {
+        printf("PASS %s: %u cases\n", name, nb_cases);
+    }
+}
+
+/*! \fn     emu_tests_clear_frame_buffers(void)
+*   \brief  Clear the display frame buffer and the reference one
+*/
+static void emu_tests_clear_frame_buffers(void)
+{
+    sh1122_clear_frame_buffer(&plat_oled_descriptor);
+    sh1122_check_for_fill_and_terminate(&plat_oled_descriptor);
+    memset((void*)emu_tests_reference_frame_buffer, 0x00, sizeof(emu_tests_reference_frame_buffer));
+}
+
+/*! \fn     emu_tests_compare_frame_buffers(const char* case_name)
+*   \brief  Compare the display frame buffer with the reference one, printing the first difference
+*   \param  case_name   Tested case, for the printed difference
+*   \return RETURN_OK if both frame buffers are identical
+*/
+static RET_TYPE emu_tests_compare_frame_buffers(const char* case_name)
+{
+    for (uint16_t y = 0; y < SH1122_OLED_HEIGHT; y++)
+    {
+        for (uint16_t x = 0; x < SH1122_OLED_WIDTH/2; x++)
+        {
+            if (plat_oled_descriptor.frame_buffer[y][x] != emu_tests_reference_frame_buffer[y][x])
+            {
+                printf("  %s: row %u byte column %u is 0x%02x, expected 0x%02x\n", case_name, y, x, plat_oled_descriptor.frame_buffer[y][x], emu_tests_reference_frame_buffer[y][x]);
+                return RETURN_NOK;
+            }
+        }
+    }
+    return RETURN_OK;
+}
+
+/*! \fn     emu_tests_reference_alpha_blend(uint8_t dst, uint8_t src)
+*   \brief  Reference alpha blending of white over a pixel
+*   \param  dst     4 bits destination pixel
+*   \param  src     4 bits source pixel, the white coverage
+*   \return dst + round((15 - dst) * src / 15)
+*/
+static uint8_t emu_tests_reference_alpha_blend(uint8_t dst, uint8_t src)
+{
+    /* (15 - dst) * src / 15 never ends in .5 */
+    return dst + (uint8_t)(((15 - dst) * src + 7) / 15);
+}
+
+/*! \fn     emu_tests_reference_draw_pixel(int16_t x, int16_t y, uint8_t pixel)
+*   \brief  Draw a foreground pixel into the reference frame buffer, pixels outside of the display are dropped
+*   \param  x       Pixel x
+*   \param  y       Pixel y
+*   \param  pixel   4 bits pixel
+*   \note   Pixels are ORed, or alpha blended when a background layer is set
+*/
+static void emu_tests_reference_draw_pixel(int16_t x, int16_t y, uint8_t pixel)
+{
+    uint8_t shift = ((x & 0x01) == 0) ? 4 : 0;
+    uint8_t* byte_pt;
+    
+    if ((x < 0) || (y < 0) || (x >= SH1122_OLED_WIDTH) || (y >= SH1122_OLED_HEIGHT))
+    {
+        return;
+    }
+    byte_pt = &emu_tests_reference_frame_buffer[y][x/2];
+    
+    #ifdef OLED_BACKGROUND_LAYER
+    if (plat_oled_descriptor.background_layer_pt != 0)
+    {
+        pixel = emu_tests_reference_alpha_blend((*byte_pt >> shift) & 0x0F, pixel);
+        *byte_pt = (*byte_pt & ~(0x0F << shift)) | (uint8_t)(pixel << shift);
+        return;
+    }
+    #endif
+    *byte_pt |= (uint8_t)((pixel & 0x0F) << shift);
+}
+
+/*! \fn     emu_tests_reference_put_string_xy(int16_t x, int16_t y, const cust_char_t* string)
+*   \brief  Reference left justified string draw: glyphs are decoded one pixel at a time from the font file
+*   \param  x       Starting x
+*   \param  y       Starting y
+*   \param  string  Null terminated string
+*/
+static void emu_tests_reference_put_string_xy(int16_t x, int16_t y, const cust_char_t* string)
+{
+    sh1122_glyph_run_t run;
+    
+    sh1122_layout_string(&plat_oled_descriptor, string, &run);
+    for (uint16_t i = 0; i < run.nb_items; i++)
+    {
+        sh1122_glyph_run_item_t* item_pt = &run.items[i];
+        bitstream_bitmap_t bs;
+        font_glyph_t glyph;
+    
+        if ((item_pt->width + x + item_pt->x) > plat_oled_descriptor.max_text_x)
+        {
+            break;
+        }
+        if (item_pt->glyph_desc.data_addr == 0)
+        {
+            continue;
+        }
+    
+        glyph.xrect = item_pt->glyph_desc.xrect;
+        glyph.yrect = item_pt->glyph_desc.yrect;
+        bitstream_glyph_bitmap_init(&bs, &plat_oled_descriptor.current_font_header, &glyph, item_pt->glyph_desc.data_addr, TRUE);
+        for (uint16_t yy = 0; yy < glyph.yrect; yy++)
+        {
+            for (uint16_t xx = 0; xx < glyph.xrect; xx++)
+            {
+                emu_tests_reference_draw_pixel(x + item_pt->x + item_pt->glyph_desc.xoffset + xx, y + item_pt->glyph_desc.yoffset + yy, (uint8_t)bitstream_bitmap_read(&bs, 1));
+            }
+        }
+        bitstream_bitmap_close(&bs);
+    }
+}
+
+/*! \fn     emu_tests_reference_display_bitmap(int16_t x, int16_t y, uint32_t file_id)
+*   \brief  Reference bitmap draw: pixels are decoded one at a time from the bitmap file
+*   \param  x       Starting x
+*   \param  y       Starting y
+*   \param  file_id Bitmap file ID
+*/
+static void emu_tests_reference_display_bitmap(int16_t x, int16_t y, uint32_t file_id)
+{
+    custom_fs_address_t file_address;
+    bitstream_bitmap_t bitstream;
+    bitmap_t bitmap;
+    
+    if (custom_fs_get_file_address(file_id, &file_address, CUSTOM_FS_BITMAP_TYPE) != RETURN_OK)
+    {
+        return;
+    }
+    custom_fs_read_from_flash((uint8_t*)&bitmap, file_address, sizeof(bitmap));
+    bitstream_bitmap_init(&bitstream, &bitmap, file_address + sizeof(bitmap), TRUE);
+    for (uint16_t j = 0; j < bitmap.height; j++)
+    {
+        for (uint16_t i = 0; i < bitmap.width; i++)
+        {
+            emu_tests_reference_draw_pixel(x + i, y + j, (uint8_t)bitstream_bitmap_read(&bitstream, 1));
+        }
+    }
+    bitstream_bitmap_close(&bitstream);
+}
+
+/*! \fn     emu_tests_get_string(uint16_t index, cust_char_t** string_pt)
+*   \brief  Get a test string: spaces, kerned pairs and all printable ASCII chars, then the current language strings
+*   \param  index       Test string index
+*   \param  string_pt   Where to store the string pointer
+*   \return RETURN_NOK past the last test string
+*/
+static RET_TYPE emu_tests_get_string(uint16_t index, cust_char_t** string_pt)
+{
+    if (index < sizeof(emu_tests_strings)/sizeof(emu_tests_strings[0]))
+    {
+        *string_pt = (cust_char_t*)emu_tests_strings[index];
+        return RETURN_OK;
+    }
+    index -= sizeof(emu_tests_strings)/sizeof(emu_tests_strings[0]);
+    if (index >= EMU_TESTS_MAX_STRING_ID)
+    {
+        return RETURN_NOK;
+    }
+    return custom_fs_get_string_from_file(index, string_pt);
+}
+
+/*! \fn     emu_tests_random(void)
+*   \brief  Deterministic pseudo random numbers, for test data
+*   \return 16 bits random number
+*/
+static uint16_t emu_tests_random(void)
+{
+    emu_tests_random_state = emu_tests_random_state * 1103515245UL + 12345UL;
+    return (uint16_t)(emu_tests_random_state >> 16);
+}
+
+/*! \fn     emu_tests_reference_blit_row(uint8_t* row_pt, int16_t x, const uint8_t* src_pt, int16_t nb_pixels, oled_blit_mode_te mode)
+*   \brief  Reference pixel by pixel blit, as done by our previous frame buffer draw code
+*   \param  row_pt              Pointer to the display row
+*   \param  x                   Starting x
+*   \param  src_pt              Pointer to the source pixels, first pixel in the high nibble
+*   \param  nb_pixels           Number of pixels
+*   \param  mode                Blit mode, alpha blending excluded
+*/
+static void emu_tests_reference_blit_row(uint8_t* row_pt, int16_t x, const uint8_t* src_pt, int16_t nb_pixels, oled_blit_mode_te mode)
+{
+    for (int16_t i = 0; i < nb_pixels; i++)
+    {
+        uint8_t shift = (((x+i) & 0x01) != 0) ? 0 : 4;
+        uint8_t pixel;
+    
+        if (((x+i) < 0) || ((x+i) >= SH1122_OLED_WIDTH))
+        {
+            continue;
+        }
+        pixel = ((i & 0x01) != 0) ? (src_pt[i/2] & 0x0F) : (src_pt[i/2] >> 4);
+        if (mode == OLED_BLIT_OR)
+        {
+            pixel |= (row_pt[(x+i)/2] >> shift) & 0x0F;
+        }
+        else if (mode == OLED_BLIT_INVERTED)
+        {
+            pixel = ~pixel & 0x0F;
+        }
+        row_pt[(x+i)/2] = (row_pt[(x+i)/2] & ~(0x0F << shift)) | (uint8_t)(pixel << shift);
+    }
+}
+
+/*! \fn     emu_tests_blit_row(void)
+*   \brief  Word blit kernels must match the reference pixel by pixel blit, for all alignments and clippings
+*/
+static void emu_tests_blit_row(void)
+{
+    uint32_t src_buffer[EMU_TESTS_MAX_BLIT_WIDTH/8 + 2];
+    uint32_t row_buffer[SH1122_OLED_WIDTH/8 + 2];
+    uint8_t reference_row[SH1122_OLED_WIDTH/2 + 4];
+    const int16_t nb_pixels_list[] = {0, 1, 2, 3, 7, 8, 9, 15, 16, 17, 31, 33, 64, 127, 128, 255, 256, EMU_TESTS_MAX_BLIT_WIDTH};
+    const int16_t x_list[] = {-300, -33, -9, -8, -1, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 63, 100, 127, 128, 200, 247, 248, 250, 255, 256};
+    const oled_blit_mode_te mode_list[] = {OLED_BLIT_OPAQUE, OLED_BLIT_OR, OLED_BLIT_INVERTED};
+    uint32_t nb_failed_cases = 0;
+    uint32_t nb_cases = 0;
+    
+    for (uint16_t mode_index = 0; mode_index < sizeof(mode_list)/sizeof(mode_list[0]); mode_index++)
+    {
+        for (uint16_t x_index = 0; x_index < sizeof(x_list)/sizeof(x_list[0]); x_index++)
+        {
+            for (uint16_t nb_pixels_index = 0; nb_pixels_index < sizeof(nb_pixels_list)/sizeof(nb_pixels_list[0]); nb_pixels_index++)
+            {
+                /* Source and row pointers at each word alignment */
+                for (uint16_t src_offset = 0; src_offset < 4; src_offset++)
+                {
+                    for (uint16_t row_offset = 0; row_offset < 4; row_offset++)
+                    {
+                        uint8_t* src_pt = (uint8_t*)src_buffer + src_offset;
+                        uint8_t* row_pt = (uint8_t*)row_buffer + row_offset;
+    
+                        for (uint16_t i = 0; i < sizeof(src_buffer); i++)
+                        {
+                            ((uint8_t*)src_buffer)[i] = (uint8_t)emu_tests_random();
+                        }
+                        for (uint16_t i = 0; i < sizeof(row_buffer); i++)
+                        {
+                            ((uint8_t*)row_buffer)[i] = (uint8_t)emu_tests_random();
+                        }
+                        memcpy((void*)reference_row, (void*)row_pt, sizeof(reference_row));
+    
+                        sh1122_blit_row(row_pt, x_list[x_index], src_pt, nb_pixels_list[nb_pixels_index], mode_list[mode_index]);
+                        emu_tests_reference_blit_row(reference_row, x_list[x_index], src_pt, nb_pixels_list[nb_pixels_index], mode_list[mode_index]);
+                        if (memcmp((void*)reference_row, (void*)row_pt, sizeof(reference_row)) != 0)
+                        {
+                            if (nb_failed_cases == 0)
+                            {
+                                printf("  mode %u x %d %d pixels, source offset %u row offset %u: rows differ\n", mode_list[mode_index], x_list[x_index], nb_pixels_list[nb_pixels_index], src_offset, row_offset);
+                            }
+                            nb_failed_cases++;
+                        }
+                        nb_cases++;
+                    }
+                }
+            }
+        }
+    }
+    emu_tests_report("blit row kernels", nb_cases, nb_failed_cases);
+}
+
+/*! \fn     emu_tests_bitmap_draws(void)
+*   \brief  RLE span decoding must match pixel decoding, bitmap draws must match a reference pixel by pixel draw
+*/
+static void emu_tests_bitmap_draws(void)
+{
+    const int16_t position_list[][2] = {{0, 0}, {1, 0}, {-3, 5}, {6, -2}, {129, 17}};
+    uint32_t nb_span_failed_cases = 0;
+    uint32_t nb_span_cases = 0;
+    uint32_t nb_failed_cases = 0;
+    uint32_t nb_cases = 0;
+    
+    for (uint32_t file_id = 0; file_id < custom_fs_flash_header.bitmap_file_count; file_id++)
+    {
+        custom_fs_address_t file_address;
+        bitstream_bitmap_t bitstream;
+        bitmap_t bitmap;
+    
+        if (custom_fs_get_file_address(file_id, &file_address, CUSTOM_FS_BITMAP_TYPE) != RETURN_OK)
+        {
+            continue;
+        }
+        custom_fs_read_from_flash((uint8_t*)&bitmap, file_address, sizeof(bitmap));
+    
+        /* Spans against single pixels, each bitstream being read on its own as they use the flash continuous read */
+        if ((bitmap.flags & CUSTOM_FS_BITMAP_RLE_FLAG) != 0)
+        {
+            uint32_t nb_pixels = (uint32_t)bitmap.width * bitmap.height;
+            uint32_t pixel_index = 0;
+    
+            if (nb_pixels > sizeof(emu_tests_span_pixels))
+            {
+                printf("  bitmap %u: %ux%u is too large\n", file_id, bitmap.width, bitmap.height);
+                nb_span_failed_cases++;
+                nb_span_cases++;
+                continue;
+            }
+            bitstream_bitmap_init(&bitstream, &bitmap, file_address + sizeof(bitmap), TRUE);
+            while (pixel_index < nb_pixels)
+            {
+                uint16_t max_span_length = bitmap.width - (pixel_index % bitmap.width);
+                uint16_t span_length = bitstream_bitmap_span_read(&bitstream, &emu_tests_span_pixels[pixel_index], max_span_length);
+    
+                if ((span_length == 0) || (span_length > max_span_length))
+                {
+                    break;
+                }
+                memset((void*)&emu_tests_span_pixels[pixel_index], emu_tests_span_pixels[pixel_index], span_length);
+                pixel_index += span_length;
+            }
+            bitstream_bitmap_close(&bitstream);
+            bitstream_bitmap_init(&bitstream, &bitmap, file_address + sizeof(bitmap), TRUE);
+            for (uint32_t i = 0; i < nb_pixels; i++)
+            {
+                emu_tests_single_pixels[i] = (uint8_t)bitstream_bitmap_read(&bitstream, 1);
+            }
+            bitstream_bitmap_close(&bitstream);
+            if ((pixel_index != nb_pixels) || (memcmp((void*)emu_tests_span_pixels, (void*)emu_tests_single_pixels, nb_pixels) != 0))
+            {
+                printf("  bitmap %u: spans differ from single pixels\n", file_id);
+                nb_span_failed_cases++;
+            }
+            nb_span_cases++;
+        }
+    
+        /* Bitmap draws, clipped or not */
+        for (uint16_t position_index = 0; position_index < sizeof(position_list)/sizeof(position_list[0]); position_index++)
+        {
+            int16_t x = position_list[position_index][0];
+            int16_t y = position_list[position_index][1];
+            char case_name[64];
+    
+            emu_tests_clear_frame_buffers();
+            sh1122_display_bitmap_from_flash(&plat_oled_descriptor, x, y, file_id, TRUE);
+            emu_tests_reference_display_bitmap(x, y, file_id);
+            snprintf(case_name, sizeof(case_name), "bitmap %u at %d,%d", file_id, x, y);
+            if (emu_tests_compare_frame_buffers(case_name) != RETURN_OK)
+            {
+                nb_failed_cases++;
+            }
+            nb_cases++;
+        }
+    }
+    emu_tests_report("RLE span decoding", nb_span_cases, nb_span_failed_cases);
+    emu_tests_report("bitmap draws", nb_cases, nb_failed_cases);
+}
+
+/*! \fn     emu_tests_list_fetch_item(uint16_t item_index, cust_char_t* string, uint16_t max_length)
+*   \brief  Generate list test item strings, some being wider than the display
+*   \param  item_index  Item index
+*   \param  string      Where to store the string
+*   \param  max_length  Max number of characters, without terminating 0
+*/
+static void emu_tests_list_fetch_item(uint16_t item_index, cust_char_t* string, uint16_t max_length)
+{
+    char item_string[64];
+    uint16_t i;
+    
+    if ((item_index % 3) == 0)
+    {
+        snprintf(item_string, sizeof(item_string), "Item %u rev %u WWWWWWWWWWWWWWWWWWWWWWWWWWWWWWWWWWWW", item_index, emu_tests_list_item_revision);
+    }
+    else
+    {
+        snprintf(item_string, sizeof(item_string), "Item %u rev %u", item_index, emu_tests_list_item_revision);
+    }
+    for (i = 0; (i < max_length) && (item_string[i] != 0); i++)
+    {
+        string[i] = item_string[i];
+    }
+    string[i] = 0;
+}
+
+/*! \fn     emu_tests_list_widget(void)
+*   \brief  Lists only redrawing what changed must match lists redrawn from scratch after each wheel action
+*/
+static void emu_tests_list_widget(void)
+{
+    const int16_t move_list[] = {1, 1, 1, 1, 1, 1, 1, -1, -1, 3, -5, 7, -7, 1, -2, 10, -30, 1, 6, -6, 2, 0, -1, 4};
+    const uint8_t nb_rows_list[] = {1, 2, 4};
+    uint8_t row_height = plat_oled_descriptor.current_font_header.height;   // Glyphs stay inside the rows
+    uint32_t nb_failed_cases = 0;
+    uint32_t nb_cases = 0;
+    gui_list_t retained_list;
+    gui_list_t full_list;
+    
+    /* Lists without rows or not fitting in the display are rejected and empty */
+    if ((gui_list_init(&retained_list, 0, row_height, 0, EMU_TESTS_NB_LIST_ITEMS, emu_tests_list_fetch_item) != RETURN_NOK) || (retained_list.nb_items != 0))
+    {
+        printf("  list without rows accepted\n");
+        nb_failed_cases++;
+    }
+    gui_list_invalidate_item(&retained_list, 0);
+    gui_list_move_selection(&retained_list, 1);
+    gui_list_render(&plat_oled_descriptor, &retained_list);
+    if ((gui_list_init(&retained_list, SH1122_OLED_HEIGHT - 2*row_height + 1, row_height, 2, EMU_TESTS_NB_LIST_ITEMS, emu_tests_list_fetch_item) != RETURN_NOK) || (retained_list.nb_items != 0))
+    {
+        printf("  list below the display accepted\n");
+        nb_failed_cases++;
+    }
+    nb_cases += 2;
+    
+    for (uint16_t nb_rows_index = 0; nb_rows_index < sizeof(nb_rows_list)/sizeof(nb_rows_list[0]); nb_rows_index++)
+    {
+        emu_tests_clear_frame_buffers();
+        emu_tests_list_item_revision = 0;
+        gui_list_init(&retained_list, 3, row_height, nb_rows_list[nb_rows_index], EMU_TESTS_NB_LIST_ITEMS, emu_tests_list_fetch_item);
+        gui_list_init(&full_list, 3, row_height, nb_rows_list[nb_rows_index], EMU_TESTS_NB_LIST_ITEMS, emu_tests_list_fetch_item);
+        for (uint16_t move_index = 0; move_index <= sizeof(move_list)/sizeof(move_list[0]); move_index++)
+        {
+            char case_name[64];
+    
+            /* First render, then wheel actions, an item changing halfway */
+            if (move_index != 0)
+            {
+                gui_list_move_selection(&retained_list, move_list[move_index-1]);
+                gui_list_move_selection(&full_list, move_list[move_index-1]);
+            }
+            if (move_index == sizeof(move_list)/sizeof(move_list[0])/2)
+            {
+                emu_tests_list_item_revision++;
+                for (uint16_t i = 0; i < EMU_TESTS_NB_LIST_ITEMS; i++)
+                {
+                    gui_list_invalidate_item(&retained_list, i);
+                }
+            }
+    
+            /* Retained list in the frame buffer, full redraw in the reference one */
+            gui_list_render(&plat_oled_descriptor, &retained_list);
+            memset((void*)emu_tests_reference_frame_buffer, 0x00, sizeof(emu_tests_reference_frame_buffer));
+            sh1122_set_draw_buffer(&plat_oled_descriptor, &emu_tests_reference_frame_buffer[0][0], 0, SH1122_OLED_HEIGHT);
+            gui_list_invalidate(&full_list);
+            gui_list_render(&plat_oled_descriptor, &full_list);
+            sh1122_set_draw_buffer(&plat_oled_descriptor, &plat_oled_descriptor.frame_buffer[0][0], 0, SH1122_OLED_HEIGHT);
+    
+            snprintf(case_name, sizeof(case_name), "%u rows, wheel action %u", nb_rows_list[nb_rows_index], move_index);
+            if ((gui_list_get_selected_item(&retained_list) != gui_list_get_selected_item(&full_list)) || (emu_tests_compare_frame_buffers(case_name) != RETURN_OK))
+            {
+                nb_failed_cases++;
+            }
+            nb_cases++;
+        }
+    }
+    emu_tests_report("list widget rendering", nb_cases, nb_failed_cases);
+}
+
+/*! \fn     emu_tests_page_flip(void)
+*   \brief  Frames flushed to the hidden page must be displayed once sent, the display then only running its transitions routine
+*/
+static void emu_tests_page_flip(void)
+{
+    uint8_t displayed_pixels[SH1122_OLED_HEIGHT][SH1122_OLED_WIDTH];
+    uint32_t nb_failed_cases = 0;
+    uint32_t nb_cases = 0;
+    
+    sh1122_set_frame_buffer_page_flip(&plat_oled_descriptor, TRUE);
+    for (uint16_t i = 0; i < sizeof(emu_tests_strings)/sizeof(emu_tests_strings[0]); i++)
+    {
+        uint8_t start_line = plat_oled_descriptor.display_start_line;
+        char case_name[64];
+    
+        /* New frame flushed, display left idle */
+        emu_tests_clear_frame_buffers();
+        sh1122_put_string_xy(&plat_oled_descriptor, 0, 20, OLED_ALIGN_LEFT, emu_tests_strings[i], TRUE);
+        sh1122_flush_frame_buffer(&plat_oled_descriptor);
+        sh1122_transitions_routine(&plat_oled_descriptor);
+    
+        /* Displayed page must be the frame buffer */
+        emu_sh1122_get_displayed_pixels(displayed_pixels);
+        for (uint16_t y = 0; y < SH1122_OLED_HEIGHT; y++)
+        {
+            for (uint16_t x = 0; x < SH1122_OLED_WIDTH/2; x++)
+            {
+                emu_tests_reference_frame_buffer[y][x] = (uint8_t)(displayed_pixels[y][2*x] << 4) | displayed_pixels[y][2*x+1];
+            }
+        }
+        snprintf(case_name, sizeof(case_name), "string %u: displayed", i);
+        if ((plat_oled_descriptor.display_start_line == start_line) || (plat_oled_descriptor.frame_buffer_flush_in_progress != FALSE))
+        {
+            printf("  string %u: flush not terminated by the transitions routine\n", i);
+            nb_failed_cases++;
+        }
+        else if (emu_tests_compare_frame_buffers(case_name) != RETURN_OK)
+        {
+            nb_failed_cases++;
+        }
+        nb_cases++;
+    }
+    sh1122_set_frame_buffer_page_flip(&plat_oled_descriptor, FALSE);
+    emu_tests_clear_frame_buffers();
+    emu_tests_report("page flips at flush completion", nb_cases, nb_failed_cases);
+}
+
+/*! \fn     emu_tests_flush_stats(void)
+*   \brief  Flush stats must be those of the last frame buffer flush, left running display fills not counting as flushes
+*/
+static void emu_tests_flush_stats(void)
+{
+    uint32_t nb_failed_cases = 0;
+    uint32_t flush_time_ms;
+    
+    /* Full rows flush, completion seen by the transitions routine */
+    emu_tests_clear_frame_buffers();
+    sh1122_flush_frame_buffer(&plat_oled_descriptor);
+    sh1122_draw_rectangle(&plat_oled_descriptor, 0, 10, SH1122_OLED_WIDTH, 10, 0x0F, TRUE);
+    sh1122_flush_frame_buffer(&plat_oled_descriptor);
+    sh1122_transitions_routine(&plat_oled_descriptor);
+    flush_time_ms = plat_oled_descriptor.frame_buffer_last_flush_time_ms;
+    if ((plat_oled_descriptor.frame_buffer_flush_in_progress != FALSE) || (plat_oled_descriptor.frame_buffer_last_flush_nb_bytes != 10*sizeof(plat_oled_descriptor.frame_buffer[0])))
+    {
+        printf("  flush: %u bytes, expected %u\n", plat_oled_descriptor.frame_buffer_last_flush_nb_bytes, (uint32_t)(10*sizeof(plat_oled_descriptor.frame_buffer[0])));
+        nb_failed_cases++;
+    }
+    
+    /* Screen fill left running then terminated */
+    sh1122_fill_screen(&plat_oled_descriptor, 0);
+    sh1122_transitions_routine(&plat_oled_descriptor);
+    if ((plat_oled_descriptor.display_fill_in_progress != FALSE) || (plat_oled_descriptor.frame_buffer_last_flush_nb_bytes != 10*sizeof(plat_oled_descriptor.frame_buffer[0])) || (plat_oled_descriptor.frame_buffer_last_flush_time_ms != flush_time_ms))
+    {
+        printf("  screen fill: flush stats changed to %u bytes, %u ms\n", plat_oled_descriptor.frame_buffer_last_flush_nb_bytes, plat_oled_descriptor.frame_buffer_last_flush_time_ms);
+        nb_failed_cases++;
+    }
+    
+    emu_tests_clear_frame_buffers();
+    sh1122_flush_frame_buffer(&plat_oled_descriptor);
+    sh1122_check_for_flush_and_terminate(&plat_oled_descriptor);
+    emu_tests_report("flush stats", 2, nb_failed_cases);
+}
+
+#ifdef OLED_BACKGROUND_LAYER
+/*! \fn     emu_tests_alpha_blending(void)
+*   \brief  Alpha blending kernels, strings and bitmaps drawn over a background layer must match the reference blending formula
+*/
+static void emu_tests_alpha_blending(void)
+{
+    const int16_t string_position_list[][2] = {{0, 0}, {1, 9}, {6, 20}, {33, 40}, {-5, 46}};
+    uint32_t src_buffer[SH1122_OLED_WIDTH/8 + 2];
+    uint32_t row_buffer[SH1122_OLED_WIDTH/8 + 2];
+    uint8_t reference_row[SH1122_OLED_WIDTH/2 + 4];
+    uint32_t nb_kernel_failed_cases = 0;
+    uint32_t nb_kernel_cases = 0;
+    uint32_t nb_failed_cases = 0;
+    uint32_t nb_cases = 0;
+    cust_char_t* string_pt;
+    
+    /* Kernels: all destination and coverage pairs, at each word alignment and starting x parity */
+    for (uint16_t src_offset = 0; src_offset < 4; src_offset++)
+    {
+        for (uint16_t row_offset = 0; row_offset < 4; row_offset++)
+        {
+            for (int16_t x = 0; x < 2; x++)
+            {
+                uint8_t* src_pt = (uint8_t*)src_buffer + src_offset;
+                uint8_t* row_pt = (uint8_t*)row_buffer + row_offset;
+    
+                memset((void*)row_buffer, 0x00, sizeof(row_buffer));
+                for (uint16_t i = 0; i < SH1122_OLED_WIDTH; i++)
+                {
+                    uint8_t shift = (((x+i) & 0x01) != 0) ? 0 : 4;
+    
+                    /* Destination pixel i/16, coverage i%16 */
+                    src_pt[i/2] = ((i & 0x01) != 0) ? ((src_pt[i/2] & 0xF0) | (i & 0x0F)) : (uint8_t)((i & 0x0F) << 4);
+                    if ((x+i) < SH1122_OLED_WIDTH)
+                    {
+                        row_pt[(x+i)/2] = (row_pt[(x+i)/2] & ~(0x0F << shift)) | (uint8_t)((i >> 4) << shift);
+                    }
+                }
+                memcpy((void*)reference_row, (void*)row_pt, sizeof(reference_row));
+                for (uint16_t i = 0; (x+i) < SH1122_OLED_WIDTH; i++)
+                {
+                    uint8_t shift = (((x+i) & 0x01) != 0) ? 0 : 4;
+                    uint8_t pixel = emu_tests_reference_alpha_blend(i >> 4, i & 0x0F);
+                    reference_row[(x+i)/2] = (reference_row[(x+i)/2] & ~(0x0F << shift)) | (uint8_t)(pixel << shift);
+                }
+    
+                sh1122_blit_row(row_pt, x, src_pt, SH1122_OLED_WIDTH, OLED_BLIT_ALPHA);
+                if (memcmp((void*)reference_row, (void*)row_pt, sizeof(reference_row)) != 0)
+                {
+                    if (nb_kernel_failed_cases == 0)
+                    {
+                        printf("  x %d, source offset %u row offset %u: rows differ\n", x, src_offset, row_offset);
+                    }
+                    nb_kernel_failed_cases++;
+                }
+                nb_kernel_cases++;
+            }
+        }
+    }
+    emu_tests_report("alpha blending kernels", nb_kernel_cases, nb_kernel_failed_cases);
+    
+    /* Random background in the middle rows, black elsewhere */
+    for (uint16_t i = 0; i < sizeof(emu_tests_background_layer); i++)
+    {
+        ((uint8_t*)emu_tests_background_layer)[i] = (uint8_t)emu_tests_random();
+    }
+    sh1122_set_background_layer(&plat_oled_descriptor, &emu_tests_background_layer[0][0], EMU_TESTS_BACKGROUND_Y, EMU_TESTS_BACKGROUND_NB_ROWS);
+    
+    /* Strings crossing the layer borders, foreground then replaced by the background over an odd x area */
+    for (uint16_t string_index = 0; emu_tests_get_string(string_index, &string_pt) == RETURN_OK; string_index++)
+    {
+        for (uint16_t position_index = 0; position_index < sizeof(string_position_list)/sizeof(string_position_list[0]); position_index++)
+        {
+            int16_t x = string_position_list[position_index][0];
+            int16_t y = string_position_list[position_index][1];
+            char case_name[64];
+    
+            emu_tests_clear_frame_buffers();
+            memcpy((void*)emu_tests_reference_frame_buffer[EMU_TESTS_BACKGROUND_Y], (void*)emu_tests_background_layer, sizeof(emu_tests_background_layer));
+            sh1122_restore_background(&plat_oled_descriptor, 0, 0, SH1122_OLED_WIDTH, SH1122_OLED_HEIGHT);
+            sh1122_put_string_xy(&plat_oled_descriptor, x, y, OLED_ALIGN_LEFT, string_pt, TRUE);
+            emu_tests_reference_put_string_xy(x, y, string_pt);
+            snprintf(case_name, sizeof(case_name), "string %u at %d,%d", string_index, x, y);
+            if (emu_tests_compare_frame_buffers(case_name) != RETURN_OK)
+            {
+                nb_failed_cases++;
+            }
+            nb_cases++;
+    
+            for (int16_t yy = y; yy < (y + 8); yy++)
+            {
+                for (int16_t xx = x + 3; xx < (x + 3 + 45); xx++)
+                {
+                    int16_t layer_row = yy - EMU_TESTS_BACKGROUND_Y;
+                    uint8_t shift = ((xx & 0x01) != 0) ? 0 : 4;
+                    uint8_t pixel = 0;
+    
+                    if ((xx < 0) || (xx >= SH1122_OLED_WIDTH) || (yy < 0) || (yy >= SH1122_OLED_HEIGHT))
+                    {
+                        continue;
+                    }
+                    if ((layer_row >= 0) && (layer_row < EMU_TESTS_BACKGROUND_NB_ROWS))
+                    {
+                        pixel = (emu_tests_background_layer[layer_row][xx/2] >> shift) & 0x0F;
+                    }
+                    emu_tests_reference_frame_buffer[yy][xx/2] = (emu_tests_reference_frame_buffer[yy][xx/2] & ~(0x0F << shift)) | (uint8_t)(pixel << shift);
+                }
+            }
+            sh1122_restore_background(&plat_oled_descriptor, x + 3, y, 45, 8);
+            snprintf(case_name, sizeof(case_name), "string %u at %d,%d, background restored", string_index, x, y);
+            if (emu_tests_compare_frame_buffers(case_name) != RETURN_OK)
+            {
+                nb_failed_cases++;
+            }
+            nb_cases++;
+        }
+    }
+    
+    /* Bitmaps, whose pixels use all gray levels */
+    for (uint32_t file_id = 0; file_id < custom_fs_flash_header.bitmap_file_count; file_id++)
+    {
+        char case_name[64];
+    
+        emu_tests_clear_frame_buffers();
+        memcpy((void*)emu_tests_reference_frame_buffer[EMU_TESTS_BACKGROUND_Y], (void*)emu_tests_background_layer, sizeof(emu_tests_background_layer));
+        sh1122_restore_background(&plat_oled_descriptor, 0, 0, SH1122_OLED_WIDTH, SH1122_OLED_HEIGHT);
+        sh1122_display_bitmap_from_flash(&plat_oled_descriptor, 3, 10, file_id, TRUE);
+        emu_tests_reference_display_bitmap(3, 10, file_id);
+        snprintf(case_name, sizeof(case_name), "bitmap %u", file_id);
+        if (emu_tests_compare_frame_buffers(case_name) != RETURN_OK)
+        {
+            nb_failed_cases++;
+        }
+        nb_cases++;
+    }
+    sh1122_set_background_layer(&plat_oled_descriptor, 0, 0, 0);
+    emu_tests_report("alpha blended string and bitmap draws", nb_cases, nb_failed_cases);
+}
+#endif
+
+#ifdef CUSTOM_FS_FLASH_CACHE
+/*! \fn     emu_tests_flash_cache(void)
+*   \brief  Reads through the flash cache must match direct flash reads, only reads inside a single line using the cache
+*/
+static void emu_tests_flash_cache(void)
+{
+    uint32_t nb_cache_accesses = custom_fs_flash_cache_hits + custom_fs_flash_cache_misses;
+    uint32_t nb_expected_cache_accesses = 0;
+    uint8_t cached_data[EMU_TESTS_MAX_FLASH_READ + 4];
+    uint8_t flash_data[EMU_TESTS_MAX_FLASH_READ];
+    custom_fs_address_t window_address = 0;
+    uint32_t nb_failed_cases = 0;
+    uint32_t nb_cases = 0;
+    
+    custom_fs_flash_cache_clear();
+    for (uint16_t i = 0; i < 4000; i++)
+    {
+        custom_fs_address_t address;
+        uint32_t size = 1 + emu_tests_random() % EMU_TESTS_MAX_FLASH_READ;
+    
+        /* Half of the reads close to the previous ones, so lines get reused */
+        if ((i % 64) == 0)
+        {
+            window_address = ((uint32_t)emu_tests_random() << 8) % (custom_fs_flash_header.total_size - 2*EMU_TESTS_MAX_FLASH_READ);
+        }
+        if ((emu_tests_random() & 0x01) != 0)
+        {
+            address = window_address + emu_tests_random() % EMU_TESTS_MAX_FLASH_READ;
+        }
+        else
+        {
+            address = ((uint32_t)emu_tests_random() << 8 | (emu_tests_random() & 0xFF)) % (custom_fs_flash_header.total_size - EMU_TESTS_MAX_FLASH_READ);
+        }
+        if (((address & (CUSTOM_FS_FLASH_CACHE_LINE_SIZE - 1)) + size) <= CUSTOM_FS_FLASH_CACHE_LINE_SIZE)
+        {
+            nb_expected_cache_accesses++;
+        }
+    
+        /* Guard bytes after the requested size must be left untouched */
+        memset((void*)cached_data, 0xA5, sizeof(cached_data));
+        custom_fs_read_from_flash(cached_data, address, size);
+        dataflash_read_data_array(&dataflash_descriptor, address, flash_data, size);
+        if ((memcmp((void*)cached_data, (void*)flash_data, size) != 0) || (cached_data[size] != 0xA5))
+        {
+            if (nb_failed_cases == 0)
+            {
+                printf("  %u bytes at 0x%08x differ from the flash\n", size, address);
+            }
+            nb_failed_cases++;
+        }
+        nb_cases++;
+    }
+    
+    /* Reads crossing a line bypass the cache, lines got reused */
+    nb_cache_accesses = custom_fs_flash_cache_hits + custom_fs_flash_cache_misses - nb_cache_accesses;
+    if ((nb_cache_accesses != nb_expected_cache_accesses) || (custom_fs_flash_cache_hits == 0))
+    {
+        printf("  %u cache accesses, expected %u, %u hits\n", nb_cache_accesses, nb_expected_cache_accesses, custom_fs_flash_cache_hits);
+        nb_failed_cases++;
+    }
+    emu_tests_report("flash cache reads", nb_cases, nb_failed_cases);
+}
+#endif
+
+#ifdef OLED_STRING_SPRITE_CACHE
+/*! \fn     emu_tests_string_sprites(void)
+*   \brief  Language strings drawn from their sprites must match sh1122_put_string_xy() draws, byte for byte
+*/
+static void emu_tests_string_sprites(void)
+{
+    const oled_align_te justify_list[] = {OLED_ALIGN_LEFT, OLED_ALIGN_CENTER, OLED_ALIGN_RIGHT};
+    const int16_t x_list[] = {0, 1, 2, 7, 100, 255};
+    uint32_t nb_failed_cases = 0;
+    uint32_t nb_cases = 0;
+    
+    plat_oled_descriptor.string_sprite_misses = 0;
+    plat_oled_descriptor.string_sprite_hits = 0;
+    for (uint16_t language = 0; language < custom_fs_get_number_of_languages(); language++)
+    {
+        custom_fs_set_current_language(language);
+        sh1122_refresh_used_font(&plat_oled_descriptor);
+    
+        for (uint32_t string_id = 0; string_id < EMU_TESTS_MAX_STRING_ID; string_id++)
+        {
+            cust_char_t* string_pt;
+    
+            if (custom_fs_get_string_from_file(string_id, &string_pt) != RETURN_OK)
+            {
+                break;
+            }
+    
+            /* Sprite rendered at the first draw, then reused */
+            for (uint16_t justify_index = 0; justify_index < sizeof(justify_list)/sizeof(justify_list[0]); justify_index++)
+            {
+                for (uint16_t x_index = 0; x_index < sizeof(x_list)/sizeof(x_list[0]); x_index++)
+                {
+                    int16_t x = (justify_list[justify_index] == OLED_ALIGN_RIGHT) ? SH1122_OLED_WIDTH - x_list[x_index] : x_list[x_index];
+                    uint16_t nb_cached_glyphs, nb_glyphs;
+                    int16_t cached_text_x;
+                    char case_name[64];
+    
+                    emu_tests_clear_frame_buffers();
+                    nb_cached_glyphs = sh1122_put_cached_string_xy(&plat_oled_descriptor, x, 20, justify_list[justify_index], string_id, TRUE);
+                    cached_text_x = plat_oled_descriptor.cur_text_x;
+                    memcpy((void*)emu_tests_reference_frame_buffer, (void*)plat_oled_descriptor.frame_buffer, sizeof(emu_tests_reference_frame_buffer));
+                    sh1122_clear_frame_buffer(&plat_oled_descriptor);
+                    sh1122_check_for_fill_and_terminate(&plat_oled_descriptor);
+                    custom_fs_get_string_from_file(string_id, &string_pt);
+                    nb_glyphs = sh1122_put_string_xy(&plat_oled_descriptor, x, 20, justify_list[justify_index], string_pt, TRUE);
+    
+                    snprintf(case_name, sizeof(case_name), "language %u string %u justify %u x %d", language, string_id, justify_list[justify_index], x);
+                    if ((nb_cached_glyphs != nb_glyphs) || (cached_text_x != plat_oled_descriptor.cur_text_x))
+                    {
+                        printf("  %s: %u glyphs, text x %d, expected %u glyphs, text x %d\n", case_name, nb_cached_glyphs, cached_text_x, nb_glyphs, plat_oled_descriptor.cur_text_x);
+                        nb_failed_cases++;
+                    }
+                    else if (emu_tests_compare_frame_buffers(case_name) != RETURN_OK)
+                    {
+                        nb_failed_cases++;
+                    }
+                    nb_cases++;
+                }
+            }
+        }
+    }
+    
+    /* Sprites must have been drawn */
+    if ((plat_oled_descriptor.string_sprite_misses == 0) || (plat_oled_descriptor.string_sprite_hits == 0))
+    {
+        printf("  %u sprite misses, %u sprite hits\n", plat_oled_descriptor.string_sprite_misses, plat_oled_descriptor.string_sprite_hits);
+        nb_failed_cases++;
+    }
+    emu_tests_report("string sprite draws", nb_cases, nb_failed_cases);
+    custom_fs_set_current_language(0);
+    sh1122_refresh_used_font(&plat_oled_descriptor);
+}
+#endif
+
+#ifdef OLED_GLYPH_BITMAP_ARENA
+/*! \fn     emu_tests_glyph_arena(void)
+*   \brief  Strings drawn from the decoded glyphs arena must match the reference, arena being cold, warm or evicting
+*/
+static void emu_tests_glyph_arena(void)
+{
+    uint32_t nb_failed_cases = 0;
+    uint32_t nb_cases = 0;
+    
+    plat_oled_descriptor.glyph_arena_misses = 0;
+    plat_oled_descriptor.glyph_arena_hits = 0;
+    for (uint16_t language = 0; language < custom_fs_get_number_of_languages(); language++)
+    {
+        custom_fs_set_current_language(language);
+        sh1122_refresh_used_font(&plat_oled_descriptor);
+    
+        /* First pass with a cold arena, second one with the glyphs of the previous strings */
+        for (uint16_t pass = 0; pass < 2; pass++)
+        {
+            cust_char_t* string_pt;
+    
+            for (uint16_t string_index = 0; emu_tests_get_string(string_index, &string_pt) == RETURN_OK; string_index++)
+            {
+                char case_name[64];
+    
+                /* Even and odd starting x */
+                for (int16_t x = 0; x < 2; x++)
+                {
+                    if (pass == 0)
+                    {
+                        sh1122_invalidate_glyph_cache(&plat_oled_descriptor);
+                    }
+                    emu_tests_clear_frame_buffers();
+                    sh1122_put_string_xy(&plat_oled_descriptor, x, 10, OLED_ALIGN_LEFT, string_pt, TRUE);
+                    emu_tests_reference_put_string_xy(x, 10, string_pt);
+                    snprintf(case_name, sizeof(case_name), "language %u string %u pass %u x %d", language, string_index, pass, x);
+                    if (emu_tests_compare_frame_buffers(case_name) != RETURN_OK)
+                    {
+                        nb_failed_cases++;
+                    }
+                    nb_cases++;
+                }
+            }
+        }
+    }
+    
+    /* Both arena paths must have been taken */
+    if ((plat_oled_descriptor.glyph_arena_misses == 0) || (plat_oled_descriptor.glyph_arena_hits == 0))
+    {
+        printf("  %u arena misses, %u arena hits\n", plat_oled_descriptor.glyph_arena_misses, plat_oled_descriptor.glyph_arena_hits);
+        nb_failed_cases++;
+    }
+    emu_tests_report("glyph arena string draws", nb_cases, nb_failed_cases);
+    custom_fs_set_current_language(0);
+    sh1122_refresh_used_font(&plat_oled_descriptor);
+}
+#endif
+
+#ifdef OLED_BANDED_RENDERING
+/*! \fn     emu_tests_banded_rendering(void)
+*   \brief  Draw lists rendered band by band must match their frame buffer rendering, bands being sent to the display or not
+*/
+static void emu_tests_banded_rendering(void)
+{
+    uint8_t displayed_pixels[SH1122_OLED_HEIGHT][SH1122_OLED_WIDTH];
+    uint32_t nb_failed_cases = 0;
+    uint32_t nb_cases = 0;
+    
+    /* Draw list similar to the debug menu, moved so items cross band boundaries at different rows */
+    for (int16_t offset = 0; offset < OLED_BAND_HEIGHT; offset++)
+    {
+        char case_name[64];
+    
+        sh1122_draw_list_clear(&plat_oled_descriptor);
+        sh1122_draw_list_add_bitmap(&plat_oled_descriptor, offset, offset, 0);
+        sh1122_draw_list_add_string(&plat_oled_descriptor, 0, offset, OLED_ALIGN_CENTER, u"Debug Menu");
+        sh1122_draw_list_add_string(&plat_oled_descriptor, 10 + offset, 14 + offset, OLED_ALIGN_LEFT, u"Time / Accelerometer / Battery");
+        sh1122_draw_list_add_string(&plat_oled_descriptor, 10 + offset, 24 + offset, OLED_ALIGN_LEFT, u"Language Switch Test");
+        sh1122_draw_list_add_string(&plat_oled_descriptor, 10 + offset, 34 + offset, OLED_ALIGN_LEFT, u"Smartcard Debug");
+        sh1122_draw_list_add_string(&plat_oled_descriptor, 10 + offset, 44 + offset, OLED_ALIGN_LEFT, u"Animation Test");
+        sh1122_draw_list_add_rectangle(&plat_oled_descriptor, 1 + offset, 17 + offset, 5, 3, 0x0F);
+    
+        /* Reference: whole list replayed in the frame buffer */
+        emu_tests_clear_frame_buffers();
+        sh1122_draw_list_replay(&plat_oled_descriptor);
+    
+        /* Each band replayed on its own */
+        for (uint16_t band = 0; band < SH1122_OLED_HEIGHT/OLED_BAND_HEIGHT; band++)
+        {
+            memset((void*)plat_oled_descriptor.band_buffers[0], 0x00, sizeof(plat_oled_descriptor.band_buffers[0]));
+            sh1122_set_draw_buffer(&plat_oled_descriptor, &plat_oled_descriptor.band_buffers[0][0][0], band*OLED_BAND_HEIGHT, OLED_BAND_HEIGHT);
+            sh1122_draw_list_replay(&plat_oled_descriptor);
+            if (memcmp((void*)plat_oled_descriptor.band_buffers[0], (void*)plat_oled_descriptor.frame_buffer[band*OLED_BAND_HEIGHT], sizeof(plat_oled_descriptor.band_buffers[0])) != 0)
+            {
+                printf("  offset %d: band %u differs from the frame buffer rows\n", offset, band);
+                nb_failed_cases++;
+            }
+            nb_cases++;
+        }
+        sh1122_set_draw_buffer(&plat_oled_descriptor, &plat_oled_descriptor.frame_buffer[0][0], 0, SH1122_OLED_HEIGHT);
+    
+        /* Bands sent to the display */
+        sh1122_render_draw_list(&plat_oled_descriptor);
+        emu_sh1122_get_displayed_pixels(displayed_pixels);
+        for (uint16_t y = 0; y < SH1122_OLED_HEIGHT; y++)
+        {
+            for (uint16_t x = 0; x < SH1122_OLED_WIDTH/2; x++)
+            {
+                emu_tests_reference_frame_buffer[y][x] = (uint8_t)(displayed_pixels[y][2*x] << 4) | displayed_pixels[y][2*x+1];
+            }
+        }
+        snprintf(case_name, sizeof(case_name), "offset %d: displayed", offset);
+        if (emu_tests_compare_frame_buffers(case_name) != RETURN_OK)
+        {
+            nb_failed_cases++;
+        }
+        nb_cases++;
+    }
+    sh1122_draw_list_clear(&plat_oled_descriptor);
+    emu_tests_report("banded draw list rendering", nb_cases, nb_failed_cases);
+}
+#endif
+
+#ifdef OLED_MARQUEE
+/*! \fn     emu_tests_check_marquee(int16_t expected_offset, uint32_t* nb_cases_pt, uint32_t* nb_failed_cases_pt)
+*   \brief  Compare the frame buffer with the marquee string drawn at the left of its expected offset
+*   \param  expected_offset     Expected marquee offset
+*   \param  nb_cases_pt         Pointer to the number of cases, incremented
+*   \param  nb_failed_cases_pt  Pointer to the number of failed cases, incremented on failure
+*/
+static void emu_tests_check_marquee(int16_t expected_offset, uint32_t* nb_cases_pt, uint32_t* nb_failed_cases_pt)
+{
+    int16_t max_text_x = plat_oled_descriptor.max_text_x;
+    char case_name[64];
+    
+    /* Reference: whole string drawn directly, pixels outside of the display dropped */
+    memset((void*)emu_tests_reference_frame_buffer, 0x00, sizeof(emu_tests_reference_frame_buffer));
+    plat_oled_descriptor.max_text_x = OLED_MARQUEE_MAX_WIDTH;
+    emu_tests_reference_put_string_xy(-expected_offset, EMU_TESTS_MARQUEE_Y, emu_tests_marquee_string);
+    plat_oled_descriptor.max_text_x = max_text_x;
+    
+    snprintf(case_name, sizeof(case_name), "offset %d", expected_offset);
+    if (emu_tests_scrolled_marquee.offset_transition.current_value != expected_offset)
+    {
+        printf("  offset %d, expected %d\n", emu_tests_scrolled_marquee.offset_transition.current_value, expected_offset);
+        (*nb_failed_cases_pt)++;
+    }
+    else if (emu_tests_compare_frame_buffers(case_name) != RETURN_OK)
+    {
+        (*nb_failed_cases_pt)++;
+    }
+    (*nb_cases_pt)++;
+}
+
+/*! \fn     emu_tests_marquee(void)
+*   \brief  Marquee windows copied from the strip must match the string drawn directly, scrolling and pausing at both ends
+*/
+static void emu_tests_marquee(void)
+{
+    uint8_t displayed_pixels[SH1122_OLED_HEIGHT][SH1122_OLED_WIDTH];
+    uint16_t width = sh1122_get_string_width(&plat_oled_descriptor, emu_tests_marquee_string);
+    int16_t max_offset = width - SH1122_OLED_WIDTH;
+    uint32_t nb_failed_cases = 0;
+    uint32_t nb_cases = 0;
+    
+    if ((width <= SH1122_OLED_WIDTH) || (width > OLED_MARQUEE_MAX_WIDTH))
+    {
+        printf("  marquee string width %u doesn't need a marquee or doesn't fit the strip\n", width);
+        emu_tests_report("marquee scrolling", 0, 0);
+        return;
+    }
+    
+    /* String start, pausing before scrolling */
+    emu_tests_clear_frame_buffers();
+    sh1122_start_marquee(&plat_oled_descriptor, &emu_tests_scrolled_marquee, EMU_TESTS_MARQUEE_Y, emu_tests_marquee_string, EMU_TESTS_MARQUEE_STEP_MS);
+    emu_tests_check_marquee(0, &nb_cases, &nb_failed_cases);
+    emu_hw_advance_systick(OLED_MARQUEE_PAUSE_MS - EMU_TESTS_MARQUEE_STEP_MS);
+    sh1122_transitions_routine(&plat_oled_descriptor);
+    emu_tests_check_marquee(0, &nb_cases, &nb_failed_cases);
+    
+    /* One pixel per step up to the string end */
+    for (int16_t offset = 1; offset <= max_offset; offset++)
+    {
+        emu_hw_advance_systick(EMU_TESTS_MARQUEE_STEP_MS);
+        sh1122_transitions_routine(&plat_oled_descriptor);
+        emu_tests_check_marquee(offset, &nb_cases, &nb_failed_cases);
+    }
+    
+    /* String end displayed during the pause, then back to the string start, pausing there too */
+    emu_hw_advance_systick(OLED_MARQUEE_PAUSE_MS - EMU_TESTS_MARQUEE_STEP_MS);
+    sh1122_transitions_routine(&plat_oled_descriptor);
+    emu_tests_check_marquee(max_offset, &nb_cases, &nb_failed_cases);
+    emu_hw_advance_systick(EMU_TESTS_MARQUEE_STEP_MS);
+    sh1122_transitions_routine(&plat_oled_descriptor);
+    emu_tests_check_marquee(0, &nb_cases, &nb_failed_cases);
+    emu_hw_advance_systick(OLED_MARQUEE_PAUSE_MS - EMU_TESTS_MARQUEE_STEP_MS);
+    sh1122_transitions_routine(&plat_oled_descriptor);
+    emu_tests_check_marquee(0, &nb_cases, &nb_failed_cases);
+    emu_hw_advance_systick(EMU_TESTS_MARQUEE_STEP_MS);
+    sh1122_transitions_routine(&plat_oled_descriptor);
+    emu_tests_check_marquee(1, &nb_cases, &nb_failed_cases);
+    
+    /* Marquee area flushed to the display */
+    emu_sh1122_get_displayed_pixels(displayed_pixels);
+    for (uint16_t y = 0; y < SH1122_OLED_HEIGHT; y++)
+    {
+        for (uint16_t x = 0; x < SH1122_OLED_WIDTH/2; x++)
+        {
+            emu_tests_reference_frame_buffer[y][x] = (uint8_t)(displayed_pixels[y][2*x] << 4) | displayed_pixels[y][2*x+1];
+        }
+    }
+    if (emu_tests_compare_frame_buffers("displayed") != RETURN_OK)
+    {
+        nb_failed_cases++;
+    }
+    nb_cases++;
+    
+    /* Stopped marquee isn't scrolled */
+    sh1122_stop_marquee(&plat_oled_descriptor);
+    emu_hw_advance_systick(OLED_MARQUEE_PAUSE_MS);
+    sh1122_transitions_routine(&plat_oled_descriptor);
+    emu_tests_check_marquee(1, &nb_cases, &nb_failed_cases);
+    
+    emu_tests_clear_frame_buffers();
+    emu_tests_report("marquee scrolling", nb_cases, nb_failed_cases);
+}
+#endif
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        printf("Usage: emu_tests <bundle image file>\n");
+        return 1;
+    }
+    if (emu_dataflash_load_bundle(argv[1]) != RETURN_OK)
+    {
+        printf("Couldn't load bundle image %s\n", argv[1]);
+        return 1;
+    }
+    
+    /* Same initialization as the firmware */
+    emu_hw_attach_sh1122(plat_oled_descriptor.sercom_pt, plat_oled_descriptor.sh1122_cd_pin_group, plat_oled_descriptor.sh1122_cd_pin_mask);
+    custom_fs_set_dataflash_descriptor(&dataflash_descriptor);
+    sh1122_init_display(&plat_oled_descriptor);
+    if (custom_fs_init() != RETURN_OK)
+    {
+        printf("No bundle in the dataflash image\n");
+        return 1;
+    }
+    sh1122_refresh_used_font(&plat_oled_descriptor);
+    
+    emu_tests_blit_row();
+    emu_tests_bitmap_draws();
+    emu_tests_list_widget();
+    emu_tests_page_flip();
+    emu_tests_flush_stats();
+    #ifdef OLED_BACKGROUND_LAYER
+    emu_tests_alpha_blending();
+    #endif
+    #ifdef CUSTOM_FS_FLASH_CACHE
+    emu_tests_flash_cache();
+    #endif
+    #ifdef OLED_STRING_SPRITE_CACHE
+    emu_tests_string_sprites();
+    #endif
+    #ifdef OLED_GLYPH_BITMAP_ARENA
+    emu_tests_glyph_arena();
+    #endif
+    #ifdef OLED_BANDED_RENDERING
+    emu_tests_banded_rendering();
+    #endif
+    #ifdef OLED_MARQUEE
+    emu_tests_marquee();
+    #endif
+    
+    printf("%u failed tests\n", emu_tests_nb_failures);
+    return emu_tests_nb_failures;
+}
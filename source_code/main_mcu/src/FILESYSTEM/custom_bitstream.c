@@ -9,6 +9,71 @@
 #include "custom_fs.h"
 #include "dma.h"
 
+/* Source pixel to 4-bit pixel lookup tables, indexed by bit depth - 1 */
+static const uint8_t bitstream_depth_luts[4][16] =
+{
+    {0x00, 0x0F},
+    {0x00, 0x05, 0x0A, 0x0F},
+    {0x00, 0x02, 0x04, 0x06, 0x08, 0x0A, 0x0C, 0x0F},
+    {0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F}
+};
+/* Two 1-bit pixels to two 4-bit pixels lookup table */
+static const uint8_t bitstream_1bpp_two_pixel_lut[4] = {0x00, 0x0F, 0xF0, 0xFF};
+/* Two 2-bit pixels to two 4-bit pixels lookup table */
+static const uint8_t bitstream_2bpp_two_pixel_lut[16] =
+{
+    0x00, 0x05, 0x0A, 0x0F,
+    0x50, 0x55, 0x5A, 0x5F,
+    0xA0, 0xA5, 0xAA, 0xAF,
+    0xF0, 0xF5, 0xFA, 0xFF
+};
+
+/* Specialized decoders, selected at init */
+static uint8_t bitstream_bitmap_rle_pixel_read(bitstream_bitmap_t* bs);
+static uint8_t bitstream_bitmap_raw_pixel_read(bitstream_bitmap_t* bs);
+static void bitstream_bitmap_rle_array_read(bitstream_bitmap_t* bs, uint8_t* data, uint16_t nb_pixels);
+static void bitstream_bitmap_4bpp_array_read(bitstream_bitmap_t* bs, uint8_t* data, uint16_t nb_pixels);
+static void bitstream_bitmap_lut_array_read(bitstream_bitmap_t* bs, uint8_t* data, uint16_t nb_pixels);
+static void bitstream_bitmap_raw_array_read(bitstream_bitmap_t* bs, uint8_t* data, uint16_t nb_pixels);
+
+
+/*! \fn     bitstream_bitmap_select_decoders(bitstream_bitmap_t* bs)
+*   \brief  Select the decoders matching the bitstream depth and compression
+*   \param  bs          Pointer to a bitmap bitstream structure
+*/
+static void bitstream_bitmap_select_decoders(bitstream_bitmap_t* bs)
+{
+    bs->_depth_lut = bitstream_depth_luts[(bs->bitsPerPixel - 1) & 0x03];
+    bs->_two_pixel_lut = 0;
+    
+    if ((bs->_flags & CUSTOM_FS_BITMAP_RLE_FLAG) != 0)
+    {
+        bs->_pixel_read = bitstream_bitmap_rle_pixel_read;
+        bs->_array_read = bitstream_bitmap_rle_array_read;
+    }
+    else
+    {
+        bs->_pixel_read = bitstream_bitmap_raw_pixel_read;
+        if (bs->bitsPerPixel == 4)
+        {
+            bs->_array_read = bitstream_bitmap_4bpp_array_read;
+        }
+        else if (bs->bitsPerPixel == 2)
+        {
+            bs->_two_pixel_lut = bitstream_2bpp_two_pixel_lut;
+            bs->_array_read = bitstream_bitmap_lut_array_read;
+        }
+        else if (bs->bitsPerPixel == 1)
+        {
+            bs->_two_pixel_lut = bitstream_1bpp_two_pixel_lut;
+            bs->_array_read = bitstream_bitmap_lut_array_read;
+        }
+        else
+        {
+            bs->_array_read = bitstream_bitmap_raw_array_read;
+        }
+    }
+}
 
 /*! \fn     bitstream_bitmap_init(bitstream_bitmap_t* bs, bitmap_t* bitmap, custom_fs_address_t address, BOOL exclusive)
 *   \brief  Initialize a bitmap bitstream
@@ -31,6 +96,7 @@ void bitstream_bitmap_init(bitstream_bitmap_t* bs, bitmap_t* bitmap, custom_fs_a
     bs->addr = address;
     bs->bufSel = 0;
     bs->_exclusive_transfer = exclusive;
+    bitstream_bitmap_select_decoders(bs);
 
     /* In case you want to implement a DMA enabling strategy... */
     #ifdef FLASH_ALONE_ON_SPI_BUS
@@ -96,6 +162,7 @@ void bitstream_glyph_bitmap_init(bitstream_bitmap_t* bs, font_header_t* font, fo
     bs->addr = address;
     bs->bufSel = 0;
     bs->_exclusive_transfer = exclusive;
+    bitstream_bitmap_select_decoders(bs);
 
     /* In case you want to implement a DMA enabling strategy... */
     #ifdef FLASH_ALONE_ON_SPI_BUS
@@ -192,80 +259,183 @@ static inline uint8_t bitstream_bitmap_get_next_byte(bitstream_bitmap_t* bs)
     }
 }
 
-/*! \fn     bitstream_bitmap_array_read(bitstream_bitmap_t* bs, uint8_t* data, uint16_t nb_pixels)
-*   \brief  Read continuous pixel data
+/*! \fn     bitstream_bitmap_refill_run(bitstream_bitmap_t* bs)
+*   \brief  Fetch the next RLE run if the current one is exhausted
+*   \param  bs          Pointer to a bitmap bitstream structure
+*/
+static inline void bitstream_bitmap_refill_run(bitstream_bitmap_t* bs)
+{
+    if (bs->_bits == 0)
+    {
+        /* We have read all pixels of the same color */
+        uint8_t byte = bitstream_bitmap_get_next_byte(bs);
+        bs->_bits = (byte >> 4) + 1;
+        bs->_pixel = byte & 0x0F;
+    }
+}
+
+/*! \fn     bitstream_bitmap_rle_pixel_read(bitstream_bitmap_t* bs)
+*   \brief  RLE decoder: get a 4-bit pixel
+*   \param  bs          Pointer to a bitmap bitstream structure
+*   \return The 4-bit pixel
+*/
+static uint8_t bitstream_bitmap_rle_pixel_read(bitstream_bitmap_t* bs)
+{
+    bitstream_bitmap_refill_run(bs);
+    bs->_bits--;
+    return bs->_pixel;
+}
+
+/*! \fn     bitstream_bitmap_raw_pixel_read(bitstream_bitmap_t* bs)
+*   \brief  Uncompressed decoder: get a pixel converted to 4 bits
+*   \param  bs          Pointer to a bitmap bitstream structure
+*   \return The 4-bit pixel
+*/
+static uint8_t bitstream_bitmap_raw_pixel_read(bitstream_bitmap_t* bs)
+{
+    uint8_t pixel;
+    
+    if (bs->_bits == 0)
+    {
+        /* We have processed all data inside _word */
+        bs->_word = bitstream_bitmap_get_next_byte(bs);
+        bs->_bits = 8;
+    }
+    if (bs->_bits >= bs->bitsPerPixel)
+    {
+        /* Move pixel data from _word to data */
+        bs->_bits -= bs->bitsPerPixel;
+        pixel = (bs->_word >> bs->_bits) & bs->mask;
+    }
+    else
+    {
+        /* Pixel depth not aligned with word */
+        uint8_t offset = bs->bitsPerPixel - bs->_bits;
+        pixel = (bs->_word << offset) & bs->mask;
+        bs->_bits += 8 - bs->bitsPerPixel;
+        bs->_word = bitstream_bitmap_get_next_byte(bs);
+        pixel |= bs->_word >> bs->_bits;
+    }
+    
+    return bs->_depth_lut[pixel];
+}
+
+/*! \fn     bitstream_bitmap_rle_array_read(bitstream_bitmap_t* bs, uint8_t* data, uint16_t nb_pixels)
+*   \brief  RLE decoder: read continuous pixel data
 *   \param  bs          Pointer to a bitmap bitstream structure
 *   \param  data        Pointer to where to store the data
-*   \param  nb_pixels   Number of pixels to be read (multiple of 4!)
+*   \param  nb_pixels   Number of pixels to be read (multiple of 2!)
 */
-void bitstream_bitmap_array_read(bitstream_bitmap_t* bs, uint8_t* data, uint16_t nb_pixels)
+static void bitstream_bitmap_rle_array_read(bitstream_bitmap_t* bs, uint8_t* data, uint16_t nb_pixels)
 {
-    if (bs->_flags & CUSTOM_FS_BITMAP_RLE_FLAG)
+    while (nb_pixels != 0)
     {
-        while (nb_pixels != 0)
+        bitstream_bitmap_refill_run(bs);
+        
+        /* Current run covers both pixels */
+        if (bs->_bits >= 2)
+        {
+            *data++ = bs->_pixel * 0x11;
+            bs->_bits -= 2;
+        }
+        else
         {
-            if (bs->_bits == 0)
-            {
-                /* We have read all pixels of the same color */
-                uint8_t byte = bitstream_bitmap_get_next_byte(bs);
-                bs->_bits = (byte >> 4) + 1;
-                bs->_pixel = byte & 0x0F;
-            }
-            
-            /* We have pixels of the same color to store */
             *data = bs->_pixel << 4;
+            bs->_bits = 0;
+            bitstream_bitmap_refill_run(bs);
+            *data++ |= bs->_pixel;
             bs->_bits--;
-            nb_pixels--;
-                
-            if (bs->_bits == 0)
-            {
-                /* We have read all pixels of the same color */
-                uint8_t byte = bitstream_bitmap_get_next_byte(bs);
-                bs->_bits = (byte >> 4) + 1;
-                bs->_pixel = byte & 0x0F;
-            }
-            
-            /* We have pixels of the same color to store */
-            *data |= bs->_pixel;
-            bs->_bits--;
-            nb_pixels--;
-            data++;
+        }
+        nb_pixels -= 2;
+    }
+}
+
+/*! \fn     bitstream_bitmap_4bpp_array_read(bitstream_bitmap_t* bs, uint8_t* data, uint16_t nb_pixels)
+*   \brief  Uncompressed 4 bits per pixel decoder: read continuous pixel data
+*   \param  bs          Pointer to a bitmap bitstream structure
+*   \param  data        Pointer to where to store the data
+*   \param  nb_pixels   Number of pixels to be read (multiple of 2!)
+*/
+static void bitstream_bitmap_4bpp_array_read(bitstream_bitmap_t* bs, uint8_t* data, uint16_t nb_pixels)
+{
+    if (bs->_bits == 0)
+    {
+        /* Byte aligned: source bytes are our pixels */
+        for (; nb_pixels != 0; nb_pixels -= 2)
+        {
+            *data++ = bitstream_bitmap_get_next_byte(bs);
         }
     }
     else
     {
-        while (nb_pixels != 0)
+        /* One pixel left in _word: shift by a nibble */
+        for (; nb_pixels != 0; nb_pixels -= 2)
         {
-            *data = 0;
-            for (uint16_t i = 0; i < 2; i++)
-            {
-                *data <<= 4;
-                if (bs->_bits == 0)
-                {
-                    /* We have processed all data inside _word */
-                    bs->_word = bitstream_bitmap_get_next_byte(bs);
-                    bs->_bits = 8;
-                }
-                if (bs->_bits >= bs->bitsPerPixel)
-                {
-                    /* Move pixel data from _word to data */
-                    bs->_bits -= bs->bitsPerPixel;
-                    *data |= (((bs->_word >> bs->_bits) & bs->mask) * 15) / bs->mask;
-                }
-                else
-                {
-                    /* Pixel depth not aligned with word */
-                    uint8_t offset = bs->bitsPerPixel - bs->_bits;
-                    *data |= (bs->_word << offset & bs->mask);
-                    bs->_bits += 8 - bs->bitsPerPixel;
-                    bs->_word = bitstream_bitmap_get_next_byte(bs);
-                    *data |= ((bs->_word >> bs->_bits) * 15) / bs->mask;
-                }                
-            }
-            nb_pixels-=2;
-            data++;
+            uint8_t byte = bitstream_bitmap_get_next_byte(bs);
+            *data++ = (uint8_t)(bs->_word << 4) | (byte >> 4);
+            bs->_word = byte;
+        }
+    }
+}
+
+/*! \fn     bitstream_bitmap_lut_array_read(bitstream_bitmap_t* bs, uint8_t* data, uint16_t nb_pixels)
+*   \brief  Uncompressed 1 & 2 bits per pixel decoder: read continuous pixel data
+*   \param  bs          Pointer to a bitmap bitstream structure
+*   \param  data        Pointer to where to store the data
+*   \param  nb_pixels   Number of pixels to be read (multiple of 2!)
+*/
+static void bitstream_bitmap_lut_array_read(bitstream_bitmap_t* bs, uint8_t* data, uint16_t nb_pixels)
+{
+    uint8_t two_pixel_bits = bs->bitsPerPixel * 2;
+    uint8_t two_pixel_mask = (1 << two_pixel_bits) - 1;
+    
+    for (; nb_pixels != 0; nb_pixels -= 2)
+    {
+        if (bs->_bits == 0)
+        {
+            /* We have processed all data inside _word */
+            bs->_word = bitstream_bitmap_get_next_byte(bs);
+            bs->_bits = 8;
         }
-    }        
+        if (bs->_bits >= two_pixel_bits)
+        {
+            /* Both pixels inside _word */
+            bs->_bits -= two_pixel_bits;
+            *data++ = bs->_two_pixel_lut[(bs->_word >> bs->_bits) & two_pixel_mask];
+        }
+        else
+        {
+            /* Pixels across two words */
+            *data = bitstream_bitmap_raw_pixel_read(bs) << 4;
+            *data++ |= bitstream_bitmap_raw_pixel_read(bs);
+        }
+    }
+}
+
+/*! \fn     bitstream_bitmap_raw_array_read(bitstream_bitmap_t* bs, uint8_t* data, uint16_t nb_pixels)
+*   \brief  Uncompressed decoder for other bit depths: read continuous pixel data
+*   \param  bs          Pointer to a bitmap bitstream structure
+*   \param  data        Pointer to where to store the data
+*   \param  nb_pixels   Number of pixels to be read (multiple of 2!)
+*/
+static void bitstream_bitmap_raw_array_read(bitstream_bitmap_t* bs, uint8_t* data, uint16_t nb_pixels)
+{
+    for (; nb_pixels != 0; nb_pixels -= 2)
+    {
+        *data = bitstream_bitmap_raw_pixel_read(bs) << 4;
+        *data++ |= bitstream_bitmap_raw_pixel_read(bs);
+    }
+}
+
+/*! \fn     bitstream_bitmap_array_read(bitstream_bitmap_t* bs, uint8_t* data, uint16_t nb_pixels)
+*   \brief  Read continuous pixel data
+*   \param  bs          Pointer to a bitmap bitstream structure
+*   \param  data        Pointer to where to store the data
+*   \param  nb_pixels   Number of pixels to be read (multiple of 2!)
+*/
+void bitstream_bitmap_array_read(bitstream_bitmap_t* bs, uint8_t* data, uint16_t nb_pixels)
+{
+    bs->_array_read(bs, data, nb_pixels);
 }
 
 /*! \fn     bitstream_bitmap_close(bitstream_bitmap_t* bs)
@@ -290,68 +460,9 @@ void bitstream_bitmap_close(bitstream_bitmap_t* bs)
  */
 uint8_t bitstream_bitmap_two_pixel_read(bitstream_bitmap_t* bs)
 {
-    uint8_t data = 0;
-    
-    if (bs->_flags & CUSTOM_FS_BITMAP_RLE_FLAG) 
-    {
-        /* for speed, no for loop */
-        if (bs->_bits == 0) 
-        {
-            /* We have read all pixels of the same color */
-            uint8_t byte = bitstream_bitmap_get_next_byte(bs);
-            bs->_bits = (byte >> 4) + 1;
-            bs->_pixel = byte & 0x0F;
-        }
-        if (bs->_bits) 
-        {
-            /* We still have pixels of the same color to send */
-            data |= bs->_pixel;
-            bs->_bits--;
-        }
-        data <<= 4;
-        if (bs->_bits == 0)
-        {
-            /* We have read all pixels of the same color */
-            uint8_t byte = bitstream_bitmap_get_next_byte(bs);
-            bs->_bits = (byte >> 4) + 1;
-            bs->_pixel = byte & 0x0F;
-        }
-        if (bs->_bits)
-        {
-            /* We still have pixels of the same color to send */
-            data |= bs->_pixel;
-            bs->_bits--;
-        }
-    }
-    else
-    {
-        for(uint32_t i = 0; i < 2; i++)
-        {
-            data <<= 4;
-            if (bs->_bits == 0) 
-            {
-                /* We have processed all data inside _word */ 
-                bs->_word = bitstream_bitmap_get_next_byte(bs);
-                bs->_bits = 8;
-            }
-            if (bs->_bits >= bs->bitsPerPixel) 
-            {
-                /* Move pixel data from _word to data */
-                bs->_bits -= bs->bitsPerPixel;
-                data |= (((bs->_word >> bs->_bits) & bs->mask) * 15) / bs->mask;
-            }
-            else 
-            {
-                /* Pixel depth not aligned with word */
-                uint8_t offset = bs->bitsPerPixel - bs->_bits;
-                data |= (bs->_word << offset & bs->mask);
-                bs->_bits += 8 - bs->bitsPerPixel;
-                bs->_word = bitstream_bitmap_get_next_byte(bs);
-                data |= ((bs->_word >> bs->_bits) * 15) / bs->mask;
-            }
-        }
-    }
+    uint8_t data;
     
+    bs->_array_read(bs, &data, 2);
     return data;
 }
 
@@ -365,54 +476,67 @@ uint16_t bitstream_bitmap_read(bitstream_bitmap_t* bs, uint16_t nb_pixels)
 {
     uint16_t data = 0;
     
-    if (bs->_flags & CUSTOM_FS_BITMAP_RLE_FLAG) 
+    /* Pixel pairs first, then the odd pixel */
+    for (; nb_pixels >= 2; nb_pixels -= 2)
     {
-        while (nb_pixels--) 
-        {
-            data <<= 4;
-            if (bs->_bits == 0) 
-            {
-                /* We have read all pixels of the same color */
-                uint8_t byte = bitstream_bitmap_get_next_byte(bs);
-                bs->_bits = (byte >> 4) + 1;
-                bs->_pixel = byte & 0x0F;
-            }
-            if (bs->_bits) 
-            {
-                /* We still have pixels of the same color to send */
-                data |= bs->_pixel;
-                bs->_bits--;
-            }
-        }
+        uint8_t two_pixels;
+        bs->_array_read(bs, &two_pixels, 2);
+        data = (data << 8) | two_pixels;
     }
-    else
+    if (nb_pixels != 0)
+    {
+        data = (data << 4) | bs->_pixel_read(bs);
+    }
+    
+    return data;
+}
+
+/*! \fn     bitstream_bitmap_span_read(bitstream_bitmap_t* bs, uint8_t* color, uint16_t max_nb_pixels)
+*   \brief  Get a span of pixels of the same color
+*   \param  bs              Pointer to a bitmap bitstream structure
+*   \param  color           Pointer to where to store the 4-bit span color
+*   \param  max_nb_pixels   Max number of pixels in the span, non 0
+*   \return Number of pixels in the span
+*   \note   Consecutive RLE runs of the same color are merged, non RLE bitmaps return single pixel spans
+*/
+uint16_t bitstream_bitmap_span_read(bitstream_bitmap_t* bs, uint8_t* color, uint16_t max_nb_pixels)
+{
+    uint16_t nb_pixels;
+    
+    if ((bs->_flags & CUSTOM_FS_BITMAP_RLE_FLAG) == 0)
+    {
+        *color = bs->_pixel_read(bs);
+        return 1;
+    }
+    
+    bitstream_bitmap_refill_run(bs);
+    
+    /* Take the current run */
+    *color = bs->_pixel;
+    nb_pixels = bs->_bits;
+    bs->_bits = 0;
+    
+    /* Merge the next runs while they have the same color */
+    while (nb_pixels < max_nb_pixels)
     {
-        while (nb_pixels--) 
+        uint8_t byte = bitstream_bitmap_get_next_byte(bs);
+        
+        if ((byte & 0x0F) != *color)
         {
-            data <<= 4;
-            if (bs->_bits == 0) 
-            {
-                /* We have processed all data inside _word */ 
-                bs->_word = bitstream_bitmap_get_next_byte(bs);
-                bs->_bits = 8;
-            }
-            if (bs->_bits >= bs->bitsPerPixel) 
-            {
-                /* Move pixel data from _word to data */
-                bs->_bits -= bs->bitsPerPixel;
-                data |= (((bs->_word >> bs->_bits) & bs->mask) * 15) / bs->mask;
-            }
-            else 
-            {
-                /* Pixel depth not aligned with word */
-                uint8_t offset = bs->bitsPerPixel - bs->_bits;
-                data |= (bs->_word << offset & bs->mask);
-                bs->_bits += 8 - bs->bitsPerPixel;
-                bs->_word = bitstream_bitmap_get_next_byte(bs);
-                data |= ((bs->_word >> bs->_bits) * 15) / bs->mask;
-            }
+            /* Different color: keep it for the next read */
+            bs->_bits = (byte >> 4) + 1;
+            bs->_pixel = byte & 0x0F;
+            break;
         }
+        nb_pixels += (byte >> 4) + 1;
     }
     
-    return data;
+    /* Keep the pixels we went past for the next read */
+    if (nb_pixels > max_nb_pixels)
+    {
+        bs->_bits = nb_pixels - max_nb_pixels;
+        nb_pixels = max_nb_pixels;
+    }
+    
+    return nb_pixels;
 }
@@ -13,7 +13,7 @@
 #include "defines.h"
 
 /* Typedefs */
-typedef struct
+typedef struct bitstream_bitmap_s
 {
     uint8_t mask;               //*< pixel mask for returned data
     uint16_t width;             //*< number of pixels wide
@@ -31,11 +31,16 @@ typedef struct
     uint32_t bufSel;            //*< specify which of the 2 buffers we're using
     BOOL _exclusive_transfer;   //*< boolean to specify if no other bitmap transfer will take place at the same time
     BOOL _dma_transfer;         //*< boolean to specify if we're using DMA transfers (only convenient for big bitmaps)
+    const uint8_t* _depth_lut;          //*< source pixel to 4-bit pixel lookup table
+    const uint8_t* _two_pixel_lut;      //*< two source pixels to two 4-bit pixels lookup table, for 1 & 2 bits per pixel
+    uint8_t (*_pixel_read)(struct bitstream_bitmap_s* bs);                                  //*< pixel decoder, selected at init
+    void (*_array_read)(struct bitstream_bitmap_s* bs, uint8_t* data, uint16_t nb_pixels);  //*< pixel array decoder, selected at init
 } bitstream_bitmap_t;
 
 /* Prototypes */
 void bitstream_glyph_bitmap_init(bitstream_bitmap_t* bs, font_header_t* font, font_glyph_t* glyph, custom_fs_address_t address, BOOL exclusive);
 void bitstream_bitmap_init(bitstream_bitmap_t* bs, bitmap_t* bitmap, custom_fs_address_t address, BOOL exclusive);
+uint16_t bitstream_bitmap_span_read(bitstream_bitmap_t* bs, uint8_t* color, uint16_t max_nb_pixels);
 void bitstream_bitmap_array_read(bitstream_bitmap_t* bs, uint8_t* data, uint16_t nb_pixels);
 uint16_t bitstream_bitmap_read(bitstream_bitmap_t* bs, uint16_t nb_pixels);
 uint8_t bitstream_bitmap_two_pixel_read(bitstream_bitmap_t* bs);
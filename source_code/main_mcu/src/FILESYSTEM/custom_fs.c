@@ -27,9 +27,422 @@ spi_flash_descriptor_t* custom_fs_dataflash_desc = 0;
 custom_file_flash_header_t custom_fs_flash_header;
 /* Bool to specify if the SPI bus is left opened */
 BOOL custom_fs_data_bus_opened = FALSE;
+#ifdef CUSTOM_FS_STRING_CACHE
+/* String cache slots, use counter for LRU eviction and statistics */
+custom_fs_string_slot_t custom_fs_string_cache_slots[CUSTOM_FS_STRING_CACHE_NB_SLOTS];
+uint32_t custom_fs_string_cache_use_counter = 0;
+uint32_t custom_fs_string_cache_misses = 0;
+uint32_t custom_fs_string_cache_hits = 0;
+#else
 /* Temp string buffers for string reading */
 uint16_t custom_fs_temp_string1[128];
+#endif
+#ifdef CUSTOM_FS_FLASH_CACHE
+/* Flash cache lines, use counter for LRU eviction and statistics */
+custom_fs_flash_cache_line_t custom_fs_flash_cache_lines[CUSTOM_FS_FLASH_CACHE_NB_SETS][CUSTOM_FS_FLASH_CACHE_NB_WAYS];
+uint32_t custom_fs_flash_cache_use_counter = 0;
+uint32_t custom_fs_flash_cache_bytes_saved = 0;
+uint32_t custom_fs_flash_cache_misses = 0;
+uint32_t custom_fs_flash_cache_hits = 0;
+#endif
+#ifdef CUSTOM_FS_PREFETCH
+/* Prefetch requests ring, indexed by ticket */
+custom_fs_prefetch_request_t custom_fs_prefetch_requests[CUSTOM_FS_PREFETCH_QUEUE_SIZE];
+/* Ticket of the next enqueued request, of the first request not done yet */
+custom_fs_prefetch_ticket_t custom_fs_prefetch_next_ticket = 0;
+custom_fs_prefetch_ticket_t custom_fs_prefetch_serviced_ticket = 0;
+/* Bool to specify if the first request not done yet is being transferred */
+BOOL custom_fs_prefetch_transfer_ongoing = FALSE;
+/* Statistics */
+uint32_t custom_fs_prefetch_bus_waits = 0;
+uint32_t custom_fs_prefetch_completed = 0;
+#endif
+#ifdef CUSTOM_FS_FILE_TABLE_CACHE
+/* RAM copies of the file address tables, language independent part then current language bitmaps */
+custom_fs_address_t custom_fs_file_table_cache[CUSTOM_FS_FILE_TABLE_CACHE_SIZE];
+custom_fs_file_table_window_t custom_fs_file_table_windows[CUSTOM_FS_NB_TABLE_WINDOWS];
+/* Number of used RAM table entries, and where the current language bitmaps start */
+uint16_t custom_fs_file_table_cache_fill = 0;
+uint16_t custom_fs_file_table_cache_language_start = 0;
+#endif
+#ifdef CUSTOM_FS_LAZY_FILE_CHECK
+/* File CRC table header, index of each file table first entry in the CRC table */
+custom_fs_file_crc_header_t custom_fs_file_crc_header;
+uint32_t custom_fs_file_crc_first_index[CUSTOM_FS_FW_UPDATE_TYPE+1];
+BOOL custom_fs_file_crc_table_found = FALSE;
+/* Bitmaps of checked and corrupted files */
+uint32_t custom_fs_checked_files[(CUSTOM_FS_LAZY_CHECK_MAX_FILES+31)/32];
+uint32_t custom_fs_corrupted_files[(CUSTOM_FS_LAZY_CHECK_MAX_FILES+31)/32];
+/* Statistics */
+uint32_t custom_fs_checked_bytes = 0;
+uint32_t custom_fs_nb_checked_files = 0;
+uint32_t custom_fs_nb_corrupted_files = 0;
+#endif
+
+
+#ifdef CUSTOM_FS_FLASH_CACHE
+/*! \fn     custom_fs_flash_cache_clear(void)
+*   \brief  Empty the flash cache
+*/
+void custom_fs_flash_cache_clear(void)
+{
+    for (uint16_t i = 0; i < CUSTOM_FS_FLASH_CACHE_NB_SETS; i++)
+    {
+        for (uint16_t j = 0; j < CUSTOM_FS_FLASH_CACHE_NB_WAYS; j++)
+        {
+            custom_fs_flash_cache_lines[i][j].address = CUSTOM_FS_FLASH_CACHE_FREE_LINE;
+            custom_fs_flash_cache_lines[i][j].last_used = 0;
+        }
+    }
+}
+
+/*! \fn     custom_fs_flash_cache_invalidate(custom_fs_address_t address, uint32_t size)
+*   \brief  Free the flash cache lines overlapping a flash range, to be called when it is written or erased
+*   \param  address     Range start address
+*   \param  size        Range size
+*/
+void custom_fs_flash_cache_invalidate(custom_fs_address_t address, uint32_t size)
+{
+    for (uint16_t i = 0; i < CUSTOM_FS_FLASH_CACHE_NB_SETS; i++)
+    {
+        for (uint16_t j = 0; j < CUSTOM_FS_FLASH_CACHE_NB_WAYS; j++)
+        {
+            custom_fs_flash_cache_line_t* line_pt = &custom_fs_flash_cache_lines[i][j];
+            
+            if ((line_pt->address != CUSTOM_FS_FLASH_CACHE_FREE_LINE) && (line_pt->address < address + size) && (line_pt->address + CUSTOM_FS_FLASH_CACHE_LINE_SIZE > address))
+            {
+                line_pt->address = CUSTOM_FS_FLASH_CACHE_FREE_LINE;
+                line_pt->last_used = 0;
+            }
+        }
+    }
+}
+
+/*! \fn     custom_fs_flash_cache_read(uint8_t* datap, custom_fs_address_t address, uint32_t size)
+*   \brief  Read data from the external flash through the flash cache
+*   \param  datap       Pointer to where to store the data
+*   \param  address     Where to read the data
+*   \param  size        How many bytes to read, the data must be inside a single cache line
+*   \note   Missing lines are read from flash in place of the least recently used line of their set
+*/
+static void custom_fs_flash_cache_read(uint8_t* datap, custom_fs_address_t address, uint32_t size)
+{
+    custom_fs_address_t line_address = address & ~((custom_fs_address_t)CUSTOM_FS_FLASH_CACHE_LINE_SIZE - 1);
+    custom_fs_flash_cache_line_t* set_pt = custom_fs_flash_cache_lines[(line_address / CUSTOM_FS_FLASH_CACHE_LINE_SIZE) & (CUSTOM_FS_FLASH_CACHE_NB_SETS - 1)];
+    custom_fs_flash_cache_line_t* lru_line_pt = &set_pt[0];
+    custom_fs_flash_cache_line_t* line_pt = 0;
+    
+    /* Look for the line in its set */
+    for (uint16_t i = 0; i < CUSTOM_FS_FLASH_CACHE_NB_WAYS; i++)
+    {
+        if (set_pt[i].address == line_address)
+        {
+            line_pt = &set_pt[i];
+            break;
+        }
+        else if (set_pt[i].last_used < lru_line_pt->last_used)
+        {
+            lru_line_pt = &set_pt[i];
+        }
+    }
+    
+    if (line_pt != 0)
+    {
+        custom_fs_flash_cache_hits++;
+        custom_fs_flash_cache_bytes_saved += size;
+    }
+    else
+    {
+        #ifdef CUSTOM_FS_PREFETCH
+        custom_fs_prefetch_finish_ongoing_transfer();
+        #endif
+        custom_fs_flash_cache_misses++;
+        line_pt = lru_line_pt;
+        dataflash_read_data_array(custom_fs_dataflash_desc, line_address, line_pt->data, CUSTOM_FS_FLASH_CACHE_LINE_SIZE);
+        line_pt->address = line_address;
+    }
+    
+    line_pt->last_used = ++custom_fs_flash_cache_use_counter;
+    memcpy(datap, &line_pt->data[address - line_address], size);
+}
+#endif
+
+#ifdef CUSTOM_FS_PREFETCH
+/*! \fn     custom_fs_prefetch_enqueue(uint8_t* datap, custom_fs_address_t address, uint16_t size, custom_fs_prefetch_ticket_t* ticket_pt)
+*   \brief  Queue an external flash read, to be done by DMA by custom_fs_prefetch_routine() when the flash bus is idle
+*   \param  datap       Pointer to where to store the data, must stay valid until the request is done or cancelled
+*   \param  address     Where to read the data
+*   \param  size        How many bytes to read
+*   \param  ticket_pt   Pointer to where to store the request ticket
+*   \return RETURN_NOK if the queue is full
+*/
+RET_TYPE custom_fs_prefetch_enqueue(uint8_t* datap, custom_fs_address_t address, uint16_t size, custom_fs_prefetch_ticket_t* ticket_pt)
+{
+    custom_fs_prefetch_request_t* request_pt = &custom_fs_prefetch_requests[custom_fs_prefetch_next_ticket & (CUSTOM_FS_PREFETCH_QUEUE_SIZE - 1)];
+    
+    if ((size == 0) || ((custom_fs_prefetch_next_ticket - custom_fs_prefetch_serviced_ticket) == CUSTOM_FS_PREFETCH_QUEUE_SIZE))
+    {
+        return RETURN_NOK;
+    }
+    
+    request_pt->address = address;
+    request_pt->datap = datap;
+    request_pt->size = size;
+    *ticket_pt = custom_fs_prefetch_next_ticket++;
+    return RETURN_OK;
+}
+
+/*! \fn     custom_fs_prefetch_is_done(custom_fs_prefetch_ticket_t ticket)
+*   \brief  Check if a prefetch request is done
+*   \param  ticket      Request ticket
+*   \return TRUE once the data is stored
+*/
+BOOL custom_fs_prefetch_is_done(custom_fs_prefetch_ticket_t ticket)
+{
+    /* Pending tickets are between the serviced and next tickets, requests being serviced in ticket order */
+    if ((ticket - custom_fs_prefetch_serviced_ticket) < (custom_fs_prefetch_next_ticket - custom_fs_prefetch_serviced_ticket))
+    {
+        return FALSE;
+    }
+    else
+    {
+        return TRUE;
+    }
+}
+
+/*! \fn     custom_fs_prefetch_finish_ongoing_transfer(void)
+*   \brief  Wait for the end of the ongoing prefetch transfer, if any, and release the flash bus
+*   \note   To be called before any other use of the flash bus
+*/
+void custom_fs_prefetch_finish_ongoing_transfer(void)
+{
+    if (custom_fs_prefetch_transfer_ongoing != FALSE)
+    {
+        while (dma_custom_fs_check_and_clear_dma_transfer_flag() == FALSE);
+        dataflash_stop_ongoing_transfer(custom_fs_dataflash_desc);
+        custom_fs_prefetch_transfer_ongoing = FALSE;
+        custom_fs_prefetch_serviced_ticket++;
+        custom_fs_prefetch_completed++;
+        custom_fs_prefetch_bus_waits++;
+    }
+}
+
+/*! \fn     custom_fs_prefetch_routine(void)
+*   \brief  Prefetch routine: complete the ongoing prefetch transfer and start the next one if the flash bus is idle
+*   \note   To be called regularly, typically from the main loop
+*/
+void custom_fs_prefetch_routine(void)
+{
+    /* Check for ongoing transfer end */
+    if (custom_fs_prefetch_transfer_ongoing != FALSE)
+    {
+        if (dma_custom_fs_check_and_clear_dma_transfer_flag() == FALSE)
+        {
+            return;
+        }
+        dataflash_stop_ongoing_transfer(custom_fs_dataflash_desc);
+        custom_fs_prefetch_transfer_ongoing = FALSE;
+        custom_fs_prefetch_serviced_ticket++;
+        custom_fs_prefetch_completed++;
+    }
+    
+    /* Skip cancelled requests */
+    while ((custom_fs_prefetch_serviced_ticket != custom_fs_prefetch_next_ticket) && (custom_fs_prefetch_requests[custom_fs_prefetch_serviced_ticket & (CUSTOM_FS_PREFETCH_QUEUE_SIZE - 1)].size == 0))
+    {
+        custom_fs_prefetch_serviced_ticket++;
+    }
+    
+    /* Start the next request, unless a continuous read is using the bus */
+    if ((custom_fs_prefetch_serviced_ticket != custom_fs_prefetch_next_ticket) && (custom_fs_data_bus_opened == FALSE))
+    {
+        custom_fs_prefetch_request_t* request_pt = &custom_fs_prefetch_requests[custom_fs_prefetch_serviced_ticket & (CUSTOM_FS_PREFETCH_QUEUE_SIZE - 1)];
+    
+        /* Check for emergency font file exception */
+        if ((request_pt->address >= CUSTOM_FS_EMERGENCY_FONT_FILE_ADDR) && (request_pt->address + request_pt->size <= CUSTOM_FS_EMERGENCY_FONT_FILE_ADDR + sizeof(custom_fs_emergency_font_file)))
+        {
+            memcpy(request_pt->datap, &custom_fs_emergency_font_file[request_pt->address-CUSTOM_FS_EMERGENCY_FONT_FILE_ADDR], request_pt->size);
+            custom_fs_prefetch_serviced_ticket++;
+            custom_fs_prefetch_completed++;
+        }
+        else
+        {
+            /* Clear a possibly left over flag before arming the transfer */
+            dma_custom_fs_check_and_clear_dma_transfer_flag();
+            dataflash_read_data_array_start(custom_fs_dataflash_desc, request_pt->address);
+            dma_custom_fs_init_transfer((void*)&custom_fs_dataflash_desc->sercom_pt->SPI.DATA.reg, (void*)request_pt->datap, request_pt->size);
+            custom_fs_prefetch_transfer_ongoing = TRUE;
+        }
+    }
+}
+
+/*! \fn     custom_fs_prefetch_wait(custom_fs_prefetch_ticket_t ticket)
+*   \brief  Wait for a prefetch request to be done, servicing the queue meanwhile
+*   \param  ticket      Request ticket
+*   \note   Must not be called during a continuous read, which keeps the flash bus
+*/
+void custom_fs_prefetch_wait(custom_fs_prefetch_ticket_t ticket)
+{
+    while (custom_fs_prefetch_is_done(ticket) == FALSE)
+    {
+        custom_fs_prefetch_routine();
+    }
+}
+
+/*! \fn     custom_fs_prefetch_cancel(custom_fs_prefetch_ticket_t ticket)
+*   \brief  Cancel a prefetch request: its buffer isn't written to once this function returns
+*   \param  ticket      Request ticket
+*   \note   A request being transferred is completed
+*/
+void custom_fs_prefetch_cancel(custom_fs_prefetch_ticket_t ticket)
+{
+    if (custom_fs_prefetch_is_done(ticket) != FALSE)
+    {
+        return;
+    }
+    
+    if ((ticket == custom_fs_prefetch_serviced_ticket) && (custom_fs_prefetch_transfer_ongoing != FALSE))
+    {
+        custom_fs_prefetch_finish_ongoing_transfer();
+    }
+    else
+    {
+        custom_fs_prefetch_requests[ticket & (CUSTOM_FS_PREFETCH_QUEUE_SIZE - 1)].size = 0;
+    }
+}
+#endif
+
+#ifdef CUSTOM_FS_LAZY_FILE_CHECK
+/*! \fn     custom_fs_compute_flash_crc32(custom_fs_address_t address, uint32_t size)
+*   \brief  Compute the crc32 of external flash data, with the same algorithm as the bundle crc32
+*   \param  address     Where the data starts
+*   \param  size        Number of bytes
+*   \return crc32
+*/
+static uint32_t custom_fs_compute_flash_crc32(custom_fs_address_t address, uint32_t size)
+{
+    uint32_t crc32;
+    
+    #ifdef CUSTOM_FS_PREFETCH
+    custom_fs_prefetch_finish_ongoing_transfer();
+    #endif
+    custom_fs_checked_bytes += size;
+    
+    /* Stream the data through the DMA CRC engine */
+    dataflash_read_data_array_start(custom_fs_dataflash_desc, address);
+    crc32 = dma_custom_fs_compute_crc32_from_spi((void*)&custom_fs_dataflash_desc->sercom_pt->SPI.DATA.reg, size);
+    dataflash_stop_ongoing_transfer(custom_fs_dataflash_desc);
+    
+    return crc32;
+}
 
+/*! \fn     custom_fs_load_file_crc_table(void)
+*   \brief  Look for the file CRC table after the bundle, check it and the bundle metadata
+*   \return RETURN_NOK if the table or the metadata is corrupted, RETURN_OK otherwise (files aren't checked if there is no table)
+*/
+static RET_TYPE custom_fs_load_file_crc_table(void)
+{
+    custom_fs_file_type_te file_types[] = {CUSTOM_FS_FW_UPDATE_TYPE, CUSTOM_FS_STRING_TYPE, CUSTOM_FS_FONTS_TYPE, CUSTOM_FS_BITMAP_TYPE, CUSTOM_FS_BINARY_TYPE};
+    custom_fs_file_count_t file_counts[] = {custom_fs_flash_header.update_file_count, custom_fs_flash_header.string_file_count, custom_fs_flash_header.fonts_file_count, custom_fs_flash_header.bitmap_file_count, custom_fs_flash_header.binary_img_file_count};
+    custom_fs_address_t table_address = CUSTOM_FS_FILES_ADDR_OFFSET + custom_fs_flash_header.total_size;
+    uint32_t crc32_start = sizeof(custom_fs_flash_header.magic_header) + sizeof(custom_fs_flash_header.total_size) + sizeof(custom_fs_flash_header.crc32);
+    uint32_t file_count = 0;
+    
+    /* File tables are stored one after the other in the CRC table, in flash header order */
+    for (uint16_t i = 0; i < sizeof(file_types)/sizeof(file_types[0]); i++)
+    {
+        custom_fs_file_crc_first_index[file_types[i]] = file_count;
+        if (file_counts[i] != CUSTOM_FS_MAX_FILE_COUNT)
+        {
+            file_count += file_counts[i];
+        }
+    }
+    
+    /* Bundles generated without the table */
+    custom_fs_read_from_flash((uint8_t*)&custom_fs_file_crc_header, table_address, sizeof(custom_fs_file_crc_header));
+    if (custom_fs_file_crc_header.magic != CUSTOM_FS_FILE_CRC_MAGIC)
+    {
+        return RETURN_OK;
+    }
+    
+    /* Check table consistency, then the table entries and metadata */
+    if ((custom_fs_file_crc_header.file_count != file_count) || (custom_fs_file_crc_header.metadata_size > custom_fs_flash_header.total_size - crc32_start))
+    {
+        return RETURN_NOK;
+    }
+    if (custom_fs_compute_flash_crc32(table_address + sizeof(custom_fs_file_crc_header), file_count * sizeof(custom_fs_file_crc_entry_t)) != custom_fs_file_crc_header.entries_crc32)
+    {
+        return RETURN_NOK;
+    }
+    if (custom_fs_compute_flash_crc32(CUSTOM_FS_FILES_ADDR_OFFSET + crc32_start, custom_fs_file_crc_header.metadata_size) != custom_fs_file_crc_header.metadata_crc32)
+    {
+        return RETURN_NOK;
+    }
+    
+    custom_fs_file_crc_table_found = TRUE;
+    return RETURN_OK;
+}
+
+/*! \fn     custom_fs_check_file(custom_fs_file_type_te file_type, uint32_t table_index, custom_fs_address_t address)
+*   \brief  Check a file crc32 when first accessed, the result is then kept in RAM
+*   \param  file_type   File type (see enum)
+*   \param  table_index Index in the file type table
+*   \param  address     File address
+*   \return RETURN_NOK if the file is corrupted
+*/
+static RET_TYPE custom_fs_check_file(custom_fs_file_type_te file_type, uint32_t table_index, custom_fs_address_t address)
+{
+    uint32_t file_index = custom_fs_file_crc_first_index[file_type] + table_index;
+    uint32_t file_mask = 1UL << (file_index & 0x1F);
+    custom_fs_file_crc_entry_t file_crc_entry;
+    RET_TYPE check_result = RETURN_NOK;
+    
+    /* Bundles without file CRC table */
+    if (custom_fs_file_crc_table_found == FALSE)
+    {
+        return RETURN_OK;
+    }
+    
+    /* Already checked? */
+    if ((file_index < CUSTOM_FS_LAZY_CHECK_MAX_FILES) && ((custom_fs_checked_files[file_index >> 5] & file_mask) != 0))
+    {
+        if ((custom_fs_corrupted_files[file_index >> 5] & file_mask) != 0)
+        {
+            return RETURN_NOK;
+        }
+        else
+        {
+            return RETURN_OK;
+        }
+    }
+    
+    /* Read the file CRC table entry, check the file is inside the bundle and its crc32 */
+    custom_fs_read_from_flash((uint8_t*)&file_crc_entry, CUSTOM_FS_FILES_ADDR_OFFSET + custom_fs_flash_header.total_size + sizeof(custom_fs_file_crc_header) + file_index * sizeof(file_crc_entry), sizeof(file_crc_entry));
+    if (((address - CUSTOM_FS_FILES_ADDR_OFFSET) <= custom_fs_flash_header.total_size) && (file_crc_entry.size <= custom_fs_flash_header.total_size - (address - CUSTOM_FS_FILES_ADDR_OFFSET)))
+    {
+        if (custom_fs_compute_flash_crc32(address, file_crc_entry.size) == file_crc_entry.crc32)
+        {
+            check_result = RETURN_OK;
+        }
+    }
+    custom_fs_nb_checked_files++;
+    
+    /* Store the result */
+    if (check_result != RETURN_OK)
+    {
+        custom_fs_nb_corrupted_files++;
+    }
+    if (file_index < CUSTOM_FS_LAZY_CHECK_MAX_FILES)
+    {
+        custom_fs_checked_files[file_index >> 5] |= file_mask;
+        if (check_result != RETURN_OK)
+        {
+            custom_fs_corrupted_files[file_index >> 5] |= file_mask;
+        }
+    }
+    
+    return check_result;
+}
+#endif
 
 /*! \fn     custom_fs_read_from_flash(uint8_t* datap, custom_fs_address_t address, uint32_t size)
 *   \brief  Read data from the external flash
@@ -45,8 +458,19 @@ RET_TYPE custom_fs_read_from_flash(uint8_t* datap, custom_fs_address_t address,
     {
         memcpy(datap, &custom_fs_emergency_font_file[address-CUSTOM_FS_EMERGENCY_FONT_FILE_ADDR], size);
     } 
+    #ifdef CUSTOM_FS_FLASH_CACHE
+    else if (((address & (CUSTOM_FS_FLASH_CACHE_LINE_SIZE - 1)) + size) <= CUSTOM_FS_FLASH_CACHE_LINE_SIZE)
+    {
+        /* Small reads inside a single line: headers, table entries, glyph descriptors... Others go straight to the flash */
+        custom_fs_flash_cache_read(datap, address, size);
+    }
+    #endif
     else
     {
+        #ifdef CUSTOM_FS_PREFETCH
+        /* Demand reads come first: wait for the prefetch transfer using the bus */
+        custom_fs_prefetch_finish_ongoing_transfer();
+        #endif
         dataflash_read_data_array(custom_fs_dataflash_desc, address, datap, size);
         //memcpy(datap, &mooltipass_bundle[address], size);
     }
@@ -79,6 +503,9 @@ RET_TYPE custom_fs_continuous_read_from_flash(uint8_t* datap, custom_fs_address_
         /* Check if we have opened the SPI bus */
         if (custom_fs_data_bus_opened == FALSE)
         {
+            #ifdef CUSTOM_FS_PREFETCH
+            custom_fs_prefetch_finish_ongoing_transfer();
+            #endif
             dataflash_read_data_array_start(custom_fs_dataflash_desc, address);
             custom_fs_data_bus_opened = TRUE;
         }
@@ -102,9 +529,14 @@ RET_TYPE custom_fs_continuous_read_from_flash(uint8_t* datap, custom_fs_address_
 /*! \fn     custom_fs_compute_and_check_external_bundle_crc32(void)
 *   \brief  Compute the crc32 of our bundle
 *   \return Success status
+*   \note   Bootloader only, before updates: the application checks bundle files when they are accessed
 */
 RET_TYPE custom_fs_compute_and_check_external_bundle_crc32(void)
 {
+    #ifdef CUSTOM_FS_PREFETCH
+    custom_fs_prefetch_finish_ongoing_transfer();
+    #endif
+    
     /* Start a read on external flash */
     dataflash_read_data_array_start(custom_fs_dataflash_desc, CUSTOM_FS_FILES_ADDR_OFFSET + sizeof(custom_fs_flash_header.magic_header) + sizeof(custom_fs_flash_header.total_size) + sizeof(custom_fs_flash_header.crc32));
     
@@ -171,6 +603,95 @@ cust_char_t* custom_fs_get_current_language_text_desc(void)
     return custom_fs_cur_language_entry.language_descr;
 }
 
+/*! \fn     custom_fs_get_current_string_file_address(void)
+*   \brief  Get the address of the current language string file
+*   \return The address, 0 if the current language doesn't have a string file
+*   \note   Identifies the language strings returned by custom_fs_get_string_from_file() are in
+*/
+custom_fs_address_t custom_fs_get_current_string_file_address(void)
+{
+    return custom_fs_current_text_file_addr;
+}
+
+#ifdef CUSTOM_FS_FILE_TABLE_CACHE
+/*! \fn     custom_fs_load_file_table_window(custom_fs_table_window_te window_id, custom_fs_address_t file_table_address, uint32_t first_index, uint32_t nb_entries)
+*   \brief  Copy a range of a file address table to the remaining RAM table space
+*   \param  window_id           Window ID (see enum)
+*   \param  file_table_address  File address table offset, from the flash header
+*   \param  first_index         First table index to copy
+*   \param  nb_entries          Number of table entries to copy
+*   \note   Entries not fitting in RAM are later read from flash
+*/
+static void custom_fs_load_file_table_window(custom_fs_table_window_te window_id, custom_fs_address_t file_table_address, uint32_t first_index, uint32_t nb_entries)
+{
+    custom_fs_file_table_window_t* window_pt = &custom_fs_file_table_windows[window_id];
+    
+    /* Clamp to the remaining RAM table space */
+    if (nb_entries > (uint32_t)(CUSTOM_FS_FILE_TABLE_CACHE_SIZE - custom_fs_file_table_cache_fill))
+    {
+        nb_entries = CUSTOM_FS_FILE_TABLE_CACHE_SIZE - custom_fs_file_table_cache_fill;
+    }
+    
+    window_pt->first_index = first_index;
+    window_pt->nb_entries = (uint16_t)nb_entries;
+    window_pt->cache_index = custom_fs_file_table_cache_fill;
+    
+    /* Read the table range in one go */
+    if (nb_entries != 0)
+    {
+        custom_fs_read_from_flash((uint8_t*)&custom_fs_file_table_cache[custom_fs_file_table_cache_fill], CUSTOM_FS_FILES_ADDR_OFFSET + file_table_address + first_index * sizeof(custom_fs_address_t), nb_entries * sizeof(custom_fs_address_t));
+        custom_fs_file_table_cache_fill += (uint16_t)nb_entries;
+    }
+}
+
+/*! \fn     custom_fs_load_file_tables(void)
+*   \brief  Load the language independent parts of the string, font and bitmap file address tables in RAM
+*/
+static void custom_fs_load_file_tables(void)
+{
+    uint32_t nb_common_bitmaps = custom_fs_flash_header.language_bitmap_starting_id;
+    
+    /* Tables are stored first, in order of lookup frequency per file */
+    custom_fs_file_table_cache_fill = 0;
+    if (custom_fs_flash_header.string_file_count != CUSTOM_FS_MAX_FILE_COUNT)
+    {
+        custom_fs_load_file_table_window(CUSTOM_FS_STRING_TABLE_WINDOW, custom_fs_flash_header.string_file_offset, 0, custom_fs_flash_header.string_file_count);
+    }
+    if (custom_fs_flash_header.fonts_file_count != CUSTOM_FS_MAX_FILE_COUNT)
+    {
+        custom_fs_load_file_table_window(CUSTOM_FS_FONTS_TABLE_WINDOW, custom_fs_flash_header.fonts_file_offset, 0, custom_fs_flash_header.fonts_file_count);
+    }
+    if (custom_fs_flash_header.bitmap_file_count != CUSTOM_FS_MAX_FILE_COUNT)
+    {
+        if (nb_common_bitmaps > custom_fs_flash_header.bitmap_file_count)
+        {
+            nb_common_bitmaps = custom_fs_flash_header.bitmap_file_count;
+        }
+        custom_fs_load_file_table_window(CUSTOM_FS_BITMAP_TABLE_WINDOW, custom_fs_flash_header.bitmap_file_offset, 0, nb_common_bitmaps);
+    }
+    
+    /* Current language bitmaps are loaded after, see custom_fs_load_language_file_table */
+    custom_fs_file_table_cache_language_start = custom_fs_file_table_cache_fill;
+}
+
+/*! \fn     custom_fs_load_language_file_table(void)
+*   \brief  Load the current language bitmap file addresses in the remaining RAM table space
+*/
+static void custom_fs_load_language_file_table(void)
+{
+    uint32_t first_index = custom_fs_flash_header.language_bitmap_starting_id + custom_fs_cur_language_entry.starting_bitmap;
+    
+    /* Overwrite the previous language bitmaps */
+    custom_fs_file_table_cache_fill = custom_fs_file_table_cache_language_start;
+    custom_fs_file_table_windows[CUSTOM_FS_LANGUAGE_BITMAP_TABLE_WINDOW].nb_entries = 0;
+    
+    if ((custom_fs_flash_header.bitmap_file_count != CUSTOM_FS_MAX_FILE_COUNT) && (first_index < custom_fs_flash_header.bitmap_file_count))
+    {
+        custom_fs_load_file_table_window(CUSTOM_FS_LANGUAGE_BITMAP_TABLE_WINDOW, custom_fs_flash_header.bitmap_file_offset, first_index, custom_fs_flash_header.bitmap_file_count - first_index);
+    }
+}
+#endif
+
 /*! \fn     custom_fs_set_current_language(uint16_t language_id)
 *   \brief  Set current language
 *   \param  language_id     Language ID
@@ -191,11 +712,22 @@ ret_type_te custom_fs_set_current_language(uint16_t language_id)
     /* Load language map entry */
     custom_fs_read_from_flash((uint8_t*)&custom_fs_cur_language_entry, CUSTOM_FS_FILES_ADDR_OFFSET + language_map_table_addr + (language_id*sizeof(custom_fs_cur_language_entry)), sizeof(custom_fs_cur_language_entry));
     
+    #ifdef CUSTOM_FS_FILE_TABLE_CACHE
+    /* Load the file addresses of this language bitmaps */
+    custom_fs_load_language_file_table();
+    #endif
+    
     /* Try to read address and file count of text file for this language */
     if (custom_fs_get_file_address(custom_fs_cur_language_entry.string_file_index, &custom_fs_current_text_file_addr, CUSTOM_FS_STRING_TYPE) != RETURN_NOK)
     {
         custom_fs_read_from_flash((uint8_t*)&custom_fs_current_text_file_string_count, custom_fs_current_text_file_addr, sizeof(custom_fs_current_text_file_string_count));
     }
+    else
+    {
+        /* No text file (or a corrupted one): no strings rather than the previous language ones */
+        custom_fs_current_text_file_addr = 0;
+        custom_fs_current_text_file_string_count = 0;
+    }
     
     return RETURN_OK;
 }
@@ -208,7 +740,27 @@ void custom_fs_set_dataflash_descriptor(spi_flash_descriptor_t* desc)
 {
     /* Locally copy the flash descriptor */
     custom_fs_dataflash_desc = desc;    
+    
+    #ifdef CUSTOM_FS_FLASH_CACHE
+    /* Nothing read from this flash yet */
+    custom_fs_flash_cache_clear();
+    #endif
+}
+
+#ifdef CUSTOM_FS_STRING_CACHE
+/*! \fn     custom_fs_clear_string_cache(void)
+*   \brief  Empty the string cache, invalidating all handles
+*/
+static void custom_fs_clear_string_cache(void)
+{
+    for (uint16_t i = 0; i < CUSTOM_FS_STRING_CACHE_NB_SLOTS; i++)
+    {
+        custom_fs_string_cache_slots[i].string_file_addr = 0;
+        custom_fs_string_cache_slots[i].last_used = 0;
+        custom_fs_string_cache_slots[i].generation++;
+    }
 }
+#endif
 
 /*! \fn     custom_fs_init(void)
 *   \brief  Initialize our custom file system... system
@@ -216,6 +768,25 @@ void custom_fs_set_dataflash_descriptor(spi_flash_descriptor_t* desc)
 */
 ret_type_te custom_fs_init(void)
 {    
+    #ifdef CUSTOM_FS_FILE_TABLE_CACHE
+    /* Forget the previous bundle file tables */
+    memset((void*)custom_fs_file_table_windows, 0x00, sizeof(custom_fs_file_table_windows));
+    #endif
+    #ifdef CUSTOM_FS_STRING_CACHE
+    /* String file addresses may be reused by the new bundle */
+    custom_fs_clear_string_cache();
+    #endif
+    #ifdef CUSTOM_FS_FLASH_CACHE
+    /* The bundle may have been written without the dataflash driver */
+    custom_fs_flash_cache_clear();
+    #endif
+    #ifdef CUSTOM_FS_LAZY_FILE_CHECK
+    /* Files of the new bundle aren't checked yet */
+    memset((void*)custom_fs_checked_files, 0x00, sizeof(custom_fs_checked_files));
+    memset((void*)custom_fs_corrupted_files, 0x00, sizeof(custom_fs_corrupted_files));
+    custom_fs_file_crc_table_found = FALSE;
+    #endif
+    
     /* Read flash header */
     custom_fs_read_from_flash((uint8_t*)&custom_fs_flash_header, CUSTOM_FS_FILES_ADDR_OFFSET, sizeof(custom_fs_flash_header));
     
@@ -225,17 +796,31 @@ ret_type_te custom_fs_init(void)
         return RETURN_NOK;
     }
     
+    #ifdef CUSTOM_FS_LAZY_FILE_CHECK
+    /* Files are checked when accessed, the bundle metadata now */
+    if (custom_fs_load_file_crc_table() != RETURN_OK)
+    {
+        return RETURN_NOK;
+    }
+    #endif
+    
+    #ifdef CUSTOM_FS_FILE_TABLE_CACHE
+    /* Load the file address tables in RAM */
+    custom_fs_load_file_tables();
+    #endif
+    
     /* Set default language */
     return custom_fs_set_current_language(0);
 }
 
-/*! \fn     custom_fs_get_string_from_file(uint32_t text_file_id, uint32_t string_id, char* string_pt)
-*   \brief  Read a string from a string file
+/*! \fn     custom_fs_read_string_from_file(uint32_t string_id, cust_char_t* string_pt, uint16_t max_length)
+*   \brief  Read a string from the current language string file
 *   \param  string_id   String ID
-*   \param  string_pt   Pointer to the returned string
+*   \param  string_pt   Where to store the string
+*   \param  max_length  Max number of chars to store, terminating 0 included
 *   \return success status
 */
-RET_TYPE custom_fs_get_string_from_file(uint32_t string_id, cust_char_t** string_pt)
+static RET_TYPE custom_fs_read_string_from_file(uint32_t string_id, cust_char_t* string_pt, uint16_t max_length)
 {
     custom_fs_string_offset_t string_offset;
     custom_fs_string_length_t string_length;
@@ -259,21 +844,123 @@ RET_TYPE custom_fs_get_string_from_file(uint32_t string_id, cust_char_t** string
     custom_fs_read_from_flash((uint8_t*)&string_length, custom_fs_current_text_file_addr + string_offset, sizeof(string_length));
     
     /* Check string length (already contains terminating 0) */
-    if (string_length > sizeof(custom_fs_temp_string1))
+    if (string_length > max_length)
     {
-        string_length = sizeof(custom_fs_temp_string1);
+        string_length = max_length;
     }
     
     /* Read string : *2 because of uint16_t used to store chars */
-    custom_fs_read_from_flash((uint8_t*)custom_fs_temp_string1, custom_fs_current_text_file_addr + string_offset + sizeof(string_length), string_length*2);
+    custom_fs_read_from_flash((uint8_t*)string_pt, custom_fs_current_text_file_addr + string_offset + sizeof(string_length), string_length*2);
     
     /* Add terminating 0 just in case */
-    custom_fs_temp_string1[(sizeof(custom_fs_temp_string1)/sizeof(custom_fs_temp_string1[0]))-1] = 0;
+    string_pt[max_length-1] = 0;
+    
+    return RETURN_OK;
+}
+
+#ifdef CUSTOM_FS_STRING_CACHE
+/*! \fn     custom_fs_get_string_handle(uint32_t string_id, custom_fs_string_handle_t* handle_pt)
+*   \brief  Get a handle to a current language string, reading it in the least recently used cache slot if it isn't cached
+*   \param  string_id   String ID
+*   \param  handle_pt   Pointer to where to store the handle
+*   \return success status
+*   \note   The handle stays valid until its slot is reused, at the earliest after CUSTOM_FS_STRING_CACHE_NB_SLOTS other strings
+*/
+RET_TYPE custom_fs_get_string_handle(uint32_t string_id, custom_fs_string_handle_t* handle_pt)
+{
+    custom_fs_string_slot_t* lru_slot_pt = &custom_fs_string_cache_slots[0];
+    custom_fs_string_slot_t* slot_pt = 0;
+    
+    /* No string file for this language */
+    if (custom_fs_current_text_file_addr == 0)
+    {
+        return RETURN_NOK;
+    }
+    
+    /* Look for this string in the cache, for the current language */
+    for (uint16_t i = 0; i < CUSTOM_FS_STRING_CACHE_NB_SLOTS; i++)
+    {
+        if ((custom_fs_string_cache_slots[i].string_file_addr == custom_fs_current_text_file_addr) && (custom_fs_string_cache_slots[i].string_id == string_id))
+        {
+            slot_pt = &custom_fs_string_cache_slots[i];
+            break;
+        }
+        else if (custom_fs_string_cache_slots[i].last_used < lru_slot_pt->last_used)
+        {
+            lru_slot_pt = &custom_fs_string_cache_slots[i];
+        }
+    }
+    
+    if (slot_pt != 0)
+    {
+        custom_fs_string_cache_hits++;
+    }
+    else
+    {
+        /* Evict the least recently used slot, invalidating its handles */
+        custom_fs_string_cache_misses++;
+        slot_pt = lru_slot_pt;
+        slot_pt->string_file_addr = 0;
+        slot_pt->generation++;
+        if (custom_fs_read_string_from_file(string_id, slot_pt->string, sizeof(slot_pt->string)/sizeof(slot_pt->string[0])) != RETURN_OK)
+        {
+            slot_pt->last_used = 0;
+            return RETURN_NOK;
+        }
+        slot_pt->string_file_addr = custom_fs_current_text_file_addr;
+        slot_pt->string_id = string_id;
+    }
+    
+    slot_pt->last_used = ++custom_fs_string_cache_use_counter;
+    *handle_pt = ((custom_fs_string_handle_t)slot_pt->generation << 16) | (custom_fs_string_handle_t)(slot_pt - custom_fs_string_cache_slots);
+    return RETURN_OK;
+}
+
+/*! \fn     custom_fs_get_string_from_handle(custom_fs_string_handle_t handle)
+*   \brief  Get the string behind a handle
+*   \param  handle      Handle from custom_fs_get_string_handle()
+*   \return Pointer to the string, 0 if its cache slot was reused
+*/
+cust_char_t* custom_fs_get_string_from_handle(custom_fs_string_handle_t handle)
+{
+    uint16_t slot_index = (uint16_t)(handle & 0xFFFF);
+    
+    if ((slot_index >= CUSTOM_FS_STRING_CACHE_NB_SLOTS) || (custom_fs_string_cache_slots[slot_index].generation != (uint16_t)(handle >> 16)) || (custom_fs_string_cache_slots[slot_index].string_file_addr == 0))
+    {
+        return 0;
+    }
+    return custom_fs_string_cache_slots[slot_index].string;
+}
+#endif
+
+/*! \fn     custom_fs_get_string_from_file(uint32_t string_id, cust_char_t** string_pt)
+*   \brief  Read a string from a string file
+*   \param  string_id   String ID
+*   \param  string_pt   Pointer to the returned string
+*   \return success status
+*   \note   With CUSTOM_FS_STRING_CACHE, the string stays valid until its cache slot is reused, otherwise until the next call
+*/
+RET_TYPE custom_fs_get_string_from_file(uint32_t string_id, cust_char_t** string_pt)
+{
+    #ifdef CUSTOM_FS_STRING_CACHE
+    custom_fs_string_handle_t handle;
+    
+    if (custom_fs_get_string_handle(string_id, &handle) != RETURN_OK)
+    {
+        return RETURN_NOK;
+    }
+    *string_pt = custom_fs_get_string_from_handle(handle);
+    return RETURN_OK;
+    #else
+    if (custom_fs_read_string_from_file(string_id, custom_fs_temp_string1, sizeof(custom_fs_temp_string1)/sizeof(custom_fs_temp_string1[0])) != RETURN_OK)
+    {
+        return RETURN_NOK;
+    }
     
     /* Store pointer to string */
     *string_pt = custom_fs_temp_string1;
-    
     return RETURN_OK;
+    #endif
 }
 
 /*! \fn     custom_fs_get_file_address(uint32_t file_id, custom_fs_address_t* address)
@@ -286,7 +973,11 @@ RET_TYPE custom_fs_get_string_from_file(uint32_t string_id, cust_char_t** string
 RET_TYPE custom_fs_get_file_address(uint32_t file_id, custom_fs_address_t* address, custom_fs_file_type_te file_type)
 {
     custom_fs_address_t file_table_address;
+    custom_fs_address_t file_address;
     uint32_t language_offset = 0;
+    #ifdef CUSTOM_FS_FILE_TABLE_CACHE
+    custom_fs_file_table_window_t* window_pt = 0;
+    #endif
 
     // Check for invalid file index or flash not formatted
     if (file_type == CUSTOM_FS_STRING_TYPE)
@@ -298,6 +989,9 @@ RET_TYPE custom_fs_get_file_address(uint32_t file_id, custom_fs_address_t* addre
         else
         {
             file_table_address = custom_fs_flash_header.string_file_offset;
+            #ifdef CUSTOM_FS_FILE_TABLE_CACHE
+            window_pt = &custom_fs_file_table_windows[CUSTOM_FS_STRING_TABLE_WINDOW];
+            #endif
         }
     }
     else if (file_type == CUSTOM_FS_FONTS_TYPE)
@@ -312,6 +1006,9 @@ RET_TYPE custom_fs_get_file_address(uint32_t file_id, custom_fs_address_t* addre
         else
         {
             file_table_address = custom_fs_flash_header.fonts_file_offset;
+            #ifdef CUSTOM_FS_FILE_TABLE_CACHE
+            window_pt = &custom_fs_file_table_windows[CUSTOM_FS_FONTS_TABLE_WINDOW];
+            #endif
         }
     }
     else if (file_type == CUSTOM_FS_BITMAP_TYPE)
@@ -329,6 +1026,16 @@ RET_TYPE custom_fs_get_file_address(uint32_t file_id, custom_fs_address_t* addre
         else
         {
             file_table_address = custom_fs_flash_header.bitmap_file_offset;
+            #ifdef CUSTOM_FS_FILE_TABLE_CACHE
+            if (file_id >= custom_fs_flash_header.language_bitmap_starting_id)
+            {
+                window_pt = &custom_fs_file_table_windows[CUSTOM_FS_LANGUAGE_BITMAP_TABLE_WINDOW];
+            }
+            else
+            {
+                window_pt = &custom_fs_file_table_windows[CUSTOM_FS_BITMAP_TABLE_WINDOW];
+            }
+            #endif
         }
     }
     else if (file_type == CUSTOM_FS_BINARY_TYPE)
@@ -358,12 +1065,31 @@ RET_TYPE custom_fs_get_file_address(uint32_t file_id, custom_fs_address_t* addre
         return RETURN_NOK;
     }
 
-    /* Read the file address : <filecount> <fileid0><address0> <fileid1><address1> ... */
-    custom_fs_read_from_flash((uint8_t*)address, CUSTOM_FS_FILES_ADDR_OFFSET + file_table_address + (file_id + language_offset) * sizeof(*address), sizeof(*address));
+    #ifdef CUSTOM_FS_FILE_TABLE_CACHE
+    /* File address kept in RAM? */
+    if ((window_pt != 0) && ((file_id + language_offset - window_pt->first_index) < window_pt->nb_entries))
+    {
+        file_address = custom_fs_file_table_cache[window_pt->cache_index + file_id + language_offset - window_pt->first_index];
+    }
+    else
+    #endif
+    {
+        /* Read the file address : <filecount> <fileid0><address0> <fileid1><address1> ... */
+        custom_fs_read_from_flash((uint8_t*)&file_address, CUSTOM_FS_FILES_ADDR_OFFSET + file_table_address + (file_id + language_offset) * sizeof(file_address), sizeof(file_address));
+    }
     
     /* Add the file address offset */
-    *address += CUSTOM_FS_FILES_ADDR_OFFSET;
+    file_address += CUSTOM_FS_FILES_ADDR_OFFSET;
+    
+    #ifdef CUSTOM_FS_LAZY_FILE_CHECK
+    /* Corrupted files are reported when looked up, without returning their address */
+    if (custom_fs_check_file(file_type, file_id + language_offset, file_address) != RETURN_OK)
+    {
+        return RETURN_NOK;
+    }
+    #endif
     
+    *address = file_address;
     return RETURN_OK;
 }
 
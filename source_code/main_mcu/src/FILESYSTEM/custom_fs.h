@@ -19,10 +19,19 @@
 #define CUSTOM_FS_FILES_ADDR_OFFSET         0x0000
 // Magic address for the emergency font file
 #define CUSTOM_FS_EMERGENCY_FONT_FILE_ADDR  0x80000000UL
+// Flash cache line address for free lines
+#define CUSTOM_FS_FLASH_CACHE_FREE_LINE     0xFFFFFFFFUL
 // Magic number at the beginning of the flash header
 #define CUSTOM_FS_MAGIC_HEADER              0x12345678UL
+// Magic number at the beginning of the file CRC table
+#define CUSTOM_FS_FILE_CRC_MAGIC            0xC3C5F11EUL
 // Custom file flags
 #define CUSTOM_FS_BITMAP_RLE_FLAG   0x01
+// Magic number at the beginning of animation files
+#define CUSTOM_FS_ANIMATION_MAGIC   0xA1F5
+// Animation rectangle flags
+#define CUSTOM_FS_ANIMATION_XOR_FLAG    0x01
+#define CUSTOM_FS_ANIMATION_RLE_FLAG    0x02
 
 /* Typedefs */
 typedef uint32_t custom_fs_file_count_t;
@@ -32,9 +41,12 @@ typedef uint16_t custom_fs_string_count_t;
 typedef uint16_t custom_fs_string_length_t;
 typedef uint16_t custom_fs_string_offset_t;
 typedef uint32_t custom_fs_binfile_size_t;
+typedef uint32_t custom_fs_string_handle_t;
+typedef uint32_t custom_fs_prefetch_ticket_t;
 
 /* Enums */
 typedef enum {CUSTOM_FS_STRING_TYPE = 0, CUSTOM_FS_FONTS_TYPE = 1, CUSTOM_FS_BITMAP_TYPE = 2, CUSTOM_FS_BINARY_TYPE = 3, CUSTOM_FS_FW_UPDATE_TYPE = 4} custom_fs_file_type_te;
+typedef enum {CUSTOM_FS_STRING_TABLE_WINDOW = 0, CUSTOM_FS_FONTS_TABLE_WINDOW = 1, CUSTOM_FS_BITMAP_TABLE_WINDOW = 2, CUSTOM_FS_LANGUAGE_BITMAP_TABLE_WINDOW = 3, CUSTOM_FS_NB_TABLE_WINDOWS = 4} custom_fs_table_window_te;
     
 /* Structs */
 
@@ -70,6 +82,28 @@ typedef struct
     uint32_t language_bitmap_starting_id;
 } custom_file_flash_header_t;
 
+// Optional file CRC table, stored right after the bundle so older firmwares and bundles are unaffected:
+// magic number: to indicate the presence of the table
+// metadata size: number of bundle bytes between the header crc32 field and the first file
+// metadata crc32: crc32 of these bytes (signed hash, file tables, language map)
+// file count: number of entries, one per file table entry, tables in flash header order (update, string, fonts, bitmap, binary)
+// entries crc32: crc32 of the entries following this header
+typedef struct
+{
+    uint32_t magic;
+    uint32_t metadata_size;
+    uint32_t metadata_crc32;
+    uint32_t file_count;
+    uint32_t entries_crc32;
+} custom_fs_file_crc_header_t;
+
+// File CRC table entry
+typedef struct
+{
+    uint32_t size;              // File size, padding to the next file included
+    uint32_t crc32;             // crc32 of the file
+} custom_fs_file_crc_entry_t;
+
 // Platform settings
 typedef struct  
 {
@@ -91,6 +125,37 @@ typedef struct
     uint16_t data[];    //*< pointer to the image data
 } bitmap_t;
 
+// Animation header, stored as a binary file: <custom_fs_binfile_size_t size> <animation header> <frame 0> <frame 1> ...
+typedef struct
+{
+    uint16_t magic;             //*< CUSTOM_FS_ANIMATION_MAGIC
+    uint16_t nb_frames;         //*< Number of frames
+    uint16_t frame_period_ms;   //*< Recommended delay between frames
+    uint8_t depth;              //*< Number of bits per pixel, only 4 is supported
+    uint8_t flags;              //*< Reserved
+} animation_header_t;
+
+// Animation frame header, followed by its changed rectangles. The first frame has to redraw the complete screen
+typedef struct
+{
+    uint16_t nb_rects;          //*< Number of changed rectangles
+    uint16_t reserved;          //*< Reserved
+    uint32_t frame_size;        //*< Frame size, this header included
+} animation_frame_t;
+
+// Animation changed rectangle header, followed by data_size bytes of 2 pixels columns, row by row
+// CUSTOM_FS_ANIMATION_XOR_FLAG: data is xored with the previous frame pixels instead of replacing them
+// CUSTOM_FS_ANIMATION_RLE_FLAG: data is a sequence of <count-1> <byte> pairs
+typedef struct
+{
+    uint8_t column;             //*< First 2 pixels column
+    uint8_t y;                  //*< First row
+    uint8_t nb_columns;         //*< Number of 2 pixels columns
+    uint8_t height;             //*< Number of rows
+    uint16_t flags;             //*< Flags defining data format
+    uint16_t data_size;         //*< Number of data bytes
+} animation_rect_t;
+
 // Font header
 typedef struct
 {
@@ -117,6 +182,40 @@ typedef struct
     custom_fs_address_t glyph_data_offset;  // offset to glyph data
 } font_glyph_t;
 
+// Range of a file address table kept in RAM
+typedef struct
+{
+    uint32_t first_index;       // First table index kept in RAM
+    uint16_t nb_entries;        // Number of table entries kept in RAM
+    uint16_t cache_index;       // Where these entries are stored in the RAM table
+} custom_fs_file_table_window_t;
+
+// String cache slot, handles to its string are <generation> <slot index> on 16 bits each
+typedef struct
+{
+    uint32_t last_used;                     // Use counter value when last requested, for LRU eviction
+    custom_fs_address_t string_file_addr;   // Address of the language string file the string was read from, 0 if slot is free
+    uint32_t string_id;                     // String ID in the string file
+    uint16_t generation;                    // Incremented when the slot is emptied, invalidating previous handles
+    cust_char_t string[CUSTOM_FS_STRING_CACHE_MAX_LENGTH];
+} custom_fs_string_slot_t;
+
+// Flash cache line
+typedef struct
+{
+    uint32_t last_used;                     // Use counter value when last read, for LRU eviction
+    custom_fs_address_t address;            // Flash address of the line, CUSTOM_FS_FLASH_CACHE_FREE_LINE if line is free
+    uint8_t data[CUSTOM_FS_FLASH_CACHE_LINE_SIZE];
+} custom_fs_flash_cache_line_t;
+
+// Prefetch request, serviced in ticket order
+typedef struct
+{
+    custom_fs_address_t address;            // Where to read the data
+    uint8_t* datap;                         // Where to store the data
+    uint16_t size;                          // Number of bytes to read, 0 if request was cancelled
+} custom_fs_prefetch_request_t;
+
 // Language map entry
 typedef struct
 {
@@ -139,6 +238,7 @@ uint32_t custom_fs_get_custom_storage_slot_addr(uint32_t slot_id);
 RET_TYPE custom_fs_compute_and_check_external_bundle_crc32(void);
 ret_type_te custom_fs_set_current_language(uint16_t language_id);
 cust_char_t* custom_fs_get_current_language_text_desc(void);
+custom_fs_address_t custom_fs_get_current_string_file_address(void);
 custom_fs_init_ret_type_te custom_fs_settings_init(void);
 void custom_fs_stop_continuous_read_from_flash(void);
 BOOL custom_fs_settings_check_fw_upgrade_flag(void);
@@ -149,10 +249,50 @@ uint32_t custom_fs_get_number_of_languages(void);
 BOOL custom_fs_is_first_boot(void);
 ret_type_te custom_fs_init(void);
 
+/* Depending on enabled features */
+#ifdef CUSTOM_FS_STRING_CACHE
+RET_TYPE custom_fs_get_string_handle(uint32_t string_id, custom_fs_string_handle_t* handle_pt);
+cust_char_t* custom_fs_get_string_from_handle(custom_fs_string_handle_t handle);
+#endif
+#ifdef CUSTOM_FS_PREFETCH
+RET_TYPE custom_fs_prefetch_enqueue(uint8_t* datap, custom_fs_address_t address, uint16_t size, custom_fs_prefetch_ticket_t* ticket_pt);
+BOOL custom_fs_prefetch_is_done(custom_fs_prefetch_ticket_t ticket);
+void custom_fs_prefetch_cancel(custom_fs_prefetch_ticket_t ticket);
+void custom_fs_prefetch_wait(custom_fs_prefetch_ticket_t ticket);
+void custom_fs_prefetch_finish_ongoing_transfer(void);
+void custom_fs_prefetch_routine(void);
+#endif
+#ifdef CUSTOM_FS_FLASH_CACHE
+void custom_fs_flash_cache_invalidate(custom_fs_address_t address, uint32_t size);
+void custom_fs_flash_cache_clear(void);
+#endif
+
 /* Global vars, for debug only */
 #if defined(DEBUG_MENU_ENABLED)
     extern custom_file_flash_header_t custom_fs_flash_header;
     extern language_map_entry_t custom_fs_cur_language_entry;
+    #ifdef CUSTOM_FS_FILE_TABLE_CACHE
+    extern uint16_t custom_fs_file_table_cache_fill;
+    #endif
+    #ifdef CUSTOM_FS_STRING_CACHE
+    extern uint32_t custom_fs_string_cache_misses;
+    extern uint32_t custom_fs_string_cache_hits;
+    #endif
+    #ifdef CUSTOM_FS_FLASH_CACHE
+    extern uint32_t custom_fs_flash_cache_bytes_saved;
+    extern uint32_t custom_fs_flash_cache_misses;
+    extern uint32_t custom_fs_flash_cache_hits;
+    #endif
+    #ifdef CUSTOM_FS_PREFETCH
+    extern uint32_t custom_fs_prefetch_bus_waits;
+    extern uint32_t custom_fs_prefetch_completed;
+    #endif
+    #ifdef CUSTOM_FS_LAZY_FILE_CHECK
+    extern BOOL custom_fs_file_crc_table_found;
+    extern uint32_t custom_fs_checked_bytes;
+    extern uint32_t custom_fs_nb_checked_files;
+    extern uint32_t custom_fs_nb_corrupted_files;
+    #endif
 #endif   
 
 #endif /* CUSTOM_FS_H_ */
@@ -7,6 +7,7 @@
 #include "driver_sercom.h"
 #include "driver_timer.h"
 #include "dataflash.h"
+#include "custom_fs.h"
 #include "defines.h"
 
 
@@ -22,6 +23,15 @@ void dataflash_write_array_to_memory(spi_flash_descriptor_t* descriptor_pt, uint
 {
     uint32_t nb_bytes_to_write = 0;
     
+    #ifdef CUSTOM_FS_PREFETCH
+    /* Release the bus from a prefetch transfer */
+    custom_fs_prefetch_finish_ongoing_transfer();
+    #endif
+    #ifdef CUSTOM_FS_FLASH_CACHE
+    /* Drop cached copies of the overwritten data */
+    custom_fs_flash_cache_invalidate(address, length);
+    #endif
+    
     /* First run: check if we're aligned and compute number of bytes to write accordingly */
     if ((address & 0x0FF) != 0)
     {
@@ -246,6 +256,12 @@ void dataflash_wait_for_not_busy(spi_flash_descriptor_t* descriptor_pt)
 void dataflash_erase_64kb_block(spi_flash_descriptor_t* descriptor_pt, uint32_t address)
 {
     uint8_t erase_64kb_cmd[] = {0xD8, (uint8_t)((address >> 16) & 0xFF), (uint8_t)((address >> 8) & 0xFF), (uint8_t)((address >> 0) & 0xFF)};
+    #ifdef CUSTOM_FS_PREFETCH
+    custom_fs_prefetch_finish_ongoing_transfer();
+    #endif
+    #ifdef CUSTOM_FS_FLASH_CACHE
+    custom_fs_flash_cache_invalidate(address & 0xFFFF0000UL, 0x10000UL);
+    #endif
     dataflash_send_write_enable(descriptor_pt);
     dataflash_send_command(descriptor_pt, erase_64kb_cmd, sizeof(erase_64kb_cmd));
 } 
@@ -256,6 +272,12 @@ void dataflash_erase_64kb_block(spi_flash_descriptor_t* descriptor_pt, uint32_t
 */
 void dataflash_bulk_erase_with_wait(spi_flash_descriptor_t* descriptor_pt)
 {
+    #ifdef CUSTOM_FS_PREFETCH
+    custom_fs_prefetch_finish_ongoing_transfer();
+    #endif
+    #ifdef CUSTOM_FS_FLASH_CACHE
+    custom_fs_flash_cache_clear();
+    #endif
     dataflash_send_write_enable(descriptor_pt);
     dataflash_send_single_byte_command(descriptor_pt, 0xC7);
     dataflash_wait_for_not_busy(descriptor_pt);
@@ -267,6 +289,12 @@ void dataflash_bulk_erase_with_wait(spi_flash_descriptor_t* descriptor_pt)
 */
 void dataflash_bulk_erase_without_wait(spi_flash_descriptor_t* descriptor_pt)
 {
+    #ifdef CUSTOM_FS_PREFETCH
+    custom_fs_prefetch_finish_ongoing_transfer();
+    #endif
+    #ifdef CUSTOM_FS_FLASH_CACHE
+    custom_fs_flash_cache_clear();
+    #endif
     dataflash_send_write_enable(descriptor_pt);
     dataflash_send_single_byte_command(descriptor_pt, 0xC7);
 }
@@ -0,0 +1,274 @@
+/*!  \file     gui_list.c
+*    \brief    Scrolling list widget, only redrawing what changed
+*    Created:  17/10/2026
+*/
+#include <string.h>
+#include <asf.h>
+#include "platform_defines.h"
+#include "gui_list.h"
+#include "sh1122.h"
+
+/* Rows are drawn in the frame buffer if we have one */
+#ifdef OLED_INTERNAL_FRAME_BUFFER
+    #define GUI_LIST_WRITE_TO_BUFFER    TRUE
+#else
+    #define GUI_LIST_WRITE_TO_BUFFER    FALSE
+#endif
+
+
+/*! \fn     gui_list_init(gui_list_t* list, int16_t y, uint8_t row_height, uint8_t nb_rows, uint16_t nb_items, gui_list_fetch_item_t fetch_item)
+*   \brief  Initialize a list spanning the display width
+*   \param  list            Pointer to the list
+*   \param  y               List top y
+*   \param  row_height      Row height in pixels
+*   \param  nb_rows         Number of displayed rows, from 1 to GUI_LIST_MAX_NB_ROWS
+*   \param  nb_items        Number of items in the list
+*   \param  fetch_item      Function filling an item string, only called for items getting displayed
+*   \return RETURN_NOK if nb_rows is 0 or if the rows do not fit in the display, the list then being empty
+*/
+RET_TYPE gui_list_init(gui_list_t* list, int16_t y, uint8_t row_height, uint8_t nb_rows, uint16_t nb_items, gui_list_fetch_item_t fetch_item)
+{
+    memset((void*)list, 0x00, sizeof(*list));
+    
+    /* Items are stored in row item_index % nb_rows, scrolls move frame buffer rows */
+    if (nb_rows > GUI_LIST_MAX_NB_ROWS)
+    {
+        nb_rows = GUI_LIST_MAX_NB_ROWS;
+    }
+    if ((nb_rows == 0) || (y < 0) || ((y + nb_rows * row_height) > SH1122_OLED_HEIGHT))
+    {
+        return RETURN_NOK;
+    }
+    
+    list->nb_rows = nb_rows;
+    list->fetch_item = fetch_item;
+    list->row_height = row_height;
+    list->nb_items = nb_items;
+    list->y = y;
+    gui_list_invalidate(list);
+    return RETURN_OK;
+}
+
+/*! \fn     gui_list_invalidate(gui_list_t* list)
+*   \brief  Force the complete list to be fetched and drawn at the next render
+*   \param  list            Pointer to the list
+*   \note   To be called when the list area was overwritten or the items changed
+*/
+void gui_list_invalidate(gui_list_t* list)
+{
+    for (uint16_t i = 0; i < list->nb_rows; i++)
+    {
+        list->rows[i].item_index = GUI_LIST_NO_ITEM;
+    }
+    list->drawn_first_item = GUI_LIST_NO_ITEM;
+    list->area_clear_needed = TRUE;
+}
+
+/*! \fn     gui_list_invalidate_item(gui_list_t* list, uint16_t item_index)
+*   \brief  Force an item to be fetched again and redrawn at the next render, if displayed
+*   \param  list            Pointer to the list
+*   \param  item_index      Item index
+*/
+void gui_list_invalidate_item(gui_list_t* list, uint16_t item_index)
+{
+    gui_list_row_t* row_pt;
+    
+    if (item_index >= list->nb_items)
+    {
+        return;
+    }
+    
+    row_pt = &list->rows[item_index % list->nb_rows];
+    if (row_pt->item_index == item_index)
+    {
+        row_pt->item_index = GUI_LIST_NO_ITEM;
+    }
+}
+
+/*! \fn     gui_list_mark_item_for_redraw(gui_list_t* list, uint16_t item_index)
+*   \brief  Mark an item row as needing a redraw, if it stores the item
+*   \param  list            Pointer to the list
+*   \param  item_index      Item index
+*/
+static void gui_list_mark_item_for_redraw(gui_list_t* list, uint16_t item_index)
+{
+    gui_list_row_t* row_pt = &list->rows[item_index % list->nb_rows];
+    
+    if (row_pt->item_index == item_index)
+    {
+        row_pt->redraw_needed = TRUE;
+    }
+}
+
+/*! \fn     gui_list_select_item(gui_list_t* list, uint16_t item_index)
+*   \brief  Select an item, scrolling the list so it is displayed
+*   \param  list            Pointer to the list
+*   \param  item_index      Item index
+*/
+void gui_list_select_item(gui_list_t* list, uint16_t item_index)
+{
+    if ((item_index >= list->nb_items) || (item_index == list->selected_item))
+    {
+        return;
+    }
+    
+    /* Selection highlight changes */
+    gui_list_mark_item_for_redraw(list, list->selected_item);
+    gui_list_mark_item_for_redraw(list, item_index);
+    list->selected_item = item_index;
+    
+    /* Scroll as little as possible */
+    if (item_index < list->first_item)
+    {
+        list->first_item = item_index;
+    }
+    else if (item_index >= list->first_item + list->nb_rows)
+    {
+        list->first_item = item_index - list->nb_rows + 1;
+    }
+}
+
+/*! \fn     gui_list_move_selection(gui_list_t* list, int16_t offset)
+*   \brief  Move the selection by a given number of items, wrapping around the list ends
+*   \param  list            Pointer to the list
+*   \param  offset          Signed number of items, typically from a wheel action
+*/
+void gui_list_move_selection(gui_list_t* list, int16_t offset)
+{
+    int32_t item_index = (int32_t)list->selected_item + offset;
+    
+    if (list->nb_items == 0)
+    {
+        return;
+    }
+    
+    item_index %= list->nb_items;
+    if (item_index < 0)
+    {
+        item_index += list->nb_items;
+    }
+    gui_list_select_item(list, (uint16_t)item_index);
+}
+
+/*! \fn     gui_list_get_selected_item(gui_list_t* list)
+*   \brief  Get the selected item index
+*   \param  list            Pointer to the list
+*   \return Selected item index
+*/
+uint16_t gui_list_get_selected_item(gui_list_t* list)
+{
+    return list->selected_item;
+}
+
+/*! \fn     gui_list_fetch_row(gui_list_t* list, uint16_t item_index)
+*   \brief  Store an item in its row
+*   \param  list            Pointer to the list
+*   \param  item_index      Item index
+*/
+static void gui_list_fetch_row(gui_list_t* list, uint16_t item_index)
+{
+    gui_list_row_t* row_pt = &list->rows[item_index % list->nb_rows];
+    
+    /* Fetch the string once, rows are then redrawn from RAM */
+    row_pt->string[0] = 0;
+    list->fetch_item(item_index, row_pt->string, GUI_LIST_ROW_MAX_LENGTH);
+    row_pt->string[GUI_LIST_ROW_MAX_LENGTH] = 0;
+    row_pt->item_index = item_index;
+    row_pt->redraw_needed = TRUE;
+    list->nb_fetches++;
+}
+
+/*! \fn     gui_list_draw_row(sh1122_descriptor_t* oled_descriptor, gui_list_t* list, uint16_t item_index)
+*   \brief  Draw an item row
+*   \param  oled_descriptor Pointer to a sh1122 descriptor struct
+*   \param  list            Pointer to the list
+*   \param  item_index      Item index, must be displayed
+*/
+static void gui_list_draw_row(sh1122_descriptor_t* oled_descriptor, gui_list_t* list, uint16_t item_index)
+{
+    gui_list_row_t* row_pt = &list->rows[item_index % list->nb_rows];
+    int16_t y = list->y + (item_index - list->first_item) * list->row_height;
+    
+    /* Clear row, draw cursor and string */
+    sh1122_draw_rectangle(oled_descriptor, 0, y, SH1122_OLED_WIDTH, list->row_height, 0x00, GUI_LIST_WRITE_TO_BUFFER);
+    if (item_index == list->selected_item)
+    {
+        sh1122_put_string_xy(oled_descriptor, 0, y, OLED_ALIGN_LEFT, u"-", GUI_LIST_WRITE_TO_BUFFER);
+    }
+    sh1122_put_ellipsized_string_xy(oled_descriptor, GUI_LIST_TEXT_X, y, OLED_ALIGN_LEFT, row_pt->string, GUI_LIST_WRITE_TO_BUFFER);
+    row_pt->redraw_needed = FALSE;
+    list->nb_row_draws++;
+}
+
+/*! \fn     gui_list_render(sh1122_descriptor_t* oled_descriptor, gui_list_t* list)
+*   \brief  Draw the list rows that changed since the last render
+*   \param  oled_descriptor Pointer to a sh1122 descriptor struct
+*   \param  list            Pointer to the list
+*   \return Number of rows drawn
+*   \note   Only items scrolled into view are fetched. With a frame buffer, rows kept on screen by a scroll are moved rather than redrawn
+*/
+uint16_t gui_list_render(sh1122_descriptor_t* oled_descriptor, gui_list_t* list)
+{
+    uint16_t nb_row_draws = list->nb_row_draws;
+    uint16_t last_item = list->first_item + list->nb_rows;
+    
+    if (last_item > list->nb_items)
+    {
+        last_item = list->nb_items;
+    }
+    
+    /* List area overwritten: clear it */
+    if (list->area_clear_needed != FALSE)
+    {
+        sh1122_draw_rectangle(oled_descriptor, 0, list->y, SH1122_OLED_WIDTH, list->nb_rows * list->row_height, 0x00, GUI_LIST_WRITE_TO_BUFFER);
+        list->area_clear_needed = FALSE;
+        for (uint16_t i = 0; i < list->nb_rows; i++)
+        {
+            list->rows[i].redraw_needed = TRUE;
+        }
+    }
+    else if (list->drawn_first_item != list->first_item)
+    {
+        #ifdef OLED_INTERNAL_FRAME_BUFFER
+        int16_t nb_scrolled_rows = (int16_t)list->first_item - (int16_t)list->drawn_first_item;
+        int16_t nb_kept_rows = list->nb_rows - ((nb_scrolled_rows < 0) ? -nb_scrolled_rows : nb_scrolled_rows);
+    
+        /* Rows staying on screen: move their pixels, other rows are recycled below */
+        if (nb_kept_rows > 0)
+        {
+            int16_t kept_rows_src_y = list->y + ((nb_scrolled_rows > 0) ? nb_scrolled_rows * list->row_height : 0);
+            int16_t kept_rows_dst_y = list->y + ((nb_scrolled_rows > 0) ? 0 : -nb_scrolled_rows * list->row_height);
+            sh1122_move_frame_buffer_rows(oled_descriptor, kept_rows_dst_y, kept_rows_src_y, nb_kept_rows * list->row_height);
+        }
+        else
+        {
+            for (uint16_t i = 0; i < list->nb_rows; i++)
+            {
+                list->rows[i].redraw_needed = TRUE;
+            }
+        }
+        #else
+        /* Rows staying on screen are redrawn, but not fetched again */
+        for (uint16_t i = 0; i < list->nb_rows; i++)
+        {
+            list->rows[i].redraw_needed = TRUE;
+        }
+        #endif
+    }
+    list->drawn_first_item = list->first_item;
+    
+    /* Recycle rows of items scrolled out, draw rows that changed */
+    for (uint16_t i = list->first_item; i < last_item; i++)
+    {
+        if (list->rows[i % list->nb_rows].item_index != i)
+        {
+            gui_list_fetch_row(list, i);
+        }
+        if (list->rows[i % list->nb_rows].redraw_needed != FALSE)
+        {
+            gui_list_draw_row(oled_descriptor, list, i);
+        }
+    }
+    
+    return (uint16_t)(list->nb_row_draws - nb_row_draws);
+}
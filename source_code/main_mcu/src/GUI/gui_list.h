@@ -0,0 +1,54 @@
+/*!  \file     gui_list.h
+*    \brief    Scrolling list widget, only redrawing what changed
+*    Created:  17/10/2026
+*/
+
+
+#ifndef GUI_LIST_H_
+#define GUI_LIST_H_
+
+#include "defines.h"
+#include "sh1122.h"
+
+/* Defines */
+#define GUI_LIST_MAX_NB_ROWS        6       // Max number of displayed rows
+#define GUI_LIST_ROW_MAX_LENGTH     32      // Max number of characters kept per row
+#define GUI_LIST_TEXT_X             10      // Item text x, the selection cursor being drawn at x 0
+#define GUI_LIST_NO_ITEM            0xFFFF  // Item index of rows not storing an item
+
+/* Typedefs */
+typedef void (*gui_list_fetch_item_t)(uint16_t item_index, cust_char_t* string, uint16_t max_length);
+
+typedef struct
+{
+    cust_char_t string[GUI_LIST_ROW_MAX_LENGTH+1];  // Item string, ellipsized when drawn if wider than the display
+    uint16_t item_index;                            // Index of the stored item, GUI_LIST_NO_ITEM if none
+    BOOL redraw_needed;                             // Set when the row needs to be redrawn
+} gui_list_row_t;
+
+typedef struct
+{
+    gui_list_row_t rows[GUI_LIST_MAX_NB_ROWS];      // Rows, item i being stored in row i % nb_rows
+    gui_list_fetch_item_t fetch_item;               // Function filling an item string
+    uint16_t nb_items;                              // Number of items in the list
+    uint16_t selected_item;                         // Selected item index
+    uint16_t first_item;                            // First displayed item index
+    uint16_t drawn_first_item;                      // First item index when the list was last drawn
+    int16_t y;                                      // List top y
+    uint8_t row_height;                             // Row height in pixels
+    uint8_t nb_rows;                                // Number of displayed rows
+    BOOL area_clear_needed;                         // Set when the list area needs to be cleared before drawing rows
+    uint32_t nb_fetches;                            // Number of item strings fetched, for benchmarking
+    uint32_t nb_row_draws;                          // Number of rows drawn, for benchmarking
+} gui_list_t;
+
+/* Prototypes */
+RET_TYPE gui_list_init(gui_list_t* list, int16_t y, uint8_t row_height, uint8_t nb_rows, uint16_t nb_items, gui_list_fetch_item_t fetch_item);
+uint16_t gui_list_render(sh1122_descriptor_t* oled_descriptor, gui_list_t* list);
+void gui_list_invalidate_item(gui_list_t* list, uint16_t item_index);
+void gui_list_select_item(gui_list_t* list, uint16_t item_index);
+void gui_list_move_selection(gui_list_t* list, int16_t offset);
+uint16_t gui_list_get_selected_item(gui_list_t* list);
+void gui_list_invalidate(gui_list_t* list);
+
+#endif /* GUI_LIST_H_ */
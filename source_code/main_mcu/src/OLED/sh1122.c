@@ -53,6 +53,11 @@ static const uint8_t sh1122_init_sequence[] =
 */
 void sh1122_write_single_command(sh1122_descriptor_t* oled_descriptor, uint8_t reg)
 {
+    #ifdef OLED_INTERNAL_FRAME_BUFFER
+    /* Commands can't be sent during a DMA transfer to the display RAM */
+    sh1122_check_for_flush_and_terminate(oled_descriptor);
+    #endif
+    
     PORT->Group[oled_descriptor->sh1122_cs_pin_group].OUTCLR.reg = oled_descriptor->sh1122_cs_pin_mask;
     PORT->Group[oled_descriptor->sh1122_cd_pin_group].OUTCLR.reg = oled_descriptor->sh1122_cd_pin_mask;
     sercom_spi_send_single_byte(oled_descriptor->sercom_pt, reg);
@@ -114,6 +119,7 @@ void sh1122_set_contrast_current(sh1122_descriptor_t* oled_descriptor, uint8_t c
 {
     sh1122_write_single_command(oled_descriptor, SH1122_CMD_SET_CONTRAST_CURRENT);
     sh1122_write_single_data(oled_descriptor, contrast_current);    
+    oled_descriptor->contrast_current = contrast_current;
 }
 
 /*! \fn     sh1122_set_master_current(sh1122_descriptor_t* oled_descriptor, uint8_t contrast_current)
@@ -159,6 +165,7 @@ void sh1122_move_display_start_line(sh1122_descriptor_t* oled_descriptor, int16_
 {    
     sh1122_write_single_command(oled_descriptor, SH1122_CMD_SET_DISPLAY_START_LINE);
     sh1122_write_single_data(oled_descriptor, (uint8_t)offset);   
+    oled_descriptor->display_start_line = (uint8_t)offset;
 }
 
 /*! \fn     sh1122_set_min_text_x(sh1122_descriptor_t* oled_descriptor, int16_t x)
@@ -199,33 +206,203 @@ void sh1122_flip_displayed_buffer(sh1122_descriptor_t* oled_descriptor)
     sh1122_move_display_start_line(oled_descriptor, SH1122_OLED_HEIGHT);
 }
 
+/*! \fn     sh1122_start_transition(sh1122_transition_t* transition_pt, int16_t current_value, int16_t target_value, int16_t step, uint32_t step_period_ms)
+*   \brief  Schedule a transition, performed by sh1122_transitions_routine()
+*   \param  transition_pt       Pointer to the transition
+*   \param  current_value       Value at the start of the transition
+*   \param  target_value        Value at the end of the transition
+*   \param  step                Absolute value increment per step
+*   \param  step_period_ms      Delay in ms between steps
+*/
+static void sh1122_start_transition(sh1122_transition_t* transition_pt, int16_t current_value, int16_t target_value, int16_t step, uint32_t step_period_ms)
+{
+    transition_pt->next_step_time = timer_get_systick() + step_period_ms;
+    transition_pt->step = (target_value >= current_value) ? step : -step;
+    transition_pt->step_period_ms = step_period_ms;
+    transition_pt->current_value = current_value;
+    transition_pt->target_value = target_value;
+    transition_pt->in_progress = (current_value != target_value) ? TRUE : FALSE;
+}
+
+/*! \fn     sh1122_transition_step(sh1122_transition_t* transition_pt, uint32_t systick)
+*   \brief  Advance a transition if its next step is due
+*   \param  transition_pt       Pointer to the transition
+*   \param  systick             Current systick value
+*   \return TRUE if the transition value changed
+*/
+static BOOL sh1122_transition_step(sh1122_transition_t* transition_pt, uint32_t systick)
+{
+    /* Transition in progress and step due? */
+    if ((transition_pt->in_progress == FALSE) || ((int32_t)(systick - transition_pt->next_step_time) < 0))
+    {
+        return FALSE;
+    }
+    
+    /* Next step, don't go further than the target */
+    transition_pt->current_value += transition_pt->step;
+    if (((transition_pt->step > 0) && (transition_pt->current_value >= transition_pt->target_value)) || ((transition_pt->step < 0) && (transition_pt->current_value <= transition_pt->target_value)))
+    {
+        transition_pt->current_value = transition_pt->target_value;
+        transition_pt->in_progress = FALSE;
+    }
+    
+    /* Schedule next step from now, steps are skipped rather than bursted if we're late */
+    transition_pt->next_step_time = systick + transition_pt->step_period_ms;
+    return TRUE;
+}
+
+/*! \fn     sh1122_transitions_routine(sh1122_descriptor_t* oled_descriptor)
+*   \brief  Perform the due display transition steps
+*   \param  oled_descriptor     Pointer to a sh1122 descriptor struct
+*   \note   To be called from the main loop, as it sends commands to the display
+*/
+void sh1122_transitions_routine(sh1122_descriptor_t* oled_descriptor)
+{
+    uint32_t systick = timer_get_systick();
+    
+    #ifdef OLED_INTERNAL_FRAME_BUFFER
+    /* Done flush: display RAM writes stopped, flushed hidden page displayed */
+    sh1122_check_for_flush_completion(oled_descriptor);
+    #endif
+    
+    /* Display start line */
+    if (sh1122_transition_step(&oled_descriptor->start_line_transition, systick) != FALSE)
+    {
+        sh1122_move_display_start_line(oled_descriptor, oled_descriptor->start_line_transition.current_value & SH1122_OLED_START_LINE_MASK);
+    }
+    
+    /* Contrast current */
+    if (sh1122_transition_step(&oled_descriptor->contrast_transition, systick) != FALSE)
+    {
+        sh1122_set_contrast_current(oled_descriptor, (uint8_t)oled_descriptor->contrast_transition.current_value);
+    }
+    
+    #ifdef OLED_MARQUEE
+    /* Marquee scroll */
+    sh1122_marquee_routine(oled_descriptor);
+    #endif
+}
+
+/*! \fn     sh1122_is_transition_in_progress(sh1122_descriptor_t* oled_descriptor)
+*   \brief  Know if a display transition is in progress
+*   \param  oled_descriptor     Pointer to a sh1122 descriptor struct
+*   \return TRUE if a transition isn't finished
+*/
+BOOL sh1122_is_transition_in_progress(sh1122_descriptor_t* oled_descriptor)
+{
+    if ((oled_descriptor->start_line_transition.in_progress != FALSE) || (oled_descriptor->contrast_transition.in_progress != FALSE))
+    {
+        return TRUE;
+    } 
+    else
+    {
+        return FALSE;
+    }
+}
+
+/*! \fn     sh1122_wait_for_transitions_end(sh1122_descriptor_t* oled_descriptor)
+*   \brief  Perform display transitions until they are all finished
+*   \param  oled_descriptor     Pointer to a sh1122 descriptor struct
+*   \note   Blocking: loop on sh1122_is_transition_in_progress() to keep servicing other routines
+*/
+void sh1122_wait_for_transitions_end(sh1122_descriptor_t* oled_descriptor)
+{
+    while (sh1122_is_transition_in_progress(oled_descriptor) != FALSE)
+    {
+        sh1122_transitions_routine(oled_descriptor);
+    }
+}
+
 /*! \fn     sh1122_flip_buffers(sh1122_descriptor_t* oled_descriptor, oled_scroll_te scroll_mode, uint32_t delay)
 *   \brief  Flip buffer using scrolling
 *   \param  oled_descriptor     Pointer to a sh1122 descriptor struct
 *   \param  scroll_mode         Scrolling mode (see enum)
 *   \param  delay               Delay in ms between line scrolls
+*   \note   Non blocking: scrolling is performed by sh1122_transitions_routine()
 */
 void sh1122_flip_buffers(sh1122_descriptor_t* oled_descriptor, oled_scroll_te scroll_mode, uint32_t delay)
 {
-    int16_t offset = (scroll_mode == OLED_SCROLL_UP ? 1 : -1);
+    int16_t start_line = oled_descriptor->display_start_line;
+    
+    if (scroll_mode == OLED_SCROLL_UP)
+    {
+        sh1122_start_transition(&oled_descriptor->start_line_transition, start_line, start_line + SH1122_OLED_HEIGHT, 1, delay);
+    }
+    else if (scroll_mode == OLED_SCROLL_DOWN)
+    {
+        sh1122_start_transition(&oled_descriptor->start_line_transition, start_line, start_line - SH1122_OLED_HEIGHT, 1, delay);
+    }
+    else
+    {
+        /* Immediate flip, cancelling a possible ongoing scroll */
+        oled_descriptor->start_line_transition.in_progress = FALSE;
+        sh1122_move_display_start_line(oled_descriptor, (start_line + SH1122_OLED_HEIGHT) & SH1122_OLED_START_LINE_MASK);
+    }
+}
+
+/*! \fn     sh1122_start_contrast_transition(sh1122_descriptor_t* oled_descriptor, uint8_t target_contrast, uint8_t step, uint32_t step_period_ms)
+*   \brief  Fade the contrast current to a given value
+*   \param  oled_descriptor     Pointer to a sh1122 descriptor struct
+*   \param  target_contrast     Contrast current at the end of the transition
+*   \param  step                Contrast current increment per step
+*   \param  step_period_ms      Delay in ms between steps
+*   \note   Non blocking: fading is performed by sh1122_transitions_routine()
+*/
+void sh1122_start_contrast_transition(sh1122_descriptor_t* oled_descriptor, uint8_t target_contrast, uint8_t step, uint32_t step_period_ms)
+{
+    sh1122_start_transition(&oled_descriptor->contrast_transition, oled_descriptor->contrast_current, target_contrast, (step == 0) ? 1 : step, step_period_ms);
+}
+
+/*! \fn     sh1122_send_fill_bytes(sh1122_descriptor_t* oled_descriptor, uint8_t fill_byte, uint16_t nb_bytes, BOOL leave_running)
+*   \brief  Send the same byte several times to the display RAM, data sending being started
+*   \param  oled_descriptor     Pointer to a sh1122 descriptor struct
+*   \param  fill_byte           Byte to be sent
+*   \param  nb_bytes            Number of bytes to send, non 0
+*   \param  leave_running       Set to TRUE to return while the bytes are sent, data sending being then stopped by sh1122_check_for_flush_and_terminate()
+*   \return TRUE if the transfer was left running
+*/
+static BOOL sh1122_send_fill_bytes(sh1122_descriptor_t* oled_descriptor, uint8_t fill_byte, uint16_t nb_bytes, BOOL leave_running)
+{
+    #ifdef OLED_DMA_TRANSFER
+    /* Same byte sent by the DMA controller */
+    oled_descriptor->dma_fill_byte = fill_byte;
+    dma_oled_init_fill_transfer((void*)&oled_descriptor->sercom_pt->SPI.DATA.reg, &oled_descriptor->dma_fill_byte, nb_bytes, oled_descriptor->dma_trigger_id);
+    
+    #ifdef OLED_INTERNAL_FRAME_BUFFER
+    /* Terminated like a frame buffer flush, at the latest before the next display command, but not counted in the flush stats */
+    if (leave_running != FALSE)
+    {
+        oled_descriptor->display_fill_in_progress = TRUE;
+        return TRUE;
+    }
+    #endif
     
-    for (uint8_t ind = 0; ind < SH1122_OLED_HEIGHT; ind++)
+    /* Wait for data to be transferred */
+    while(dma_oled_check_and_clear_dma_transfer_flag() == FALSE);
+    #else
+    for (uint16_t i = 0; i < nb_bytes; i++)
     {
-        sh1122_move_display_start_line(oled_descriptor, offset);
-        timer_delay_ms(delay);
+        sercom_spi_send_single_byte_without_receive_wait(oled_descriptor->sercom_pt, fill_byte);
     }
+    #endif
+    
+    return FALSE;
 }
 
 /*! \fn     sh1122_fill_screen(sh1122_descriptor_t* oled_descriptor, uint8_t color)
 *   \brief  Fill the sh1122 screen with a given color
 *   \param  oled_descriptor     Pointer to a sh1122 descriptor struct
 *   \param  color               Color (4 bits value)
-*   \note   timed at 8.3ms
+*   \note   timed at 8.3ms when sent by the CPU. With DMA transfers and a frame buffer, the function returns while the screen is filled
 */
 void sh1122_fill_screen(sh1122_descriptor_t* oled_descriptor, uint16_t color)
 {
     uint8_t fill_color = (uint8_t)((color & 0x000F) | (color << 4));
-    uint32_t i;
+    
+    #ifdef OLED_INTERNAL_FRAME_BUFFER
+    /* Display contents won't match the frame buffer anymore */
+    sh1122_frame_buffer_mark_dirty(oled_descriptor, 0, 0, SH1122_OLED_WIDTH, SH1122_OLED_HEIGHT, FALSE);
+    #endif
     
     /* Select a square that fits the complete screen */
     sh1122_set_row_address(oled_descriptor, 0);
@@ -233,10 +410,11 @@ void sh1122_fill_screen(sh1122_descriptor_t* oled_descriptor, uint16_t color)
 
     /* Start filling the SSD1322 RAM */
     sh1122_start_data_sending(oled_descriptor);
-    for (i = 0; i < SH1122_OLED_HEIGHT * SH1122_OLED_WIDTH / 2; i++)
+    if (sh1122_send_fill_bytes(oled_descriptor, fill_color, SH1122_OLED_HEIGHT * SH1122_OLED_WIDTH / 2, TRUE) != FALSE)
     {
-        sercom_spi_send_single_byte_without_receive_wait(oled_descriptor->sercom_pt, fill_color);
-    }   
+        /* Transfer left running, terminated like a frame buffer flush */
+        return;
+    }
     sercom_spi_wait_for_transmit_complete(oled_descriptor->sercom_pt);
     sh1122_stop_data_sending(oled_descriptor);
 }
@@ -262,1063 +440,3287 @@ void sh1122_clear_current_screen(sh1122_descriptor_t* oled_descriptor)
     oled_descriptor->cur_text_y = 0;
 }
 
-/*! \fn     sh1122_check_for_flush_and_terminate(sh1122_descriptor_t* oled_descriptor)
-*   \brief  Check if a flush is in progress, and wait for its completion if so
+#ifdef SH1122_BUFFERED_DRAWS
+/*! \fn     sh1122_set_draw_buffer(sh1122_descriptor_t* oled_descriptor, uint8_t* buffer, int16_t y_start, int16_t nb_rows)
+*   \brief  Select the buffer written by buffered draws (write_to_buffer set)
 *   \param  oled_descriptor     Pointer to a sh1122 descriptor struct
+*   \param  buffer              Pointer to the buffer, nb_rows rows of SH1122_OLED_WIDTH/2 bytes
+*   \param  y_start             Display row corresponding to the buffer first row
+*   \param  nb_rows             Number of rows in the buffer
+*   \note   Draws outside of the buffer rows are discarded
 */
-#ifdef OLED_INTERNAL_FRAME_BUFFER
-void sh1122_check_for_flush_and_terminate(sh1122_descriptor_t* oled_descriptor)
+void sh1122_set_draw_buffer(sh1122_descriptor_t* oled_descriptor, uint8_t* buffer, int16_t y_start, int16_t nb_rows)
 {
-    /* Check for in progress flush */
-    if (oled_descriptor->frame_buffer_flush_in_progress != FALSE)
-    {        
-        /* Wait for data to be transferred */
-        while(dma_oled_check_and_clear_dma_transfer_flag() == FALSE);
-
-        /* Wait for spi buffer to be sent */
-        sercom_spi_wait_for_transmit_complete(oled_descriptor->sercom_pt);
-        
-        /* Stop sending data */
-        sh1122_stop_data_sending(oled_descriptor);
-        
-        /* Clear bool */
-        oled_descriptor->frame_buffer_flush_in_progress = FALSE;
-    }
-}    
+    #ifdef OLED_INTERNAL_FRAME_BUFFER
+    /* Buffer contents may be accessed after this call */
+    sh1122_check_for_fill_and_terminate(oled_descriptor);
+    #endif
+    
+    oled_descriptor->draw_buffer_pt = buffer;
+    oled_descriptor->draw_buffer_y_start = y_start;
+    oled_descriptor->draw_buffer_nb_rows = nb_rows;
+}
 
-/*! \fn     sh1122_flush_frame_buffer(sh1122_descriptor_t* oled_descriptor)
-*   \brief  Flush frame buffer to screen
+/*! \fn     sh1122_get_draw_buffer_row(sh1122_descriptor_t* oled_descriptor, int16_t y)
+*   \brief  Get a pointer to a given display row inside the draw buffer
 *   \param  oled_descriptor     Pointer to a sh1122 descriptor struct
+*   \param  y                   Display row
+*   \return Pointer to the row, 0 if the row isn't inside the draw buffer
 */
-void sh1122_flush_frame_buffer(sh1122_descriptor_t* oled_descriptor)
-{   
-    /* Wait for a possible ongoing previous flush */ 
-    sh1122_check_for_flush_and_terminate(oled_descriptor);
-    
-    /* Set pixel write window */
-    sh1122_set_row_address(oled_descriptor, 0);
-    sh1122_set_column_address(oled_descriptor, 0);
+static inline uint8_t* sh1122_get_draw_buffer_row(sh1122_descriptor_t* oled_descriptor, int16_t y)
+{
+    #ifdef OLED_INTERNAL_FRAME_BUFFER
+    /* Wait for a possible ongoing frame buffer fill */
+    if (oled_descriptor->frame_buffer_fill_in_progress != FALSE)
+    {
+        sh1122_check_for_fill_and_terminate(oled_descriptor);
+    }
+    #endif
     
-    /* Start filling the SSD1322 RAM */
-    sh1122_start_data_sending(oled_descriptor);
+    y -= oled_descriptor->draw_buffer_y_start;
     
-    /* Send buffer! */
-    dma_oled_init_transfer((void*)&oled_descriptor->sercom_pt->SPI.DATA.reg, (void*)&oled_descriptor->frame_buffer[0][0], sizeof(oled_descriptor->frame_buffer), oled_descriptor->dma_trigger_id);
-    oled_descriptor->frame_buffer_flush_in_progress = TRUE;
-}    
-
-/*! \fn     sh1122_clear_frame_buffer(sh1122_descriptor_t* oled_descriptor)
-*   \brief  Clear frame buffer
-*   \param  oled_descriptor     Pointer to a sh1122 descriptor struct
-*/
-void sh1122_clear_frame_buffer(sh1122_descriptor_t* oled_descriptor)
-{    
-    memset((void*)oled_descriptor->frame_buffer, 0x00, sizeof(oled_descriptor->frame_buffer));
+    if ((y < 0) || (y >= oled_descriptor->draw_buffer_nb_rows))
+    {
+        return 0;
+    }
+    else
+    {
+        return &oled_descriptor->draw_buffer_pt[y * (SH1122_OLED_WIDTH/2)];
+    }
 }
-#endif
 
-/*! \fn     sh1122_oled_off(sh1122_descriptor_t* oled_descriptor)
-*   \brief  Switch on the screen
+/*! \fn     sh1122_get_foreground_blit_mode(sh1122_descriptor_t* oled_descriptor)
+*   \brief  Get the blit mode used by buffered glyph and bitmap draws
 *   \param  oled_descriptor     Pointer to a sh1122 descriptor struct
+*   \return OLED_BLIT_ALPHA over a background layer, OLED_BLIT_OR otherwise
 */
-void sh1122_oled_off(sh1122_descriptor_t* oled_descriptor)
+static inline oled_blit_mode_te sh1122_get_foreground_blit_mode(sh1122_descriptor_t* oled_descriptor)
 {
-    sh1122_write_single_command(oled_descriptor, SH1122_CMD_SET_DISPLAY_OFF);
-    oled_descriptor->oled_on = FALSE;
+    #ifdef OLED_BACKGROUND_LAYER
+    if (oled_descriptor->background_layer_pt != 0)
+    {
+        return OLED_BLIT_ALPHA;
+    }
+    #endif
+    return OLED_BLIT_OR;
 }
 
-/*! \fn     sh1122_oled_on(sh1122_descriptor_t* oled_descriptor)
-*   \brief  Switch on the screen
-*   \param  oled_descriptor     Pointer to a sh1122 descriptor struct
+#ifdef OLED_BACKGROUND_LAYER
+/*! \fn     sh1122_alpha_blend(uint32_t dst, uint32_t src, uint32_t mask)
+*   \brief  Blend white over packed destination pixels, using packed source pixels as coverage
+*   \param  dst                 Destination pixels
+*   \param  src                 Source pixels, 0 being transparent and 15 opaque
+*   \param  mask                Mask of the destination bits to modify
+*   \return The blended pixels
+*   \note   Each pixel becomes dst + round((15 - dst) * src / 15): blending over black is a copy, the division being done with a multiply and shift exact over our range
 */
-void sh1122_oled_on(sh1122_descriptor_t* oled_descriptor)
+static inline uint32_t sh1122_alpha_blend(uint32_t dst, uint32_t src, uint32_t mask)
 {
-    sh1122_write_single_command(oled_descriptor, SH1122_CMD_SET_DISPLAY_ON);
-    oled_descriptor->oled_on = TRUE;
-    timer_delay_ms(100);
+    uint32_t result = dst;
+    
+    for (uint32_t shift = 0; shift < 32; shift += 4)
+    {
+        uint32_t coverage = ((src & mask) >> shift) & 0x0F;
+        
+        if (coverage != 0)
+        {
+            uint32_t pixel = (dst >> shift) & 0x0F;
+            pixel += (((0x0F - pixel) * coverage + 7) * 274) >> 12;
+            result = (result & ~(0x0FUL << shift)) | (pixel << shift);
+        }
+    }
+    return result;
 }
+#endif
 
-/*! \fn     sh1122_set_emergency_font(void)
-*   \brief  Use the flash-stored emergency font (ascii only)
-*   \param  oled_descriptor     Pointer to a sh1122 descriptor struct
+/*! \fn     sh1122_blit_combine(uint32_t dst, uint32_t src, uint32_t mask, oled_blit_mode_te mode)
+*   \brief  Combine packed source pixels with packed destination pixels
+*   \param  dst                 Destination pixels
+*   \param  src                 Source pixels
+*   \param  mask                Mask of the destination bits to modify
+*   \param  mode                Blit mode (see enum)
+*   \return The combined pixels
+*   \note   Works on single nibbles, bytes or 32bit words, which hold 8 pixels
 */
-void sh1122_set_emergency_font(sh1122_descriptor_t* oled_descriptor)
+static inline uint32_t sh1122_blit_combine(uint32_t dst, uint32_t src, uint32_t mask, oled_blit_mode_te mode)
 {
-    oled_descriptor->currentFontAddress = CUSTOM_FS_EMERGENCY_FONT_FILE_ADDR;
-    custom_fs_read_from_flash((uint8_t*)&oled_descriptor->current_font_header, oled_descriptor->currentFontAddress, sizeof(oled_descriptor->current_font_header));
-    custom_fs_read_from_flash((uint8_t*)&oled_descriptor->current_unicode_inters, oled_descriptor->currentFontAddress + sizeof(oled_descriptor->current_font_header), sizeof(oled_descriptor->current_unicode_inters));
+    if (mode == OLED_BLIT_OR)
+    {
+        return dst | (src & mask);
+    }
+    else if (mode == OLED_BLIT_INVERTED)
+    {
+        return (dst & ~mask) | (~src & mask);
+    }
+    #ifdef OLED_BACKGROUND_LAYER
+    else if (mode == OLED_BLIT_ALPHA)
+    {
+        return sh1122_alpha_blend(dst, src, mask);
+    }
+    #endif
+    else
+    {
+        return (dst & ~mask) | (src & mask);
+    }
 }
 
-/*! \fn     sh1122_refresh_used_font(void)
-*   \brief  Refreshed used font (in case of init or language change)
-*   \param  oled_descriptor     Pointer to a sh1122 descriptor struct
+/*! \fn     sh1122_blit_row(uint8_t* row_pt, int16_t x, const uint8_t* src_pt, int16_t nb_pixels, oled_blit_mode_te mode)
+*   \brief  Blit a row of packed pixels inside a display row, clipping to the display width
+*   \param  row_pt              Pointer to the display row, SH1122_OLED_WIDTH/2 bytes
+*   \param  x                   Starting x
+*   \param  src_pt              Pointer to the source pixels, first pixel in the high nibble
+*   \param  nb_pixels           Number of pixels
+*   \param  mode                Blit mode (see enum)
+*   \note   Pixels are processed 8 at a time when the source and row pointers allow 32bit accesses
 */
-void sh1122_refresh_used_font(sh1122_descriptor_t* oled_descriptor)
+void sh1122_blit_row(uint8_t* row_pt, int16_t x, const uint8_t* src_pt, int16_t nb_pixels, oled_blit_mode_te mode)
 {
-    if (custom_fs_get_file_address(DEFAULT_FONT_ID, &oled_descriptor->currentFontAddress, CUSTOM_FS_FONTS_TYPE) == RETURN_NOK)
+    int16_t src_x = 0;
+    
+    /* Clip to the display borders */
+    if (x < 0)
     {
-        oled_descriptor->currentFontAddress = 0;
+        src_x = -x;
+        nb_pixels += x;
+        x = 0;
     }
-    else
+    if ((x + nb_pixels) > SH1122_OLED_WIDTH)
     {
-        /* Read font header */
-        custom_fs_read_from_flash((uint8_t*)&oled_descriptor->current_font_header, oled_descriptor->currentFontAddress, sizeof(oled_descriptor->current_font_header));
+        nb_pixels = SH1122_OLED_WIDTH - x;
+    }
+    if (nb_pixels <= 0)
+    {
+        return;
+    }
+    
+    /* Odd x: first pixel goes in the low nibble */
+    if ((x & 0x01) != 0)
+    {
+        uint8_t pixel = ((src_x & 0x01) != 0) ? (src_pt[src_x/2] & 0x0F) : (src_pt[src_x/2] >> 4);
+        row_pt[x/2] = (uint8_t)sh1122_blit_combine(row_pt[x/2], pixel, 0x0F, mode);
+        src_x++;
+        x++;
+        nb_pixels--;
+    }
+    
+    /* Destination is now byte aligned */
+    uint8_t* dst_pt = &row_pt[x/2];
+    const uint8_t* cur_src_pt = &src_pt[src_x/2];
+    uint16_t nb_bytes = nb_pixels/2;
+    
+    if ((src_x & 0x01) == 0)
+    {
+        /* Source byte aligned as well: copy bytes until the destination is word aligned */
+        while ((nb_bytes != 0) && (((uintptr_t)dst_pt & 0x03) != 0))
+        {
+            *dst_pt = (uint8_t)sh1122_blit_combine(*dst_pt, *cur_src_pt++, 0xFF, mode);
+            dst_pt++;
+            nb_bytes--;
+        }
         
-        /* Read unicode chars support intervals */
-        custom_fs_read_from_flash((uint8_t*)&oled_descriptor->current_unicode_inters, oled_descriptor->currentFontAddress + sizeof(oled_descriptor->current_font_header), sizeof(oled_descriptor->current_unicode_inters));
+        /* 8 pixels at a time if the source is word aligned too */
+        if (((uintptr_t)cur_src_pt & 0x03) == 0)
+        {
+            for (; nb_bytes >= 4; nb_bytes -= 4, dst_pt += 4, cur_src_pt += 4)
+            {
+                *(uint32_t*)dst_pt = sh1122_blit_combine(*(uint32_t*)dst_pt, *(const uint32_t*)cur_src_pt, 0xFFFFFFFF, mode);
+            }
+        }
         
-        /* Check for ? support */
-        if (('?' < oled_descriptor->current_unicode_inters[0].interval_start) || ('?' > oled_descriptor->current_unicode_inters[0].interval_end))
+        /* Remaining bytes */
+        for (; nb_bytes != 0; nb_bytes--, dst_pt++)
         {
-            oled_descriptor->question_mark_support_described = FALSE;
-        } 
-        else
+            *dst_pt = (uint8_t)sh1122_blit_combine(*dst_pt, *cur_src_pt++, 0xFF, mode);
+        }
+        
+        /* Last pixel in the high nibble */
+        if ((nb_pixels & 0x01) != 0)
         {
-            oled_descriptor->question_mark_support_described = TRUE;
+            *dst_pt = (uint8_t)sh1122_blit_combine(*dst_pt, *cur_src_pt, 0xF0, mode);
         }
-    }    
-}
-
-/*! \fn     sh1122_init_display(sh1122_descriptor_t oled_descriptor)
-*   \brief  Initialize a SSD1322 display
-*   \param  oled_descriptor     Pointer to a sh1122 descriptor struct
-*/
-void sh1122_init_display(sh1122_descriptor_t* oled_descriptor)
-{
-    /* Vars init : should already be to 0 but you never know... */
-    oled_descriptor->carriage_return_allowed = FALSE;
-    oled_descriptor->line_feed_allowed = FALSE;
-    oled_descriptor->currentFontAddress = 0;
-    oled_descriptor->max_text_x = SH1122_OLED_WIDTH;
-    oled_descriptor->min_text_x = 0;
-    
-    /* Send the initialization sequence through SPI */
-    for (uint16_t ind = 0; ind < sizeof(sh1122_init_sequence);)
+    }
+    else
     {
-        /* nCS set */
-        PORT->Group[oled_descriptor->sh1122_cs_pin_group].OUTCLR.reg = oled_descriptor->sh1122_cs_pin_mask;
-        PORT->Group[oled_descriptor->sh1122_cd_pin_group].OUTCLR.reg = oled_descriptor->sh1122_cd_pin_mask;
-        
-        /* First byte: command */
-        sercom_spi_send_single_byte(oled_descriptor->sercom_pt, sh1122_init_sequence[ind++]);
+        /* Source shifted by one pixel: each destination byte is made of the low nibble of a source byte and the high nibble of the next one */
+        while ((nb_bytes != 0) && (((uintptr_t)dst_pt & 0x03) != 0))
+        {
+            *dst_pt = (uint8_t)sh1122_blit_combine(*dst_pt, (uint8_t)(cur_src_pt[0] << 4) | (cur_src_pt[1] >> 4), 0xFF, mode);
+            cur_src_pt++;
+            dst_pt++;
+            nb_bytes--;
+        }
         
-        /* Second byte: payload length */
-        uint16_t dataSize = sh1122_init_sequence[ind++];
+        /* 8 pixels at a time if the source is word aligned too: bytes are little endian inside the word */
+        if (((uintptr_t)cur_src_pt & 0x03) == 0)
+        {
+            for (; nb_bytes >= 4; nb_bytes -= 4, dst_pt += 4, cur_src_pt += 4)
+            {
+                uint32_t src_word = *(const uint32_t*)cur_src_pt;
+                src_word = ((src_word & 0x0F0F0F0F) << 4) | ((src_word >> 12) & 0x000F0F0F) | ((uint32_t)(cur_src_pt[4] & 0xF0) << 20);
+                *(uint32_t*)dst_pt = sh1122_blit_combine(*(uint32_t*)dst_pt, src_word, 0xFFFFFFFF, mode);
+            }
+        }
         
-        /* If different than 0, send payload */
-        while (dataSize--)
+        /* Remaining bytes */
+        for (; nb_bytes != 0; nb_bytes--, dst_pt++, cur_src_pt++)
         {
-            sercom_spi_send_single_byte(oled_descriptor->sercom_pt, sh1122_init_sequence[ind++]);
+            *dst_pt = (uint8_t)sh1122_blit_combine(*dst_pt, (uint8_t)(cur_src_pt[0] << 4) | (cur_src_pt[1] >> 4), 0xFF, mode);
         }
         
-        /* nCS release */
-        PORT->Group[oled_descriptor->sh1122_cs_pin_group].OUTSET.reg = oled_descriptor->sh1122_cs_pin_mask;
-        asm("NOP");asm("NOP");
+        /* Last pixel in the high nibble */
+        if ((nb_pixels & 0x01) != 0)
+        {
+            *dst_pt = (uint8_t)sh1122_blit_combine(*dst_pt, (uint8_t)(cur_src_pt[0] << 4), 0xF0, mode);
+        }
     }
+}
 
-    /* Clear display */
-    sh1122_clear_current_screen(oled_descriptor);
-    #ifdef OLED_INTERNAL_FRAME_BUFFER
-    memset((void*)oled_descriptor->frame_buffer, 0x00, sizeof(oled_descriptor->frame_buffer));
-    oled_descriptor->frame_buffer_flush_in_progress = FALSE;
-    #endif
-
-    /* Switch screen on */    
-    sh1122_write_single_command(oled_descriptor, SH1122_CMD_SET_DISPLAY_ON);
-    oled_descriptor->oled_on = TRUE;
+/*! \fn     sh1122_fill_row(uint8_t* row_pt, int16_t x, int16_t nb_pixels, uint8_t color, oled_blit_mode_te mode)
+*   \brief  Fill pixels of a display row with a given color, clipping to the display width
+*   \param  row_pt              Pointer to the display row, SH1122_OLED_WIDTH/2 bytes
+*   \param  x                   Starting x
+*   \param  nb_pixels           Number of pixels
+*   \param  color               4 bits color
+*   \param  mode                Blit mode (see enum)
+*   \note   Pixels are processed 8 at a time once the row pointer is word aligned
+*/
+void sh1122_fill_row(uint8_t* row_pt, int16_t x, int16_t nb_pixels, uint8_t color, oled_blit_mode_te mode)
+{
+    uint32_t color_word = (color & 0x0F) * 0x11111111UL;
     
-    /* Set emergency font by default */
-    sh1122_set_emergency_font(oled_descriptor);
+    /* Clip to the display borders */
+    if (x < 0)
+    {
+        nb_pixels += x;
+        x = 0;
+    }
+    if ((x + nb_pixels) > SH1122_OLED_WIDTH)
+    {
+        nb_pixels = SH1122_OLED_WIDTH - x;
+    }
+    if (nb_pixels <= 0)
+    {
+        return;
+    }
     
-    /* From datasheet : wait 100ms */
-    timer_delay_ms(100);
+    /* Odd x: first pixel goes in the low nibble */
+    if ((x & 0x01) != 0)
+    {
+        row_pt[x/2] = (uint8_t)sh1122_blit_combine(row_pt[x/2], color_word, 0x0F, mode);
+        x++;
+        nb_pixels--;
+    }
+    
+    uint8_t* dst_pt = &row_pt[x/2];
+    uint16_t nb_bytes = nb_pixels/2;
+    
+    /* Bytes until the destination is word aligned, then 8 pixels at a time */
+    for (; (nb_bytes != 0) && (((uintptr_t)dst_pt & 0x03) != 0); nb_bytes--, dst_pt++)
+    {
+        *dst_pt = (uint8_t)sh1122_blit_combine(*dst_pt, color_word, 0xFF, mode);
+    }
+    for (; nb_bytes >= 4; nb_bytes -= 4, dst_pt += 4)
+    {
+        *(uint32_t*)dst_pt = sh1122_blit_combine(*(uint32_t*)dst_pt, color_word, 0xFFFFFFFF, mode);
+    }
+    for (; nb_bytes != 0; nb_bytes--, dst_pt++)
+    {
+        *dst_pt = (uint8_t)sh1122_blit_combine(*dst_pt, color_word, 0xFF, mode);
+    }
+    
+    /* Last pixel in the high nibble */
+    if ((nb_pixels & 0x01) != 0)
+    {
+        *dst_pt = (uint8_t)sh1122_blit_combine(*dst_pt, color_word, 0xF0, mode);
+    }
 }
 
-/*! \fn     sh1122_draw_full_screen_image_from_bitstream(sh1122_descriptor_t* oled_descriptor, bitstream_bitmap_t* bitstream)
-*   \brief  Draw a full screen picture from a bitstream
+/*! \fn     sh1122_blit_to_draw_buffer(sh1122_descriptor_t* oled_descriptor, int16_t x, int16_t y, const uint8_t* src_pt, uint16_t width, uint16_t height, uint16_t src_row_size, oled_blit_mode_te mode)
+*   \brief  Blit packed pixels inside the draw buffer, clipping to the display and draw buffer borders
 *   \param  oled_descriptor     Pointer to a sh1122 descriptor struct
-*   \param  bitstream           Pointer to the bistream
+*   \param  x                   Starting x
+*   \param  y                   Starting y
+*   \param  src_pt              Pointer to the source pixels, rows starting with a pixel in the high nibble
+*   \param  width               Width
+*   \param  height              Height
+*   \param  src_row_size        Number of bytes between two source rows
+*   \param  mode                Blit mode (see enum)
 */
-void sh1122_draw_full_screen_image_from_bitstream(sh1122_descriptor_t* oled_descriptor, bitstream_bitmap_t* bitstream)
+void sh1122_blit_to_draw_buffer(sh1122_descriptor_t* oled_descriptor, int16_t x, int16_t y, const uint8_t* src_pt, uint16_t width, uint16_t height, uint16_t src_row_size, oled_blit_mode_te mode)
 {
-    /*  So, here's a quick overview if you were to wonder what has been done to improve display speeds:
-    /   Note: the FPS count mentioned here highly depends on the picture itself due to RLE compression
-    /   Using internal flash :
-    /   1) No defines: 28fps
-    /   2) OLED_DMA_TRANSFER: 43fps
-    /   Using external flash :
-    /   1) FLASH_ALONE_ON_SPI_BUS: when defined, reads from the flash are done in a continuous manner, rather than doing multiple reads for different chunks of data: 20fps
-    /   2) FLASH_DMA_FETCHES: when defined, reads from the flash are done using the DMA controller: 26fps
-    /   3) OLED_DMA_TRANSFER: when defined, writes to the oled are done using the DMA controller: 40fps
-    /   Note: more or less no performance improvements have been found by overclocking oled spi clk
-    /   TODO: compare sh1122_draw_full_screen_image_from_bitstream performance with sh1122_draw_aligned_image_from_bitstream
-    */
-
     #ifdef OLED_INTERNAL_FRAME_BUFFER
-    /* Wait for a possible ongoing previous flush */
-    sh1122_check_for_flush_and_terminate(oled_descriptor);
+    /* Keep track of modified area */
+    sh1122_frame_buffer_mark_dirty(oled_descriptor, x, y, width, height, TRUE);
     #endif
-
-    /* Set pixel write window */
-    sh1122_set_row_address(oled_descriptor, 0);
-    sh1122_set_column_address(oled_descriptor, 0);
-    
-    /* Start filling the SSD1322 RAM */
-    sh1122_start_data_sending(oled_descriptor);
     
-    /* Depending if we use DMA transfers */
-    #ifdef OLED_DMA_TRANSFER        
-        uint8_t pixel_buffer[2][32];
-        uint32_t buffer_sel = 0;
+    for (uint16_t j = 0; j < height; j++, src_pt += src_row_size)
+    {
+        uint8_t* row_pt = sh1122_get_draw_buffer_row(oled_descriptor, y+j);
         
-        /* Get things going: start first transfer then enter the for(), as we need to wait for OLED DMA after inside the loop */
-        bitstream_bitmap_array_read(bitstream, pixel_buffer[buffer_sel], sizeof(pixel_buffer[0])*2);
-        dma_oled_init_transfer((void*)&oled_descriptor->sercom_pt->SPI.DATA.reg, (void*)pixel_buffer[buffer_sel], sizeof(pixel_buffer[0]), oled_descriptor->dma_trigger_id);
+        if (row_pt != 0)
+        {
+            sh1122_blit_row(row_pt, x, src_pt, width, mode);
+        }
+    }
+}
+
+/*! \fn     sh1122_blit_bitstream_to_draw_buffer(sh1122_descriptor_t* oled_descriptor, int16_t x, int16_t y, bitstream_bitmap_t* bitstream)
+*   \brief  Decode a bitstream one row at a time and or it (or blend it over the background layer) inside the draw buffer
+*   \param  oled_descriptor     Pointer to a sh1122 descriptor struct
+*   \param  x                   Starting x
+*   \param  y                   Starting y
+*   \param  bitstream           Pointer to the bistream
+*/
+static void sh1122_blit_bitstream_to_draw_buffer(sh1122_descriptor_t* oled_descriptor, int16_t x, int16_t y, bitstream_bitmap_t* bitstream)
+{
+    /* Word aligned decoding buffer, for the blit kernel fast paths */
+    uint32_t pixel_buffer[SH1122_OLED_WIDTH/8];
+    uint8_t* pixel_pt = (uint8_t*)pixel_buffer;
+    
+    for (uint16_t j = 0; j < bitstream->height; j++)
+    {
+        uint8_t* row_pt = sh1122_get_draw_buffer_row(oled_descriptor, y+j);
         
-        for (uint32_t i = 0; i < (SH1122_OLED_WIDTH*SH1122_OLED_HEIGHT) - sizeof(pixel_buffer[0]); i+=sizeof(pixel_buffer[0])*2)
-        {            
-            /* Read from bitstream in the next buffer */
-            bitstream_bitmap_array_read(bitstream, pixel_buffer[(buffer_sel+1)&0x01], sizeof(pixel_buffer[0])*2);
-            
-            /* Wait for transfer done */
-            while(dma_oled_check_and_clear_dma_transfer_flag() == FALSE);
-            
-            /* Init DMA transfer */
-            buffer_sel = (buffer_sel+1) & 0x01;
-            dma_oled_init_transfer((void*)&oled_descriptor->sercom_pt->SPI.DATA.reg, (void*)pixel_buffer[buffer_sel], sizeof(pixel_buffer[0]), oled_descriptor->dma_trigger_id);
+        /* Past the draw buffer end: no need to decode further */
+        if ((row_pt == 0) && ((y+j) >= oled_descriptor->draw_buffer_y_start))
+        {
+            break;
         }
         
-        /* Wait for data to be transferred */
-        while(dma_oled_check_and_clear_dma_transfer_flag() == FALSE);
-    #else        
-        uint8_t pixel_buffer[16];
+        /* RLE bitmaps: fill spans of the same color, or-ing or blending black spans is a no-op */
+        if ((bitstream->_flags & CUSTOM_FS_BITMAP_RLE_FLAG) != 0)
+        {
+            for (uint16_t i = 0; i < bitstream->width;)
+            {
+                uint8_t color;
+                uint16_t nb_pixels = bitstream_bitmap_span_read(bitstream, &color, bitstream->width - i);
+                
+                if ((row_pt != 0) && (color != 0))
+                {
+                    sh1122_fill_row(row_pt, x+i, nb_pixels, color, sh1122_get_foreground_blit_mode(oled_descriptor));
+                }
+                i += nb_pixels;
+            }
+            continue;
+        }
         
-        /* Send all pixels */
-        for (uint32_t i = 0; i < (SH1122_OLED_WIDTH*SH1122_OLED_HEIGHT); i+=sizeof(pixel_buffer)*2)
+        /* Decode the row by chunks of the display width */
+        for (uint16_t i = 0; i < bitstream->width; i += SH1122_OLED_WIDTH)
         {
-            /* Read from bitstream */
-            bitstream_bitmap_array_read(bitstream, pixel_buffer, sizeof(pixel_buffer)*2);
+            uint16_t nb_pixels = bitstream->width - i;
+            if (nb_pixels > SH1122_OLED_WIDTH)
+            {
+                nb_pixels = SH1122_OLED_WIDTH;
+            }
             
-            /* Send pixels */
-            for (uint32_t j = 0; j < sizeof(pixel_buffer); j++)
+            /* Array reads are done 2 pixels at a time, rows aren't padded in the bitstream */
+            bitstream_bitmap_array_read(bitstream, pixel_pt, nb_pixels & ~0x01);
+            if ((nb_pixels & 0x01) != 0)
             {
-                sercom_spi_send_single_byte_without_receive_wait(oled_descriptor->sercom_pt, pixel_buffer[j]);
+                pixel_pt[nb_pixels/2] = (uint8_t)(bitstream_bitmap_read(bitstream, 1) << 4);
+            }
+            
+            if (row_pt != 0)
+            {
+                sh1122_blit_row(row_pt, x+i, pixel_pt, nb_pixels, sh1122_get_foreground_blit_mode(oled_descriptor));
             }
         }
-    #endif
+    }
+}
+#endif
+
+#ifdef OLED_BACKGROUND_LAYER
+/*! \fn     sh1122_set_background_layer(sh1122_descriptor_t* oled_descriptor, uint8_t* layer, int16_t y_start, int16_t nb_rows)
+*   \brief  Select the background layer buffered glyph and bitmap draws are alpha blended over
+*   \param  oled_descriptor     Pointer to a sh1122 descriptor struct
+*   \param  layer               Pointer to the layer, nb_rows rows of SH1122_OLED_WIDTH/2 bytes, 0 to go back to or-ed draws
+*   \param  y_start             Display row corresponding to the layer first row
+*   \param  nb_rows             Number of rows in the layer, the background being black outside of them
+*   \note   Covering only part of the display (a title bar, a band...) keeps the RAM cost down
+*/
+void sh1122_set_background_layer(sh1122_descriptor_t* oled_descriptor, uint8_t* layer, int16_t y_start, int16_t nb_rows)
+{
+    oled_descriptor->background_layer_pt = layer;
+    oled_descriptor->background_layer_y_start = y_start;
+    oled_descriptor->background_layer_nb_rows = nb_rows;
+}
+
+/*! \fn     sh1122_load_background_layer(sh1122_descriptor_t* oled_descriptor, uint32_t file_id)
+*   \brief  Decode a bitmap from flash into the background layer, at its recommended position
+*   \param  oled_descriptor     Pointer to a sh1122 descriptor struct
+*   \param  file_id             Bitmap file ID
+*   \return RETURN_OK if the bitmap was decoded
+*   \note   Bitmap parts outside of the layer rows are discarded
+*/
+RET_TYPE sh1122_load_background_layer(sh1122_descriptor_t* oled_descriptor, uint32_t file_id)
+{
+    uint8_t* draw_buffer_pt = oled_descriptor->draw_buffer_pt;
+    int16_t draw_buffer_y_start = oled_descriptor->draw_buffer_y_start;
+    int16_t draw_buffer_nb_rows = oled_descriptor->draw_buffer_nb_rows;
+    RET_TYPE ret_val;
     
-    /* Wait for spi buffer to be sent */
-    sercom_spi_wait_for_transmit_complete(oled_descriptor->sercom_pt);
+    if (oled_descriptor->background_layer_pt == 0)
+    {
+        return RETURN_NOK;
+    }
     
-    /* Stop sending data */
-    sh1122_stop_data_sending(oled_descriptor);
+    /* Decode into the cleared layer: blending over black is a copy */
+    sh1122_set_draw_buffer(oled_descriptor, oled_descriptor->background_layer_pt, oled_descriptor->background_layer_y_start, oled_descriptor->background_layer_nb_rows);
+    memset((void*)oled_descriptor->background_layer_pt, 0x00, oled_descriptor->background_layer_nb_rows * (SH1122_OLED_WIDTH/2));
+    ret_val = sh1122_display_bitmap_from_flash_at_recommended_position(oled_descriptor, file_id, TRUE);
+    sh1122_set_draw_buffer(oled_descriptor, draw_buffer_pt, draw_buffer_y_start, draw_buffer_nb_rows);
     
-    /* Close bitstream */
-    bitstream_bitmap_close(bitstream);
+    return ret_val;
 }
 
-/*! \fn     sh1122_draw_aligned_image_from_bitstream(sh1122_descriptor_t* oled_descriptor, int16_t x, int16_t y, bitstream_bitmap_t* bitstream, BOOL write_to_buffer)
-*   \brief  Draw a 2 pixels-aligned picture from a bitstream
+/*! \fn     sh1122_restore_background(sh1122_descriptor_t* oled_descriptor, int16_t x, int16_t y, int16_t width, int16_t height)
+*   \brief  Copy the background layer to an area of the draw buffer, erasing what was drawn over it
 *   \param  oled_descriptor     Pointer to a sh1122 descriptor struct
 *   \param  x                   Starting x
 *   \param  y                   Starting y
-*   \param  bitstream           Pointer to the bistream
-*   \param  write_to_buffer     Set to true to write to internal buffer
+*   \param  width               Width
+*   \param  height              Height
+*   \note   Updating a foreground element then only costs restoring its area and drawing it again, without decoding the background from flash
 */
-void sh1122_draw_aligned_image_from_bitstream(sh1122_descriptor_t* oled_descriptor, int16_t x, int16_t y, bitstream_bitmap_t* bitstream, BOOL write_to_buffer)
+void sh1122_restore_background(sh1122_descriptor_t* oled_descriptor, int16_t x, int16_t y, int16_t width, int16_t height)
 {
-    uint16_t height = bitstream->height;
-    uint16_t width = bitstream->width;
+    /* Clip to the display borders */
+    if (x < 0)
+    {
+        width += x;
+        x = 0;
+    }
+    if ((x + width) > SH1122_OLED_WIDTH)
+    {
+        width = SH1122_OLED_WIDTH - x;
+    }
+    if (width <= 0)
+    {
+        return;
+    }
     
-    /* Frame buffer: we only support DMA transfers when not writing to buffer */
     #ifdef OLED_INTERNAL_FRAME_BUFFER
-        /* Depending if we write in the frame buffer or not */
-        if (write_to_buffer != FALSE)
+    /* Keep track of modified area */
+    sh1122_frame_buffer_mark_dirty(oled_descriptor, x, y, width, height, TRUE);
+    #endif
+    
+    for (int16_t j = y; j < (y + height); j++)
+    {
+        uint8_t* row_pt = sh1122_get_draw_buffer_row(oled_descriptor, j);
+        int16_t layer_row = j - oled_descriptor->background_layer_y_start;
+        
+        if (row_pt == 0)
         {
-            /* Scan Y */
-            for (uint16_t j = 0; j < height; j++)
-            {
-                /* Scan X */
-                for (uint16_t i = 0; i < width/2; i++)
-                {
-                    uint8_t pixels = bitstream_bitmap_two_pixel_read(bitstream);
-                    oled_descriptor->frame_buffer[y+j][x/2+i] |= pixels;
-                }
-            }
-        } 
+            continue;
+        }
+        
+        if ((oled_descriptor->background_layer_pt == 0) || (layer_row < 0) || (layer_row >= oled_descriptor->background_layer_nb_rows))
+        {
+            /* Outside of the layer: black background */
+            sh1122_fill_row(row_pt, x, width, 0x00, OLED_BLIT_OPAQUE);
+        }
         else
         {
-            /* Wait for a possible ongoing previous flush */
-            sh1122_check_for_flush_and_terminate(oled_descriptor);
-            
-            /* Buffer large enough to contain a display line in order to trig one DMA transfer */
-            uint8_t pixel_buffer[2][SH1122_OLED_WIDTH/2];
-            uint32_t buffer_sel = 0;
-            
-            /* Trigger first buffer fill: if we asked more data, the bitstream will return 0s */
-            bitstream_bitmap_array_read(bitstream, pixel_buffer[buffer_sel], width);
+            uint8_t* layer_row_pt = &oled_descriptor->background_layer_pt[layer_row * (SH1122_OLED_WIDTH/2)];
+            int16_t nb_pixels = width;
+            int16_t cur_x = x;
             
-            /* Scan Y */
-            for (uint16_t j = 0; j < height; j++)
+            /* Odd x: copy the first pixel, blit sources starting with a high nibble */
+            if ((cur_x & 0x01) != 0)
             {
-                /* Set pixel write window */
-                sh1122_set_row_address(oled_descriptor, y+j);
-                sh1122_set_column_address(oled_descriptor, x/2);
-                
-                /* Start filling the SSD1322 RAM */
-                sh1122_start_data_sending(oled_descriptor);
-                
-                /* Trigger DMA transfer for the complete width */
-                dma_oled_init_transfer((void*)&oled_descriptor->sercom_pt->SPI.DATA.reg, (void*)pixel_buffer[buffer_sel], width/2, oled_descriptor->dma_trigger_id);
-                
-                /* Flip buffer, start fetching next line while the transfer is happening */
-                if (j != height-1)
-                {
-                    buffer_sel = (buffer_sel+1) & 0x01;
-                    bitstream_bitmap_array_read(bitstream, pixel_buffer[buffer_sel], width);
-                }
-                
-                /* Wait for transfer done */
-                while(dma_oled_check_and_clear_dma_transfer_flag() == FALSE);
-                
-                /* Wait for spi buffer to be sent */
-                sercom_spi_wait_for_transmit_complete(oled_descriptor->sercom_pt);
-                
-                /* Stop sending data */
-                sh1122_stop_data_sending(oled_descriptor);
+                row_pt[cur_x/2] = (row_pt[cur_x/2] & 0xF0) | (layer_row_pt[cur_x/2] & 0x0F);
+                nb_pixels--;
+                cur_x++;
             }
+            sh1122_blit_row(row_pt, cur_x, &layer_row_pt[cur_x/2], nb_pixels, OLED_BLIT_OPAQUE);
         }
-    #else    
-        /* Depending if we use DMA transfers */
-        #ifdef OLED_DMA_TRANSFER        
-            /* Buffer large enough to contain a display line in order to trig one DMA transfer */
-            uint8_t pixel_buffer[2][SH1122_OLED_WIDTH/2];
-            uint32_t buffer_sel = 0;
-        
-            /* Trigger first buffer fill: if we asked more data, the bitstream will return 0s */
-            bitstream_bitmap_array_read(bitstream, pixel_buffer[buffer_sel], width);
-        
-            /* Scan Y */
-            for (uint16_t j = 0; j < height; j++)
-            {
-                /* Set pixel write window */
-                sh1122_set_row_address(oled_descriptor, y+j);
-                sh1122_set_column_address(oled_descriptor, x/2);
-            
-                /* Start filling the SSD1322 RAM */
-                sh1122_start_data_sending(oled_descriptor);
-            
-                /* Trigger DMA transfer for the complete width */
-                dma_oled_init_transfer((void*)&oled_descriptor->sercom_pt->SPI.DATA.reg, (void*)pixel_buffer[buffer_sel], width/2, oled_descriptor->dma_trigger_id);  
-            
-                /* Flip buffer, start fetching next line while the transfer is happening */   
-                if (j != height-1)
-                {                
-                    buffer_sel = (buffer_sel+1) & 0x01;
-                    bitstream_bitmap_array_read(bitstream, pixel_buffer[buffer_sel], width);
-                }
-            
-                /* Wait for transfer done */
-                while(dma_oled_check_and_clear_dma_transfer_flag() == FALSE);
-            
-                /* Wait for spi buffer to be sent */
-                sercom_spi_wait_for_transmit_complete(oled_descriptor->sercom_pt);
-            
-                /* Stop sending data */
-                sh1122_stop_data_sending(oled_descriptor);
-            }
-        #else        
-            uint8_t pixel_buffer[16];
-            uint32_t pixel_ind = 0;
-        
-            /* Read from bitstream */
+    }
+}
+#endif
+
+#ifdef OLED_INTERNAL_FRAME_BUFFER
+/*! \fn     sh1122_reset_fb_window(sh1122_fb_window_t* window_pt)
+*   \brief  Set a frame buffer window as empty
+*   \param  window_pt           Pointer to the window
+*/
+static inline void sh1122_reset_fb_window(sh1122_fb_window_t* window_pt)
+{
+    window_pt->x_min = SH1122_OLED_WIDTH;
+    window_pt->y_min = SH1122_OLED_HEIGHT;
+    window_pt->x_max = -1;
+    window_pt->y_max = -1;
+}
+
+/*! \fn     sh1122_extend_fb_window(sh1122_fb_window_t* window_pt, sh1122_fb_window_t* area_pt)
+*   \brief  Extend a frame buffer window so it includes a given area
+*   \param  window_pt           Pointer to the window
+*   \param  area_pt             Pointer to the area to include
+*/
+static inline void sh1122_extend_fb_window(sh1122_fb_window_t* window_pt, sh1122_fb_window_t* area_pt)
+{
+    if (area_pt->x_min < window_pt->x_min) window_pt->x_min = area_pt->x_min;
+    if (area_pt->x_max > window_pt->x_max) window_pt->x_max = area_pt->x_max;
+    if (area_pt->y_min < window_pt->y_min) window_pt->y_min = area_pt->y_min;
+    if (area_pt->y_max > window_pt->y_max) window_pt->y_max = area_pt->y_max;
+}
+
+#ifdef DEBUG_USB_COMMANDS_ENABLED
+/*! \fn     sh1122_mark_rows_uncaptured(sh1122_descriptor_t* oled_descriptor, int16_t y_min, int16_t y_max)
+*   \brief  Flag frame buffer rows as written since the last USB capture
+*   \param  oled_descriptor     Pointer to a sh1122 descriptor struct
+*   \param  y_min               First row
+*   \param  y_max               Last row
+*/
+static inline void sh1122_mark_rows_uncaptured(sh1122_descriptor_t* oled_descriptor, int16_t y_min, int16_t y_max)
+{
+    for (int16_t y = y_min; y <= y_max; y++)
+    {
+        oled_descriptor->frame_buffer_uncaptured_rows[y/32] |= (1UL << (y & 0x1F));
+    }
+}
+#endif
+
+/*! \fn     sh1122_frame_buffer_mark_dirty(sh1122_descriptor_t* oled_descriptor, int16_t x, int16_t y, int16_t width, int16_t height, BOOL frame_buffer_written)
+*   \brief  Signal that a given area needs to be sent at the next frame buffer flush
+*   \param  oled_descriptor         Pointer to a sh1122 descriptor struct
+*   \param  x                       Starting x
+*   \param  y                       Starting y
+*   \param  width                   Width
+*   \param  height                  Height
+*   \param  frame_buffer_written    TRUE if the frame buffer was written, FALSE if the screen was directly written
+*   \note   Direct screen writes make the display contents differ from the frame buffer ones, hence the dirty area
+*/
+void sh1122_frame_buffer_mark_dirty(sh1122_descriptor_t* oled_descriptor, int16_t x, int16_t y, int16_t width, int16_t height, BOOL frame_buffer_written)
+{
+    sh1122_fb_window_t area;
+    
+    /* Buffered draws to another buffer than the frame buffer (rendering bands) */
+    if ((frame_buffer_written != FALSE) && (oled_descriptor->draw_buffer_pt != &oled_descriptor->frame_buffer[0][0]))
+    {
+        return;
+    }
+    
+    /* Clip to screen */
+    if (x < 0)
+    {
+        width += x;
+        x = 0;
+    }
+    if (y < 0)
+    {
+        height += y;
+        y = 0;
+    }
+    if ((x + width) > SH1122_OLED_WIDTH)
+    {
+        width = SH1122_OLED_WIDTH - x;
+    }
+    if ((y + height) > SH1122_OLED_HEIGHT)
+    {
+        height = SH1122_OLED_HEIGHT - y;
+    }
+    if ((width <= 0) || (height <= 0))
+    {
+        return;
+    }
+    
+    /* Convert to frame buffer byte columns */
+    area.x_min = x / 2;
+    area.x_max = (x + width - 1) / 2;
+    area.y_min = y;
+    area.y_max = y + height - 1;
+    
+    /* Update windows */
+    sh1122_extend_fb_window(&oled_descriptor->frame_buffer_dirty_window, &area);
+    if (frame_buffer_written != FALSE)
+    {
+        sh1122_extend_fb_window(&oled_descriptor->frame_buffer_content_window, &area);
+        #ifdef DEBUG_USB_COMMANDS_ENABLED
+        sh1122_mark_rows_uncaptured(oled_descriptor, area.y_min, area.y_max);
+        #endif
+    }
+}
+
+/*! \fn     sh1122_get_hidden_page_first_row(sh1122_descriptor_t* oled_descriptor)
+*   \brief  Get the GDDRAM row of the hidden page first line
+*   \param  oled_descriptor     Pointer to a sh1122 descriptor struct
+*   \return 0 or SH1122_OLED_HEIGHT
+*/
+static inline uint8_t sh1122_get_hidden_page_first_row(sh1122_descriptor_t* oled_descriptor)
+{
+    /* The first page is displayed with the init display start line */
+    if (((oled_descriptor->display_start_line - SH1122_OLED_INIT_START_LINE) & SH1122_OLED_START_LINE_MASK) < SH1122_OLED_HEIGHT)
+    {
+        return SH1122_OLED_HEIGHT;
+    } 
+    else
+    {
+        return 0;
+    }
+}
+
+/*! \fn     sh1122_terminate_flush(sh1122_descriptor_t* oled_descriptor)
+*   \brief  Terminate a flush or display fill whose DMA transfer is done
+*   \param  oled_descriptor     Pointer to a sh1122 descriptor struct
+*/
+static void sh1122_terminate_flush(sh1122_descriptor_t* oled_descriptor)
+{
+    /* Wait for spi buffer to be sent */
+    sercom_spi_wait_for_transmit_complete(oled_descriptor->sercom_pt);
+    
+    /* Stop sending data */
+    sh1122_stop_data_sending(oled_descriptor);
+    
+    /* Clear bools, update stats of frame buffer flushes */
+    if (oled_descriptor->frame_buffer_flush_in_progress != FALSE)
+    {
+        oled_descriptor->frame_buffer_last_flush_time_ms = timer_get_systick() - oled_descriptor->frame_buffer_flush_start_time;
+    }
+    oled_descriptor->frame_buffer_flush_in_progress = FALSE;
+    oled_descriptor->display_fill_in_progress = FALSE;
+    
+    /* Flushed to the hidden page: display it, cancelling a possible ongoing scroll */
+    if (oled_descriptor->frame_buffer_page_flip_pending != FALSE)
+    {
+        oled_descriptor->frame_buffer_page_flip_pending = FALSE;
+        oled_descriptor->start_line_transition.in_progress = FALSE;
+        sh1122_move_display_start_line(oled_descriptor, (oled_descriptor->display_start_line + SH1122_OLED_HEIGHT) & SH1122_OLED_START_LINE_MASK);
+    }
+}
+
+/*! \fn     sh1122_check_for_flush_and_terminate(sh1122_descriptor_t* oled_descriptor)
+*   \brief  Check if a flush is in progress, and wait for its completion if so
+*   \param  oled_descriptor     Pointer to a sh1122 descriptor struct
+*/
+void sh1122_check_for_flush_and_terminate(sh1122_descriptor_t* oled_descriptor)
+{
+    /* Check for in progress flush or display fill */
+    if ((oled_descriptor->frame_buffer_flush_in_progress != FALSE) || (oled_descriptor->display_fill_in_progress != FALSE))
+    {        
+        /* Wait for data to be transferred */
+        while(dma_oled_check_and_clear_dma_transfer_flag() == FALSE);
+
+        sh1122_terminate_flush(oled_descriptor);
+    }
+}    
+
+/*! \fn     sh1122_check_for_flush_completion(sh1122_descriptor_t* oled_descriptor)
+*   \brief  Terminate an in progress flush if its transfer is done, without waiting
+*   \param  oled_descriptor     Pointer to a sh1122 descriptor struct
+*   \note   Called by sh1122_transitions_routine(): the flushed hidden page is displayed even if no other display call follows
+*/
+void sh1122_check_for_flush_completion(sh1122_descriptor_t* oled_descriptor)
+{
+    if (((oled_descriptor->frame_buffer_flush_in_progress != FALSE) || (oled_descriptor->display_fill_in_progress != FALSE)) && (dma_oled_check_and_clear_dma_transfer_flag() != FALSE))
+    {
+        sh1122_terminate_flush(oled_descriptor);
+    }
+}
+
+/*! \fn     sh1122_check_for_fill_and_terminate(sh1122_descriptor_t* oled_descriptor)
+*   \brief  Check if a frame buffer fill is in progress, and wait for its completion if so
+*   \param  oled_descriptor     Pointer to a sh1122 descriptor struct
+*/
+void sh1122_check_for_fill_and_terminate(sh1122_descriptor_t* oled_descriptor)
+{
+    if (oled_descriptor->frame_buffer_fill_in_progress != FALSE)
+    {
+        while(dma_ram_fill_check_and_clear_dma_transfer_flag() == FALSE);
+        oled_descriptor->frame_buffer_fill_in_progress = FALSE;
+    }
+}
+
+/*! \fn     sh1122_set_frame_buffer_page_flip(sh1122_descriptor_t* oled_descriptor, BOOL enable)
+*   \brief  Enable or disable frame buffer flushes to the hidden GDDRAM page, displayed once the flush is completed
+*   \param  oled_descriptor     Pointer to a sh1122 descriptor struct
+*   \param  enable              TRUE to enable page flips
+*   \note   Tear free flushes: the displayed page is never written to. Direct screen writes target the first page and shouldn't be used while enabled
+*/
+void sh1122_set_frame_buffer_page_flip(sh1122_descriptor_t* oled_descriptor, BOOL enable)
+{
+    sh1122_fb_window_t screen_window = {.x_min = 0, .x_max = sizeof(oled_descriptor->frame_buffer[0]) - 1, .y_min = 0, .y_max = SH1122_OLED_HEIGHT - 1};
+    
+    /* Wait for a possible ongoing flush, which may flip pages */
+    sh1122_check_for_flush_and_terminate(oled_descriptor);
+    
+    if ((enable != FALSE) && (oled_descriptor->frame_buffer_page_flip_enabled == FALSE))
+    {
+        /* Hidden page contents are unknown */
+        oled_descriptor->frame_buffer_hidden_page_window = screen_window;
+        oled_descriptor->frame_buffer_page_flip_enabled = TRUE;
+    }
+    else if ((enable == FALSE) && (oled_descriptor->frame_buffer_page_flip_enabled != FALSE))
+    {
+        /* Second page displayed: send the frame buffer to the first one and display it */
+        if (sh1122_get_hidden_page_first_row(oled_descriptor) == 0)
+        {
+            sh1122_extend_fb_window(&oled_descriptor->frame_buffer_dirty_window, &screen_window);
+            sh1122_flush_frame_buffer(oled_descriptor);
+            sh1122_check_for_flush_and_terminate(oled_descriptor);
+        }
+        oled_descriptor->frame_buffer_page_flip_enabled = FALSE;
+    }
+}
+
+/*! \fn     sh1122_fill_frame_buffer_rows(sh1122_descriptor_t* oled_descriptor, int16_t y, int16_t nb_rows, uint8_t fill_byte)
+*   \brief  Start filling complete frame buffer rows with a given byte
+*   \param  oled_descriptor     Pointer to a sh1122 descriptor struct
+*   \param  y                   First row
+*   \param  nb_rows             Number of rows, non 0
+*   \param  fill_byte           Byte to fill the rows with
+*   \note   Rows are filled by the DMA controller, frame buffer accesses through the draw buffer and flushes wait for the fill end
+*/
+static void sh1122_fill_frame_buffer_rows(sh1122_descriptor_t* oled_descriptor, int16_t y, int16_t nb_rows, uint8_t fill_byte)
+{
+    /* Wait for a possible ongoing fill */
+    sh1122_check_for_fill_and_terminate(oled_descriptor);
+    
+    oled_descriptor->frame_buffer_fill_word = fill_byte * 0x01010101UL;
+    dma_ram_init_fill_transfer((void*)&oled_descriptor->frame_buffer[y][0], &oled_descriptor->frame_buffer_fill_word, nb_rows * sizeof(oled_descriptor->frame_buffer[0]) / sizeof(uint32_t));
+    oled_descriptor->frame_buffer_fill_in_progress = TRUE;
+}
+
+/*! \fn     sh1122_flush_frame_buffer(sh1122_descriptor_t* oled_descriptor)
+*   \brief  Flush frame buffer to screen
+*   \param  oled_descriptor     Pointer to a sh1122 descriptor struct
+*   \note   Only the area modified since the last flush is sent
+*/
+void sh1122_flush_frame_buffer(sh1122_descriptor_t* oled_descriptor)
+{   
+    sh1122_fb_window_t flush_window = oled_descriptor->frame_buffer_dirty_window;
+    uint8_t first_row = 0;
+    
+    /* Wait for a possible ongoing previous flush or frame buffer fill */ 
+    sh1122_check_for_flush_and_terminate(oled_descriptor);
+    sh1122_check_for_fill_and_terminate(oled_descriptor);
+    
+    /* Nothing to send? */
+    if (flush_window.y_max < flush_window.y_min)
+    {
+        oled_descriptor->frame_buffer_last_flush_nb_bytes = 0;
+        oled_descriptor->frame_buffer_last_flush_time_ms = 0;
+        return;
+    }
+    
+    /* Page flips: the hidden page also lags behind by the area sent to the other page at the previous flush */
+    if (oled_descriptor->frame_buffer_page_flip_enabled != FALSE)
+    {
+        sh1122_extend_fb_window(&flush_window, &oled_descriptor->frame_buffer_hidden_page_window);
+        oled_descriptor->frame_buffer_hidden_page_window = oled_descriptor->frame_buffer_dirty_window;
+        first_row = sh1122_get_hidden_page_first_row(oled_descriptor);
+    }
+    
+    /* Reset dirty window */
+    sh1122_reset_fb_window(&oled_descriptor->frame_buffer_dirty_window);
+    
+    /* If we only spare a few bytes per row, rather send complete rows in one go */
+    if ((int16_t)sizeof(oled_descriptor->frame_buffer[0]) - (flush_window.x_max - flush_window.x_min + 1) < SH1122_FLUSH_MIN_ROW_SAVING)
+    {
+        flush_window.x_min = 0;
+        flush_window.x_max = sizeof(oled_descriptor->frame_buffer[0]) - 1;
+    }
+    uint16_t nb_bytes_per_row = flush_window.x_max - flush_window.x_min + 1;
+    
+    /* Stats */
+    oled_descriptor->frame_buffer_flush_start_time = timer_get_systick();
+    oled_descriptor->frame_buffer_last_flush_nb_bytes = nb_bytes_per_row * (flush_window.y_max - flush_window.y_min + 1);
+    
+    if (nb_bytes_per_row == sizeof(oled_descriptor->frame_buffer[0]))
+    {
+        /* Set pixel write window */
+        sh1122_set_row_address(oled_descriptor, first_row + flush_window.y_min);
+        sh1122_set_column_address(oled_descriptor, 0);
+        
+        /* Start filling the SSD1322 RAM */
+        sh1122_start_data_sending(oled_descriptor);
+        
+        /* Send complete rows in one go, display RAM row address is automatically incremented */
+        dma_oled_init_transfer((void*)&oled_descriptor->sercom_pt->SPI.DATA.reg, (void*)&oled_descriptor->frame_buffer[flush_window.y_min][0], oled_descriptor->frame_buffer_last_flush_nb_bytes, oled_descriptor->dma_trigger_id);
+        oled_descriptor->frame_buffer_flush_in_progress = TRUE;
+        oled_descriptor->frame_buffer_page_flip_pending = oled_descriptor->frame_buffer_page_flip_enabled;
+    } 
+    else
+    {
+        for (int16_t y = flush_window.y_min; y <= flush_window.y_max; y++)
+        {
+            /* Set pixel write window */
+            sh1122_set_row_address(oled_descriptor, first_row + y);
+            sh1122_set_column_address(oled_descriptor, flush_window.x_min);
+            
+            /* Start filling the SSD1322 RAM */
+            sh1122_start_data_sending(oled_descriptor);
+            
+            /* Send row part */
+            dma_oled_init_transfer((void*)&oled_descriptor->sercom_pt->SPI.DATA.reg, (void*)&oled_descriptor->frame_buffer[y][flush_window.x_min], nb_bytes_per_row, oled_descriptor->dma_trigger_id);
+            oled_descriptor->frame_buffer_flush_in_progress = TRUE;
+            
+            /* Wait for the transfer to end, except for the last row which flips pages at completion */
+            if (y != flush_window.y_max)
+            {
+                sh1122_check_for_flush_and_terminate(oled_descriptor);
+            }
+            else
+            {
+                oled_descriptor->frame_buffer_page_flip_pending = oled_descriptor->frame_buffer_page_flip_enabled;
+            }
+        }
+    }
+}    
+
+/*! \fn     sh1122_clear_frame_buffer(sh1122_descriptor_t* oled_descriptor)
+*   \brief  Clear frame buffer
+*   \param  oled_descriptor     Pointer to a sh1122 descriptor struct
+*   \note   Only the rows containing drawn pixels are cleared, by the DMA controller
+*/
+void sh1122_clear_frame_buffer(sh1122_descriptor_t* oled_descriptor)
+{    
+    sh1122_fb_window_t* content_window_pt = &oled_descriptor->frame_buffer_content_window;
+    
+    /* Clear complete drawn rows as bytes outside of the drawn area are already cleared, area then needs to be sent at next flush */
+    if (content_window_pt->y_max >= content_window_pt->y_min)
+    {
+        sh1122_fill_frame_buffer_rows(oled_descriptor, content_window_pt->y_min, content_window_pt->y_max - content_window_pt->y_min + 1, 0x00);
+        #ifdef DEBUG_USB_COMMANDS_ENABLED
+        sh1122_mark_rows_uncaptured(oled_descriptor, content_window_pt->y_min, content_window_pt->y_max);
+        #endif
+    }
+    sh1122_extend_fb_window(&oled_descriptor->frame_buffer_dirty_window, content_window_pt);
+    sh1122_reset_fb_window(content_window_pt);
+}
+
+/*! \fn     sh1122_move_frame_buffer_rows(sh1122_descriptor_t* oled_descriptor, int16_t y_dst, int16_t y_src, int16_t nb_rows)
+*   \brief  Move complete frame buffer rows, to scroll an area without redrawing it
+*   \param  oled_descriptor     Pointer to a sh1122 descriptor struct
+*   \param  y_dst               First destination row
+*   \param  y_src               First source row
+*   \param  nb_rows             Number of rows
+*   \note   Source and destination rows may overlap, rows must be inside the frame buffer
+*/
+void sh1122_move_frame_buffer_rows(sh1122_descriptor_t* oled_descriptor, int16_t y_dst, int16_t y_src, int16_t nb_rows)
+{
+    if ((nb_rows <= 0) || (y_dst == y_src))
+    {
+        return;
+    }
+    
+    /* Wait for a possible ongoing frame buffer fill */
+    sh1122_check_for_fill_and_terminate(oled_descriptor);
+    
+    memmove((void*)&oled_descriptor->frame_buffer[y_dst][0], (void*)&oled_descriptor->frame_buffer[y_src][0], nb_rows * sizeof(oled_descriptor->frame_buffer[0]));
+    sh1122_frame_buffer_mark_dirty(oled_descriptor, 0, y_dst, SH1122_OLED_WIDTH, nb_rows, TRUE);
+}
+#endif
+
+/*! \fn     sh1122_oled_off(sh1122_descriptor_t* oled_descriptor)
+*   \brief  Switch on the screen
+*   \param  oled_descriptor     Pointer to a sh1122 descriptor struct
+*/
+void sh1122_oled_off(sh1122_descriptor_t* oled_descriptor)
+{
+    sh1122_write_single_command(oled_descriptor, SH1122_CMD_SET_DISPLAY_OFF);
+    oled_descriptor->oled_on = FALSE;
+}
+
+/*! \fn     sh1122_oled_on(sh1122_descriptor_t* oled_descriptor)
+*   \brief  Switch on the screen
+*   \param  oled_descriptor     Pointer to a sh1122 descriptor struct
+*/
+void sh1122_oled_on(sh1122_descriptor_t* oled_descriptor)
+{
+    sh1122_write_single_command(oled_descriptor, SH1122_CMD_SET_DISPLAY_ON);
+    oled_descriptor->oled_on = TRUE;
+    timer_delay_ms(100);
+}
+
+/*! \fn     sh1122_invalidate_glyph_cache(sh1122_descriptor_t* oled_descriptor)
+*   \brief  Invalidate the RAM cached glyph data and string sprites (to be called on font or language change)
+*   \param  oled_descriptor     Pointer to a sh1122 descriptor struct
+*/
+void sh1122_invalidate_glyph_cache(sh1122_descriptor_t* oled_descriptor)
+{
+    #ifdef OLED_GLYPH_DESC_CACHE
+    memset((void*)oled_descriptor->glyph_desc_cache, 0x00, sizeof(oled_descriptor->glyph_desc_cache));
+    #endif
+    #ifdef OLED_GLYPH_BITMAP_ARENA
+    memset((void*)oled_descriptor->glyph_arena_entries, 0x00, sizeof(oled_descriptor->glyph_arena_entries));
+    oled_descriptor->glyph_arena_used = 0;
+    #endif
+    #ifdef OLED_STRING_SPRITE_CACHE
+    memset((void*)oled_descriptor->string_sprite_entries, 0x00, sizeof(oled_descriptor->string_sprite_entries));
+    oled_descriptor->string_sprite_arena_used = 0;
+    #endif
+}
+
+/*! \fn     sh1122_set_emergency_font(void)
+*   \brief  Use the flash-stored emergency font (ascii only)
+*   \param  oled_descriptor     Pointer to a sh1122 descriptor struct
+*/
+void sh1122_set_emergency_font(sh1122_descriptor_t* oled_descriptor)
+{
+    oled_descriptor->currentFontAddress = CUSTOM_FS_EMERGENCY_FONT_FILE_ADDR;
+    sh1122_invalidate_glyph_cache(oled_descriptor);
+    custom_fs_read_from_flash((uint8_t*)&oled_descriptor->current_font_header, oled_descriptor->currentFontAddress, sizeof(oled_descriptor->current_font_header));
+    custom_fs_read_from_flash((uint8_t*)&oled_descriptor->current_unicode_inters, oled_descriptor->currentFontAddress + sizeof(oled_descriptor->current_font_header), sizeof(oled_descriptor->current_unicode_inters));
+}
+
+/*! \fn     sh1122_refresh_used_font(void)
+*   \brief  Refreshed used font (in case of init or language change)
+*   \param  oled_descriptor     Pointer to a sh1122 descriptor struct
+*/
+void sh1122_refresh_used_font(sh1122_descriptor_t* oled_descriptor)
+{
+    /* Previously cached glyphs may belong to another font */
+    sh1122_invalidate_glyph_cache(oled_descriptor);
+    
+    if (custom_fs_get_file_address(DEFAULT_FONT_ID, &oled_descriptor->currentFontAddress, CUSTOM_FS_FONTS_TYPE) == RETURN_NOK)
+    {
+        oled_descriptor->currentFontAddress = 0;
+    }
+    else
+    {
+        /* Read font header */
+        custom_fs_read_from_flash((uint8_t*)&oled_descriptor->current_font_header, oled_descriptor->currentFontAddress, sizeof(oled_descriptor->current_font_header));
+        
+        /* Read unicode chars support intervals */
+        custom_fs_read_from_flash((uint8_t*)&oled_descriptor->current_unicode_inters, oled_descriptor->currentFontAddress + sizeof(oled_descriptor->current_font_header), sizeof(oled_descriptor->current_unicode_inters));
+        
+        /* Check for ? support */
+        if (('?' < oled_descriptor->current_unicode_inters[0].interval_start) || ('?' > oled_descriptor->current_unicode_inters[0].interval_end))
+        {
+            oled_descriptor->question_mark_support_described = FALSE;
+        } 
+        else
+        {
+            oled_descriptor->question_mark_support_described = TRUE;
+        }
+    }    
+}
+
+/*! \fn     sh1122_init_display(sh1122_descriptor_t oled_descriptor)
+*   \brief  Initialize a SSD1322 display
+*   \param  oled_descriptor     Pointer to a sh1122 descriptor struct
+*/
+void sh1122_init_display(sh1122_descriptor_t* oled_descriptor)
+{
+    /* Vars init : should already be to 0 but you never know... */
+    oled_descriptor->carriage_return_allowed = FALSE;
+    oled_descriptor->line_feed_allowed = FALSE;
+    oled_descriptor->currentFontAddress = 0;
+    oled_descriptor->max_text_x = SH1122_OLED_WIDTH;
+    oled_descriptor->min_text_x = 0;
+    
+    /* Send the initialization sequence through SPI */
+    for (uint16_t ind = 0; ind < sizeof(sh1122_init_sequence);)
+    {
+        /* nCS set */
+        PORT->Group[oled_descriptor->sh1122_cs_pin_group].OUTCLR.reg = oled_descriptor->sh1122_cs_pin_mask;
+        PORT->Group[oled_descriptor->sh1122_cd_pin_group].OUTCLR.reg = oled_descriptor->sh1122_cd_pin_mask;
+        
+        /* First byte: command */
+        sercom_spi_send_single_byte(oled_descriptor->sercom_pt, sh1122_init_sequence[ind++]);
+        
+        /* Second byte: payload length */
+        uint16_t dataSize = sh1122_init_sequence[ind++];
+        
+        /* If different than 0, send payload */
+        while (dataSize--)
+        {
+            sercom_spi_send_single_byte(oled_descriptor->sercom_pt, sh1122_init_sequence[ind++]);
+        }
+        
+        /* nCS release */
+        PORT->Group[oled_descriptor->sh1122_cs_pin_group].OUTSET.reg = oled_descriptor->sh1122_cs_pin_mask;
+        asm("NOP");asm("NOP");
+    }
+
+    /* Values set by the init sequence */
+    oled_descriptor->display_start_line = SH1122_OLED_INIT_START_LINE;
+    oled_descriptor->contrast_current = SH1122_OLED_INIT_CONTRAST;
+    oled_descriptor->start_line_transition.in_progress = FALSE;
+    oled_descriptor->contrast_transition.in_progress = FALSE;
+    #ifdef OLED_MARQUEE
+    oled_descriptor->marquee_pt = 0;
+    #endif
+    #ifdef OLED_INTERNAL_FRAME_BUFFER
+    oled_descriptor->frame_buffer_flush_in_progress = FALSE;
+    oled_descriptor->display_fill_in_progress = FALSE;
+    oled_descriptor->frame_buffer_fill_in_progress = FALSE;
+    oled_descriptor->frame_buffer_page_flip_enabled = FALSE;
+    oled_descriptor->frame_buffer_page_flip_pending = FALSE;
+    #endif
+
+    /* Clear display */
+    sh1122_clear_current_screen(oled_descriptor);
+    #ifdef OLED_INTERNAL_FRAME_BUFFER
+    memset((void*)oled_descriptor->frame_buffer, 0x00, sizeof(oled_descriptor->frame_buffer));
+    sh1122_reset_fb_window(&oled_descriptor->frame_buffer_content_window);
+    sh1122_reset_fb_window(&oled_descriptor->frame_buffer_dirty_window);
+    sh1122_set_draw_buffer(oled_descriptor, &oled_descriptor->frame_buffer[0][0], 0, SH1122_OLED_HEIGHT);
+    #ifdef DEBUG_USB_COMMANDS_ENABLED
+    memset((void*)oled_descriptor->frame_buffer_uncaptured_rows, 0xFF, sizeof(oled_descriptor->frame_buffer_uncaptured_rows));
+    #endif
+    #elif defined(OLED_BANDED_RENDERING)
+    sh1122_set_draw_buffer(oled_descriptor, &oled_descriptor->band_buffers[0][0][0], 0, OLED_BAND_HEIGHT);
+    #endif
+    #ifdef OLED_BACKGROUND_LAYER
+    oled_descriptor->background_layer_pt = 0;
+    #endif
+
+    /* Switch screen on */    
+    sh1122_write_single_command(oled_descriptor, SH1122_CMD_SET_DISPLAY_ON);
+    oled_descriptor->oled_on = TRUE;
+    
+    /* Set emergency font by default */
+    sh1122_set_emergency_font(oled_descriptor);
+    
+    /* From datasheet : wait 100ms */
+    timer_delay_ms(100);
+}
+
+/*! \fn     sh1122_draw_full_screen_image_from_bitstream(sh1122_descriptor_t* oled_descriptor, bitstream_bitmap_t* bitstream)
+*   \brief  Draw a full screen picture from a bitstream
+*   \param  oled_descriptor     Pointer to a sh1122 descriptor struct
+*   \param  bitstream           Pointer to the bistream
+*/
+void sh1122_draw_full_screen_image_from_bitstream(sh1122_descriptor_t* oled_descriptor, bitstream_bitmap_t* bitstream)
+{
+    /*  So, here's a quick overview if you were to wonder what has been done to improve display speeds:
+    /   Note: the FPS count mentioned here highly depends on the picture itself due to RLE compression
+    /   Using internal flash :
+    /   1) No defines: 28fps
+    /   2) OLED_DMA_TRANSFER: 43fps
+    /   Using external flash :
+    /   1) FLASH_ALONE_ON_SPI_BUS: when defined, reads from the flash are done in a continuous manner, rather than doing multiple reads for different chunks of data: 20fps
+    /   2) FLASH_DMA_FETCHES: when defined, reads from the flash are done using the DMA controller: 26fps
+    /   3) OLED_DMA_TRANSFER: when defined, writes to the oled are done using the DMA controller: 40fps
+    /   4) raw (non RLE) full screen bitmaps: see sh1122_dma_raw_full_screen_bitmap_to_display, display bound at ~60fps
+    /   Note: more or less no performance improvements have been found by overclocking oled spi clk
+    /   TODO: compare sh1122_draw_full_screen_image_from_bitstream performance with sh1122_draw_aligned_image_from_bitstream
+    */
+
+    #ifdef OLED_INTERNAL_FRAME_BUFFER
+    /* Wait for a possible ongoing previous flush */
+    sh1122_check_for_flush_and_terminate(oled_descriptor);
+    sh1122_frame_buffer_mark_dirty(oled_descriptor, 0, 0, SH1122_OLED_WIDTH, SH1122_OLED_HEIGHT, FALSE);
+    #endif
+
+    /* Set pixel write window */
+    sh1122_set_row_address(oled_descriptor, 0);
+    sh1122_set_column_address(oled_descriptor, 0);
+    
+    /* Start filling the SSD1322 RAM */
+    sh1122_start_data_sending(oled_descriptor);
+    
+    /* Depending if we use DMA transfers */
+    #ifdef OLED_DMA_TRANSFER        
+        uint8_t pixel_buffer[2][32];
+        uint32_t buffer_sel = 0;
+        
+        /* Get things going: start first transfer then enter the for(), as we need to wait for OLED DMA after inside the loop */
+        bitstream_bitmap_array_read(bitstream, pixel_buffer[buffer_sel], sizeof(pixel_buffer[0])*2);
+        dma_oled_init_transfer((void*)&oled_descriptor->sercom_pt->SPI.DATA.reg, (void*)pixel_buffer[buffer_sel], sizeof(pixel_buffer[0]), oled_descriptor->dma_trigger_id);
+        
+        for (uint32_t i = 0; i < (SH1122_OLED_WIDTH*SH1122_OLED_HEIGHT) - sizeof(pixel_buffer[0]); i+=sizeof(pixel_buffer[0])*2)
+        {            
+            /* Read from bitstream in the next buffer */
+            bitstream_bitmap_array_read(bitstream, pixel_buffer[(buffer_sel+1)&0x01], sizeof(pixel_buffer[0])*2);
+            
+            /* Wait for transfer done */
+            while(dma_oled_check_and_clear_dma_transfer_flag() == FALSE);
+            
+            /* Init DMA transfer */
+            buffer_sel = (buffer_sel+1) & 0x01;
+            dma_oled_init_transfer((void*)&oled_descriptor->sercom_pt->SPI.DATA.reg, (void*)pixel_buffer[buffer_sel], sizeof(pixel_buffer[0]), oled_descriptor->dma_trigger_id);
+        }
+        
+        /* Wait for data to be transferred */
+        while(dma_oled_check_and_clear_dma_transfer_flag() == FALSE);
+    #else        
+        uint8_t pixel_buffer[16];
+        
+        /* Send all pixels */
+        for (uint32_t i = 0; i < (SH1122_OLED_WIDTH*SH1122_OLED_HEIGHT); i+=sizeof(pixel_buffer)*2)
+        {
+            /* Read from bitstream */
+            bitstream_bitmap_array_read(bitstream, pixel_buffer, sizeof(pixel_buffer)*2);
+            
+            /* Send pixels */
+            for (uint32_t j = 0; j < sizeof(pixel_buffer); j++)
+            {
+                sercom_spi_send_single_byte_without_receive_wait(oled_descriptor->sercom_pt, pixel_buffer[j]);
+            }
+        }
+    #endif
+    
+    /* Wait for spi buffer to be sent */
+    sercom_spi_wait_for_transmit_complete(oled_descriptor->sercom_pt);
+    
+    /* Stop sending data */
+    sh1122_stop_data_sending(oled_descriptor);
+    
+    /* Close bitstream */
+    bitstream_bitmap_close(bitstream);
+}
+
+/*! \fn     sh1122_draw_aligned_image_from_bitstream(sh1122_descriptor_t* oled_descriptor, int16_t x, int16_t y, bitstream_bitmap_t* bitstream, BOOL write_to_buffer)
+*   \brief  Draw a 2 pixels-aligned picture from a bitstream
+*   \param  oled_descriptor     Pointer to a sh1122 descriptor struct
+*   \param  x                   Starting x
+*   \param  y                   Starting y
+*   \param  bitstream           Pointer to the bistream
+*   \param  write_to_buffer     Set to true to write to internal buffer
+*/
+void sh1122_draw_aligned_image_from_bitstream(sh1122_descriptor_t* oled_descriptor, int16_t x, int16_t y, bitstream_bitmap_t* bitstream, BOOL write_to_buffer)
+{
+    uint16_t height = bitstream->height;
+    uint16_t width = bitstream->width;
+    
+    /* Frame buffer: we only support DMA transfers when not writing to buffer */
+    #ifdef SH1122_BUFFERED_DRAWS
+        #ifdef OLED_INTERNAL_FRAME_BUFFER
+        /* Keep track of modified area */
+        sh1122_frame_buffer_mark_dirty(oled_descriptor, x, y, width, height, write_to_buffer);
+        #endif
+        
+        /* Depending if we write in the frame buffer or not */
+        if (write_to_buffer != FALSE)
+        {
+            sh1122_blit_bitstream_to_draw_buffer(oled_descriptor, x, y, bitstream);
+        } 
+        else
+        {
+            #ifdef OLED_INTERNAL_FRAME_BUFFER
+            /* Wait for a possible ongoing previous flush */
+            sh1122_check_for_flush_and_terminate(oled_descriptor);
+            #endif
+            
+            /* Buffer large enough to contain a display line in order to trig one DMA transfer */
+            uint8_t pixel_buffer[2][SH1122_OLED_WIDTH/2];
+            uint32_t buffer_sel = 0;
+            
+            /* Trigger first buffer fill: if we asked more data, the bitstream will return 0s */
+            bitstream_bitmap_array_read(bitstream, pixel_buffer[buffer_sel], width);
+            
+            /* Scan Y */
+            for (uint16_t j = 0; j < height; j++)
+            {
+                /* Set pixel write window */
+                sh1122_set_row_address(oled_descriptor, y+j);
+                sh1122_set_column_address(oled_descriptor, x/2);
+                
+                /* Start filling the SSD1322 RAM */
+                sh1122_start_data_sending(oled_descriptor);
+                
+                /* Trigger DMA transfer for the complete width */
+                dma_oled_init_transfer((void*)&oled_descriptor->sercom_pt->SPI.DATA.reg, (void*)pixel_buffer[buffer_sel], width/2, oled_descriptor->dma_trigger_id);
+                
+                /* Flip buffer, start fetching next line while the transfer is happening */
+                if (j != height-1)
+                {
+                    buffer_sel = (buffer_sel+1) & 0x01;
+                    bitstream_bitmap_array_read(bitstream, pixel_buffer[buffer_sel], width);
+                }
+                
+                /* Wait for transfer done */
+                while(dma_oled_check_and_clear_dma_transfer_flag() == FALSE);
+                
+                /* Wait for spi buffer to be sent */
+                sercom_spi_wait_for_transmit_complete(oled_descriptor->sercom_pt);
+                
+                /* Stop sending data */
+                sh1122_stop_data_sending(oled_descriptor);
+            }
+        }
+    #else    
+        /* Depending if we use DMA transfers */
+        #ifdef OLED_DMA_TRANSFER        
+            /* Buffer large enough to contain a display line in order to trig one DMA transfer */
+            uint8_t pixel_buffer[2][SH1122_OLED_WIDTH/2];
+            uint32_t buffer_sel = 0;
+        
+            /* Trigger first buffer fill: if we asked more data, the bitstream will return 0s */
+            bitstream_bitmap_array_read(bitstream, pixel_buffer[buffer_sel], width);
+        
+            /* Scan Y */
+            for (uint16_t j = 0; j < height; j++)
+            {
+                /* Set pixel write window */
+                sh1122_set_row_address(oled_descriptor, y+j);
+                sh1122_set_column_address(oled_descriptor, x/2);
+            
+                /* Start filling the SSD1322 RAM */
+                sh1122_start_data_sending(oled_descriptor);
+            
+                /* Trigger DMA transfer for the complete width */
+                dma_oled_init_transfer((void*)&oled_descriptor->sercom_pt->SPI.DATA.reg, (void*)pixel_buffer[buffer_sel], width/2, oled_descriptor->dma_trigger_id);  
+            
+                /* Flip buffer, start fetching next line while the transfer is happening */   
+                if (j != height-1)
+                {                
+                    buffer_sel = (buffer_sel+1) & 0x01;
+                    bitstream_bitmap_array_read(bitstream, pixel_buffer[buffer_sel], width);
+                }
+            
+                /* Wait for transfer done */
+                while(dma_oled_check_and_clear_dma_transfer_flag() == FALSE);
+            
+                /* Wait for spi buffer to be sent */
+                sercom_spi_wait_for_transmit_complete(oled_descriptor->sercom_pt);
+            
+                /* Stop sending data */
+                sh1122_stop_data_sending(oled_descriptor);
+            }
+        #else        
+            uint8_t pixel_buffer[16];
+            uint32_t pixel_ind = 0;
+        
+            /* Read from bitstream */
             bitstream_bitmap_array_read(bitstream, pixel_buffer, sizeof(pixel_buffer)*2);
         
-            /* Scan Y */
-            for (uint16_t j = 0; j < height; j++)
+            /* Scan Y */
+            for (uint16_t j = 0; j < height; j++)
+            {
+                /* Set pixel write window */
+                sh1122_set_row_address(oled_descriptor, y+j);
+                sh1122_set_column_address(oled_descriptor, x/2);
+            
+                /* Start filling the SSD1322 RAM */
+                sh1122_start_data_sending(oled_descriptor);
+            
+                /* Scan X */
+                for (uint16_t i = 0; i < width; i+=2)
+                {
+                    sercom_spi_send_single_byte_without_receive_wait(oled_descriptor->sercom_pt, pixel_buffer[pixel_ind++]);     
+                
+                    /* Check for empty buffer */
+                    if (pixel_ind == sizeof(pixel_buffer))
+                    {
+                        bitstream_bitmap_array_read(bitstream, pixel_buffer, sizeof(pixel_buffer)*2);
+                        pixel_ind = 0;
+                    }
+                }
+            
+                /* Wait for spi buffer to be sent */
+                sercom_spi_wait_for_transmit_complete(oled_descriptor->sercom_pt);
+            
+                /* Stop sending data */
+                sh1122_stop_data_sending(oled_descriptor);
+            }
+        #endif   
+    #endif 
+        
+    /* Close bitstream */
+    bitstream_bitmap_close(bitstream);    
+}   
+
+/*! \fn     sh1122_draw_non_aligned_image_from_bitstream(sh1122_descriptor_t* oled_descriptor, int16_t x, int16_t y, bitstream_bitmap_t* bitstream, BOOL write_to_buffer)
+*   \brief  Draw a 2 pixels non aligned picture from a bitstream
+*   \param  oled_descriptor     Pointer to a sh1122 descriptor struct
+*   \param  x                   Starting x
+*   \param  y                   Starting y
+*   \param  bitstream           Pointer to the bistream
+*   \param  write_to_buffer    Set to true to write to internal buffer
+*/
+void sh1122_draw_non_aligned_image_from_bitstream(sh1122_descriptor_t* oled_descriptor, int16_t x, int16_t y, bitstream_bitmap_t* bitstream, BOOL write_to_buffer)
+{
+    uint16_t height = bitstream->height;
+    uint16_t width = bitstream->width;
+    uint16_t xoff = x - (x / 2) * 2;
+    
+    #ifdef SH1122_BUFFERED_DRAWS
+    #ifdef OLED_INTERNAL_FRAME_BUFFER
+    /* Keep track of modified area */
+    sh1122_frame_buffer_mark_dirty(oled_descriptor, x, y, width, height, write_to_buffer);
+    #endif
+    
+    if (write_to_buffer != FALSE)
+    {
+        sh1122_blit_bitstream_to_draw_buffer(oled_descriptor, x, y, bitstream);
+    } 
+    else
+    {
+    #endif
+    for (uint16_t yind=0; yind < height; yind++)
+    {
+        uint16_t xind = 0;
+        uint16_t pixels = 0;
+        
+        /* Set pixel write window */
+        sh1122_set_row_address(oled_descriptor, y+yind);
+        sh1122_set_column_address(oled_descriptor, x/2);
+        
+        /* Start filling the SSD1322 RAM */
+        sh1122_start_data_sending(oled_descriptor);
+
+        /* Start x not a multiple of 2 */
+        if (xoff != 0)
+        {
+            /* Set xind to 1 as we're writing a pixel */
+            xind = 1;
+            
+            /* Fetch one pixel */
+            pixels = bitstream_bitmap_read(bitstream, 1);
+
+            /* Fill existing pixels if available */
+            if ((x/2) == oled_descriptor->gddram_pixel[y+yind].xaddr)
+            {
+                pixels |= oled_descriptor->gddram_pixel[y+yind].pixels;
+            }
+
+            /* Send the 2 pixels to the display */
+            sercom_spi_send_single_byte_without_receive_wait(oled_descriptor->sercom_pt, (uint8_t)(pixels & 0x00FF));
+        }
+        
+        /* Start x multiple of 2, start filling */
+        for (; xind < width; xind+=2)
+        {
+            if ((xind+2) <= width)
+            {
+                pixels = bitstream_bitmap_read(bitstream, 2);
+            }
+            else
+            {
+                pixels = bitstream_bitmap_read(bitstream, 1) << 4;
+            }
+            
+            // Send 2 pixels to the display
+            sercom_spi_send_single_byte_without_receive_wait(oled_descriptor->sercom_pt, (uint8_t)(pixels & 0x00FF));
+        }
+        
+        /* Store pixel data in our gddram buffer for later merging */
+        if (pixels != 0)
+        {
+            oled_descriptor->gddram_pixel[y+yind].pixels = (uint8_t)pixels;
+            oled_descriptor->gddram_pixel[y+yind].xaddr = (x+width-1)/2;
+        }
+            
+        /* Wait for spi buffer to be sent */
+        sercom_spi_wait_for_transmit_complete(oled_descriptor->sercom_pt);
+            
+        /* Stop sending data */
+        sh1122_stop_data_sending(oled_descriptor);
+    }
+    #ifdef SH1122_BUFFERED_DRAWS
+    }
+    #endif
+    
+    /* Close bitstream */
+    bitstream_bitmap_close(bitstream);
+}    
+
+/*! \fn     sh1122_draw_image_from_bitstream(sh1122_descriptor_t* oled_descriptor, int16_t x, int16_t y, bitstream_t* bs, BOOL write_to_buffer)
+*   \brief  Draw a picture from a bitstream
+*   \param  oled_descriptor     Pointer to a sh1122 descriptor struct
+*   \param  x                   Starting x
+*   \param  y                   Starting y
+*   \param  bitstream           Pointer to the bistream
+*   \param  write_to_buffer     Set to true to write to internal buffer
+*/
+void sh1122_draw_image_from_bitstream(sh1122_descriptor_t* oled_descriptor, int16_t x, int16_t y, bitstream_bitmap_t* bitstream, BOOL write_to_buffer)
+{
+    #ifndef SH1122_BUFFERED_DRAWS
+    /* No buffer to write to */
+    write_to_buffer = FALSE;
+    #endif
+    
+    if ((x == 0) && (y == 0) && (bitstream->width == SH1122_OLED_WIDTH) && (bitstream->height == SH1122_OLED_HEIGHT) && (write_to_buffer == FALSE))
+    {
+        /* Dedicated code to allow faster update */
+        //sh1122_draw_aligned_image_from_bitstream(oled_descriptor, x, y, bitstream);
+        sh1122_draw_full_screen_image_from_bitstream(oled_descriptor, bitstream);        
+    }
+    else if ((bitstream->width % 2 == 0) && (x % 2 == 0))
+    {
+        /* If we're 2 pixels aligned, call a dedicated function for fast processing */
+        sh1122_draw_aligned_image_from_bitstream(oled_descriptor, x, y, bitstream, write_to_buffer);
+    } 
+    else
+    {
+        sh1122_draw_non_aligned_image_from_bitstream(oled_descriptor, x, y, bitstream, write_to_buffer);
+    }    
+}
+
+#if defined(OLED_INTERNAL_FRAME_BUFFER) && defined(FLASH_ALONE_ON_SPI_BUS) && defined(FLASH_DMA_FETCHES)
+/*! \fn     sh1122_dma_raw_bitmap_to_frame_buffer(sh1122_descriptor_t* oled_descriptor, int16_t x, int16_t y, bitmap_t* bitmap, custom_fs_address_t address)
+*   \brief  Fast path for raw bitmaps aligned on frame buffer bytes: rows are transferred from the external flash by the DMA controller
+*   \param  oled_descriptor     Pointer to a sh1122 descriptor struct
+*   \param  x                   Starting x
+*   \param  y                   Starting y
+*   \param  bitmap              Pointer to the bitmap header
+*   \param  address             Bitmap data address in flash
+*   \return RETURN_OK if the bitmap was drawn, RETURN_NOK if it isn't eligible to this fast path
+*   \note   Rows go straight to the frame buffer if the area doesn't contain drawn pixels, otherwise they're OR-ed from a row buffer
+*/
+static RET_TYPE sh1122_dma_raw_bitmap_to_frame_buffer(sh1122_descriptor_t* oled_descriptor, int16_t x, int16_t y, bitmap_t* bitmap, custom_fs_address_t address)
+{
+    sh1122_fb_window_t* content_window_pt = &oled_descriptor->frame_buffer_content_window;
+    uint16_t nb_bytes_per_row = bitmap->width / 2;
+    BOOL area_empty;
+    
+    /* Raw display depth bitmaps, aligned on frame buffer bytes and fully inside the frame buffer */
+    if (((bitmap->flags & CUSTOM_FS_BITMAP_RLE_FLAG) != 0) || (bitmap->depth != SH1122_OLED_BPP) || (oled_descriptor->draw_buffer_pt != &oled_descriptor->frame_buffer[0][0]))
+    {
+        return RETURN_NOK;
+    }
+    if (((x & 0x01) != 0) || ((bitmap->width & 0x01) != 0) || (bitmap->width == 0) || (bitmap->height == 0) || (bitmap->dataSize < nb_bytes_per_row * bitmap->height))
+    {
+        return RETURN_NOK;
+    }
+    if ((x < 0) || (y < 0) || ((x + bitmap->width) > SH1122_OLED_WIDTH) || ((y + bitmap->height) > SH1122_OLED_HEIGHT))
+    {
+        return RETURN_NOK;
+    }
+    
+    /* Check if the area contains drawn pixels, before marking it */
+    area_empty = ((content_window_pt->y_max < content_window_pt->y_min) || ((y + bitmap->height - 1) < content_window_pt->y_min) || (y > content_window_pt->y_max) || ((x/2 + nb_bytes_per_row - 1) < content_window_pt->x_min) || ((x/2) > content_window_pt->x_max)) ? TRUE : FALSE;
+    sh1122_frame_buffer_mark_dirty(oled_descriptor, x, y, bitmap->width, bitmap->height, TRUE);
+    
+    /* Wait for a possible ongoing frame buffer fill */
+    sh1122_check_for_fill_and_terminate(oled_descriptor);
+    
+    if (area_empty != FALSE)
+    {
+        if (nb_bytes_per_row == sizeof(oled_descriptor->frame_buffer[0]))
+        {
+            /* Complete rows: one transfer */
+            custom_fs_continuous_read_from_flash(&oled_descriptor->frame_buffer[y][0], address, nb_bytes_per_row * bitmap->height, TRUE);
+            while(dma_custom_fs_check_and_clear_dma_transfer_flag() == FALSE);
+        }
+        else
+        {
+            /* One transfer per row, the flash read continuing where it stopped */
+            for (uint16_t j = 0; j < bitmap->height; j++)
+            {
+                custom_fs_continuous_read_from_flash(&oled_descriptor->frame_buffer[y+j][x/2], address, nb_bytes_per_row, TRUE);
+                while(dma_custom_fs_check_and_clear_dma_transfer_flag() == FALSE);
+            }
+        }
+    }
+    else
+    {
+        /* Pixels to OR with: fetch the next row while OR-ing the current one */
+        uint32_t row_buffers[2][SH1122_OLED_WIDTH/8];
+        uint32_t buffer_sel = 0;
+        
+        custom_fs_continuous_read_from_flash((uint8_t*)row_buffers[buffer_sel], address, nb_bytes_per_row, TRUE);
+        for (uint16_t j = 0; j < bitmap->height; j++)
+        {
+            while(dma_custom_fs_check_and_clear_dma_transfer_flag() == FALSE);
+            if (j != bitmap->height-1)
+            {
+                custom_fs_continuous_read_from_flash((uint8_t*)row_buffers[(buffer_sel+1) & 0x01], address, nb_bytes_per_row, TRUE);
+            }
+            sh1122_blit_row(oled_descriptor->frame_buffer[y+j], x, (uint8_t*)row_buffers[buffer_sel], bitmap->width, sh1122_get_foreground_blit_mode(oled_descriptor));
+            buffer_sel = (buffer_sel+1) & 0x01;
+        }
+    }
+    custom_fs_stop_continuous_read_from_flash();
+    
+    return RETURN_OK;
+}
+#endif
+
+#if defined(FLASH_ALONE_ON_SPI_BUS) && defined(FLASH_DMA_FETCHES) && defined(OLED_DMA_TRANSFER)
+/*! \fn     sh1122_dma_raw_full_screen_bitmap_to_display(sh1122_descriptor_t* oled_descriptor, int16_t x, int16_t y, bitmap_t* bitmap, custom_fs_address_t address)
+*   \brief  Fast path for raw full screen bitmaps: data is moved from the external flash to the display by the DMA controller, through a RAM ring
+*   \param  oled_descriptor     Pointer to a sh1122 descriptor struct
+*   \param  x                   Starting x
+*   \param  y                   Starting y
+*   \param  bitmap              Pointer to the bitmap header
+*   \param  address             Bitmap data address in flash
+*   \return RETURN_OK if the bitmap was drawn, RETURN_NOK if it isn't eligible to this fast path
+*   \note   The CPU only arms the flash read of a slot and the display transfer of the other one: no decoding or copy is done
+*/
+static RET_TYPE sh1122_dma_raw_full_screen_bitmap_to_display(sh1122_descriptor_t* oled_descriptor, int16_t x, int16_t y, bitmap_t* bitmap, custom_fs_address_t address)
+{
+    uint32_t ring[2][SH1122_DMA_RING_SLOT_SIZE/sizeof(uint32_t)];
+    uint16_t nb_slots = (SH1122_OLED_WIDTH*SH1122_OLED_HEIGHT/2) / SH1122_DMA_RING_SLOT_SIZE;
+    
+    /* Raw display depth bitmaps, covering the complete screen */
+    if (((bitmap->flags & CUSTOM_FS_BITMAP_RLE_FLAG) != 0) || (bitmap->depth != SH1122_OLED_BPP))
+    {
+        return RETURN_NOK;
+    }
+    if ((x != 0) || (y != 0) || (bitmap->width != SH1122_OLED_WIDTH) || (bitmap->height != SH1122_OLED_HEIGHT) || (bitmap->dataSize < SH1122_OLED_WIDTH*SH1122_OLED_HEIGHT/2))
+    {
+        return RETURN_NOK;
+    }
+    
+    #ifdef OLED_INTERNAL_FRAME_BUFFER
+    /* Wait for a possible ongoing previous flush */
+    sh1122_check_for_flush_and_terminate(oled_descriptor);
+    sh1122_frame_buffer_mark_dirty(oled_descriptor, 0, 0, SH1122_OLED_WIDTH, SH1122_OLED_HEIGHT, FALSE);
+    #endif
+    
+    /* Set pixel write window */
+    sh1122_set_row_address(oled_descriptor, 0);
+    sh1122_set_column_address(oled_descriptor, 0);
+    
+    /* Start filling the SSD1322 RAM */
+    sh1122_start_data_sending(oled_descriptor);
+    
+    /* Get things going: fetch the first slot */
+    custom_fs_continuous_read_from_flash((uint8_t*)ring[0], address, SH1122_DMA_RING_SLOT_SIZE, TRUE);
+    
+    for (uint16_t i = 0; i < nb_slots; i++)
+    {
+        /* Wait for the slot to be fetched and for the other slot to be sent */
+        while(dma_custom_fs_check_and_clear_dma_transfer_flag() == FALSE);
+        if (i != 0)
+        {
+            while(dma_oled_check_and_clear_dma_transfer_flag() == FALSE);
+        }
+        
+        /* Send the slot, fetch the next data in the other one. The flash being faster than the display, the display is never starved */
+        dma_oled_init_transfer((void*)&oled_descriptor->sercom_pt->SPI.DATA.reg, (void*)ring[i & 0x01], SH1122_DMA_RING_SLOT_SIZE, oled_descriptor->dma_trigger_id);
+        if (i != nb_slots-1)
+        {
+            custom_fs_continuous_read_from_flash((uint8_t*)ring[(i+1) & 0x01], address, SH1122_DMA_RING_SLOT_SIZE, TRUE);
+        }
+    }
+    custom_fs_stop_continuous_read_from_flash();
+    
+    /* Wait for data to be transferred, as the ring is on the stack */
+    while(dma_oled_check_and_clear_dma_transfer_flag() == FALSE);
+    
+    /* Wait for spi buffer to be sent */
+    sercom_spi_wait_for_transmit_complete(oled_descriptor->sercom_pt);
+    
+    /* Stop sending data */
+    sh1122_stop_data_sending(oled_descriptor);
+    
+    return RETURN_OK;
+}
+#endif
+
+/*! \fn     sh1122_display_bitmap_from_flash_at_recommended_position(sh1122_descriptor_t* oled_descriptor, uint32_t file_id, BOOL write_to_buffer)
+*   \brief  Display a bitmap stored in the external flash, at its recommended position
+*   \param  oled_descriptor     Pointer to a sh1122 descriptor struct
+*   \param  file_id             Bitmap file ID
+*   \param  write_to_buffer     Set to true to write to internal buffer
+*   \return success status
+*/
+RET_TYPE sh1122_display_bitmap_from_flash_at_recommended_position(sh1122_descriptor_t* oled_descriptor, uint32_t file_id, BOOL write_to_buffer)
+{
+    custom_fs_address_t file_adress;
+    bitstream_bitmap_t bitstream;
+    bitmap_t bitmap;
+
+    /* Fetch file address */
+    if (custom_fs_get_file_address(file_id, &file_adress, CUSTOM_FS_BITMAP_TYPE) != RETURN_OK)
+    {
+        return RETURN_NOK;
+    }
+
+    /* Read bitmap info data */
+    custom_fs_read_from_flash((uint8_t *)&bitmap, file_adress, sizeof(bitmap));
+    
+    #if defined(OLED_INTERNAL_FRAME_BUFFER) && defined(FLASH_ALONE_ON_SPI_BUS) && defined(FLASH_DMA_FETCHES)
+    /* Raw aligned bitmaps: DMA transfers straight from the flash */
+    if ((write_to_buffer != FALSE) && (sh1122_dma_raw_bitmap_to_frame_buffer(oled_descriptor, bitmap.xpos, bitmap.ypos, &bitmap, file_adress + sizeof(bitmap)) == RETURN_OK))
+    {
+        return RETURN_OK;
+    }
+    #endif
+    
+    #if defined(FLASH_ALONE_ON_SPI_BUS) && defined(FLASH_DMA_FETCHES) && defined(OLED_DMA_TRANSFER)
+    /* Raw full screen bitmaps: DMA transfers from the flash to the display */
+    if ((write_to_buffer == FALSE) && (sh1122_dma_raw_full_screen_bitmap_to_display(oled_descriptor, bitmap.xpos, bitmap.ypos, &bitmap, file_adress + sizeof(bitmap)) == RETURN_OK))
+    {
+        return RETURN_OK;
+    }
+    #endif
+    
+    /* Init bitstream */
+    bitstream_bitmap_init(&bitstream, &bitmap, file_adress + sizeof(bitmap), TRUE);
+    
+    /* Draw bitmap */
+    sh1122_draw_image_from_bitstream(oled_descriptor, bitmap.xpos, bitmap.ypos, &bitstream, write_to_buffer);
+    
+    return RETURN_OK;    
+}
+
+/*! \fn     sh1122_display_bitmap_from_flash(sh1122_descriptor_t* oled_descriptor, int16_t x, int16_t y, uint32_t file_id, BOOL write_to_buffer)
+*   \brief  Display a bitmap stored in the external flash
+*   \param  oled_descriptor     Pointer to a sh1122 descriptor struct
+*   \param  x                   Starting x
+*   \param  y                   Starting y
+*   \param  file_id             Bitmap file ID
+*   \param  write_to_buffer    Set to true to write to internal buffer
+*   \return success status
+*/
+RET_TYPE sh1122_display_bitmap_from_flash(sh1122_descriptor_t* oled_descriptor, int16_t x, int16_t y, uint32_t file_id, BOOL write_to_buffer)
+{
+    custom_fs_address_t file_adress;
+    bitstream_bitmap_t bitstream;
+    bitmap_t bitmap;
+
+    /* Fetch file address */
+    if (custom_fs_get_file_address(file_id, &file_adress, CUSTOM_FS_BITMAP_TYPE) != RETURN_OK)
+    {
+        return RETURN_NOK;
+    }    
+
+    /* Read bitmap info data */
+    custom_fs_read_from_flash((uint8_t *)&bitmap, file_adress, sizeof(bitmap));
+    
+    #if defined(OLED_INTERNAL_FRAME_BUFFER) && defined(FLASH_ALONE_ON_SPI_BUS) && defined(FLASH_DMA_FETCHES)
+    /* Raw aligned bitmaps: DMA transfers straight from the flash */
+    if ((write_to_buffer != FALSE) && (sh1122_dma_raw_bitmap_to_frame_buffer(oled_descriptor, x, y, &bitmap, file_adress + sizeof(bitmap)) == RETURN_OK))
+    {
+        return RETURN_OK;
+    }
+    #endif
+    
+    #if defined(FLASH_ALONE_ON_SPI_BUS) && defined(FLASH_DMA_FETCHES) && defined(OLED_DMA_TRANSFER)
+    /* Raw full screen bitmaps: DMA transfers from the flash to the display */
+    if ((write_to_buffer == FALSE) && (sh1122_dma_raw_full_screen_bitmap_to_display(oled_descriptor, x, y, &bitmap, file_adress + sizeof(bitmap)) == RETURN_OK))
+    {
+        return RETURN_OK;
+    }
+    #endif
+    
+    /* Init bitstream */
+    bitstream_bitmap_init(&bitstream, &bitmap, file_adress + sizeof(bitmap), TRUE);
+    
+    /* Draw bitmap */
+    sh1122_draw_image_from_bitstream(oled_descriptor, x, y, &bitstream, write_to_buffer);
+    
+    return RETURN_OK;  
+} 
+
+/*! \fn     sh1122_rewind_animation(sh1122_animation_t* animation)
+*   \brief  Set an animation back to its first frame
+*   \param  animation           Pointer to the animation
+*/
+void sh1122_rewind_animation(sh1122_animation_t* animation)
+{
+    animation->next_frame_addr = animation->first_frame_addr;
+    animation->next_frame = 0;
+}
+
+/*! \fn     sh1122_open_animation(uint32_t file_id, sh1122_animation_t* animation)
+*   \brief  Open an animation stored in the external flash
+*   \param  file_id             Animation binary file ID
+*   \param  animation           Pointer to the animation to be initialized
+*   \return success status, RETURN_NOK if the file isn't a supported animation
+*/
+RET_TYPE sh1122_open_animation(uint32_t file_id, sh1122_animation_t* animation)
+{
+    custom_fs_address_t file_adress;
+    animation_header_t header;
+    
+    /* Fetch file address */
+    if (custom_fs_get_file_address(file_id, &file_adress, CUSTOM_FS_BINARY_TYPE) != RETURN_OK)
+    {
+        return RETURN_NOK;
+    }
+    
+    /* Read animation header, located after the binary file size */
+    file_adress += sizeof(custom_fs_binfile_size_t);
+    custom_fs_read_from_flash((uint8_t*)&header, file_adress, sizeof(header));
+    
+    /* Check that we support this file */
+    if ((header.magic != CUSTOM_FS_ANIMATION_MAGIC) || (header.depth != SH1122_OLED_BPP) || (header.nb_frames == 0))
+    {
+        return RETURN_NOK;
+    }
+    
+    animation->first_frame_addr = file_adress + sizeof(header);
+    animation->frame_period_ms = header.frame_period_ms;
+    animation->nb_frames = header.nb_frames;
+    sh1122_rewind_animation(animation);
+    return RETURN_OK;
+}
+
+/*! \fn     sh1122_draw_animation_frame(sh1122_descriptor_t* oled_descriptor, sh1122_animation_t* animation, BOOL write_to_buffer)
+*   \brief  Draw the next animation frame, only streaming the rectangles changed since the previous frame
+*   \param  oled_descriptor     Pointer to a sh1122 descriptor struct
+*   \param  animation           Pointer to the animation
+*   \param  write_to_buffer     Set to true to write to internal buffer
+*   \return RETURN_NOK if all frames were already drawn, or if the frame has xored rectangles and write_to_buffer isn't set
+*   \note   Xored rectangles need the previous frame pixels, only available in the draw buffer
+*/
+RET_TYPE sh1122_draw_animation_frame(sh1122_descriptor_t* oled_descriptor, sh1122_animation_t* animation, BOOL write_to_buffer)
+{
+    custom_fs_address_t read_address = animation->next_frame_addr;
+    uint8_t row_buffer[2][SH1122_OLED_WIDTH/2];
+    BOOL oled_transfer_ongoing = FALSE;
+    RET_TYPE return_val = RETURN_OK;
+    uint32_t buffer_sel = 0;
+    animation_frame_t frame;
+    animation_rect_t rect;
+    
+    #ifndef SH1122_BUFFERED_DRAWS
+    /* No buffer to write to */
+    write_to_buffer = FALSE;
+    #endif
+    
+    /* Last frame already drawn? */
+    if (animation->next_frame >= animation->nb_frames)
+    {
+        return RETURN_NOK;
+    }
+    
+    #ifdef OLED_INTERNAL_FRAME_BUFFER
+    /* Wait for a possible ongoing previous flush */
+    if (write_to_buffer == FALSE)
+    {
+        sh1122_check_for_flush_and_terminate(oled_descriptor);
+    }
+    #endif
+    
+    /* Stream the frame: frame header, then rectangle headers each followed by their data */
+    custom_fs_continuous_read_from_flash((uint8_t*)&frame, read_address, sizeof(frame), FALSE);
+    read_address += sizeof(frame);
+    
+    for (uint16_t i = 0; i < frame.nb_rects; i++)
+    {
+        uint16_t rle_count = 0;
+        uint8_t rle_byte = 0;
+        
+        custom_fs_continuous_read_from_flash((uint8_t*)&rect, read_address, sizeof(rect), FALSE);
+        read_address += sizeof(rect);
+        
+        /* Malformed rectangle: skip the rest of the frame */
+        if (rect.nb_columns > sizeof(row_buffer[0]))
+        {
+            return_val = RETURN_NOK;
+            break;
+        }
+        
+        /* Clip to the display width */
+        uint16_t nb_visible_columns = 0;
+        if (rect.column < SH1122_OLED_WIDTH/2)
+        {
+            nb_visible_columns = ((rect.column + rect.nb_columns) > SH1122_OLED_WIDTH/2) ? (SH1122_OLED_WIDTH/2 - rect.column) : rect.nb_columns;
+        }
+        
+        #ifdef OLED_INTERNAL_FRAME_BUFFER
+        /* Keep track of modified area */
+        sh1122_frame_buffer_mark_dirty(oled_descriptor, rect.column*2, rect.y, rect.nb_columns*2, rect.height, write_to_buffer);
+        #endif
+        
+        /* Direct writes can't be xored with the previous frame */
+        if (((rect.flags & CUSTOM_FS_ANIMATION_XOR_FLAG) != 0) && (write_to_buffer == FALSE))
+        {
+            return_val = RETURN_NOK;
+        }
+        
+        for (uint16_t j = 0; j < rect.height; j++)
+        {
+            uint8_t* data_pt = row_buffer[buffer_sel];
+            
+            /* Fetch row data */
+            if ((rect.flags & CUSTOM_FS_ANIMATION_RLE_FLAG) != 0)
             {
-                /* Set pixel write window */
-                sh1122_set_row_address(oled_descriptor, y+j);
-                sh1122_set_column_address(oled_descriptor, x/2);
+                for (uint16_t k = 0; k < rect.nb_columns; k++)
+                {
+                    if (rle_count == 0)
+                    {
+                        uint8_t rle_pair[2];
+                        custom_fs_continuous_read_from_flash(rle_pair, read_address, sizeof(rle_pair), FALSE);
+                        read_address += sizeof(rle_pair);
+                        rle_count = rle_pair[0] + 1;
+                        rle_byte = rle_pair[1];
+                    }
+                    data_pt[k] = rle_byte;
+                    rle_count--;
+                }
+            } 
+            else
+            {
+                custom_fs_continuous_read_from_flash(data_pt, read_address, rect.nb_columns, FALSE);
+                read_address += rect.nb_columns;
+            }
             
-                /* Start filling the SSD1322 RAM */
-                sh1122_start_data_sending(oled_descriptor);
+            /* Nothing to display? */
+            if ((nb_visible_columns == 0) || ((rect.y + j) >= SH1122_OLED_HEIGHT))
+            {
+                continue;
+            }
             
-                /* Scan X */
-                for (uint16_t i = 0; i < width; i+=2)
-                {
-                    sercom_spi_send_single_byte_without_receive_wait(oled_descriptor->sercom_pt, pixel_buffer[pixel_ind++]);     
+            #ifdef SH1122_BUFFERED_DRAWS
+            if (write_to_buffer != FALSE)
+            {
+                uint8_t* row_pt = sh1122_get_draw_buffer_row(oled_descriptor, rect.y + j);
                 
-                    /* Check for empty buffer */
-                    if (pixel_ind == sizeof(pixel_buffer))
+                if (row_pt == 0)
+                {
+                    continue;
+                }
+                else if ((rect.flags & CUSTOM_FS_ANIMATION_XOR_FLAG) != 0)
+                {
+                    for (uint16_t k = 0; k < nb_visible_columns; k++)
                     {
-                        bitstream_bitmap_array_read(bitstream, pixel_buffer, sizeof(pixel_buffer)*2);
-                        pixel_ind = 0;
+                        row_pt[rect.column + k] ^= data_pt[k];
                     }
                 }
+                else
+                {
+                    memcpy(&row_pt[rect.column], data_pt, nb_visible_columns);
+                }
+            }
+            else
+            #endif
+            if ((rect.flags & CUSTOM_FS_ANIMATION_XOR_FLAG) == 0)
+            {
+                /* Wait for the previous row to be sent, its data was fetched in the other buffer */
+                if (oled_transfer_ongoing != FALSE)
+                {
+                    while(dma_oled_check_and_clear_dma_transfer_flag() == FALSE);
+                    sercom_spi_wait_for_transmit_complete(oled_descriptor->sercom_pt);
+                    sh1122_stop_data_sending(oled_descriptor);
+                }
+                
+                /* Set pixel write window */
+                sh1122_set_row_address(oled_descriptor, rect.y + j);
+                sh1122_set_column_address(oled_descriptor, rect.column);
+                
+                /* Send the row while the next one is fetched */
+                sh1122_start_data_sending(oled_descriptor);
+                dma_oled_init_transfer((void*)&oled_descriptor->sercom_pt->SPI.DATA.reg, (void*)data_pt, nb_visible_columns, oled_descriptor->dma_trigger_id);
+                buffer_sel = (buffer_sel+1) & 0x01;
+                oled_transfer_ongoing = TRUE;
+            }
+        }
+    }
+    custom_fs_stop_continuous_read_from_flash();
+    
+    /* Wait for the last row to be sent */
+    if (oled_transfer_ongoing != FALSE)
+    {
+        while(dma_oled_check_and_clear_dma_transfer_flag() == FALSE);
+        sercom_spi_wait_for_transmit_complete(oled_descriptor->sercom_pt);
+        sh1122_stop_data_sending(oled_descriptor);
+    }
+    
+    /* Move to next frame */
+    animation->next_frame_addr += frame.frame_size;
+    animation->next_frame++;
+    return return_val;
+}
+
+/*! \fn     sh1122_draw_rectangle(sh1122_descriptor_t* oled_descriptor, int16_t x, int16_t y, int16_t width, int16_t height, uint16_t color, BOOL write_to_buffer)
+*   \brief  Draw a rectangle on the screen
+*   \param  oled_descriptor     Pointer to a sh1122 descriptor struct
+*   \param  x                   Starting x
+*   \param  y                   Starting y
+*   \param  width               Width
+*   \param  height              Height
+*   \param  color               4 bits color
+*   \param  write_to_buffer     Set to true to write to internal buffer
+*/
+void sh1122_draw_rectangle(sh1122_descriptor_t* oled_descriptor, int16_t x, int16_t y, int16_t width, int16_t height, uint16_t color, BOOL write_to_buffer)
+{
+    uint16_t xoff = x - (x / 2) * 2;
+    
+    #ifdef OLED_INTERNAL_FRAME_BUFFER
+    /* Keep track of modified area */
+    sh1122_frame_buffer_mark_dirty(oled_descriptor, x, y, width, height, write_to_buffer);
+    #endif
+    
+    #ifdef SH1122_BUFFERED_DRAWS
+    if (write_to_buffer != FALSE)
+    {
+        #ifdef OLED_INTERNAL_FRAME_BUFFER
+        /* Complete frame buffer rows: filled by the DMA controller */
+        if ((oled_descriptor->draw_buffer_pt == &oled_descriptor->frame_buffer[0][0]) && (x <= 0) && ((x + width) >= SH1122_OLED_WIDTH))
+        {
+            int16_t y_start = (y < 0) ? 0 : y;
+            int16_t y_end = ((y + height) > SH1122_OLED_HEIGHT) ? SH1122_OLED_HEIGHT : (y + height);
             
-                /* Wait for spi buffer to be sent */
-                sercom_spi_wait_for_transmit_complete(oled_descriptor->sercom_pt);
+            if (y_end > y_start)
+            {
+                sh1122_fill_frame_buffer_rows(oled_descriptor, y_start, y_end - y_start, (uint8_t)((color & 0x0F) * 0x11));
+            }
+            return;
+        }
+        #endif
+        
+        for (int16_t yind = 0; yind < height; yind++)
+        {
+            uint8_t* row_pt = sh1122_get_draw_buffer_row(oled_descriptor, y+yind);
+            
+            /* Row not in draw buffer */
+            if (row_pt == 0)
+            {
+                continue;
+            }
+            
+            /* Set pixels, clipping to the screen borders */
+            sh1122_fill_row(row_pt, x, width, (uint8_t)color, OLED_BLIT_OPAQUE);
+        }
+        return;
+    }
+    #endif
+
+    for (uint16_t yind=0; yind < height; yind++)
+    {
+        BOOL transfer_running = FALSE;
+        uint16_t nb_full_bytes = 0;
+        uint16_t xind = 0;
+        uint16_t pixels = 0;
+        
+        /* Set pixel write window */
+        sh1122_set_row_address(oled_descriptor, y+yind);
+        sh1122_set_column_address(oled_descriptor, x/2);
+        
+        /* Start filling the SSD1322 RAM */
+        sh1122_start_data_sending(oled_descriptor);
+
+        /* Start x not a multiple of 2 */
+        if (xoff != 0)
+        {
+            /* Set xind to 1 as we're writing a pixel */
+            xind = 1;
             
-                /* Stop sending data */
-                sh1122_stop_data_sending(oled_descriptor);
+            /* one pixel */
+            pixels = color;
+
+            /* Fill existing pixels if available */
+            if ((x/2) == oled_descriptor->gddram_pixel[y+yind].xaddr)
+            {
+                pixels |= oled_descriptor->gddram_pixel[y+yind].pixels;
             }
-        #endif   
-    #endif 
+
+            /* Send the 2 pixels to the display */
+            sercom_spi_send_single_byte_without_receive_wait(oled_descriptor->sercom_pt, (uint8_t)(pixels & 0x00FF));
+        }
         
-    /* Close bitstream */
-    bitstream_bitmap_close(bitstream);    
-}   
+        /* Start x multiple of 2: send the bytes of 2 pixels with a DMA fill, leaving the last transfer running */
+        if (xind < width)
+        {
+            nb_full_bytes = (width - xind) / 2;
+        }
+        if (nb_full_bytes != 0)
+        {
+            pixels = color | (color << 4);
+            transfer_running = sh1122_send_fill_bytes(oled_descriptor, (uint8_t)pixels, nb_full_bytes, ((yind == (height-1)) && (((width - xind) & 0x01) == 0)) ? TRUE : FALSE);
+            xind += nb_full_bytes * 2;
+        }
+        
+        /* Start x multiple of 2, start filling */
+        for (; xind < width; xind+=2)
+        {
+            if ((xind+2) <= width)
+            {
+                pixels = color | (color << 4);
+            }
+            else
+            {
+                pixels = color << 4;
+            }
+            
+            // Send 2 pixels to the display
+            sercom_spi_send_single_byte_without_receive_wait(oled_descriptor->sercom_pt, (uint8_t)(pixels & 0x00FF));
+        }
+        
+        /* Store pixel data in our gddram buffer for later merging */
+        if (pixels != 0)
+        {
+            oled_descriptor->gddram_pixel[y+yind].pixels = (uint8_t)pixels;
+            oled_descriptor->gddram_pixel[y+yind].xaddr = (x+width-1)/2;
+        }
+        
+        /* Transfer left running, terminated like a frame buffer flush */
+        if (transfer_running != FALSE)
+        {
+            continue;
+        }
+        
+        /* Wait for spi buffer to be sent */
+        sercom_spi_wait_for_transmit_complete(oled_descriptor->sercom_pt);
+        
+        /* Stop sending data */
+        sh1122_stop_data_sending(oled_descriptor);
+    }
+}
 
-/*! \fn     sh1122_draw_non_aligned_image_from_bitstream(sh1122_descriptor_t* oled_descriptor, int16_t x, int16_t y, bitstream_bitmap_t* bitstream, BOOL write_to_buffer)
-*   \brief  Draw a 2 pixels non aligned picture from a bitstream
+/*! \fn     sh1122_get_string_width(sh1122_descriptor_t* oled_descriptor, const char* str)
+*   \brief  Return the pixel width of the string.
 *   \param  oled_descriptor     Pointer to a sh1122 descriptor struct
-*   \param  x                   Starting x
-*   \param  y                   Starting y
-*   \param  bitstream           Pointer to the bistream
-*   \param  write_to_buffer    Set to true to write to internal buffer
+*   \param  str                 String to get width of
+*   \return Width of string in pixels based on current font
 */
-void sh1122_draw_non_aligned_image_from_bitstream(sh1122_descriptor_t* oled_descriptor, int16_t x, int16_t y, bitstream_bitmap_t* bitstream, BOOL write_to_buffer)
+uint16_t sh1122_get_string_width(sh1122_descriptor_t* oled_descriptor, const cust_char_t* str)
 {
-    uint16_t height = bitstream->height;
-    uint16_t width = bitstream->width;
-    uint16_t xoff = x - (x / 2) * 2;
+    uint16_t width=0;
     
-    #ifdef OLED_INTERNAL_FRAME_BUFFER
-    if (write_to_buffer != FALSE)
+    for (nat_type_t ind=0; (str[ind] != 0) && (str[ind] != '\r'); ind++)
     {
-        for (uint16_t yind=0; yind < height; yind++)
-        {
-            uint16_t xind = 0;
-            uint16_t pixels = 0;
+        width += sh1122_get_glyph_width(oled_descriptor, str[ind]);
+    }
+    
+    return width;    
+}
 
-            /* Start x not a multiple of 2 */
-            if (xoff != 0)
+#ifdef OLED_GLYPH_BITMAP_ARENA
+/*! \fn     sh1122_allocate_glyph_arena_entry(sh1122_descriptor_t* oled_descriptor, uint16_t size)
+*   \brief  Allocate space in the glyph arena, evicting least recently used glyphs if needed
+*   \param  oled_descriptor     Pointer to a sh1122 descriptor struct
+*   \param  size                Number of bytes to allocate, smaller or equal to OLED_GLYPH_ARENA_SIZE
+*   \return Pointer to the allocated arena entry
+*/
+sh1122_glyph_arena_entry_t* sh1122_allocate_glyph_arena_entry(sh1122_descriptor_t* oled_descriptor, uint16_t size)
+{
+    while (TRUE)
+    {
+        sh1122_glyph_arena_entry_t* free_entry_pt = 0;
+        sh1122_glyph_arena_entry_t* lru_entry_pt = 0;
+        
+        /* Find a free entry and the least recently used one */
+        for (uint16_t i = 0; i < OLED_GLYPH_ARENA_NB_ENTRIES; i++)
+        {
+            sh1122_glyph_arena_entry_t* entry_pt = &oled_descriptor->glyph_arena_entries[i];
+            
+            if (entry_pt->size == 0)
             {
-                /* Set xind to 1 as we're writing a pixel */
-                xind = 1;
-                
-                /* Fetch one pixel */
-                pixels = bitstream_bitmap_read(bitstream, 1);
-
-                /* Fill frame buffer */
-                oled_descriptor->frame_buffer[y+yind][x/2] |= pixels;
+                free_entry_pt = entry_pt;
             }
-            
-            /* Start x multiple of 2, start filling */
-            for (; xind < width; xind+=2)
+            else if ((lru_entry_pt == 0) || (entry_pt->last_used < lru_entry_pt->last_used))
+            {
+                lru_entry_pt = entry_pt;
+            }
+        }
+        
+        /* Enough space? Allocate at the end of the arena */
+        if ((free_entry_pt != 0) && ((oled_descriptor->glyph_arena_used + size) <= OLED_GLYPH_ARENA_SIZE))
+        {
+            free_entry_pt->offset = oled_descriptor->glyph_arena_used;
+            free_entry_pt->size = size;
+            oled_descriptor->glyph_arena_used += size;
+            return free_entry_pt;
+        }
+        
+        /* Evict LRU entry: move the data located after it to keep the arena contiguous */
+        uint16_t evicted_end = lru_entry_pt->offset + lru_entry_pt->size;
+        memmove(&oled_descriptor->glyph_arena[lru_entry_pt->offset], &oled_descriptor->glyph_arena[evicted_end], oled_descriptor->glyph_arena_used - evicted_end);
+        for (uint16_t i = 0; i < OLED_GLYPH_ARENA_NB_ENTRIES; i++)
+        {
+            if ((oled_descriptor->glyph_arena_entries[i].size != 0) && (oled_descriptor->glyph_arena_entries[i].offset >= evicted_end))
+            {
+                oled_descriptor->glyph_arena_entries[i].offset -= lru_entry_pt->size;
+            }
+        }
+        oled_descriptor->glyph_arena_used -= lru_entry_pt->size;
+        lru_entry_pt->size = 0;
+    }
+}
+
+/*! \fn     sh1122_draw_glyph_from_arena(sh1122_descriptor_t* oled_descriptor, int16_t x, int16_t y, sh1122_glyph_desc_t* glyph_desc)
+*   \brief  Draw a glyph in the draw buffer from the decoded glyphs arena, decoding it first if needed
+*   \param  oled_descriptor     Pointer to a sh1122 descriptor struct
+*   \param  x                   Starting x, glyph offset included
+*   \param  y                   Starting y, glyph offset included
+*   \param  glyph_desc          Pointer to the glyph descriptor
+*   \return RETURN_OK if the glyph was drawn, RETURN_NOK if it doesn't fit in the arena
+*   \note   Arena pixel rows are stored byte aligned, first pixel in the high nibble
+*/
+RET_TYPE sh1122_draw_glyph_from_arena(sh1122_descriptor_t* oled_descriptor, int16_t x, int16_t y, sh1122_glyph_desc_t* glyph_desc)
+{
+    uint16_t row_size = (glyph_desc->xrect + 1) / 2;
+    uint16_t glyph_size = row_size * glyph_desc->yrect;
+    sh1122_glyph_arena_entry_t* entry_pt = 0;
+    
+    /* Check that the glyph can fit inside our arena */
+    if ((glyph_size == 0) || (glyph_size > OLED_GLYPH_ARENA_SIZE))
+    {
+        return RETURN_NOK;
+    }
+    
+    /* Look for this glyph in the arena */
+    for (uint16_t i = 0; i < OLED_GLYPH_ARENA_NB_ENTRIES; i++)
+    {
+        if ((oled_descriptor->glyph_arena_entries[i].size != 0) && (oled_descriptor->glyph_arena_entries[i].chr == glyph_desc->chr))
+        {
+            entry_pt = &oled_descriptor->glyph_arena_entries[i];
+            break;
+        }
+    }
+    
+    if (entry_pt != 0)
+    {
+        oled_descriptor->glyph_arena_hits++;
+    } 
+    else
+    {
+        bitstream_bitmap_t bs;
+        font_glyph_t glyph;
+        
+        /* Not found: allocate space and decode the glyph into it */
+        oled_descriptor->glyph_arena_misses++;
+        entry_pt = sh1122_allocate_glyph_arena_entry(oled_descriptor, glyph_size);
+        entry_pt->chr = glyph_desc->chr;
+        entry_pt->width = glyph_desc->xrect;
+        entry_pt->height = glyph_desc->yrect;
+        
+        /* Bitstream init only uses the glyph rectangle */
+        glyph.xrect = glyph_desc->xrect;
+        glyph.yrect = glyph_desc->yrect;
+        bitstream_glyph_bitmap_init(&bs, &oled_descriptor->current_font_header, &glyph, glyph_desc->data_addr, TRUE);
+        
+        /* Same read sequence as the frame buffer draw functions */
+        uint8_t* pixel_pt = &oled_descriptor->glyph_arena[entry_pt->offset];
+        for (uint16_t yind = 0; yind < entry_pt->height; yind++)
+        {
+            for (uint16_t xind = 0; xind < entry_pt->width; xind+=2)
             {
-                if ((xind+2) <= width)
+                if ((xind+2) <= entry_pt->width)
                 {
-                    pixels = bitstream_bitmap_read(bitstream, 2);
+                    *pixel_pt++ = (uint8_t)bitstream_bitmap_read(&bs, 2);
                 }
                 else
                 {
-                    pixels = bitstream_bitmap_read(bitstream, 1) << 4;
-                }                
+                    *pixel_pt++ = (uint8_t)(bitstream_bitmap_read(&bs, 1) << 4);
+                }
+            }
+        }
+        bitstream_bitmap_close(&bs);
+    }
+    
+    /* Update LRU info */
+    entry_pt->last_used = ++(oled_descriptor->glyph_arena_use_counter);
+    
+    /* Blit into the draw buffer, clipping to its borders */
+    sh1122_blit_to_draw_buffer(oled_descriptor, x, y, &oled_descriptor->glyph_arena[entry_pt->offset], entry_pt->width, entry_pt->height, row_size, sh1122_get_foreground_blit_mode(oled_descriptor));
+    
+    return RETURN_OK;
+}
+#endif
+
+/*! \fn     sh1122_get_glyph_descriptor(sh1122_descriptor_t* oled_descriptor, cust_char_t ch, sh1122_glyph_desc_t* glyph_desc)
+*   \brief  Get the descriptor of a given character glyph in the current font
+*   \param  oled_descriptor     Pointer to a sh1122 descriptor struct
+*   \param  ch                  Character
+*   \param  glyph_desc          Where to store the glyph descriptor
+*   \return RETURN_OK if the glyph (or its '?' replacement) was found
+*   \note   Glyphs not supported by the font are replaced by '?' when possible
+*/
+RET_TYPE sh1122_get_glyph_descriptor(sh1122_descriptor_t* oled_descriptor, cust_char_t ch, sh1122_glyph_desc_t* glyph_desc)
+{
+    uint16_t glyph_desc_pt_offset = 0;  // Offset to the pointer of the glyph descriptor
+    uint16_t interval_start = 0;        // Unicode code of the first char of the current unicode support interval
+    cust_char_t requested_ch = ch;      // Requested character, before possible '?' replacement
+    font_glyph_t glyph;                 // Glyph header
+    uint16_t gind;                      // Glyph index
+
+    /* Check for selected font */
+    if (oled_descriptor->currentFontAddress == 0)
+    {
+        return RETURN_NOK;
+    }
+    
+    #ifdef OLED_GLYPH_DESC_CACHE
+    /* Check if we have it in cache */
+    sh1122_glyph_desc_t* cache_entry_pt = &oled_descriptor->glyph_desc_cache[ch & (OLED_GLYPH_DESC_CACHE_SIZE-1)];
+    if ((cache_entry_pt->valid != FALSE) && (cache_entry_pt->chr == ch))
+    {
+        oled_descriptor->glyph_desc_cache_hits++;
+        *glyph_desc = *cache_entry_pt;
+        return RETURN_OK;
+    }
+    oled_descriptor->glyph_desc_cache_misses++;
+    #endif
+    
+    /* Check that support for this char is described */
+    BOOL char_support_described = FALSE;
+    for (uint16_t i=0; i < sizeof(oled_descriptor->current_unicode_inters)/sizeof(oled_descriptor->current_unicode_inters[0]); i++)
+    {
+        /* Check if char is within this interval */
+        if ((oled_descriptor->current_unicode_inters[i].interval_start != 0xFFFF) && (oled_descriptor->current_unicode_inters[i].interval_start <= ch) && (oled_descriptor->current_unicode_inters[i].interval_end >= ch))
+        {
+            interval_start = oled_descriptor->current_unicode_inters[i].interval_start;
+            char_support_described = TRUE;
+            break;
+        }
+        
+        /* Add offset to descriptor */
+        glyph_desc_pt_offset += oled_descriptor->current_unicode_inters[i].interval_end - oled_descriptor->current_unicode_inters[i].interval_start + 1;
+    }
+    
+    /* Support not described, check if we could switch with ? */
+    if (char_support_described == FALSE)
+    {
+        if (oled_descriptor->question_mark_support_described != FALSE)
+        {
+            interval_start = oled_descriptor->current_unicode_inters[0].interval_start;
+            glyph_desc_pt_offset = 0;
+            ch = '?';
+        }
+        else
+        {
+            return RETURN_NOK;
+        }
+    }
+    
+    /* Convert character to glyph index */
+    custom_fs_read_from_flash((uint8_t*)&gind, oled_descriptor->currentFontAddress + sizeof(oled_descriptor->current_font_header) + sizeof(oled_descriptor->current_unicode_inters) + glyph_desc_pt_offset*sizeof(gind) + (ch - interval_start)*sizeof(gind), sizeof(gind));
+
+    /* Check that we know this glyph */
+    if(gind == 0xFFFF)
+    {
+        // If we don't know this character, try again with '?'
+        if (oled_descriptor->question_mark_support_described == FALSE)
+        {
+            return RETURN_NOK;
+        }
+        else
+        {
+            ch = '?';
+        }
+        custom_fs_read_from_flash((uint8_t*)&gind, oled_descriptor->currentFontAddress + sizeof(oled_descriptor->current_font_header) + sizeof(oled_descriptor->current_unicode_inters) + glyph_desc_pt_offset*sizeof(gind) + (ch - interval_start)*sizeof(gind), sizeof(gind));
+        
+        // If we still don't know it, return 0
+        if (gind == 0xFFFF)
+        {
+            return RETURN_NOK;
+        }
+    }
+    
+    /* Read glyph header */
+    custom_fs_read_from_flash((uint8_t*)&glyph, oled_descriptor->currentFontAddress + sizeof(oled_descriptor->current_font_header) + sizeof(oled_descriptor->current_unicode_inters) + (oled_descriptor->current_font_header.described_chr_count)*sizeof(gind) + gind*sizeof(glyph), sizeof(glyph));
+
+    /* Fill descriptor */
+    glyph_desc->chr = requested_ch;
+    glyph_desc->xrect = glyph.xrect;
+    glyph_desc->yrect = glyph.yrect;
+    glyph_desc->xoffset = glyph.xoffset;
+    glyph_desc->yoffset = glyph.yoffset;
+    glyph_desc->valid = TRUE;
+    
+    /* Compute glyph data address, if any */
+    if (glyph.glyph_data_offset == 0xFFFFFFFF)
+    {
+        glyph_desc->data_addr = 0;
+    } 
+    else
+    {
+        glyph_desc->data_addr = oled_descriptor->currentFontAddress + sizeof(oled_descriptor->current_font_header) + sizeof(oled_descriptor->current_unicode_inters) + (oled_descriptor->current_font_header.described_chr_count)*sizeof(gind) + (oled_descriptor->current_font_header.chr_count)*sizeof(glyph) + glyph.glyph_data_offset;
+    }
+    
+    #ifdef OLED_GLYPH_DESC_CACHE
+    /* Store it in cache */
+    *cache_entry_pt = *glyph_desc;
+    #endif
+    
+    return RETURN_OK;
+}
+
+/*! \fn     sh1122_get_glyph_width(sh1122_descriptor_t* oled_descriptor, char ch)
+*   \brief  Return the width of the specified character in the current font
+*   \param  oled_descriptor     Pointer to a sh1122 descriptor struct
+*   \param  ch                  Character
+*   \return width of the glyph
+*/
+uint16_t sh1122_get_glyph_width(sh1122_descriptor_t* oled_descriptor, cust_char_t ch)
+{
+    sh1122_glyph_desc_t glyph_desc;
+    
+    /* Fetch glyph descriptor */
+    if (sh1122_get_glyph_descriptor(oled_descriptor, ch, &glyph_desc) != RETURN_OK)
+    {
+        return 0;
+    }
+    
+    if (glyph_desc.data_addr == 0)
+    {
+        // If there's no glyph data, it is the space!
+        return (glyph_desc.xrect >> 1); // space character is always too large...
+    }
+    else
+    {
+        return glyph_desc.xrect + glyph_desc.xoffset + 1;
+    }
+}
+
+ /*! \fn     sh1122_glyph_desc_draw(sh1122_descriptor_t* oled_descriptor, int16_t x, int16_t y, sh1122_glyph_desc_t* glyph_desc, BOOL write_to_buffer)
+ *   \brief  Draw a glyph on the screen at x,y from its descriptor.
+ *   \param  oled_descriptor    Pointer to a sh1122 descriptor struct
+ *   \param  x                  x position to start glyph
+ *   \param  y                  y position to start glyph
+ *   \param  glyph_desc         Pointer to the glyph descriptor
+ *   \param  write_to_buffer    Set to true to write to internal buffer
+ *   \return width of the glyph
+ */
+static uint16_t sh1122_glyph_desc_draw(sh1122_descriptor_t* oled_descriptor, int16_t x, int16_t y, sh1122_glyph_desc_t* glyph_desc, BOOL write_to_buffer)
+{
+    bitstream_bitmap_t bs;              // Character bitstream
+    uint8_t glyph_width;                // Glyph width
+    font_glyph_t glyph;                 // Glyph header
 
-                /* Fill frame buffer */
-                oled_descriptor->frame_buffer[y+yind][(x+xind)/2] |= pixels;
-            }
-        }
-    } 
-    else
+    if (glyph_desc->data_addr == 0)
     {
-    #endif
-    for (uint16_t yind=0; yind < height; yind++)
+        /* Space character, just fill in the gddram buffer and output background pixels */
+        glyph_width = glyph_desc->xrect >> 1; // space character is always too large...
+    }
+    else
     {
-        uint16_t xind = 0;
-        uint16_t pixels = 0;
+        /* Store glyph height and width, increment with offset */
+        glyph_width = glyph_desc->xrect;
+        x += glyph_desc->xoffset;
+        y += glyph_desc->yoffset;
         
-        /* Set pixel write window */
-        sh1122_set_row_address(oled_descriptor, y+yind);
-        sh1122_set_column_address(oled_descriptor, x/2);
+        #ifdef OLED_GLYPH_BITMAP_ARENA
+        /* Frame buffer writes: use our decoded glyphs arena when possible */
+        if ((write_to_buffer != FALSE) && (sh1122_draw_glyph_from_arena(oled_descriptor, x, y, glyph_desc) == RETURN_OK))
+        {
+            return (uint8_t)(glyph_width + glyph_desc->xoffset) + 1;
+        }
+        #endif
         
-        /* Start filling the SSD1322 RAM */
-        sh1122_start_data_sending(oled_descriptor);
+        /* Bitstream init only uses the glyph rectangle */
+        glyph.xrect = glyph_desc->xrect;
+        glyph.yrect = glyph_desc->yrect;
+        
+        // Initialize bitstream & draw the character
+        bitstream_glyph_bitmap_init(&bs, &oled_descriptor->current_font_header, &glyph, glyph_desc->data_addr, TRUE);
+        sh1122_draw_image_from_bitstream(oled_descriptor, x, y, &bs, write_to_buffer);
+    }
+    
+    return (uint8_t)(glyph_width + glyph_desc->xoffset) + 1;
+}
 
-        /* Start x not a multiple of 2 */
-        if (xoff != 0)
-        {
-            /* Set xind to 1 as we're writing a pixel */
-            xind = 1;
-            
-            /* Fetch one pixel */
-            pixels = bitstream_bitmap_read(bitstream, 1);
+ /*! \fn     sh1122_glyph_draw(sh1122_descriptor_t* oled_descriptor, int16_t x, int16_t y, char ch, BOOL write_to_buffer)
+ *   \brief  Draw a character glyph on the screen at x,y.
+ *   \param  oled_descriptor    Pointer to a sh1122 descriptor struct
+ *   \param  x                  x position to start glyph
+ *   \param  y                  y position to start glyph
+ *   \param  ch                 Character to draw
+ *   \param  write_to_buffer    Set to true to write to internal buffer
+ *   \return width of the glyph
+ */
+uint16_t sh1122_glyph_draw(sh1122_descriptor_t* oled_descriptor, int16_t x, int16_t y, cust_char_t ch, BOOL write_to_buffer)
+{
+    sh1122_glyph_desc_t glyph_desc;     // Glyph descriptor
 
-            /* Fill existing pixels if available */
-            if ((x/2) == oled_descriptor->gddram_pixel[y+yind].xaddr)
-            {
-                pixels |= oled_descriptor->gddram_pixel[y+yind].pixels;
-            }
+    /* Fetch glyph descriptor */
+    if (sh1122_get_glyph_descriptor(oled_descriptor, ch, &glyph_desc) != RETURN_OK)
+    {
+        return 0;
+    }
+    
+    return sh1122_glyph_desc_draw(oled_descriptor, x, y, &glyph_desc, write_to_buffer);
+}
 
-            /* Send the 2 pixels to the display */
-            sercom_spi_send_single_byte_without_receive_wait(oled_descriptor->sercom_pt, (uint8_t)(pixels & 0x00FF));
-        }
+/*! \fn     sh1122_put_char(sh1122_descriptor_t* oled_descriptor, char ch, BOOL write_to_buffer)
+*   \brief  Print char on display
+*   \param  oled_descriptor     Pointer to a sh1122 descriptor struct
+*   \param  ch                  Char to display
+*   \param  write_to_buffer     Set to true to write to internal buffer
+*   \return success status
+*/
+RET_TYPE sh1122_put_char(sh1122_descriptor_t* oled_descriptor, cust_char_t ch, BOOL write_to_buffer)
+{
+    /* Have we actually selected a font? */
+    if (oled_descriptor->currentFontAddress == 0)
+    {
+        return RETURN_NOK;
+    }
+    
+    if ((ch == '\n') && (oled_descriptor->line_feed_allowed != FALSE))
+    {
+        oled_descriptor->cur_text_y += oled_descriptor->current_font_header.height;
+        oled_descriptor->cur_text_x = 0;
+    }
+    else if ((ch == '\r') && (oled_descriptor->carriage_return_allowed != FALSE))
+    {
+        oled_descriptor->cur_text_x = 0;
+    }
+    else
+    {
+        uint16_t width = sh1122_get_glyph_width(oled_descriptor, ch);
         
-        /* Start x multiple of 2, start filling */
-        for (; xind < width; xind+=2)
+        /* Check if we're not larger than the screen */
+        if ((width + oled_descriptor->cur_text_x) > oled_descriptor->max_text_x)
         {
-            if ((xind+2) <= width)
+            if (oled_descriptor->line_feed_allowed != FALSE)
             {
-                pixels = bitstream_bitmap_read(bitstream, 2);
+                oled_descriptor->cur_text_y += oled_descriptor->current_font_header.height;
+                oled_descriptor->cur_text_x = 0;
             }
             else
             {
-                pixels = bitstream_bitmap_read(bitstream, 1) << 4;
+                return RETURN_NOK;
             }
-            
-            // Send 2 pixels to the display
-            sercom_spi_send_single_byte_without_receive_wait(oled_descriptor->sercom_pt, (uint8_t)(pixels & 0x00FF));
         }
         
-        /* Store pixel data in our gddram buffer for later merging */
-        if (pixels != 0)
+        /* Check that we're not writing text after the screen edge */
+        if ((oled_descriptor->cur_text_y + oled_descriptor->current_font_header.height) > SH1122_OLED_HEIGHT)
         {
-            oled_descriptor->gddram_pixel[y+yind].pixels = (uint8_t)pixels;
-            oled_descriptor->gddram_pixel[y+yind].xaddr = (x+width-1)/2;
+            return RETURN_NOK;
         }
-            
-        /* Wait for spi buffer to be sent */
-        sercom_spi_wait_for_transmit_complete(oled_descriptor->sercom_pt);
-            
-        /* Stop sending data */
-        sh1122_stop_data_sending(oled_descriptor);
-    }
-    #ifdef OLED_INTERNAL_FRAME_BUFFER
+        
+        // Display the text
+        oled_descriptor->cur_text_x += sh1122_glyph_draw(oled_descriptor, oled_descriptor->cur_text_x, oled_descriptor->cur_text_y, ch, write_to_buffer);
     }
-    #endif
     
-    /* Close bitstream */
-    bitstream_bitmap_close(bitstream);
-}    
+    return RETURN_OK;
+}
 
-/*! \fn     sh1122_draw_image_from_bitstream(sh1122_descriptor_t* oled_descriptor, int16_t x, int16_t y, bitstream_t* bs, BOOL write_to_buffer)
-*   \brief  Draw a picture from a bitstream
+/*! \fn     sh1122_put_string(sh1122_descriptor_t* oled_descriptor, const char* str, BOOL write_to_buffer)
+*   \brief  Print string at current x y
 *   \param  oled_descriptor     Pointer to a sh1122 descriptor struct
-*   \param  x                   Starting x
-*   \param  y                   Starting y
-*   \param  bitstream           Pointer to the bistream
+*   \param  str                 String to print
 *   \param  write_to_buffer     Set to true to write to internal buffer
+*   \return Number of printed chars
 */
-void sh1122_draw_image_from_bitstream(sh1122_descriptor_t* oled_descriptor, int16_t x, int16_t y, bitstream_bitmap_t* bitstream, BOOL write_to_buffer)
+uint16_t sh1122_put_string(sh1122_descriptor_t* oled_descriptor, const cust_char_t* str, BOOL write_to_buffer)
 {
-    if ((x == 0) && (y == 0) && (bitstream->width == SH1122_OLED_WIDTH) && (bitstream->height == SH1122_OLED_HEIGHT))
+    uint16_t nb_printed_chars = 0;
+    
+    // Write chars until we find final 0
+    while (*str)
     {
-        /* Dedicated code to allow faster update */
-        //sh1122_draw_aligned_image_from_bitstream(oled_descriptor, x, y, bitstream);
-        sh1122_draw_full_screen_image_from_bitstream(oled_descriptor, bitstream);        
+        if(sh1122_put_char(oled_descriptor, *str++, write_to_buffer) != RETURN_OK)
+        {
+            return nb_printed_chars;
+        }
+        else
+        {
+            nb_printed_chars++;
+        }
     }
-    else if ((bitstream->width % 2 == 0) && (x % 2 == 0))
+    
+    return nb_printed_chars;
+}
+
+/*! \fn     sh1122_put_string_xy(sh1122_descriptor_t* oled_descriptor, int16_t x, uint8_t y, oled_align_te justify, const char* string)
+*   \brief  Display an error string on the screen (X0Y0, centered)
+*   \param  oled_descriptor     Pointer to a sh1122 descriptor struct
+*   \param  string              Null terminated string
+*   \return How many characters were printed
+*/
+uint16_t sh1122_put_error_string(sh1122_descriptor_t* oled_descriptor, const cust_char_t* string)
+{
+    return sh1122_put_string_xy(oled_descriptor, 0, 0, OLED_ALIGN_CENTER, string, FALSE);
+}
+
+/*! \fn     sh1122_update_glyph_run_width(sh1122_glyph_run_t* run)
+*   \brief  Compute a glyph run width, the same way sh1122_get_string_width() does
+*   \param  run                 Pointer to the glyph run
+*/
+static void sh1122_update_glyph_run_width(sh1122_glyph_run_t* run)
+{
+    run->width = 0;
+    
+    for (uint16_t i = 0; (i < run->nb_items) && (run->items[i].glyph_desc.chr != '\r'); i++)
     {
-        /* If we're 2 pixels aligned, call a dedicated function for fast processing */
-        sh1122_draw_aligned_image_from_bitstream(oled_descriptor, x, y, bitstream, write_to_buffer);
-    } 
+        run->width += run->items[i].width;
+    }
+}
+
+/*! \fn     sh1122_add_glyph_to_run(sh1122_descriptor_t* oled_descriptor, sh1122_glyph_run_t* run, cust_char_t ch)
+*   \brief  Resolve a character and append its glyph to a glyph run
+*   \param  oled_descriptor     Pointer to a sh1122 descriptor struct
+*   \param  run                 Pointer to the glyph run
+*   \param  ch                  Character
+*   \return RETURN_NOK if the run is full
+*/
+static RET_TYPE sh1122_add_glyph_to_run(sh1122_descriptor_t* oled_descriptor, sh1122_glyph_run_t* run, cust_char_t ch)
+{
+    if (run->nb_items == OLED_GLYPH_RUN_MAX_LENGTH)
+    {
+        return RETURN_NOK;
+    }
+    
+    sh1122_glyph_run_item_t* item_pt = &run->items[run->nb_items++];
+    item_pt->x = run->end_x;
+    
+    if (sh1122_get_glyph_descriptor(oled_descriptor, ch, &item_pt->glyph_desc) != RETURN_OK)
+    {
+        /* Unknown glyph: nothing drawn, like sh1122_glyph_draw() */
+        item_pt->glyph_desc.data_addr = 0;
+        item_pt->glyph_desc.valid = FALSE;
+        item_pt->glyph_desc.chr = ch;
+        item_pt->width = 0;
+    }
+    else if (item_pt->glyph_desc.data_addr == 0)
+    {
+        /* Space: different width and advance, see sh1122_get_glyph_width() and sh1122_glyph_draw() */
+        item_pt->width = item_pt->glyph_desc.xrect >> 1;
+        run->end_x += (uint8_t)((item_pt->glyph_desc.xrect >> 1) + item_pt->glyph_desc.xoffset) + 1;
+    }
     else
     {
-        sh1122_draw_non_aligned_image_from_bitstream(oled_descriptor, x, y, bitstream, write_to_buffer);
-    }    
+        item_pt->width = item_pt->glyph_desc.xrect + item_pt->glyph_desc.xoffset + 1;
+        run->end_x += (uint8_t)(item_pt->glyph_desc.xrect + item_pt->glyph_desc.xoffset) + 1;
+    }
+    
+    return RETURN_OK;
 }
 
-/*! \fn     sh1122_display_bitmap_from_flash_at_recommended_position(sh1122_descriptor_t* oled_descriptor, uint32_t file_id, BOOL write_to_buffer)
-*   \brief  Display a bitmap stored in the external flash, at its recommended position
+/*! \fn     sh1122_layout_string(sh1122_descriptor_t* oled_descriptor, const cust_char_t* string, sh1122_glyph_run_t* run)
+*   \brief  Resolve the glyphs of a string and compute their positions
 *   \param  oled_descriptor     Pointer to a sh1122 descriptor struct
-*   \param  file_id             Bitmap file ID
-*   \param  write_to_buffer     Set to true to write to internal buffer
-*   \return success status
+*   \param  string              Null terminated string
+*   \param  run                 Where to store the glyph run
+*   \return RETURN_NOK if no font is selected
+*   \note   Characters after OLED_GLYPH_RUN_MAX_LENGTH are dropped
+*   \note   Single line: \r and \n are resolved as glyphs, use sh1122_put_string() for multi line text
 */
-RET_TYPE sh1122_display_bitmap_from_flash_at_recommended_position(sh1122_descriptor_t* oled_descriptor, uint32_t file_id, BOOL write_to_buffer)
+RET_TYPE sh1122_layout_string(sh1122_descriptor_t* oled_descriptor, const cust_char_t* string, sh1122_glyph_run_t* run)
 {
-    custom_fs_address_t file_adress;
-    bitstream_bitmap_t bitstream;
-    bitmap_t bitmap;
-
-    /* Fetch file address */
-    if (custom_fs_get_file_address(file_id, &file_adress, CUSTOM_FS_BITMAP_TYPE) != RETURN_OK)
+    run->nb_items = 0;
+    run->end_x = 0;
+    run->width = 0;
+    
+    /* Have we actually selected a font? */
+    if (oled_descriptor->currentFontAddress == 0)
     {
         return RETURN_NOK;
     }
+    
+    /* Resolve each glyph once */
+    while ((*string != 0) && (sh1122_add_glyph_to_run(oled_descriptor, run, *string) == RETURN_OK))
+    {
+        string++;
+    }
+    
+    sh1122_update_glyph_run_width(run);
+    return RETURN_OK;
+}
 
-    /* Read bitmap info data */
-    custom_fs_read_from_flash((uint8_t *)&bitmap, file_adress, sizeof(bitmap));
+/*! \fn     sh1122_ellipsize_glyph_run(sh1122_descriptor_t* oled_descriptor, sh1122_glyph_run_t* run, uint16_t max_width)
+*   \brief  Shorten a glyph run so it fits in a given width, ending it with "..."
+*   \param  oled_descriptor     Pointer to a sh1122 descriptor struct
+*   \param  run                 Pointer to the glyph run
+*   \param  max_width           Max run width
+*   \note   Runs already fitting in max_width are left untouched
+*/
+void sh1122_ellipsize_glyph_run(sh1122_descriptor_t* oled_descriptor, sh1122_glyph_run_t* run, uint16_t max_width)
+{
+    uint16_t ellipsis_width = 3 * sh1122_get_glyph_width(oled_descriptor, '.');
+    uint16_t nb_kept_items = run->nb_items;
     
-    /* Init bitstream */
-    bitstream_bitmap_init(&bitstream, &bitmap, file_adress + sizeof(bitmap), TRUE);
+    /* Already fitting? */
+    if (run->width <= max_width)
+    {
+        return;
+    }
     
-    /* Draw bitmap */
-    sh1122_draw_image_from_bitstream(oled_descriptor, bitmap.xpos, bitmap.ypos, &bitstream, write_to_buffer);
+    /* Drop glyphs until the ellipsis fits after the remaining ones */
+    while (nb_kept_items != 0)
+    {
+        int16_t ellipsis_x = (nb_kept_items == run->nb_items) ? run->end_x : run->items[nb_kept_items].x;
+        
+        if (((nb_kept_items + 3) <= OLED_GLYPH_RUN_MAX_LENGTH) && ((ellipsis_x + ellipsis_width) <= max_width))
+        {
+            break;
+        }
+        nb_kept_items--;
+    }
+    
+    /* Append ellipsis */
+    if (nb_kept_items != run->nb_items)
+    {
+        run->end_x = run->items[nb_kept_items].x;
+        run->nb_items = nb_kept_items;
+    }
+    for (uint16_t i = 0; i < 3; i++)
+    {
+        sh1122_add_glyph_to_run(oled_descriptor, run, '.');
+    }
+    sh1122_update_glyph_run_width(run);
+}
+
+/*! \fn     sh1122_justify_text_x(sh1122_descriptor_t* oled_descriptor, int16_t x, uint16_t width, oled_align_te justify, int16_t* max_text_x)
+*   \brief  Compute the starting x of a justified text
+*   \param  oled_descriptor     Pointer to a sh1122 descriptor struct
+*   \param  x                   Requested x
+*   \param  width               Text width
+*   \param  justify             Text justify (see enum)
+*   \param  max_text_x          Pointer to the max text x, lowered to x for right justified texts
+*   \return The text starting x
+*/
+static int16_t sh1122_justify_text_x(sh1122_descriptor_t* oled_descriptor, int16_t x, uint16_t width, oled_align_te justify, int16_t* max_text_x)
+{
+    if (justify == OLED_ALIGN_CENTER)
+    {
+        if ((x + oled_descriptor->min_text_x + width) < *max_text_x)
+        {
+            x = (*max_text_x + x + oled_descriptor->min_text_x - width)/2;
+        }
+    } 
+    else if (justify == OLED_ALIGN_RIGHT)
+    {
+        if (x < *max_text_x)
+        {
+            *max_text_x = x;
+        }
+        if (x >= (width + oled_descriptor->min_text_x))
+        {
+            x -= width;
+        }
+        else if ((width + oled_descriptor->min_text_x) >= *max_text_x)
+        {
+            x = oled_descriptor->min_text_x;
+        }
+        else
+        {
+            x = *max_text_x - width;
+        }
+    }
     
-    return RETURN_OK;    
+    return x;
 }
 
-/*! \fn     sh1122_display_bitmap_from_flash(sh1122_descriptor_t* oled_descriptor, int16_t x, int16_t y, uint32_t file_id, BOOL write_to_buffer)
-*   \brief  Display a bitmap stored in the external flash
+/*! \fn     sh1122_draw_glyph_run(sh1122_descriptor_t* oled_descriptor, sh1122_glyph_run_t* run, int16_t x, uint8_t y, oled_align_te justify, BOOL write_to_buffer)
+*   \brief  Display a glyph run on the screen
 *   \param  oled_descriptor     Pointer to a sh1122 descriptor struct
+*   \param  run                 Pointer to the glyph run
 *   \param  x                   Starting x
 *   \param  y                   Starting y
-*   \param  file_id             Bitmap file ID
-*   \param  write_to_buffer    Set to true to write to internal buffer
-*   \return success status
+*   \param  justify             String justify (see enum)
+*   \param  write_to_buffer     Set to true to write to internal buffer
+*   \return How many glyphs were printed
+*   \note   Glyphs not fitting before max_text_x aren't printed
 */
-RET_TYPE sh1122_display_bitmap_from_flash(sh1122_descriptor_t* oled_descriptor, int16_t x, int16_t y, uint32_t file_id, BOOL write_to_buffer)
+uint16_t sh1122_draw_glyph_run(sh1122_descriptor_t* oled_descriptor, sh1122_glyph_run_t* run, int16_t x, uint8_t y, oled_align_te justify, BOOL write_to_buffer)
 {
-    custom_fs_address_t file_adress;
-    bitstream_bitmap_t bitstream;
-    bitmap_t bitmap;
-
-    /* Fetch file address */
-    if (custom_fs_get_file_address(file_id, &file_adress, CUSTOM_FS_BITMAP_TYPE) != RETURN_OK)
+    int16_t max_text_x = oled_descriptor->max_text_x;
+    uint16_t nb_printed_glyphs = 0;
+    
+    /* Have we actually selected a font? */
+    if (oled_descriptor->currentFontAddress == 0)
     {
-        return RETURN_NOK;
-    }    
+        return 0;
+    }
 
-    /* Read bitmap info data */
-    custom_fs_read_from_flash((uint8_t *)&bitmap, file_adress, sizeof(bitmap));
+    x = sh1122_justify_text_x(oled_descriptor, x, run->width, justify, &max_text_x);
     
-    /* Init bitstream */
-    bitstream_bitmap_init(&bitstream, &bitmap, file_adress + sizeof(bitmap), TRUE);
+    /* Store cur text x & y */
+    oled_descriptor->cur_text_x = x;
+    oled_descriptor->cur_text_y = y;
     
-    /* Draw bitmap */
-    sh1122_draw_image_from_bitstream(oled_descriptor, x, y, &bitstream, write_to_buffer);
+    /* Check that we're not writing text after the screen edge */
+    if ((y + oled_descriptor->current_font_header.height) > SH1122_OLED_HEIGHT)
+    {
+        return 0;
+    }
     
-    return RETURN_OK;  
-} 
-
-/*! \fn     sh1122_draw_rectangle(sh1122_descriptor_t* oled_descriptor, int16_t x, int16_t y, int16_t width, int16_t height, uint16_t color)
-*   \brief  Draw a rectangle on the screen
-*   \param  oled_descriptor     Pointer to a sh1122 descriptor struct
-*   \param  x                   Starting x
-*   \param  y                   Starting y
-*   \param  width               Width
-*   \param  height              Height
-*   \param  color               4 bits color
-*/
-void sh1122_draw_rectangle(sh1122_descriptor_t* oled_descriptor, int16_t x, int16_t y, int16_t width, int16_t height, uint16_t color)
-{
-    uint16_t xoff = x - (x / 2) * 2;
-
-    for (uint16_t yind=0; yind < height; yind++)
+    /* Draw glyphs until we reach max text x */
+    for (uint16_t i = 0; i < run->nb_items; i++)
     {
-        uint16_t xind = 0;
-        uint16_t pixels = 0;
-        
-        /* Set pixel write window */
-        sh1122_set_row_address(oled_descriptor, y+yind);
-        sh1122_set_column_address(oled_descriptor, x/2);
-        
-        /* Start filling the SSD1322 RAM */
-        sh1122_start_data_sending(oled_descriptor);
-
-        /* Start x not a multiple of 2 */
-        if (xoff != 0)
-        {
-            /* Set xind to 1 as we're writing a pixel */
-            xind = 1;
-            
-            /* one pixel */
-            pixels = color;
-
-            /* Fill existing pixels if available */
-            if ((x/2) == oled_descriptor->gddram_pixel[y+yind].xaddr)
-            {
-                pixels |= oled_descriptor->gddram_pixel[y+yind].pixels;
-            }
-
-            /* Send the 2 pixels to the display */
-            sercom_spi_send_single_byte_without_receive_wait(oled_descriptor->sercom_pt, (uint8_t)(pixels & 0x00FF));
-        }
+        sh1122_glyph_run_item_t* item_pt = &run->items[i];
         
-        /* Start x multiple of 2, start filling */
-        for (; xind < width; xind+=2)
+        if ((item_pt->width + x + item_pt->x) > max_text_x)
         {
-            if ((xind+2) <= width)
-            {
-                pixels = color | (color << 4);
-            }
-            else
-            {
-                pixels = color << 4;
-            }
-            
-            // Send 2 pixels to the display
-            sercom_spi_send_single_byte_without_receive_wait(oled_descriptor->sercom_pt, (uint8_t)(pixels & 0x00FF));
+            break;
         }
         
-        /* Store pixel data in our gddram buffer for later merging */
-        if (pixels != 0)
+        if (item_pt->glyph_desc.valid != FALSE)
         {
-            oled_descriptor->gddram_pixel[y+yind].pixels = (uint8_t)pixels;
-            oled_descriptor->gddram_pixel[y+yind].xaddr = (x+width-1)/2;
+            sh1122_glyph_desc_draw(oled_descriptor, x + item_pt->x, y, &item_pt->glyph_desc, write_to_buffer);
         }
         
-        /* Wait for spi buffer to be sent */
-        sercom_spi_wait_for_transmit_complete(oled_descriptor->sercom_pt);
-        
-        /* Stop sending data */
-        sh1122_stop_data_sending(oled_descriptor);
+        /* Keep cur text x after the last printed glyph */
+        oled_descriptor->cur_text_x = x + ((i+1 < run->nb_items) ? run->items[i+1].x : run->end_x);
+        nb_printed_glyphs++;
     }
+    
+    return nb_printed_glyphs;
 }
 
-/*! \fn     sh1122_get_string_width(sh1122_descriptor_t* oled_descriptor, const char* str)
-*   \brief  Return the pixel width of the string.
+/*! \fn     sh1122_put_string_xy(sh1122_descriptor_t* oled_descriptor, int16_t x, uint8_t y, oled_align_te justify, const char* string, BOOL write_to_buffer) 
+*   \brief  Display a string on the screen
 *   \param  oled_descriptor     Pointer to a sh1122 descriptor struct
-*   \param  str                 String to get width of
-*   \return Width of string in pixels based on current font
+*   \param  x                   Starting x
+*   \param  y                   Starting y
+*   \param  justify             String justify (see enum)
+*   \param  string              Null terminated string
+*   \param  write_to_buffer     Set to true to write to internal buffer
+*   \return How many characters were printed
 */
-uint16_t sh1122_get_string_width(sh1122_descriptor_t* oled_descriptor, const cust_char_t* str)
+uint16_t sh1122_put_string_xy(sh1122_descriptor_t* oled_descriptor, int16_t x, uint8_t y, oled_align_te justify, const cust_char_t* string, BOOL write_to_buffer) 
 {
-    uint16_t width=0;
+    sh1122_glyph_run_t run;
     
-    for (nat_type_t ind=0; (str[ind] != 0) && (str[ind] != '\r'); ind++)
+    /* Glyphs are fetched once for both justification and drawing */
+    if (sh1122_layout_string(oled_descriptor, string, &run) != RETURN_OK)
     {
-        width += sh1122_get_glyph_width(oled_descriptor, str[ind]);
+        return 0;
     }
     
-    return width;    
+    return sh1122_draw_glyph_run(oled_descriptor, &run, x, y, justify, write_to_buffer);
 }
 
-/*! \fn     sh1122_get_glyph_width(sh1122_descriptor_t* oled_descriptor, char ch)
-*   \brief  Return the width of the specified character in the current font
+/*! \fn     sh1122_put_ellipsized_string_xy(sh1122_descriptor_t* oled_descriptor, int16_t x, uint8_t y, oled_align_te justify, const char* string, BOOL write_to_buffer) 
+*   \brief  Display a string on the screen, ending it with "..." if it doesn't fit before max_text_x
 *   \param  oled_descriptor     Pointer to a sh1122 descriptor struct
-*   \param  ch                  Character
-*   \return width of the glyph
+*   \param  x                   Starting x
+*   \param  y                   Starting y
+*   \param  justify             String justify (see enum)
+*   \param  string              Null terminated string
+*   \param  write_to_buffer     Set to true to write to internal buffer
+*   \return How many glyphs were printed, ellipsis included
 */
-uint16_t sh1122_get_glyph_width(sh1122_descriptor_t* oled_descriptor, cust_char_t ch)
+uint16_t sh1122_put_ellipsized_string_xy(sh1122_descriptor_t* oled_descriptor, int16_t x, uint8_t y, oled_align_te justify, const cust_char_t* string, BOOL write_to_buffer) 
 {
-    uint16_t glyph_desc_pt_offset = 0;
-    uint16_t interval_start = 0;
-    font_glyph_t glyph;
-    uint16_t gind;
+    int16_t available_width;
+    sh1122_glyph_run_t run;
+    
+    if (sh1122_layout_string(oled_descriptor, string, &run) != RETURN_OK)
+    {
+        return 0;
+    }
+    
+    /* Width available for the string, see justification in sh1122_draw_glyph_run() */
+    if (justify == OLED_ALIGN_RIGHT)
+    {
+        available_width = ((x < oled_descriptor->max_text_x) ? x : oled_descriptor->max_text_x) - oled_descriptor->min_text_x;
+    }
+    else
+    {
+        available_width = oled_descriptor->max_text_x - x;
+    }
     
-    /* Check that a font was actually chosen */
-    if (oled_descriptor->currentFontAddress != 0)
+    sh1122_ellipsize_glyph_run(oled_descriptor, &run, (available_width < 0) ? 0 : available_width);
+    return sh1122_draw_glyph_run(oled_descriptor, &run, x, y, justify, write_to_buffer);
+}
+
+#ifdef OLED_STRING_SPRITE_CACHE
+/*! \fn     sh1122_allocate_string_sprite_entry(sh1122_descriptor_t* oled_descriptor, uint16_t size)
+*   \brief  Allocate space in the string sprites arena, evicting least recently used sprites if needed
+*   \param  oled_descriptor     Pointer to a sh1122 descriptor struct
+*   \param  size                Number of bytes to allocate, at most OLED_STRING_SPRITE_ARENA_SIZE
+*   \return Pointer to the allocated entry
+*/
+static sh1122_string_sprite_entry_t* sh1122_allocate_string_sprite_entry(sh1122_descriptor_t* oled_descriptor, uint16_t size)
+{
+    while (TRUE)
     {
-        /* Check that support for this char is described */
-        BOOL char_support_described = FALSE;
-        for (uint16_t i=0; i < sizeof(oled_descriptor->current_unicode_inters)/sizeof(oled_descriptor->current_unicode_inters[0]); i++)
+        sh1122_string_sprite_entry_t* free_entry_pt = 0;
+        sh1122_string_sprite_entry_t* lru_entry_pt = 0;
+        
+        /* Find a free entry and the least recently used one */
+        for (uint16_t i = 0; i < OLED_STRING_SPRITE_NB_ENTRIES; i++)
         {
-            /* Check if char is within this interval */
-            if ((oled_descriptor->current_unicode_inters[i].interval_start != 0xFFFF) && (oled_descriptor->current_unicode_inters[i].interval_start <= ch) && (oled_descriptor->current_unicode_inters[i].interval_end >= ch))
+            sh1122_string_sprite_entry_t* entry_pt = &oled_descriptor->string_sprite_entries[i];
+            
+            if (entry_pt->size == 0)
             {
-                interval_start = oled_descriptor->current_unicode_inters[i].interval_start;
-                char_support_described = TRUE;
-                break;
+                free_entry_pt = entry_pt;
+            }
+            else if ((lru_entry_pt == 0) || (entry_pt->last_used < lru_entry_pt->last_used))
+            {
+                lru_entry_pt = entry_pt;
             }
-            
-            /* Add offset to descriptor */
-            glyph_desc_pt_offset += oled_descriptor->current_unicode_inters[i].interval_end - oled_descriptor->current_unicode_inters[i].interval_start + 1;
         }
         
-        /* Support not described, check if we could switch with ? */
-        if (char_support_described == FALSE)
+        /* Enough space? Allocate at the end of the arena */
+        if ((free_entry_pt != 0) && ((oled_descriptor->string_sprite_arena_used + size) <= OLED_STRING_SPRITE_ARENA_SIZE))
         {
-            if (oled_descriptor->question_mark_support_described != FALSE)
-            {
-                interval_start = oled_descriptor->current_unicode_inters[0].interval_start;
-                glyph_desc_pt_offset = 0;
-                ch = '?';
-            } 
-            else
-            {
-                return 0;
-            }
+            free_entry_pt->offset = oled_descriptor->string_sprite_arena_used;
+            free_entry_pt->size = size;
+            oled_descriptor->string_sprite_arena_used += size;
+            return free_entry_pt;
         }
         
-        /* Convert character to glyph index */
-        custom_fs_read_from_flash((uint8_t*)&gind, oled_descriptor->currentFontAddress + sizeof(oled_descriptor->current_font_header) + sizeof(oled_descriptor->current_unicode_inters) + glyph_desc_pt_offset*sizeof(gind) + (ch - interval_start)*sizeof(gind), sizeof(gind));
-
-        /* Check that we know this glyph */
-        if(gind == 0xFFFF)
+        /* Evict LRU entry: move the data located after it to keep the arena contiguous */
+        uint16_t evicted_end = lru_entry_pt->offset + lru_entry_pt->size;
+        memmove(&oled_descriptor->string_sprite_arena[lru_entry_pt->offset], &oled_descriptor->string_sprite_arena[evicted_end], oled_descriptor->string_sprite_arena_used - evicted_end);
+        for (uint16_t i = 0; i < OLED_STRING_SPRITE_NB_ENTRIES; i++)
         {
-            // If we don't know this character, try again with '?'
-            if (oled_descriptor->question_mark_support_described == FALSE)
-            {
-                return 0;
-            }
-            else
-            {
-                ch = '?';
-            }            
-            custom_fs_read_from_flash((uint8_t*)&gind, oled_descriptor->currentFontAddress + sizeof(oled_descriptor->current_font_header) + sizeof(oled_descriptor->current_unicode_inters) + glyph_desc_pt_offset*sizeof(gind) + (ch - interval_start)*sizeof(gind), sizeof(gind));
-            
-            // If we still don't know it, return 0
-            if (gind == 0xFFFF)
+            if ((oled_descriptor->string_sprite_entries[i].size != 0) && (oled_descriptor->string_sprite_entries[i].offset >= evicted_end))
             {
-                return 0;
+                oled_descriptor->string_sprite_entries[i].offset -= lru_entry_pt->size;
             }
         }
-
-        // Read the beginning of the glyph
-        custom_fs_read_from_flash((uint8_t*)&glyph, oled_descriptor->currentFontAddress + sizeof(oled_descriptor->current_font_header) + sizeof(oled_descriptor->current_unicode_inters) + (oled_descriptor->current_font_header.described_chr_count)*sizeof(gind) + gind*sizeof(glyph), sizeof(glyph));
-
-        if (glyph.glyph_data_offset == 0xFFFFFFFF)
-        {
-            // If there's no glyph data, it is the space!
-            return (glyph.xrect >> 1); // space character is always too large...
-        }
-        else
-        {
-            return glyph.xrect + glyph.xoffset + 1;
-        }
-    }
-    else
-    {
-        return 0;
+        oled_descriptor->string_sprite_arena_used -= lru_entry_pt->size;
+        lru_entry_pt->size = 0;
     }
 }
 
- /*! \fn     sh1122_glyph_draw(sh1122_descriptor_t* oled_descriptor, int16_t x, int16_t y, char ch, BOOL write_to_buffer)
- *   \brief  Draw a character glyph on the screen at x,y.
- *   \param  oled_descriptor    Pointer to a sh1122 descriptor struct
- *   \param  x                  x position to start glyph
- *   \param  y                  y position to start glyph
- *   \param  ch                 Character to draw
- *   \param  write_to_buffer    Set to true to write to internal buffer
- *   \return width of the glyph
- */
-uint16_t sh1122_glyph_draw(sh1122_descriptor_t* oled_descriptor, int16_t x, int16_t y, cust_char_t ch, BOOL write_to_buffer)
+/*! \fn     sh1122_get_string_sprite(sh1122_descriptor_t* oled_descriptor, uint32_t string_id)
+*   \brief  Get the rendered sprite of a current language string, rendering it if it isn't in the arena
+*   \param  oled_descriptor     Pointer to a sh1122 descriptor struct
+*   \param  string_id           String ID
+*   \return Pointer to the sprite entry, 0 if the string can't be stored as a sprite
+*/
+static sh1122_string_sprite_entry_t* sh1122_get_string_sprite(sh1122_descriptor_t* oled_descriptor, uint32_t string_id)
 {
-    uint16_t glyph_desc_pt_offset = 0;  // Offset to the pointer of the glyph descriptor
-    uint16_t interval_start = 0;        // Unicode code of the first char of the current unicode support interval
-    bitstream_bitmap_t bs;              // Character bitstream
-    uint8_t glyph_width;                // Glyph width
-    font_glyph_t glyph;                 // Glyph header
-    uint16_t gind;                      // Glyph index
-
-    /* Check for selected font */
-    if (oled_descriptor->currentFontAddress == 0)
-    {
-        return 0;
-    }
+    custom_fs_address_t string_file_addr = custom_fs_get_current_string_file_address();
+    sh1122_string_sprite_entry_t* entry_pt = 0;
+    cust_char_t* string_pt;
     
-    /* Check that support for this char is described */
-    BOOL char_support_described = FALSE;
-    for (uint16_t i=0; i < sizeof(oled_descriptor->current_unicode_inters)/sizeof(oled_descriptor->current_unicode_inters[0]); i++)
+    /* Look for this string in the arena, for the current language */
+    for (uint16_t i = 0; i < OLED_STRING_SPRITE_NB_ENTRIES; i++)
     {
-        /* Check if char is within this interval */
-        if ((oled_descriptor->current_unicode_inters[i].interval_start != 0xFFFF) && (oled_descriptor->current_unicode_inters[i].interval_start <= ch) && (oled_descriptor->current_unicode_inters[i].interval_end >= ch))
+        if ((oled_descriptor->string_sprite_entries[i].size != 0) && (oled_descriptor->string_sprite_entries[i].string_id == string_id) && (oled_descriptor->string_sprite_entries[i].string_file_addr == string_file_addr))
         {
-            interval_start = oled_descriptor->current_unicode_inters[i].interval_start;
-            char_support_described = TRUE;
+            entry_pt = &oled_descriptor->string_sprite_entries[i];
             break;
         }
-        
-        /* Add offset to descriptor */
-        glyph_desc_pt_offset += oled_descriptor->current_unicode_inters[i].interval_end - oled_descriptor->current_unicode_inters[i].interval_start + 1;
-    }
-    
-    /* Support not described, check if we could switch with ? */
-    if (char_support_described == FALSE)
-    {
-        if (oled_descriptor->question_mark_support_described != FALSE)
-        {
-            interval_start = oled_descriptor->current_unicode_inters[0].interval_start;
-            glyph_desc_pt_offset = 0;
-            ch = '?';
-        }
-        else
-        {
-            return 0;
-        }
-    }
-    
-    /* Convert character to glyph index */
-    custom_fs_read_from_flash((uint8_t*)&gind, oled_descriptor->currentFontAddress + sizeof(oled_descriptor->current_font_header) + sizeof(oled_descriptor->current_unicode_inters) + glyph_desc_pt_offset*sizeof(gind) + (ch - interval_start)*sizeof(gind), sizeof(gind));
-
-    /* Check that we know this glyph */
-    if(gind == 0xFFFF)
-    {
-        // If we don't know this character, try again with '?'
-        if (oled_descriptor->question_mark_support_described == FALSE)
-        {
-            return 0;
-        }
-        else
-        {
-            ch = '?';
-        }
-        custom_fs_read_from_flash((uint8_t*)&gind, oled_descriptor->currentFontAddress + sizeof(oled_descriptor->current_font_header) + sizeof(oled_descriptor->current_unicode_inters) + glyph_desc_pt_offset*sizeof(gind) + (ch - interval_start)*sizeof(gind), sizeof(gind));
-        
-        // If we still don't know it, return 0
-        if (gind == 0xFFFF)
-        {
-            return 0;
-        }
     }
     
-    /* Read glyph data */
-    custom_fs_read_from_flash((uint8_t*)&glyph, oled_descriptor->currentFontAddress + sizeof(oled_descriptor->current_font_header) + sizeof(oled_descriptor->current_unicode_inters) + (oled_descriptor->current_font_header.described_chr_count)*sizeof(gind) + gind*sizeof(glyph), sizeof(glyph));
-
-    if (glyph.glyph_data_offset == 0xFFFFFFFF)
+    if (entry_pt != 0)
     {
-        /* Space character, just fill in the gddram buffer and output background pixels */
-        glyph_width = glyph.xrect >> 1; // space character is always too large...
+        oled_descriptor->string_sprite_hits++;
     }
     else
     {
-        /* Store glyph height and width, increment with offset */
-        glyph_width = glyph.xrect;
-        x += glyph.xoffset;
-        y += glyph.yoffset;
+        uint8_t* draw_buffer_pt = oled_descriptor->draw_buffer_pt;
+        int16_t draw_buffer_y_start = oled_descriptor->draw_buffer_y_start;
+        int16_t draw_buffer_nb_rows = oled_descriptor->draw_buffer_nb_rows;
+        uint32_t render_buffer[SH1122_STRING_SPRITE_RENDER_ROWS*SH1122_OLED_WIDTH/8];
+        uint8_t height = oled_descriptor->current_font_header.height;
+        sh1122_glyph_run_t run;
+        uint16_t row_size;
+        uint16_t width;
         
-        /* Compute glyph data address */
-        custom_fs_address_t gaddr = oled_descriptor->currentFontAddress + sizeof(oled_descriptor->current_font_header) + sizeof(oled_descriptor->current_unicode_inters) + (oled_descriptor->current_font_header.described_chr_count)*sizeof(gind) + (oled_descriptor->current_font_header.chr_count)*sizeof(glyph) + glyph.glyph_data_offset;
+        /* Fetch and lay out the string */
+        oled_descriptor->string_sprite_misses++;
+        if ((custom_fs_get_string_from_file(string_id, &string_pt) != RETURN_OK) || (sh1122_layout_string(oled_descriptor, string_pt, &run) != RETURN_OK))
+        {
+            return 0;
+        }
         
-        // Initialize bitstream & draw the character
-        bitstream_glyph_bitmap_init(&bs, &oled_descriptor->current_font_header, &glyph, gaddr, TRUE);
-        sh1122_draw_image_from_bitstream(oled_descriptor, x, y, &bs, write_to_buffer);
+        /* The string width doesn't include the last glyph spacing and counts spaces narrower than their advance: size the sprite from the glyph positions */
+        width = run.end_x;
+        for (uint16_t i = 0; i < run.nb_items; i++)
+        {
+            if ((run.items[i].x + run.items[i].width) > width)
+            {
+                width = run.items[i].x + run.items[i].width;
+            }
+        }
+    
+        /* Check that the sprite can fit inside our arena */
+        row_size = (width + 1) / 2;
+        if ((width == 0) || (width > SH1122_OLED_WIDTH) || ((row_size * height) > OLED_STRING_SPRITE_ARENA_SIZE))
+        {
+            return 0;
+        }
+        
+        entry_pt = sh1122_allocate_string_sprite_entry(oled_descriptor, row_size * height);
+        entry_pt->string_file_addr = string_file_addr;
+        entry_pt->string_id = string_id;
+        entry_pt->width = width;
+        entry_pt->string_width = run.width;
+        entry_pt->end_x = run.end_x;
+        entry_pt->height = height;
+        entry_pt->nb_glyphs = (uint8_t)run.nb_items;
+        
+        /* Render the glyphs in our stack buffer, a few sprite rows at a time, then pack these rows into the arena */
+        for (uint16_t y = 0; y < height; y += SH1122_STRING_SPRITE_RENDER_ROWS)
+        {
+            uint16_t nb_rows = ((height - y) < SH1122_STRING_SPRITE_RENDER_ROWS) ? (height - y) : SH1122_STRING_SPRITE_RENDER_ROWS;
+            
+            memset((void*)render_buffer, 0x00, sizeof(render_buffer));
+            sh1122_set_draw_buffer(oled_descriptor, (uint8_t*)render_buffer, y, SH1122_STRING_SPRITE_RENDER_ROWS);
+            for (uint16_t i = 0; i < run.nb_items; i++)
+            {
+                if (run.items[i].glyph_desc.valid != FALSE)
+                {
+                    sh1122_glyph_desc_draw(oled_descriptor, run.items[i].x, 0, &run.items[i].glyph_desc, TRUE);
+                }
+            }
+            for (uint16_t j = 0; j < nb_rows; j++)
+            {
+                memcpy(&oled_descriptor->string_sprite_arena[entry_pt->offset + (y + j) * row_size], &((uint8_t*)render_buffer)[j * (SH1122_OLED_WIDTH/2)], row_size);
+            }
+        }
+        sh1122_set_draw_buffer(oled_descriptor, draw_buffer_pt, draw_buffer_y_start, draw_buffer_nb_rows);
     }
     
-    return (uint8_t)(glyph_width + glyph.xoffset) + 1;
+    /* Update LRU info */
+    entry_pt->last_used = ++(oled_descriptor->string_sprite_use_counter);
+    
+    return entry_pt;
 }
 
-/*! \fn     sh1122_put_char(sh1122_descriptor_t* oled_descriptor, char ch, BOOL write_to_buffer)
-*   \brief  Print char on display
+/*! \fn     sh1122_put_cached_string_xy(sh1122_descriptor_t* oled_descriptor, int16_t x, uint8_t y, oled_align_te justify, uint32_t string_id, BOOL write_to_buffer)
+*   \brief  Display a current language string at x,y, keeping its rendered sprite for the next draws
 *   \param  oled_descriptor     Pointer to a sh1122 descriptor struct
-*   \param  ch                  Char to display
+*   \param  x                   Starting x
+*   \param  y                   Starting y
+*   \param  justify             String justify (see enum)
+*   \param  string_id           String ID
 *   \param  write_to_buffer     Set to true to write to internal buffer
-*   \return success status
+*   \return How many glyphs were printed
+*   \note   Sprites are only used for buffered draws of strings fitting before max_text_x, other draws taking the sh1122_put_string_xy() path
+*   \note   Sprites are dropped by sh1122_invalidate_glyph_cache() and not used once the language changed
 */
-RET_TYPE sh1122_put_char(sh1122_descriptor_t* oled_descriptor, cust_char_t ch, BOOL write_to_buffer)
+uint16_t sh1122_put_cached_string_xy(sh1122_descriptor_t* oled_descriptor, int16_t x, uint8_t y, oled_align_te justify, uint32_t string_id, BOOL write_to_buffer)
 {
+    sh1122_string_sprite_entry_t* entry_pt = 0;
+    int16_t max_text_x = oled_descriptor->max_text_x;
+    cust_char_t* string_pt;
+    
     /* Have we actually selected a font? */
     if (oled_descriptor->currentFontAddress == 0)
     {
-        return RETURN_NOK;
+        return 0;
     }
     
-    if ((ch == '\n') && (oled_descriptor->line_feed_allowed != FALSE))
-    {
-        oled_descriptor->cur_text_y += oled_descriptor->current_font_header.height;
-        oled_descriptor->cur_text_x = 0;
-    }
-    else if ((ch == '\r') && (oled_descriptor->carriage_return_allowed != FALSE))
+    if (write_to_buffer != FALSE)
     {
-        oled_descriptor->cur_text_x = 0;
+        entry_pt = sh1122_get_string_sprite(oled_descriptor, string_id);
     }
-    else
+    
+    /* Sprite available and not truncated: a single blit */
+    if (entry_pt != 0)
     {
-        uint16_t width = sh1122_get_glyph_width(oled_descriptor, ch);
+        int16_t sprite_x = sh1122_justify_text_x(oled_descriptor, x, entry_pt->string_width, justify, &max_text_x);
         
-        /* Check if we're not larger than the screen */
-        if ((width + oled_descriptor->cur_text_x) > oled_descriptor->max_text_x)
+        /* Every glyph fits before max_text_x when the sprite does */
+        if ((sprite_x + entry_pt->width) <= max_text_x)
         {
-            if (oled_descriptor->line_feed_allowed != FALSE)
-            {
-                oled_descriptor->cur_text_y += oled_descriptor->current_font_header.height;
-                oled_descriptor->cur_text_x = 0;
-            }
-            else
+            /* Check that we're not writing text after the screen edge */
+            oled_descriptor->cur_text_x = sprite_x;
+            oled_descriptor->cur_text_y = y;
+            if ((y + entry_pt->height) > SH1122_OLED_HEIGHT)
             {
-                return RETURN_NOK;
+                return 0;
             }
+            
+            sh1122_blit_to_draw_buffer(oled_descriptor, sprite_x, y, &oled_descriptor->string_sprite_arena[entry_pt->offset], entry_pt->width, entry_pt->height, (entry_pt->width + 1) / 2, sh1122_get_foreground_blit_mode(oled_descriptor));
+            oled_descriptor->cur_text_x = sprite_x + entry_pt->end_x;
+            return entry_pt->nb_glyphs;
         }
+    }
+    
+    /* Regular path */
+    if (custom_fs_get_string_from_file(string_id, &string_pt) != RETURN_OK)
+    {
+        return 0;
+    }
+    return sh1122_put_string_xy(oled_descriptor, x, y, justify, string_pt, write_to_buffer);
+}
+#endif
+
+#ifdef OLED_MARQUEE
+/*! \fn     sh1122_draw_marquee_window(sh1122_descriptor_t* oled_descriptor, sh1122_marquee_t* marquee)
+*   \brief  Copy the displayed part of a marquee strip to the frame buffer or the screen
+*   \param  oled_descriptor     Pointer to a sh1122 descriptor struct
+*   \param  marquee             Pointer to the marquee
+*/
+static void sh1122_draw_marquee_window(sh1122_descriptor_t* oled_descriptor, sh1122_marquee_t* marquee)
+{
+    int16_t offset = marquee->offset_transition.current_value;
+    
+    #ifdef OLED_INTERNAL_FRAME_BUFFER
+    /* Wait for a possible ongoing frame buffer fill */
+    sh1122_check_for_fill_and_terminate(oled_descriptor);
+    sh1122_frame_buffer_mark_dirty(oled_descriptor, 0, marquee->y, SH1122_OLED_WIDTH, marquee->height, TRUE);
+    #else
+    uint32_t row_buffer[SH1122_OLED_WIDTH/8];
+    #endif
+    
+    for (uint16_t j = 0; (j < marquee->height) && ((marquee->y + j) < SH1122_OLED_HEIGHT); j++)
+    {
+        #ifdef OLED_INTERNAL_FRAME_BUFFER
+        uint8_t* row_pt = oled_descriptor->frame_buffer[marquee->y + j];
+        #else
+        uint8_t* row_pt = (uint8_t*)row_buffer;
+        #endif
         
-        /* Check that we're not writing text after the screen edge */
-        if ((oled_descriptor->cur_text_y + oled_descriptor->current_font_header.height) > SH1122_OLED_HEIGHT)
+        /* Copy the strip segments overlapping the window, blits clip to the display width */
+        memset(row_pt, 0x00, SH1122_OLED_WIDTH/2);
+        for (int16_t segment = offset / SH1122_OLED_WIDTH; (segment < OLED_MARQUEE_MAX_WIDTH/SH1122_OLED_WIDTH) && ((segment * SH1122_OLED_WIDTH - offset) < SH1122_OLED_WIDTH); segment++)
         {
-            return RETURN_NOK;
+            sh1122_blit_row(row_pt, segment * SH1122_OLED_WIDTH - offset, marquee->strip[segment][j], SH1122_OLED_WIDTH, OLED_BLIT_OPAQUE);
         }
         
-        // Display the text
-        oled_descriptor->cur_text_x += sh1122_glyph_draw(oled_descriptor, oled_descriptor->cur_text_x, oled_descriptor->cur_text_y, ch, write_to_buffer);
+        #ifndef OLED_INTERNAL_FRAME_BUFFER
+        /* Send the row */
+        sh1122_set_row_address(oled_descriptor, marquee->y + j);
+        sh1122_set_column_address(oled_descriptor, 0);
+        sh1122_start_data_sending(oled_descriptor);
+        #ifdef OLED_DMA_TRANSFER
+        dma_oled_init_transfer((void*)&oled_descriptor->sercom_pt->SPI.DATA.reg, (void*)row_pt, SH1122_OLED_WIDTH/2, oled_descriptor->dma_trigger_id);
+        while(dma_oled_check_and_clear_dma_transfer_flag() == FALSE);
+        #else
+        for (uint16_t i = 0; i < SH1122_OLED_WIDTH/2; i++)
+        {
+            sercom_spi_send_single_byte_without_receive_wait(oled_descriptor->sercom_pt, row_pt[i]);
+        }
+        #endif
+        sercom_spi_wait_for_transmit_complete(oled_descriptor->sercom_pt);
+        sh1122_stop_data_sending(oled_descriptor);
+        #endif
     }
-    
-    return RETURN_OK;
 }
 
-/*! \fn     sh1122_put_string(sh1122_descriptor_t* oled_descriptor, const char* str, BOOL write_to_buffer)
-*   \brief  Print string at current x y
+/*! \fn     sh1122_start_marquee(sh1122_descriptor_t* oled_descriptor, sh1122_marquee_t* marquee, uint8_t y, const cust_char_t* string, uint32_t step_period_ms)
+*   \brief  Display a string scrolling horizontally if it is wider than the display
 *   \param  oled_descriptor     Pointer to a sh1122 descriptor struct
-*   \param  str                 String to print
-*   \param  write_to_buffer     Set to true to write to internal buffer
-*   \return Number of printed chars
+*   \param  marquee             Pointer to the marquee, must stay valid until sh1122_stop_marquee() is called
+*   \param  y                   Display y, the marquee spanning the display width
+*   \param  string              String to display
+*   \param  step_period_ms      Delay in ms between 1 pixel scroll steps
+*   \return RETURN_OK if the marquee was started
+*   \note   The string is rendered once in the marquee strip, scroll steps performed by sh1122_transitions_routine() being strip copies
 */
-uint16_t sh1122_put_string(sh1122_descriptor_t* oled_descriptor, const cust_char_t* str, BOOL write_to_buffer)
+RET_TYPE sh1122_start_marquee(sh1122_descriptor_t* oled_descriptor, sh1122_marquee_t* marquee, uint8_t y, const cust_char_t* string, uint32_t step_period_ms)
 {
-    uint16_t nb_printed_chars = 0;
+    uint8_t* draw_buffer_pt = oled_descriptor->draw_buffer_pt;
+    int16_t draw_buffer_y_start = oled_descriptor->draw_buffer_y_start;
+    int16_t draw_buffer_nb_rows = oled_descriptor->draw_buffer_nb_rows;
+    sh1122_glyph_run_t run;
     
-    // Write chars until we find final 0
-    while (*str)
+    /* Only one marquee at a time */
+    sh1122_stop_marquee(oled_descriptor);
+    
+    if ((sh1122_layout_string(oled_descriptor, string, &run) != RETURN_OK) || (oled_descriptor->current_font_header.height > OLED_MARQUEE_MAX_HEIGHT))
     {
-        if(sh1122_put_char(oled_descriptor, *str++, write_to_buffer) != RETURN_OK)
+        return RETURN_NOK;
+    }
+    
+    /* Strings wider than the strip are cut */
+    marquee->width = (run.width > OLED_MARQUEE_MAX_WIDTH) ? OLED_MARQUEE_MAX_WIDTH : run.width;
+    marquee->height = oled_descriptor->current_font_header.height;
+    marquee->step_period_ms = step_period_ms;
+    marquee->y = y;
+    
+    /* Render the string in each display width segment of the strip, glyphs are clipped to the segment borders */
+    memset((void*)marquee->strip, 0x00, sizeof(marquee->strip));
+    for (uint16_t segment = 0; segment < OLED_MARQUEE_MAX_WIDTH/SH1122_OLED_WIDTH; segment++)
+    {
+        int16_t segment_x = segment * SH1122_OLED_WIDTH;
+        
+        sh1122_set_draw_buffer(oled_descriptor, &marquee->strip[segment][0][0], 0, marquee->height);
+        for (uint16_t i = 0; i < run.nb_items; i++)
         {
-            return nb_printed_chars;
+            sh1122_glyph_run_item_t* item_pt = &run.items[i];
+            
+            if ((item_pt->glyph_desc.valid != FALSE) && ((item_pt->x + item_pt->width) > segment_x) && (item_pt->x < (segment_x + SH1122_OLED_WIDTH)))
+            {
+                sh1122_glyph_desc_draw(oled_descriptor, item_pt->x - segment_x, 0, &item_pt->glyph_desc, TRUE);
+            }
         }
-        else
+    }
+    sh1122_set_draw_buffer(oled_descriptor, draw_buffer_pt, draw_buffer_y_start, draw_buffer_nb_rows);
+    
+    /* Display the string start, scroll after a pause if it doesn't fit */
+    sh1122_start_transition(&marquee->offset_transition, 0, (marquee->width > SH1122_OLED_WIDTH) ? (marquee->width - SH1122_OLED_WIDTH) : 0, 1, step_period_ms);
+    marquee->offset_transition.next_step_time = timer_get_systick() + OLED_MARQUEE_PAUSE_MS;
+    sh1122_draw_marquee_window(oled_descriptor, marquee);
+    oled_descriptor->marquee_pt = marquee;
+    
+    return RETURN_OK;
+}
+
+/*! \fn     sh1122_stop_marquee(sh1122_descriptor_t* oled_descriptor)
+*   \brief  Stop scrolling the running marquee, leaving its current contents displayed
+*   \param  oled_descriptor     Pointer to a sh1122 descriptor struct
+*/
+void sh1122_stop_marquee(sh1122_descriptor_t* oled_descriptor)
+{
+    oled_descriptor->marquee_pt = 0;
+}
+
+/*! \fn     sh1122_marquee_routine(sh1122_descriptor_t* oled_descriptor)
+*   \brief  Perform the due running marquee scroll step
+*   \param  oled_descriptor     Pointer to a sh1122 descriptor struct
+*   \note   Called by sh1122_transitions_routine(). With a frame buffer, the marquee area is flushed
+*/
+void sh1122_marquee_routine(sh1122_descriptor_t* oled_descriptor)
+{
+    sh1122_marquee_t* marquee = oled_descriptor->marquee_pt;
+    uint32_t systick = timer_get_systick();
+    
+    /* Running marquee, wider than the display? */
+    if ((marquee == 0) || (marquee->width <= SH1122_OLED_WIDTH))
+    {
+        return;
+    }
+    
+    if (sh1122_transition_step(&marquee->offset_transition, systick) == FALSE)
+    {
+        /* String end displayed for long enough: go back to its start, pausing there too */
+        if ((marquee->offset_transition.in_progress != FALSE) || ((int32_t)(systick - marquee->restart_time) < 0))
         {
-            nb_printed_chars++;
+            return;
         }
+        sh1122_start_transition(&marquee->offset_transition, 0, marquee->width - SH1122_OLED_WIDTH, 1, marquee->step_period_ms);
+        marquee->offset_transition.next_step_time = systick + OLED_MARQUEE_PAUSE_MS;
+    }
+    else if (marquee->offset_transition.in_progress == FALSE)
+    {
+        /* String end reached */
+        marquee->restart_time = systick + OLED_MARQUEE_PAUSE_MS;
     }
     
-    return nb_printed_chars;
+    sh1122_draw_marquee_window(oled_descriptor, marquee);
+    #ifdef OLED_INTERNAL_FRAME_BUFFER
+    sh1122_flush_frame_buffer(oled_descriptor);
+    #endif
 }
+#endif
 
-/*! \fn     sh1122_put_string_xy(sh1122_descriptor_t* oled_descriptor, int16_t x, uint8_t y, oled_align_te justify, const char* string)
-*   \brief  Display an error string on the screen (X0Y0, centered)
+#ifdef OLED_BANDED_RENDERING
+/*! \fn     sh1122_draw_list_clear(sh1122_descriptor_t* oled_descriptor)
+*   \brief  Empty the draw list
 *   \param  oled_descriptor     Pointer to a sh1122 descriptor struct
-*   \param  string              Null terminated string
-*   \return How many characters were printed
 */
-uint16_t sh1122_put_error_string(sh1122_descriptor_t* oled_descriptor, const cust_char_t* string)
+void sh1122_draw_list_clear(sh1122_descriptor_t* oled_descriptor)
 {
-    return sh1122_put_string_xy(oled_descriptor, 0, 0, OLED_ALIGN_CENTER, string, FALSE);
+    oled_descriptor->draw_list_nb_items = 0;
 }
 
-/*! \fn     sh1122_put_string_xy(sh1122_descriptor_t* oled_descriptor, int16_t x, uint8_t y, oled_align_te justify, const char* string, BOOL write_to_buffer) 
-*   \brief  Display a string on the screen
+/*! \fn     sh1122_draw_list_add_bitmap(sh1122_descriptor_t* oled_descriptor, int16_t x, int16_t y, uint32_t file_id)
+*   \brief  Add a bitmap stored in the external flash to the draw list
+*   \param  oled_descriptor     Pointer to a sh1122 descriptor struct
+*   \param  x                   Starting x
+*   \param  y                   Starting y
+*   \param  file_id             Bitmap file ID
+*   \return success status
+*/
+RET_TYPE sh1122_draw_list_add_bitmap(sh1122_descriptor_t* oled_descriptor, int16_t x, int16_t y, uint32_t file_id)
+{
+    if (oled_descriptor->draw_list_nb_items == OLED_DRAW_LIST_SIZE)
+    {
+        return RETURN_NOK;
+    }
+    
+    sh1122_draw_item_t* item_pt = &oled_descriptor->draw_list[oled_descriptor->draw_list_nb_items++];
+    item_pt->item_type = OLED_DRAW_ITEM_BITMAP;
+    item_pt->bitmap_file_id = file_id;
+    item_pt->x = x;
+    item_pt->y = y;
+    return RETURN_OK;
+}
+
+/*! \fn     sh1122_draw_list_add_string(sh1122_descriptor_t* oled_descriptor, int16_t x, int16_t y, oled_align_te justify, const cust_char_t* string)
+*   \brief  Add a string to the draw list
 *   \param  oled_descriptor     Pointer to a sh1122 descriptor struct
 *   \param  x                   Starting x
 *   \param  y                   Starting y
 *   \param  justify             String justify (see enum)
-*   \param  string              Null terminated string
-*   \param  write_to_buffer     Set to true to write to internal buffer
-*   \return How many characters were printed
+*   \param  string              Null terminated string, must stay valid until the list is rendered
+*   \return success status
 */
-uint16_t sh1122_put_string_xy(sh1122_descriptor_t* oled_descriptor, int16_t x, uint8_t y, oled_align_te justify, const cust_char_t* string, BOOL write_to_buffer) 
+RET_TYPE sh1122_draw_list_add_string(sh1122_descriptor_t* oled_descriptor, int16_t x, int16_t y, oled_align_te justify, const cust_char_t* string)
 {
-    uint16_t width = sh1122_get_string_width(oled_descriptor, string);
-    int16_t max_text_x_copy = oled_descriptor->max_text_x;
-    uint16_t return_val;
+    if (oled_descriptor->draw_list_nb_items == OLED_DRAW_LIST_SIZE)
+    {
+        return RETURN_NOK;
+    }
+    
+    sh1122_draw_item_t* item_pt = &oled_descriptor->draw_list[oled_descriptor->draw_list_nb_items++];
+    item_pt->item_type = OLED_DRAW_ITEM_STRING;
+    item_pt->string_item.string = string;
+    item_pt->string_item.justify = justify;
+    item_pt->x = x;
+    item_pt->y = y;
+    return RETURN_OK;
+}
 
-    if (justify == OLED_ALIGN_CENTER)
+/*! \fn     sh1122_draw_list_add_rectangle(sh1122_descriptor_t* oled_descriptor, int16_t x, int16_t y, int16_t width, int16_t height, uint16_t color)
+*   \brief  Add a rectangle to the draw list
+*   \param  oled_descriptor     Pointer to a sh1122 descriptor struct
+*   \param  x                   Starting x
+*   \param  y                   Starting y
+*   \param  width               Width
+*   \param  height              Height
+*   \param  color               4 bits color
+*   \return success status
+*/
+RET_TYPE sh1122_draw_list_add_rectangle(sh1122_descriptor_t* oled_descriptor, int16_t x, int16_t y, int16_t width, int16_t height, uint16_t color)
+{
+    if (oled_descriptor->draw_list_nb_items == OLED_DRAW_LIST_SIZE)
+    {
+        return RETURN_NOK;
+    }
+    
+    sh1122_draw_item_t* item_pt = &oled_descriptor->draw_list[oled_descriptor->draw_list_nb_items++];
+    item_pt->item_type = OLED_DRAW_ITEM_RECTANGLE;
+    item_pt->rectangle_item.width = width;
+    item_pt->rectangle_item.height = height;
+    item_pt->rectangle_item.color = color;
+    item_pt->x = x;
+    item_pt->y = y;
+    return RETURN_OK;
+}
+
+/*! \fn     sh1122_draw_list_replay(sh1122_descriptor_t* oled_descriptor)
+*   \brief  Draw all the draw list items into the current draw buffer
+*   \param  oled_descriptor     Pointer to a sh1122 descriptor struct
+*/
+void sh1122_draw_list_replay(sh1122_descriptor_t* oled_descriptor)
+{
+    for (uint16_t i = 0; i < oled_descriptor->draw_list_nb_items; i++)
     {
-        if ((x + oled_descriptor->min_text_x + width) < oled_descriptor->max_text_x)
+        sh1122_draw_item_t* item_pt = &oled_descriptor->draw_list[i];
+        
+        if (item_pt->item_type == OLED_DRAW_ITEM_BITMAP)
         {
-            x = (oled_descriptor->max_text_x + x + oled_descriptor->min_text_x - width)/2;
+            sh1122_display_bitmap_from_flash(oled_descriptor, item_pt->x, item_pt->y, item_pt->bitmap_file_id, TRUE);
         }
-    } 
-    else if (justify == OLED_ALIGN_RIGHT)
-    {
-        if (x < oled_descriptor->max_text_x)
+        else if (item_pt->item_type == OLED_DRAW_ITEM_STRING)
         {
-            oled_descriptor->max_text_x = x;
+            sh1122_put_string_xy(oled_descriptor, item_pt->x, item_pt->y, (oled_align_te)item_pt->string_item.justify, item_pt->string_item.string, TRUE);
         }
-        if (x >= (width + oled_descriptor->min_text_x))
+        else if (item_pt->item_type == OLED_DRAW_ITEM_RECTANGLE)
         {
-            x -= width;
+            sh1122_draw_rectangle(oled_descriptor, item_pt->x, item_pt->y, item_pt->rectangle_item.width, item_pt->rectangle_item.height, item_pt->rectangle_item.color, TRUE);
         }
-        else if ((width + oled_descriptor->min_text_x) >= oled_descriptor->max_text_x)
+    }
+}
+
+/*! \fn     sh1122_render_draw_list(sh1122_descriptor_t* oled_descriptor)
+*   \brief  Render the draw list to the screen, band by band
+*   \param  oled_descriptor     Pointer to a sh1122 descriptor struct
+*   \note   Each band is sent using DMA while the next one is rendered in the other band buffer
+*   \note   Items are replayed for each band: bitmaps are decoded up to the band end for each band
+*/
+void sh1122_render_draw_list(sh1122_descriptor_t* oled_descriptor)
+{
+    /* Store current draw buffer */
+    uint8_t* previous_draw_buffer_pt = oled_descriptor->draw_buffer_pt;
+    int16_t previous_draw_buffer_y_start = oled_descriptor->draw_buffer_y_start;
+    int16_t previous_draw_buffer_nb_rows = oled_descriptor->draw_buffer_nb_rows;
+    
+    #ifdef OLED_INTERNAL_FRAME_BUFFER
+    /* Wait for a possible ongoing previous flush, display contents won't match the frame buffer anymore */
+    sh1122_check_for_flush_and_terminate(oled_descriptor);
+    sh1122_frame_buffer_mark_dirty(oled_descriptor, 0, 0, SH1122_OLED_WIDTH, SH1122_OLED_HEIGHT, FALSE);
+    #endif
+    
+    for (uint16_t band = 0; band < SH1122_OLED_HEIGHT/OLED_BAND_HEIGHT; band++)
+    {
+        uint8_t* band_buffer_pt = &oled_descriptor->band_buffers[band & 0x01][0][0];
+        
+        /* Render band */
+        memset((void*)band_buffer_pt, 0x00, sizeof(oled_descriptor->band_buffers[0]));
+        sh1122_set_draw_buffer(oled_descriptor, band_buffer_pt, band*OLED_BAND_HEIGHT, OLED_BAND_HEIGHT);
+        #ifdef OLED_BACKGROUND_LAYER
+        if (oled_descriptor->background_layer_pt != 0)
         {
-            x = oled_descriptor->min_text_x;
+            /* Band starts with the background layer rows: only the items are replayed */
+            sh1122_restore_background(oled_descriptor, 0, band*OLED_BAND_HEIGHT, SH1122_OLED_WIDTH, OLED_BAND_HEIGHT);
         }
-        else
+        #endif
+        sh1122_draw_list_replay(oled_descriptor);
+        
+        /* Wait for the previous band to be sent */
+        if (band != 0)
         {
-            x = oled_descriptor->max_text_x - width;
+            while(dma_oled_check_and_clear_dma_transfer_flag() == FALSE);
+            sercom_spi_wait_for_transmit_complete(oled_descriptor->sercom_pt);
+            sh1122_stop_data_sending(oled_descriptor);
         }
+        
+        /* Set pixel write window */
+        sh1122_set_row_address(oled_descriptor, band*OLED_BAND_HEIGHT);
+        sh1122_set_column_address(oled_descriptor, 0);
+        
+        /* Start sending band while the next one is rendered */
+        sh1122_start_data_sending(oled_descriptor);
+        dma_oled_init_transfer((void*)&oled_descriptor->sercom_pt->SPI.DATA.reg, (void*)band_buffer_pt, sizeof(oled_descriptor->band_buffers[0]), oled_descriptor->dma_trigger_id);
     }
     
-    /* Store cur text x & y */
-    oled_descriptor->cur_text_x = x;
-    oled_descriptor->cur_text_y = y;
-    
-    /* Display string */
-    return_val = sh1122_put_string(oled_descriptor, string, write_to_buffer);
-    oled_descriptor->max_text_x = max_text_x_copy;
+    /* Wait for the last band to be sent */
+    while(dma_oled_check_and_clear_dma_transfer_flag() == FALSE);
+    sercom_spi_wait_for_transmit_complete(oled_descriptor->sercom_pt);
+    sh1122_stop_data_sending(oled_descriptor);
     
-    // Return the number of characters printed
-    return return_val;
+    /* Restore draw buffer */
+    sh1122_set_draw_buffer(oled_descriptor, previous_draw_buffer_pt, previous_draw_buffer_y_start, previous_draw_buffer_nb_rows);
 }
+#endif
 
 #ifdef OLED_PRINTF_ENABLED
 /*! \fn     sh1122_printf_xy(sh1122_descriptor_t* oled_descriptor, int16_t x, uint8_t y, uint8_t justify, BOOL write_to_buffer, const char *fmt, ...) 
@@ -1334,9 +3736,6 @@ uint16_t sh1122_put_string_xy(sh1122_descriptor_t* oled_descriptor, int16_t x, u
 #pragma GCC diagnostic ignored "-Wsuggest-attribute=format"
 uint16_t sh1122_printf_xy(sh1122_descriptor_t* oled_descriptor, int16_t x, uint8_t y, oled_align_te justify, BOOL write_to_buffer, const char *fmt, ...) 
 {
-    int16_t max_text_x_copy = oled_descriptor->max_text_x;
-    uint16_t return_val;
-    uint16_t width;
     cust_char_t u16buf[64];
     char buf[64];    
     va_list ap;
@@ -1350,51 +3749,15 @@ uint16_t sh1122_printf_xy(sh1122_descriptor_t* oled_descriptor, int16_t x, uint8
         {
             u16buf[i] = buf[i];
         }
-        width = sh1122_get_string_width(oled_descriptor, u16buf);
     }
     else
     {
         va_end(ap);
         return 0;
     }
-
-    if (justify == OLED_ALIGN_CENTER)
-    {
-        if ((x + oled_descriptor->min_text_x + width) < oled_descriptor->max_text_x)
-        {
-            x = (oled_descriptor->max_text_x + x + oled_descriptor->min_text_x - width)/2;
-        }
-    }
-    else if (justify == OLED_ALIGN_RIGHT)
-    {
-        if (x < oled_descriptor->max_text_x)
-        {
-            oled_descriptor->max_text_x = x;
-        }
-        if (x >= (width + oled_descriptor->min_text_x))
-        {
-            x -= width;
-        }
-        else if ((width + oled_descriptor->min_text_x) >= oled_descriptor->max_text_x)
-        {
-            x = oled_descriptor->min_text_x;
-        }
-        else
-        {
-            x = oled_descriptor->max_text_x - width;
-        }
-    }
-    
-    /* Store cur text x & y */
-    oled_descriptor->cur_text_x = x;
-    oled_descriptor->cur_text_y = y;
     
     /* Display string */
-    return_val = sh1122_put_string(oled_descriptor, u16buf, write_to_buffer);
-    oled_descriptor->max_text_x = max_text_x_copy;
-    
-    // Return the number of characters printed
-    return return_val;
+    return sh1122_put_string_xy(oled_descriptor, x, y, justify, u16buf, write_to_buffer);
 }
 #pragma GCC diagnostic pop
 
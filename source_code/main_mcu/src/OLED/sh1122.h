@@ -47,6 +47,23 @@
 #define SH1122_OLED_WIDTH           256
 #define SH1122_OLED_HEIGHT          64
 #define SH1122_OLED_BPP             4
+#define SH1122_OLED_START_LINE_MASK 0x7F     // Display start line spans both GDDRAM buffers
+#define SH1122_OLED_INIT_START_LINE 32       // Display start line set by the init sequence
+#define SH1122_OLED_INIT_CONTRAST   0x80     // Contrast current set by the init sequence
+
+/* Draws can be made to the frame buffer or to rendering bands */
+#if defined(OLED_INTERNAL_FRAME_BUFFER) || defined(OLED_BANDED_RENDERING)
+    #define SH1122_BUFFERED_DRAWS
+#endif
+
+/* Frame buffer flush defines */
+#define SH1122_FLUSH_MIN_ROW_SAVING 16       // Min number of bytes saved per row for a partial rows flush to be worth the row/column commands
+
+/* Flash to display DMA ring defines */
+#define SH1122_DMA_RING_SLOT_SIZE   512      // Ring slot size in bytes, the ring having 2 slots: one fetched from flash while the other is sent to the display
+
+/* String sprites defines */
+#define SH1122_STRING_SPRITE_RENDER_ROWS    8   // Number of rows of the stack buffer sprites are rendered into, taller sprites being rendered in several passes
 
 /* Structs */
 // pixel buffer to allow merging of adjacent image data.
@@ -63,6 +80,120 @@ typedef struct
     uint8_t pixels;
 } gddram_px_t;
 
+typedef struct
+{
+    custom_fs_address_t data_addr;      // Glyph bitstream address, 0 for glyphs without data (space)
+    cust_char_t chr;                    // Character this descriptor was fetched for
+    uint8_t xrect;                      // x width of rectangle
+    uint8_t yrect;                      // y height of rectangle
+    int8_t xoffset;                     // x offset of glyph in rectangle
+    int8_t yoffset;                     // y offset of glyph in rectangle
+    uint8_t valid;                      // Set when the descriptor is populated
+} sh1122_glyph_desc_t;
+
+typedef struct
+{
+    sh1122_glyph_desc_t glyph_desc;     // Glyph descriptor
+    int16_t x;                          // Glyph x, relative to the run start
+    uint8_t width;                      // Glyph width, as returned by sh1122_get_glyph_width()
+} sh1122_glyph_run_item_t;
+
+typedef struct
+{
+    sh1122_glyph_run_item_t items[OLED_GLYPH_RUN_MAX_LENGTH];
+    uint16_t nb_items;                  // Number of glyphs in the run
+    uint16_t width;                     // Run width, as returned by sh1122_get_string_width()
+    int16_t end_x;                      // x after the last glyph, relative to the run start
+} sh1122_glyph_run_t;
+
+typedef struct
+{
+    uint32_t last_used;                 // Arena use counter value when last drawn, for LRU eviction
+    uint16_t offset;                    // Pixel data offset in the arena
+    uint16_t size;                      // Pixel data size, 0 if entry is free
+    cust_char_t chr;                    // Character
+    uint8_t width;                      // Glyph width
+    uint8_t height;                     // Glyph height
+} sh1122_glyph_arena_entry_t;
+
+typedef struct
+{
+    uint32_t last_used;                     // Sprite use counter value when last drawn, for LRU eviction
+    custom_fs_address_t string_file_addr;   // Address of the language string file the string was read from
+    uint32_t string_id;                     // String ID in the string file
+    uint16_t offset;                        // Pixel data offset in the arena
+    uint16_t size;                          // Pixel data size, 0 if entry is free
+    uint16_t width;                         // Sprite width, covering all glyph pixels and the text x after the string
+    uint16_t string_width;                  // String width, for justification
+    uint16_t end_x;                         // Text x after the string, relative to the sprite
+    uint8_t height;                         // Sprite height, the font height
+    uint8_t nb_glyphs;                      // Number of glyphs in the string
+} sh1122_string_sprite_entry_t;
+
+typedef struct
+{
+    int16_t x_min;                      // Leftmost frame buffer byte column
+    int16_t x_max;                      // Rightmost frame buffer byte column (included)
+    int16_t y_min;                      // Top row
+    int16_t y_max;                      // Bottom row (included), window is empty when y_max < y_min
+} sh1122_fb_window_t;
+
+typedef struct
+{
+    const cust_char_t* string;          // String to display, must stay valid until the draw list is rendered
+    uint16_t justify;                   // String justify (see oled_align_te)
+} sh1122_draw_item_string_t;
+
+typedef struct
+{
+    int16_t width;                      // Rectangle width
+    int16_t height;                     // Rectangle height
+    uint16_t color;                     // 4 bits color
+} sh1122_draw_item_rectangle_t;
+
+typedef struct
+{
+    uint16_t item_type;                 // Item type (see oled_draw_item_te)
+    int16_t x;                          // Starting x
+    int16_t y;                          // Starting y
+    union
+    {
+        uint32_t bitmap_file_id;
+        sh1122_draw_item_string_t string_item;
+        sh1122_draw_item_rectangle_t rectangle_item;
+    };
+} sh1122_draw_item_t;
+
+typedef struct
+{
+    uint32_t next_step_time;            // Systick value at which the next step should be performed
+    uint32_t step_period_ms;            // Delay between steps
+    int16_t current_value;              // Current value
+    int16_t target_value;               // Value at the end of the transition
+    int16_t step;                       // Signed value increment per step
+    BOOL in_progress;                   // Set while the transition isn't finished
+} sh1122_transition_t;
+
+typedef struct
+{
+    custom_fs_address_t first_frame_addr;   // Address of the first frame
+    custom_fs_address_t next_frame_addr;    // Address of the next frame to be drawn
+    uint16_t frame_period_ms;               // Recommended delay between frames
+    uint16_t nb_frames;                     // Number of frames
+    uint16_t next_frame;                    // Index of the next frame to be drawn
+} sh1122_animation_t;
+
+typedef struct
+{
+    uint8_t strip[OLED_MARQUEE_MAX_WIDTH/SH1122_OLED_WIDTH][OLED_MARQUEE_MAX_HEIGHT][SH1122_OLED_WIDTH/(8/SH1122_OLED_BPP)] __attribute__((aligned(4)));
+    sh1122_transition_t offset_transition;  // Scroll offset transition, the offset being the strip x displayed at the screen left
+    uint32_t restart_time;                  // Systick value at which the scroll restarts from the string start
+    uint32_t step_period_ms;                // Delay between 1 pixel scroll steps
+    uint16_t width;                         // Rendered string width
+    uint8_t height;                         // Rendered string height
+    uint8_t y;                              // Display y
+} sh1122_marquee_t;
+
 typedef struct
 {
     Sercom* sercom_pt;
@@ -83,27 +214,99 @@ typedef struct
     int16_t cur_text_x;                                 // Current x for writing text
     int16_t cur_text_y;                                 // Current y for writing text
     BOOL oled_on;                                       // Know if oled is on
+    uint8_t display_start_line;                         // Current display start line
+    uint8_t contrast_current;                           // Current contrast current
+    sh1122_transition_t start_line_transition;          // Display start line transition
+    sh1122_transition_t contrast_transition;            // Contrast current transition
+    #ifdef OLED_DMA_TRANSFER
+    uint8_t dma_fill_byte;                              // Byte repeatedly sent by display DMA fills
+    #endif
+    #ifdef OLED_GLYPH_DESC_CACHE
+    sh1122_glyph_desc_t glyph_desc_cache[OLED_GLYPH_DESC_CACHE_SIZE];
+    uint32_t glyph_desc_cache_misses;
+    uint32_t glyph_desc_cache_hits;
+    #endif
+    #ifdef OLED_GLYPH_BITMAP_ARENA
+    sh1122_glyph_arena_entry_t glyph_arena_entries[OLED_GLYPH_ARENA_NB_ENTRIES];
+    uint8_t glyph_arena[OLED_GLYPH_ARENA_SIZE];
+    uint32_t glyph_arena_use_counter;
+    uint32_t glyph_arena_misses;
+    uint32_t glyph_arena_hits;
+    uint16_t glyph_arena_used;
+    #endif
+    #ifdef OLED_STRING_SPRITE_CACHE
+    sh1122_string_sprite_entry_t string_sprite_entries[OLED_STRING_SPRITE_NB_ENTRIES];
+    uint8_t string_sprite_arena[OLED_STRING_SPRITE_ARENA_SIZE];
+    uint32_t string_sprite_use_counter;
+    uint32_t string_sprite_misses;
+    uint32_t string_sprite_hits;
+    uint16_t string_sprite_arena_used;
+    #endif
+    #ifdef OLED_MARQUEE
+    sh1122_marquee_t* marquee_pt;                       // Running marquee, 0 if none
+    #endif
+    #ifdef SH1122_BUFFERED_DRAWS
+    uint8_t* draw_buffer_pt;                            // Buffer written by buffered draws
+    int16_t draw_buffer_y_start;                        // Display row of the draw buffer first row
+    int16_t draw_buffer_nb_rows;                        // Number of rows in the draw buffer
+    #endif
+    #ifdef OLED_BACKGROUND_LAYER
+    uint8_t* background_layer_pt;                       // Decoded background foreground draws are blended over, 0 if none
+    int16_t background_layer_y_start;                   // Display row of the background layer first row
+    int16_t background_layer_nb_rows;                   // Number of rows in the background layer
+    #endif
+    #ifdef OLED_BANDED_RENDERING
+    uint8_t band_buffers[2][OLED_BAND_HEIGHT][SH1122_OLED_WIDTH/(8/SH1122_OLED_BPP)];
+    sh1122_draw_item_t draw_list[OLED_DRAW_LIST_SIZE];
+    uint16_t draw_list_nb_items;
+    #endif
     #ifdef OLED_INTERNAL_FRAME_BUFFER
-    uint8_t frame_buffer[SH1122_OLED_HEIGHT][SH1122_OLED_WIDTH/(8/SH1122_OLED_BPP)];
+    uint8_t frame_buffer[SH1122_OLED_HEIGHT][SH1122_OLED_WIDTH/(8/SH1122_OLED_BPP)] __attribute__((aligned(4)));
     BOOL frame_buffer_flush_in_progress;
+    BOOL display_fill_in_progress;                      // Set while a left running DMA fill of the display RAM is sent
+    BOOL frame_buffer_fill_in_progress;                 // Set while a DMA fill of the frame buffer is running
+    uint32_t frame_buffer_fill_word;                    // Word repeatedly written by frame buffer DMA fills
+    sh1122_fb_window_t frame_buffer_dirty_window;       // Frame buffer area to be sent at next flush
+    sh1122_fb_window_t frame_buffer_content_window;     // Frame buffer area that may contain non zero pixels
+    uint32_t frame_buffer_flush_start_time;             // Systick value at flush start
+    uint32_t frame_buffer_last_flush_time_ms;           // Duration of the last flush, until its completion was seen by the transitions routine or a flush wait
+    uint32_t frame_buffer_last_flush_nb_bytes;          // Number of pixel bytes sent during the last flush
+    BOOL frame_buffer_page_flip_enabled;                // Set to flush to the hidden GDDRAM page, displayed once sent
+    BOOL frame_buffer_page_flip_pending;                // Set when the hidden page is to be displayed at flush completion
+    sh1122_fb_window_t frame_buffer_hidden_page_window; // Hidden page area lagging behind the displayed page
+    #ifdef DEBUG_USB_COMMANDS_ENABLED
+    // Rows written since the last USB capture, one bit per row
+    uint32_t frame_buffer_uncaptured_rows[SH1122_OLED_HEIGHT/32];
+    #endif
     #endif
 } sh1122_descriptor_t;
 
 /* Enums */
 typedef enum {OLED_SCROLL_NONE = 0, OLED_SCROLL_UP = 1, OLED_SCROLL_DOWN = 2, OLED_SCROLL_FLIP = 3} oled_scroll_te;
 typedef enum {OLED_ALIGN_LEFT = 0, OLED_ALIGN_RIGHT = 1, OLED_ALIGN_CENTER = 2} oled_align_te;
+typedef enum {OLED_DRAW_ITEM_BITMAP = 0, OLED_DRAW_ITEM_STRING = 1, OLED_DRAW_ITEM_RECTANGLE = 2} oled_draw_item_te;
+typedef enum {OLED_BLIT_OPAQUE = 0, OLED_BLIT_OR = 1, OLED_BLIT_INVERTED = 2, OLED_BLIT_ALPHA = 3} oled_blit_mode_te;
 
 /* Prototypes */
 void sh1122_draw_non_aligned_image_from_bitstream(sh1122_descriptor_t* oled_descriptor, int16_t x, int16_t y, bitstream_bitmap_t* bitstream, BOOL write_to_buffer);
+uint16_t sh1122_put_ellipsized_string_xy(sh1122_descriptor_t* oled_descriptor, int16_t x, uint8_t y, oled_align_te justify, const cust_char_t* string, BOOL write_to_buffer);
+uint16_t sh1122_draw_glyph_run(sh1122_descriptor_t* oled_descriptor, sh1122_glyph_run_t* run, int16_t x, uint8_t y, oled_align_te justify, BOOL write_to_buffer);
 uint16_t sh1122_put_string_xy(sh1122_descriptor_t* oled_descriptor, int16_t x, uint8_t y, oled_align_te justify, const cust_char_t* string, BOOL write_to_buffer);
 void sh1122_draw_aligned_image_from_bitstream(sh1122_descriptor_t* oled_descriptor, int16_t x, int16_t y, bitstream_bitmap_t* bitstream, BOOL write_to_buffer);
 void sh1122_draw_image_from_bitstream(sh1122_descriptor_t* oled_descriptor, int16_t x, int16_t y, bitstream_bitmap_t* bitstream, BOOL write_to_buffer);
 RET_TYPE sh1122_display_bitmap_from_flash_at_recommended_position(sh1122_descriptor_t* oled_descriptor, uint32_t file_id, BOOL write_to_buffer);
 RET_TYPE sh1122_display_bitmap_from_flash(sh1122_descriptor_t* oled_descriptor, int16_t x, int16_t y, uint32_t file_id, BOOL write_to_buffer);
+RET_TYPE sh1122_draw_animation_frame(sh1122_descriptor_t* oled_descriptor, sh1122_animation_t* animation, BOOL write_to_buffer);
+RET_TYPE sh1122_open_animation(uint32_t file_id, sh1122_animation_t* animation);
+void sh1122_rewind_animation(sh1122_animation_t* animation);
 void sh1122_draw_full_screen_image_from_bitstream(sh1122_descriptor_t* oled_descriptor, bitstream_bitmap_t* bitstream);
-void sh1122_draw_rectangle(sh1122_descriptor_t* oled_descriptor, int16_t x, int16_t y, int16_t width, int16_t height, uint16_t color);
+void sh1122_draw_rectangle(sh1122_descriptor_t* oled_descriptor, int16_t x, int16_t y, int16_t width, int16_t height, uint16_t color, BOOL write_to_buffer);
+RET_TYPE sh1122_get_glyph_descriptor(sh1122_descriptor_t* oled_descriptor, cust_char_t ch, sh1122_glyph_desc_t* glyph_desc);
+void sh1122_ellipsize_glyph_run(sh1122_descriptor_t* oled_descriptor, sh1122_glyph_run_t* run, uint16_t max_width);
+RET_TYPE sh1122_layout_string(sh1122_descriptor_t* oled_descriptor, const cust_char_t* string, sh1122_glyph_run_t* run);
 uint16_t sh1122_glyph_draw(sh1122_descriptor_t* oled_descriptor, int16_t x, int16_t y, cust_char_t ch, BOOL write_to_buffer);
 uint16_t sh1122_put_string(sh1122_descriptor_t* oled_descriptor, const cust_char_t* str, BOOL write_to_buffer);
+void sh1122_start_contrast_transition(sh1122_descriptor_t* oled_descriptor, uint8_t target_contrast, uint8_t step, uint32_t step_period_ms);
 void sh1122_flip_buffers(sh1122_descriptor_t* oled_descriptor, oled_scroll_te scroll_mode, uint32_t delay);
 RET_TYPE sh1122_put_char(sh1122_descriptor_t* oled_descriptor, cust_char_t ch, BOOL write_to_buffer);
 uint16_t sh1122_put_error_string(sh1122_descriptor_t* oled_descriptor, const cust_char_t* string);
@@ -122,7 +325,11 @@ void sh1122_fill_screen(sh1122_descriptor_t* oled_descriptor, uint16_t color);
 void sh1122_set_max_text_x(sh1122_descriptor_t* oled_descriptor, int16_t x);
 void sh1122_set_min_text_x(sh1122_descriptor_t* oled_descriptor, int16_t x);
 void sh1122_flip_displayed_buffer(sh1122_descriptor_t* oled_descriptor);
+void sh1122_wait_for_transitions_end(sh1122_descriptor_t* oled_descriptor);
+BOOL sh1122_is_transition_in_progress(sh1122_descriptor_t* oled_descriptor);
+void sh1122_transitions_routine(sh1122_descriptor_t* oled_descriptor);
 void sh1122_clear_current_screen(sh1122_descriptor_t* oled_descriptor);
+void sh1122_invalidate_glyph_cache(sh1122_descriptor_t* oled_descriptor);
 void sh1122_set_emergency_font(sh1122_descriptor_t* oled_descriptor);
 void sh1122_start_data_sending(sh1122_descriptor_t* oled_descriptor);
 void sh1122_stop_data_sending(sh1122_descriptor_t* oled_descriptor);
@@ -134,11 +341,48 @@ void sh1122_oled_on(sh1122_descriptor_t* oled_descriptor);
 
 /* Depending on enabled features */
 #ifdef OLED_INTERNAL_FRAME_BUFFER
+void sh1122_frame_buffer_mark_dirty(sh1122_descriptor_t* oled_descriptor, int16_t x, int16_t y, int16_t width, int16_t height, BOOL frame_buffer_written);
 void sh1122_check_for_flush_and_terminate(sh1122_descriptor_t* oled_descriptor);
+void sh1122_check_for_flush_completion(sh1122_descriptor_t* oled_descriptor);
+void sh1122_move_frame_buffer_rows(sh1122_descriptor_t* oled_descriptor, int16_t y_dst, int16_t y_src, int16_t nb_rows);
+void sh1122_set_frame_buffer_page_flip(sh1122_descriptor_t* oled_descriptor, BOOL enable);
+void sh1122_check_for_fill_and_terminate(sh1122_descriptor_t* oled_descriptor);
 void sh1122_flush_frame_buffer(sh1122_descriptor_t* oled_descriptor);
 void sh1122_clear_frame_buffer(sh1122_descriptor_t* oled_descriptor);
 #endif
 
+#ifdef SH1122_BUFFERED_DRAWS
+void sh1122_blit_to_draw_buffer(sh1122_descriptor_t* oled_descriptor, int16_t x, int16_t y, const uint8_t* src_pt, uint16_t width, uint16_t height, uint16_t src_row_size, oled_blit_mode_te mode);
+void sh1122_blit_row(uint8_t* row_pt, int16_t x, const uint8_t* src_pt, int16_t nb_pixels, oled_blit_mode_te mode);
+void sh1122_fill_row(uint8_t* row_pt, int16_t x, int16_t nb_pixels, uint8_t color, oled_blit_mode_te mode);
+void sh1122_set_draw_buffer(sh1122_descriptor_t* oled_descriptor, uint8_t* buffer, int16_t y_start, int16_t nb_rows);
+#endif
+#ifdef OLED_BANDED_RENDERING
+RET_TYPE sh1122_draw_list_add_rectangle(sh1122_descriptor_t* oled_descriptor, int16_t x, int16_t y, int16_t width, int16_t height, uint16_t color);
+RET_TYPE sh1122_draw_list_add_string(sh1122_descriptor_t* oled_descriptor, int16_t x, int16_t y, oled_align_te justify, const cust_char_t* string);
+RET_TYPE sh1122_draw_list_add_bitmap(sh1122_descriptor_t* oled_descriptor, int16_t x, int16_t y, uint32_t file_id);
+void sh1122_render_draw_list(sh1122_descriptor_t* oled_descriptor);
+void sh1122_draw_list_replay(sh1122_descriptor_t* oled_descriptor);
+void sh1122_draw_list_clear(sh1122_descriptor_t* oled_descriptor);
+#endif
+#ifdef OLED_BACKGROUND_LAYER
+void sh1122_set_background_layer(sh1122_descriptor_t* oled_descriptor, uint8_t* layer, int16_t y_start, int16_t nb_rows);
+void sh1122_restore_background(sh1122_descriptor_t* oled_descriptor, int16_t x, int16_t y, int16_t width, int16_t height);
+RET_TYPE sh1122_load_background_layer(sh1122_descriptor_t* oled_descriptor, uint32_t file_id);
+#endif
+#ifdef OLED_STRING_SPRITE_CACHE
+uint16_t sh1122_put_cached_string_xy(sh1122_descriptor_t* oled_descriptor, int16_t x, uint8_t y, oled_align_te justify, uint32_t string_id, BOOL write_to_buffer);
+#endif
+#ifdef OLED_MARQUEE
+RET_TYPE sh1122_start_marquee(sh1122_descriptor_t* oled_descriptor, sh1122_marquee_t* marquee, uint8_t y, const cust_char_t* string, uint32_t step_period_ms);
+void sh1122_stop_marquee(sh1122_descriptor_t* oled_descriptor);
+void sh1122_marquee_routine(sh1122_descriptor_t* oled_descriptor);
+#endif
+#ifdef OLED_GLYPH_BITMAP_ARENA
+RET_TYPE sh1122_draw_glyph_from_arena(sh1122_descriptor_t* oled_descriptor, int16_t x, int16_t y, sh1122_glyph_desc_t* glyph_desc);
+sh1122_glyph_arena_entry_t* sh1122_allocate_glyph_arena_entry(sh1122_descriptor_t* oled_descriptor, uint16_t size);
+#endif
+
 /* ifdef prototypes */
 #ifdef OLED_PRINTF_ENABLED
     uint16_t sh1122_printf_xy(sh1122_descriptor_t* oled_descriptor, int16_t x, uint8_t y, oled_align_te justify, BOOL write_to_buffer, const char *fmt, ...);
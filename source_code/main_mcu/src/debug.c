@@ -14,6 +14,7 @@
 #include "platform_io.h"
 #include "custom_fs.h"
 #include "lis2hh12.h"
+#include "gui_list.h"
 #include "sh1122.h"
 #include "inputs.h"
 #include "debug.h"
@@ -36,20 +37,66 @@ void debug_array_to_hex_u8string(uint8_t* array, uint8_t* string, uint16_t lengt
     }
 }
 
+#ifdef OLED_MARQUEE
+/* Marquee of the marquee test, too large for the stack */
+sh1122_marquee_t debug_marquee;
+#endif
+
+/* Debug menu items */
+static const cust_char_t* debug_menu_items[] = 
+{
+    u"Time / Accelerometer / Battery",
+    u"Language Switch Test",
+    u"Smartcard Debug",
+    u"Animation Test",
+    u"Main and Aux MCU Info",
+    u"Scroll Through Glyphs",
+    u"Aux MCU BLE Info",
+    u"NiMH Charging",
+    u"Main MCU Flash",
+    u"Aux MCU Flash",
+    u"Rendering Benchmark",
+    u"Compositor Benchmark",
+    u"Marquee Test"
+};
+
+/*! \fn     debug_menu_fetch_item(uint16_t item_index, cust_char_t* string, uint16_t max_length)
+*   \brief  Get a debug menu item string, for the list widget
+*   \param  item_index  Item index
+*   \param  string      Where to store the string
+*   \param  max_length  Max number of characters, without terminating 0
+*/
+static void debug_menu_fetch_item(uint16_t item_index, cust_char_t* string, uint16_t max_length)
+{
+    const cust_char_t* item_string = debug_menu_items[item_index];
+    uint16_t i;
+    
+    for (i = 0; (i < max_length) && (item_string[i] != 0); i++)
+    {
+        string[i] = item_string[i];
+    }
+    string[i] = 0;
+}
+
 /*! \fn     debug_debug_menu(void)
 *   \brief  Debug menu
 */
 void debug_debug_menu(void)
 {
     wheel_action_ret_te wheel_user_action;
-    int16_t selected_item = 0;
     BOOL redraw_needed = TRUE;
+    gui_list_t menu_list;
 
+    gui_list_init(&menu_list, 14, 10, 4, sizeof(debug_menu_items)/sizeof(debug_menu_items[0]), debug_menu_fetch_item);
+    
     while(1)
     {
         /* Still deal with comms */
         comms_aux_mcu_routine();
         
+        /* Display transitions */
+        sh1122_transitions_routine(&plat_oled_descriptor);
+    
         /* Draw menu */
         if (redraw_needed != FALSE)
         {
@@ -61,43 +108,14 @@ void debug_debug_menu(void)
             sh1122_clear_current_screen(&plat_oled_descriptor);
             #endif
             
-            /* Item selection */
-            if (selected_item > 7)
-            {
-                selected_item = 0;
-            }
-            else if (selected_item < 0)
-            {
-                selected_item = 7;
-            }
-            
+            /* Title, the complete list will be drawn below */
             sh1122_put_string_xy(&plat_oled_descriptor, 0, 0, OLED_ALIGN_CENTER, u"Debug Menu", TRUE);
+            gui_list_invalidate(&menu_list);
+        }
             
-            /* Print items */
-            if (selected_item < 4)
-            {
-                sh1122_put_string_xy(&plat_oled_descriptor, 10, 14, OLED_ALIGN_LEFT, u"Time / Accelerometer / Battery", TRUE);
-                sh1122_put_string_xy(&plat_oled_descriptor, 10, 24, OLED_ALIGN_LEFT, u"Language Switch Test", TRUE);
-                sh1122_put_string_xy(&plat_oled_descriptor, 10, 34, OLED_ALIGN_LEFT, u"Smartcard Debug", TRUE);
-                sh1122_put_string_xy(&plat_oled_descriptor, 10, 44, OLED_ALIGN_LEFT, u"Animation Test", TRUE);
-            }
-            else if (selected_item < 8)
-            {
-                sh1122_put_string_xy(&plat_oled_descriptor, 10, 14, OLED_ALIGN_LEFT, u"Main and Aux MCU Info", TRUE);
-                sh1122_put_string_xy(&plat_oled_descriptor, 10, 24, OLED_ALIGN_LEFT, u"Scroll Through Glyphs", TRUE);
-                sh1122_put_string_xy(&plat_oled_descriptor, 10, 34, OLED_ALIGN_LEFT, u"Aux MCU BLE Info", TRUE);
-                sh1122_put_string_xy(&plat_oled_descriptor, 10, 44, OLED_ALIGN_LEFT, u"NiMH Charging", TRUE);
-                
-            }
-            else
-            {
-                sh1122_put_string_xy(&plat_oled_descriptor, 10, 14, OLED_ALIGN_LEFT, u"Main MCU Flash", TRUE);
-                sh1122_put_string_xy(&plat_oled_descriptor, 10, 24, OLED_ALIGN_LEFT, u"Aux MCU Flash", TRUE);
-            }
-            
-            /* Cursor */
-            sh1122_put_string_xy(&plat_oled_descriptor, 0, 14 + (selected_item%4)*10, OLED_ALIGN_LEFT, u"-", TRUE);
-            
+        /* Draw the list rows that changed */
+        if (gui_list_render(&plat_oled_descriptor, &menu_list) != 0)
+        {
             #ifdef OLED_INTERNAL_FRAME_BUFFER
             sh1122_flush_frame_buffer(&plat_oled_descriptor);
             #endif
@@ -109,16 +127,16 @@ void debug_debug_menu(void)
         /* action depending on scroll */
         if (wheel_user_action == WHEEL_ACTION_UP)
         {
-            redraw_needed = TRUE;
-            selected_item--;
+            gui_list_move_selection(&menu_list, -1);
         }
         else if (wheel_user_action == WHEEL_ACTION_DOWN)
         {
-            redraw_needed = TRUE;
-            selected_item++;
+            gui_list_move_selection(&menu_list, 1);
         }
         else if (wheel_user_action == WHEEL_ACTION_SHORT_CLICK)
         {
+            uint16_t selected_item = gui_list_get_selected_item(&menu_list);
+    
             if (selected_item == 0)
             {
                 debug_debug_screen();
@@ -161,6 +179,18 @@ void debug_debug_menu(void)
             {
                 logic_aux_mcu_flash_firmware_update();
             }
+            else if (selected_item == 10)
+            {
+                debug_rendering_benchmark();
+            }
+            else if (selected_item == 11)
+            {
+                debug_compositor_benchmark();
+            }
+            else if (selected_item == 12)
+            {
+                debug_marquee_test();
+            }
             redraw_needed = TRUE;
         }
     }
@@ -293,23 +323,89 @@ void debug_language_test(void)
 }
 
 /*! \fn     debug_debug_animation(void)
-*   \brief  Debug animation
+*   \brief  Debug animation: bitmap per frame animation, then delta frames animation if the bundle contains one
 */
 void debug_debug_animation(void)
 {
-    while (1)
+    BOOL animation_found = FALSE;
+    uint32_t animation_file_id = 0;
+    uint32_t delta_animation_fps = 0;
+    sh1122_animation_t animation;
+    uint32_t bitmap_fps;
+    uint32_t nb_frames = 0;
+    uint32_t start_time;
+    
+    /* Boot animation, each frame being a bitmap */
+    start_time = timer_get_systick();
+    while (inputs_get_wheel_action(FALSE, FALSE) != WHEEL_ACTION_SHORT_CLICK)
     {
-        for (uint16_t i = 0; i < 120; i++)
+        sh1122_display_bitmap_from_flash_at_recommended_position(&plat_oled_descriptor, nb_frames % 120, FALSE);
+        nb_frames++;
+    }
+    bitmap_fps = nb_frames * 1000 / (timer_get_systick() - start_time + 1);
+    
+    /* Look for a delta frames animation */
+    for (uint32_t i = 0; i < custom_fs_flash_header.binary_img_file_count; i++)
+    {
+        if (sh1122_open_animation(i, &animation) == RETURN_OK)
         {
-            sh1122_display_bitmap_from_flash_at_recommended_position(&plat_oled_descriptor, i, FALSE);
-            
-            /* Return ? */
-            if (inputs_get_wheel_action(FALSE, FALSE) == WHEEL_ACTION_SHORT_CLICK)
+            animation_found = TRUE;
+            animation_file_id = i;
+            break;
+        }
+    }
+    
+    /* Delta frames animation, as fast as possible */
+    if (animation_found != FALSE)
+    {
+        #ifdef OLED_INTERNAL_FRAME_BUFFER
+        BOOL write_to_buffer = TRUE;
+        sh1122_check_for_flush_and_terminate(&plat_oled_descriptor);
+        sh1122_clear_frame_buffer(&plat_oled_descriptor);
+        sh1122_set_frame_buffer_page_flip(&plat_oled_descriptor, TRUE);
+        #else
+        BOOL write_to_buffer = FALSE;
+        #endif
+    
+        nb_frames = 0;
+        start_time = timer_get_systick();
+        while (inputs_get_wheel_action(FALSE, FALSE) != WHEEL_ACTION_SHORT_CLICK)
+        {
+            /* Loop */
+            if (animation.next_frame == animation.nb_frames)
             {
-                return;
+                sh1122_rewind_animation(&animation);
             }
+            sh1122_draw_animation_frame(&plat_oled_descriptor, &animation, write_to_buffer);
+            #ifdef OLED_INTERNAL_FRAME_BUFFER
+            sh1122_flush_frame_buffer(&plat_oled_descriptor);
+            #endif
+            nb_frames++;
         }
+        delta_animation_fps = nb_frames * 1000 / (timer_get_systick() - start_time + 1);
+        #ifdef OLED_INTERNAL_FRAME_BUFFER
+        sh1122_set_frame_buffer_page_flip(&plat_oled_descriptor, FALSE);
+        #endif
     }
+    
+    /* Display results */
+    #ifdef OLED_INTERNAL_FRAME_BUFFER
+    sh1122_check_for_flush_and_terminate(&plat_oled_descriptor);
+    #endif
+    sh1122_clear_current_screen(&plat_oled_descriptor);
+    sh1122_put_string_xy(&plat_oled_descriptor, 0, 0, OLED_ALIGN_CENTER, u"Animation Test", FALSE);
+    sh1122_printf_xy(&plat_oled_descriptor, 0, 14, OLED_ALIGN_LEFT, FALSE, "BITMAP FRAMES: %u fps", bitmap_fps);
+    if (animation_found != FALSE)
+    {
+        sh1122_printf_xy(&plat_oled_descriptor, 0, 24, OLED_ALIGN_LEFT, FALSE, "DELTA FRAMES: %u fps, file %u, %u frames", delta_animation_fps, animation_file_id, animation.nb_frames);
+    }
+    else
+    {
+        sh1122_put_string_xy(&plat_oled_descriptor, 0, 24, OLED_ALIGN_LEFT, u"DELTA FRAMES: no animation file", FALSE);
+    }
+    
+    /* Wait for click to return */
+    while (inputs_get_wheel_action(FALSE, FALSE) != WHEEL_ACTION_SHORT_CLICK);
 }
 
 /*! \fn     debug_debug_screen(void)
@@ -331,6 +427,9 @@ void debug_debug_screen(void)
         /* Deal with comms */
         comms_aux_mcu_routine();
         
+        /* Display transitions */
+        sh1122_transitions_routine(&plat_oled_descriptor);
+    
         /* Clear screen */
         stat_times[0] = timer_get_systick();
         #ifdef OLED_INTERNAL_FRAME_BUFFER
@@ -394,6 +493,16 @@ void debug_debug_screen(void)
         /* Line 4: battery */
         sh1122_printf_xy(&plat_oled_descriptor, 0, 30, OLED_ALIGN_LEFT, TRUE, "BAT: ADC %u, %u mV", bat_adc_result, bat_adc_result*110/273);
         
+        /* Line 1: last frame buffer flush */
+        #ifdef OLED_INTERNAL_FRAME_BUFFER
+        sh1122_printf_xy(&plat_oled_descriptor, 0, 0, OLED_ALIGN_LEFT, TRUE, "FLUSH: %u bytes, %u ms", plat_oled_descriptor.frame_buffer_last_flush_nb_bytes, plat_oled_descriptor.frame_buffer_last_flush_time_ms);
+        #endif
+    
+        /* Line 5: glyph cache */
+        #ifdef OLED_GLYPH_DESC_CACHE
+        sh1122_printf_xy(&plat_oled_descriptor, 0, 40, OLED_ALIGN_LEFT, TRUE, "GLYPH CACHE: hits %u, misses %u", plat_oled_descriptor.glyph_desc_cache_hits, plat_oled_descriptor.glyph_desc_cache_misses);
+        #endif
+    
         /* Display stats */
         stat_times[5] = timer_get_systick();
         
@@ -606,4 +715,294 @@ void debug_nimh_charging(void)
             sh1122_printf_xy(&plat_oled_descriptor, 0, 10, OLED_ALIGN_LEFT, FALSE, "Vbat: %u mV", bat_mv);
         }
     }
-}
\ No newline at end of file
+}
+
+#ifdef OLED_INTERNAL_FRAME_BUFFER
+/*! \fn     debug_decode_rle_bitmaps(BOOL use_spans)
+*   \brief  Decode all the RLE bitmaps of the bundle
+*   \param  use_spans           Set to TRUE to decode spans, FALSE to decode 2 pixels at a time
+*   \return Number of decoded pixels
+*/
+static uint32_t debug_decode_rle_bitmaps(BOOL use_spans)
+{
+    uint32_t nb_decoded_pixels = 0;
+    
+    for (uint32_t file_id = 0; file_id < custom_fs_flash_header.bitmap_file_count; file_id++)
+    {
+        custom_fs_address_t file_address;
+        bitstream_bitmap_t bitstream;
+        bitmap_t bitmap;
+        uint8_t color;
+    
+        /* Only RLE bitmaps */
+        if (custom_fs_get_file_address(file_id, &file_address, CUSTOM_FS_BITMAP_TYPE) != RETURN_OK)
+        {
+            continue;
+        }
+        custom_fs_read_from_flash((uint8_t*)&bitmap, file_address, sizeof(bitmap));
+        if ((bitmap.flags & CUSTOM_FS_BITMAP_RLE_FLAG) == 0)
+        {
+            continue;
+        }
+    
+        bitstream_bitmap_init(&bitstream, &bitmap, file_address + sizeof(bitmap), TRUE);
+        for (uint16_t j = 0; j < bitmap.height; j++)
+        {
+            for (uint16_t i = 0; i < bitmap.width;)
+            {
+                if (use_spans != FALSE)
+                {
+                    i += bitstream_bitmap_span_read(&bitstream, &color, bitmap.width - i);
+                }
+                else if ((i + 2) <= bitmap.width)
+                {
+                    bitstream_bitmap_two_pixel_read(&bitstream);
+                    i += 2;
+                }
+                else
+                {
+                    bitstream_bitmap_read(&bitstream, 1);
+                    i++;
+                }
+            }
+        }
+        bitstream_bitmap_close(&bitstream);
+        nb_decoded_pixels += (uint32_t)bitmap.width * bitmap.height;
+    }
+    
+    return nb_decoded_pixels;
+}
+#endif
+
+/*! \fn     debug_rendering_benchmark(void)
+*   \brief  Benchmark our rendering routines
+*/
+void debug_rendering_benchmark(void)
+{
+    #ifdef OLED_INTERNAL_FRAME_BUFFER
+    const cust_char_t* benchmark_string = u"0123456789 Rendering Benchmark";
+    uint32_t text_no_cache_time_ms;
+    uint32_t text_cached_time_ms;
+    uint32_t blit_row_buffer[SH1122_OLED_WIDTH/8];
+    uint32_t span_decode_time_ms;
+    uint32_t pixel_decode_time_ms;
+    uint32_t nb_rle_pixels;
+    uint32_t blit_time_ms;
+    uint32_t nb_draws = 100;
+    uint32_t nb_blits = 10;
+    uint32_t start_time;
+    
+    sh1122_check_for_flush_and_terminate(&plat_oled_descriptor);
+    
+    /* Text rendering, starting with empty caches */
+    start_time = timer_get_systick();
+    for (uint32_t i = 0; i < nb_draws; i++)
+    {
+        sh1122_invalidate_glyph_cache(&plat_oled_descriptor);
+        sh1122_put_string_xy(&plat_oled_descriptor, 0, 0, OLED_ALIGN_LEFT, benchmark_string, TRUE);
+    }
+    text_no_cache_time_ms = timer_get_systick() - start_time;
+    
+    /* Text rendering, caches warmed up by the previous draw */
+    start_time = timer_get_systick();
+    for (uint32_t i = 0; i < nb_draws; i++)
+    {
+        sh1122_put_string_xy(&plat_oled_descriptor, 0, 0, OLED_ALIGN_LEFT, benchmark_string, TRUE);
+    }
+    text_cached_time_ms = timer_get_systick() - start_time;
+    
+    #ifdef OLED_STRING_SPRITE_CACHE
+    uint32_t text_sprite_time_ms;
+    
+    /* Language string, rendered once then blitted from its sprite */
+    start_time = timer_get_systick();
+    for (uint32_t i = 0; i < nb_draws; i++)
+    {
+        sh1122_put_cached_string_xy(&plat_oled_descriptor, 0, 0, OLED_ALIGN_LEFT, 0, TRUE);
+    }
+    text_sprite_time_ms = timer_get_systick() - start_time;
+    text_sprite_time_ms = (text_sprite_time_ms == 0) ? 1 : text_sprite_time_ms;
+    #endif
+    
+    /* Full screen blits at even and odd x */
+    memset((void*)blit_row_buffer, 0x5A, sizeof(blit_row_buffer));
+    start_time = timer_get_systick();
+    for (uint32_t i = 0; i < nb_blits; i++)
+    {
+        sh1122_blit_to_draw_buffer(&plat_oled_descriptor, i & 0x01, 0, (uint8_t*)blit_row_buffer, SH1122_OLED_WIDTH, SH1122_OLED_HEIGHT, 0, OLED_BLIT_OR);
+    }
+    blit_time_ms = timer_get_systick() - start_time;
+    
+    /* RLE bitmaps decoding, spans then pixels */
+    start_time = timer_get_systick();
+    nb_rle_pixels = debug_decode_rle_bitmaps(TRUE);
+    span_decode_time_ms = timer_get_systick() - start_time;
+    start_time = timer_get_systick();
+    debug_decode_rle_bitmaps(FALSE);
+    pixel_decode_time_ms = timer_get_systick() - start_time;
+    
+    #ifdef OLED_BANDED_RENDERING
+    uint32_t banded_render_time_ms;
+    
+    /* Draw list similar to the debug menu */
+    sh1122_draw_list_clear(&plat_oled_descriptor);
+    sh1122_draw_list_add_bitmap(&plat_oled_descriptor, 0, 0, 0);
+    sh1122_draw_list_add_string(&plat_oled_descriptor, 0, 0, OLED_ALIGN_CENTER, u"Debug Menu");
+    sh1122_draw_list_add_string(&plat_oled_descriptor, 10, 14, OLED_ALIGN_LEFT, u"Time / Accelerometer / Battery");
+    sh1122_draw_list_add_string(&plat_oled_descriptor, 10, 24, OLED_ALIGN_LEFT, u"Language Switch Test");
+    sh1122_draw_list_add_string(&plat_oled_descriptor, 10, 34, OLED_ALIGN_LEFT, u"Smartcard Debug");
+    sh1122_draw_list_add_string(&plat_oled_descriptor, 10, 44, OLED_ALIGN_LEFT, u"Animation Test");
+    sh1122_draw_list_add_rectangle(&plat_oled_descriptor, 1, 17, 5, 3, 0x0F);
+    
+    /* Banded rendering to the screen */
+    start_time = timer_get_systick();
+    sh1122_render_draw_list(&plat_oled_descriptor);
+    banded_render_time_ms = timer_get_systick() - start_time;
+    #endif
+    
+    /* Avoid divisions by 0 */
+    text_no_cache_time_ms = (text_no_cache_time_ms == 0) ? 1 : text_no_cache_time_ms;
+    text_cached_time_ms = (text_cached_time_ms == 0) ? 1 : text_cached_time_ms;
+    blit_time_ms = (blit_time_ms == 0) ? 1 : blit_time_ms;
+    span_decode_time_ms = (span_decode_time_ms == 0) ? 1 : span_decode_time_ms;
+    pixel_decode_time_ms = (pixel_decode_time_ms == 0) ? 1 : pixel_decode_time_ms;
+    
+    /* Display results */
+    sh1122_clear_frame_buffer(&plat_oled_descriptor);
+    sh1122_put_string_xy(&plat_oled_descriptor, 0, 0, OLED_ALIGN_CENTER, u"Rendering Benchmark", TRUE);
+    #ifdef OLED_STRING_SPRITE_CACHE
+    sh1122_printf_xy(&plat_oled_descriptor, 0, 10, OLED_ALIGN_LEFT, TRUE, "TEXT: %u draws/s, %u no caches, %u sprite", nb_draws*1000/text_cached_time_ms, nb_draws*1000/text_no_cache_time_ms, nb_draws*1000/text_sprite_time_ms);
+    #else
+    sh1122_printf_xy(&plat_oled_descriptor, 0, 10, OLED_ALIGN_LEFT, TRUE, "TEXT: %u draws/s, %u without caches", nb_draws*1000/text_cached_time_ms, nb_draws*1000/text_no_cache_time_ms);
+    #endif
+    #ifdef OLED_GLYPH_BITMAP_ARENA
+    sh1122_printf_xy(&plat_oled_descriptor, 0, 20, OLED_ALIGN_LEFT, TRUE, "GLYPH ARENA: hits %u, misses %u, %u bytes", plat_oled_descriptor.glyph_arena_hits, plat_oled_descriptor.glyph_arena_misses, plat_oled_descriptor.glyph_arena_used);
+    #endif
+    #ifdef OLED_BANDED_RENDERING
+    sh1122_printf_xy(&plat_oled_descriptor, 0, 30, OLED_ALIGN_LEFT, TRUE, "BANDS: draw list rendered in %u ms", banded_render_time_ms);
+    #endif
+    sh1122_printf_xy(&plat_oled_descriptor, 0, 40, OLED_ALIGN_LEFT, TRUE, "BLIT: %u kpixels/s", nb_blits*SH1122_OLED_WIDTH*SH1122_OLED_HEIGHT/blit_time_ms);
+    sh1122_printf_xy(&plat_oled_descriptor, 0, 50, OLED_ALIGN_LEFT, TRUE, "RLE: %u kpixels/s spans, %u 2 pixels reads", nb_rle_pixels/span_decode_time_ms, nb_rle_pixels/pixel_decode_time_ms);
+    sh1122_flush_frame_buffer(&plat_oled_descriptor);
+    
+    /* Wait for click to return */
+    while (inputs_get_wheel_action(FALSE, FALSE) != WHEEL_ACTION_SHORT_CLICK);
+    #endif
+}
+
+/*! \fn     debug_compositor_benchmark(void)
+*   \brief  Benchmark text updates over a bitmap background, with and without a background layer
+*   \note   The background layer only covers the updated text rows, to keep it on the stack
+*/
+void debug_compositor_benchmark(void)
+{
+    #if defined(OLED_BACKGROUND_LAYER) && defined(OLED_INTERNAL_FRAME_BUFFER)
+    uint32_t background_layer[16*SH1122_OLED_WIDTH/8];
+    cust_char_t update_string[] = u"Update 000";
+    uint32_t redecode_time_ms;
+    uint32_t layer_time_ms;
+    uint16_t nb_updates = 100;
+    uint32_t start_time;
+    
+    sh1122_check_for_flush_and_terminate(&plat_oled_descriptor);
+    
+    /* Each update decodes the background from flash again, as our screens do */
+    start_time = timer_get_systick();
+    for (uint16_t i = 0; i < nb_updates; i++)
+    {
+        update_string[7] = u'0' + (i / 100) % 10;
+        update_string[8] = u'0' + (i / 10) % 10;
+        update_string[9] = u'0' + i % 10;
+        sh1122_clear_frame_buffer(&plat_oled_descriptor);
+        sh1122_display_bitmap_from_flash_at_recommended_position(&plat_oled_descriptor, 0, TRUE);
+        sh1122_put_string_xy(&plat_oled_descriptor, 0, 26, OLED_ALIGN_CENTER, update_string, TRUE);
+        sh1122_flush_frame_buffer(&plat_oled_descriptor);
+        sh1122_check_for_flush_and_terminate(&plat_oled_descriptor);
+    }
+    redecode_time_ms = timer_get_systick() - start_time;
+    
+    /* Background decoded once, each update restoring the text rows before blending the new text */
+    sh1122_set_background_layer(&plat_oled_descriptor, (uint8_t*)background_layer, 24, 16);
+    sh1122_load_background_layer(&plat_oled_descriptor, 0);
+    sh1122_clear_frame_buffer(&plat_oled_descriptor);
+    sh1122_display_bitmap_from_flash_at_recommended_position(&plat_oled_descriptor, 0, TRUE);
+    start_time = timer_get_systick();
+    for (uint16_t i = 0; i < nb_updates; i++)
+    {
+        update_string[7] = u'0' + (i / 100) % 10;
+        update_string[8] = u'0' + (i / 10) % 10;
+        update_string[9] = u'0' + i % 10;
+        sh1122_restore_background(&plat_oled_descriptor, 0, 24, SH1122_OLED_WIDTH, 16);
+        sh1122_put_string_xy(&plat_oled_descriptor, 0, 26, OLED_ALIGN_CENTER, update_string, TRUE);
+        sh1122_flush_frame_buffer(&plat_oled_descriptor);
+        sh1122_check_for_flush_and_terminate(&plat_oled_descriptor);
+    }
+    layer_time_ms = timer_get_systick() - start_time;
+    sh1122_set_background_layer(&plat_oled_descriptor, 0, 0, 0);
+    
+    /* Display results */
+    sh1122_clear_frame_buffer(&plat_oled_descriptor);
+    sh1122_put_string_xy(&plat_oled_descriptor, 0, 0, OLED_ALIGN_CENTER, u"Compositor Benchmark", TRUE);
+    #ifdef OLED_PRINTF_ENABLED
+    sh1122_printf_xy(&plat_oled_descriptor, 0, 20, OLED_ALIGN_LEFT, TRUE, "Background decoded: %u us per update", redecode_time_ms*1000/nb_updates);
+    sh1122_printf_xy(&plat_oled_descriptor, 0, 30, OLED_ALIGN_LEFT, TRUE, "Background layer: %u us per update", layer_time_ms*1000/nb_updates);
+    #endif
+    sh1122_flush_frame_buffer(&plat_oled_descriptor);
+    
+    /* Wait for click to return */
+    while (inputs_get_wheel_action(FALSE, FALSE) != WHEEL_ACTION_SHORT_CLICK);
+    #endif
+}
+
+/*! \fn     debug_marquee_test(void)
+*   \brief  Marquee test: current language strings, scrolled when wider than the display. Wheel to change string, click to return
+*/
+void debug_marquee_test(void)
+{
+    #ifdef OLED_MARQUEE
+    wheel_action_ret_te wheel_user_action = WHEEL_ACTION_NONE;
+    BOOL redraw_needed = TRUE;
+    uint32_t string_id = 0;
+    cust_char_t* string_pt;
+    
+    while (wheel_user_action != WHEEL_ACTION_SHORT_CLICK)
+    {
+        /* Display transitions, marquee scroll steps included */
+        sh1122_transitions_routine(&plat_oled_descriptor);
+        
+        /* Title and selected string */
+        if (redraw_needed != FALSE)
+        {
+            redraw_needed = FALSE;
+            #ifdef OLED_INTERNAL_FRAME_BUFFER
+            sh1122_clear_frame_buffer(&plat_oled_descriptor);
+            #else
+            sh1122_clear_current_screen(&plat_oled_descriptor);
+            #endif
+            sh1122_put_string_xy(&plat_oled_descriptor, 0, 0, OLED_ALIGN_CENTER, u"Marquee Test", TRUE);
+            if (custom_fs_get_string_from_file(string_id, &string_pt) == RETURN_OK)
+            {
+                sh1122_start_marquee(&plat_oled_descriptor, &debug_marquee, 26, string_pt, 20);
+            }
+            #ifdef OLED_INTERNAL_FRAME_BUFFER
+            sh1122_flush_frame_buffer(&plat_oled_descriptor);
+            #endif
+        }
+        
+        /* Get user action */
+        wheel_user_action = inputs_get_wheel_action(FALSE, FALSE);
+        if ((wheel_user_action == WHEEL_ACTION_UP) && (string_id != 0))
+        {
+            string_id--;
+            redraw_needed = TRUE;
+        }
+        else if (wheel_user_action == WHEEL_ACTION_DOWN)
+        {
+            string_id++;
+            redraw_needed = TRUE;
+        }
+    }
+    
+    sh1122_stop_marquee(&plat_oled_descriptor);
+    #endif
+}
@@ -10,8 +10,11 @@
 
 /* Prototypes */
 void debug_array_to_hex_u8string(uint8_t* array, uint8_t* string, uint16_t length);
+void debug_compositor_benchmark(void);
 void debug_mcu_and_aux_info(void);
+void debug_rendering_benchmark(void);
 void debug_debug_animation(void);
+void debug_marquee_test(void);
 void debug_smartcard_info(void);
 void debug_nimh_charging(void);
 void debug_language_test(void);
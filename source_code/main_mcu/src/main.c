@@ -306,6 +306,10 @@ int main(void)
         {
             abc++;
             comms_aux_mcu_routine();
+            #ifdef CUSTOM_FS_PREFETCH
+            custom_fs_prefetch_routine();
+            #endif
+            sh1122_transitions_routine(&plat_oled_descriptor);
             if (lis2hh12_check_data_received_flag_and_arm_other_transfer(&acc_descriptor) != FALSE)
             {
                 cntt++;
@@ -9,6 +9,11 @@
 #include <asf.h>
 #include "defines.h"
 
+/* Host emulator build: peripherals are emulated in RAM */
+#ifdef EMULATOR_BUILD
+    #include "emu_hw.h"
+#endif
+
 /**************** FIRMWARE DEFINES ****************/
 #define FW_MAJOR    0
 #define FW_MINOR    1
@@ -102,6 +107,31 @@ typedef struct
 #define OLED_DMA_TRANSFER
 /* Use a frame buffer on the platform */
 #define OLED_INTERNAL_FRAME_BUFFER
+/* Display and bundle caches, application only: the bootloader compiles the same drivers */
+#ifndef BOOTLOADER
+/* Cache the current font glyph descriptors in RAM: 392B in the display descriptor */
+#define OLED_GLYPH_DESC_CACHE
+/* Keep decoded glyph bitmaps in a RAM arena for frame buffer writes: 1520B in the display descriptor */
+//#define OLED_GLYPH_BITMAP_ARENA
+/* Scroll strings wider than the display from a pre-rendered RAM strip: 4B in the display descriptor, 4128B per caller sh1122_marquee_t */
+//#define OLED_MARQUEE
+/* Alpha blend buffered foreground draws over a decoded background layer: 8B in the display descriptor, plus the caller layer rows */
+#define OLED_BACKGROUND_LAYER
+/* Keep rendered sprites of the last drawn strings from the language string file: 1744B in the display descriptor, 2160B of stack when rendering */
+//#define OLED_STRING_SPRITE_CACHE
+/* Keep the bundle string, font and bitmap file address tables in RAM: 704B */
+#define CUSTOM_FS_FILE_TABLE_CACHE
+/* Keep the last read language strings in RAM: 864B */
+//#define CUSTOM_FS_STRING_CACHE
+/* Serve small external flash reads from a set associative RAM cache: 1312B */
+//#define CUSTOM_FS_FLASH_CACHE
+/* Queue external flash reads to be done by DMA when the bus is idle: 128B */
+#define CUSTOM_FS_PREFETCH
+/* Check bundle files against the bundle file CRC table when first accessed: 136B */
+#define CUSTOM_FS_LAZY_FILE_CHECK
+#endif
+/* Render draw lists band by band, allows removing the frame buffer */
+//#define OLED_BANDED_RENDERING
 /* allow printf for the screen */
 //#define OLED_PRINTF_ENABLED
 /* Allow debug USB commands */
@@ -113,6 +143,55 @@ typedef struct
 /* Debug printf through USB */
 //#define DEBUG_USB_PRINTF_ENABLED
 
+/* OLED defines */
+#define OLED_GLYPH_DESC_CACHE_SIZE  32      // Number of cached glyph descriptors, power of 2
+#define OLED_GLYPH_ARENA_SIZE       1024    // Decoded glyph bitmaps arena size in bytes
+#define OLED_GLYPH_ARENA_NB_ENTRIES 40      // Max number of glyphs stored in the arena
+#define OLED_BAND_HEIGHT            8       // Number of display rows per rendering band, 64 must be a multiple of it
+#define OLED_DRAW_LIST_SIZE         16      // Max number of items in a draw list
+#define OLED_GLYPH_RUN_MAX_LENGTH   64      // Max number of glyphs in a laid out string
+#define OLED_MARQUEE_MAX_WIDTH      512     // Max marquee string width, multiple of the display width
+#define OLED_MARQUEE_MAX_HEIGHT     16      // Max marquee font height
+#define OLED_MARQUEE_PAUSE_MS       1000    // Pause at each end of the marquee scroll
+#define OLED_STRING_SPRITE_ARENA_SIZE   1536    // Rendered string sprites arena size in bytes
+#define OLED_STRING_SPRITE_NB_ENTRIES   8       // Max number of string sprites stored in the arena
+
+/* Custom FS defines */
+#define CUSTOM_FS_FILE_TABLE_CACHE_SIZE 160     // Max number of file addresses kept in RAM, others are read from flash
+#define CUSTOM_FS_STRING_CACHE_NB_SLOTS 4       // Number of cached strings
+#define CUSTOM_FS_STRING_CACHE_MAX_LENGTH   128 // Max number of chars per cached string, terminating 0 included
+#define CUSTOM_FS_FLASH_CACHE_LINE_SIZE 32      // Flash cache line size in bytes, power of 2, reads crossing a line bypass the cache
+#define CUSTOM_FS_FLASH_CACHE_NB_SETS   8       // Number of flash cache sets, power of 2
+#define CUSTOM_FS_FLASH_CACHE_NB_WAYS   4       // Number of flash cache lines per set
+#define CUSTOM_FS_PREFETCH_QUEUE_SIZE   8       // Max number of queued prefetch requests, power of 2
+#define CUSTOM_FS_LAZY_CHECK_MAX_FILES  256     // Max number of files whose check result is kept in RAM, others are checked at each access
+
+/* Functionality dependencies */
+#if defined(OLED_GLYPH_BITMAP_ARENA) && !defined(OLED_INTERNAL_FRAME_BUFFER) && !defined(OLED_BANDED_RENDERING)
+    #error "OLED_GLYPH_BITMAP_ARENA requires OLED_INTERNAL_FRAME_BUFFER or OLED_BANDED_RENDERING"
+#endif
+#if defined(OLED_MARQUEE) && !defined(OLED_INTERNAL_FRAME_BUFFER) && !defined(OLED_BANDED_RENDERING)
+    #error "OLED_MARQUEE requires OLED_INTERNAL_FRAME_BUFFER or OLED_BANDED_RENDERING"
+#endif
+#if defined(OLED_BACKGROUND_LAYER) && !defined(OLED_INTERNAL_FRAME_BUFFER) && !defined(OLED_BANDED_RENDERING)
+    #error "OLED_BACKGROUND_LAYER requires OLED_INTERNAL_FRAME_BUFFER or OLED_BANDED_RENDERING"
+#endif
+#if defined(OLED_STRING_SPRITE_CACHE) && !defined(OLED_INTERNAL_FRAME_BUFFER) && !defined(OLED_BANDED_RENDERING)
+    #error "OLED_STRING_SPRITE_CACHE requires OLED_INTERNAL_FRAME_BUFFER or OLED_BANDED_RENDERING"
+#endif
+#if defined(CUSTOM_FS_FLASH_CACHE) && (((CUSTOM_FS_FLASH_CACHE_LINE_SIZE & (CUSTOM_FS_FLASH_CACHE_LINE_SIZE - 1)) != 0) || ((CUSTOM_FS_FLASH_CACHE_NB_SETS & (CUSTOM_FS_FLASH_CACHE_NB_SETS - 1)) != 0))
+    #error "CUSTOM_FS_FLASH_CACHE_LINE_SIZE and CUSTOM_FS_FLASH_CACHE_NB_SETS must be powers of 2"
+#endif
+#if defined(CUSTOM_FS_PREFETCH) && (!defined(FLASH_ALONE_ON_SPI_BUS) || !defined(FLASH_DMA_FETCHES))
+    #error "CUSTOM_FS_PREFETCH requires FLASH_ALONE_ON_SPI_BUS and FLASH_DMA_FETCHES"
+#endif
+#if defined(CUSTOM_FS_PREFETCH) && ((CUSTOM_FS_PREFETCH_QUEUE_SIZE & (CUSTOM_FS_PREFETCH_QUEUE_SIZE - 1)) != 0)
+    #error "CUSTOM_FS_PREFETCH_QUEUE_SIZE must be a power of 2"
+#endif
+#if defined(OLED_BANDED_RENDERING) && ((64 % OLED_BAND_HEIGHT) != 0)
+    #error "OLED_BAND_HEIGHT must divide the display height"
+#endif
+
 /* GCLK ID defines */
 #define GCLK_ID_48M             GCLK_CLKCTRL_GEN_GCLK0_Val
 #define GCLK_ID_32K             GCLK_CLKCTRL_GEN_GCLK3_Val
@@ -197,6 +276,7 @@ typedef struct
 #define DMA_DESCID_TX_OLED          4
 #define DMA_DESCID_RX_ACC           5
 #define DMA_DESCID_TX_COMMS         6
+#define DMA_DESCID_FILL_RAM         7
 
 /* External interrupts numbers */
 #if defined(PLAT_V1_SETUP) || defined(PLAT_V2_SETUP)